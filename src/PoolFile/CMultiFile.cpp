@@ -29,11 +29,13 @@
 
 #include <stdexcept>
 #include <algorithm>
+#include <memory>
 
 #include <istring>
 
 #include <CPath.h>
 #include <endian_util.h>
+#include <CTrace.h>
 
 //#if defined(__SOLARIS_GNU_CPP__) || defined(__SOLARIS_SUN_CPP__) || defined(__LINUX_GNU_CPP__)
 	// ??? if windows is posix... I think it should have these necessary files... We'll see when we try to compile there
@@ -193,6 +195,9 @@ const CMultiFile::l_addr_t CMultiFile::tell(RHandle &handle) const
 
 void CMultiFile::read(void *buffer,const l_addr_t count,RHandle &handle)
 {
+	TRACE_SCOPE("CMultiFile::read");
+	TRACE_COUNT("CMultiFile bytes read",count);
+
 	if(!opened)
 		throw runtime_error(string(__func__)+" -- not opened");
 	if((totalSize-handle.position)<count)
@@ -241,6 +246,9 @@ void CMultiFile::read(void *buffer,const l_addr_t count,const l_addr_t _position
 
 void CMultiFile::write(const void *buffer,const l_addr_t count,RHandle &handle)
 {
+	TRACE_SCOPE("CMultiFile::write");
+	TRACE_COUNT("CMultiFile bytes written",count);
+
 	if(!opened)
 		throw runtime_error(string(__func__)+" -- not opened");
 	if((getAvailableSize()-handle.position)<count)
@@ -291,6 +299,95 @@ void CMultiFile::write(const void *buffer,const l_addr_t count,const l_addr_t _p
 	write(buffer,count,handle);
 }
 
+void CMultiFile::copyFrom(CMultiFile &src,const l_addr_t srcPosition,const l_addr_t count,const l_addr_t destPosition)
+{
+	if(!opened)
+		throw runtime_error(string(__func__)+" -- not opened");
+	if(!src.opened)
+		throw runtime_error(string(__func__)+" -- src not opened");
+	if(srcPosition>src.totalSize || (src.totalSize-srcPosition)<count)
+		throw runtime_error(string(__func__)+" -- attempting to copy beyond the end of the src file size; position: "+istring(srcPosition)+" count: "+istring(count));
+	if(&src==this && srcPosition<destPosition+count && destPosition<srcPosition+count)
+		throw runtime_error(string(__func__)+" -- src and dest regions overlap");
+	if(getAvailableSize()<destPosition || (getAvailableSize()-destPosition)<count)
+		throw runtime_error(string(__func__)+" -- insufficient space to write "+istring(count)+" more bytes");
+
+	// grow file(s) if necessary
+	if(totalSize<(destPosition+count))
+		prvSetSize(destPosition+count,count);
+
+	l_addr_t srcPos=srcPosition;
+	l_addr_t destPos=destPosition;
+	l_addr_t lengthToCopy=count;
+	while(lengthToCopy>0)
+	{
+		// copy in strips that don't cross a file boundary on either side
+		const size_t srcWhichFile=srcPos/LOGICAL_MAX_FILE_SIZE;
+		const f_addr_t srcWhereFile=srcPos%LOGICAL_MAX_FILE_SIZE;
+		const size_t destWhichFile=destPos/LOGICAL_MAX_FILE_SIZE;
+		const f_addr_t destWhereFile=destPos%LOGICAL_MAX_FILE_SIZE;
+
+		const size_t stripCopy=min(lengthToCopy,min(LOGICAL_MAX_FILE_SIZE-srcWhereFile,LOGICAL_MAX_FILE_SIZE-destWhereFile));
+		copyStrip(src.openFiles[srcWhichFile],srcWhereFile+HEADER_SIZE,openFiles[destWhichFile],destWhereFile+HEADER_SIZE,stripCopy);
+
+		lengthToCopy-=stripCopy;
+		srcPos+=stripCopy;
+		destPos+=stripCopy;
+	}
+}
+
+void CMultiFile::copyStrip(int srcFileHandle,f_addr_t srcWhere,int destFileHandle,f_addr_t destWhere,size_t count)
+{
+#ifdef __linux__
+	// let the kernel do the copy (it will share the extents if the file system supports it and the offsets are suitably aligned)
+	while(count>0)
+	{
+		loff_t srcOffset=srcWhere;
+		loff_t destOffset=destWhere;
+		const ssize_t lengthCopied=copy_file_range(srcFileHandle,&srcOffset,destFileHandle,&destOffset,count,0);
+		if(lengthCopied<=0)
+		{
+			const int errNO=errno;
+			if(lengthCopied==0 || errNO==EXDEV || errNO==ENOSYS || errNO==EINVAL || errNO==EOPNOTSUPP || errNO==EBADF)
+				break; // not supported for these files (or this kernel), so do it the old fashioned way
+			throw runtime_error(string(__func__)+" -- error copying between files -- strerror: "+strerror(errNO));
+		}
+
+		srcWhere+=lengthCopied;
+		destWhere+=lengthCopied;
+		count-=lengthCopied;
+	}
+#endif
+
+	if(count<=0)
+		return;
+
+	const size_t bufferSize=min(count,(size_t)(1024*1024));
+	std::unique_ptr<uint8_t[]> buffer(new uint8_t[bufferSize]);
+	while(count>0)
+	{
+		const size_t len=min(count,bufferSize);
+
+		const ssize_t lengthRead=::pread(srcFileHandle,buffer.get(),len,srcWhere);
+		if(lengthRead<0 || (size_t)lengthRead!=len)
+		{
+			const int errNO=errno;
+			throw runtime_error(string(__func__)+" -- error reading from file -- where: "+istring(srcWhere)+" lengthRead/len: "+istring(lengthRead)+"/"+istring(len)+(lengthRead<0 ? string(" strerror: ")+strerror(errNO) : string("")));
+		}
+
+		const ssize_t lengthWritten=::pwrite(destFileHandle,buffer.get(),len,destWhere);
+		if(lengthWritten<0 || (size_t)lengthWritten!=len)
+		{
+			const int errNO=errno;
+			throw runtime_error(string(__func__)+" -- error writing to file -- where: "+istring(destWhere)+" lengthWritten/len: "+istring(lengthWritten)+"/"+istring(len)+(lengthWritten<0 ? string(" strerror: ")+strerror(errNO) : string(" -- perhaps the disk is full")));
+		}
+
+		srcWhere+=len;
+		destWhere+=len;
+		count-=len;
+	}
+}
+
 void CMultiFile::setSize(const l_addr_t newSize)
 {
 	prvSetSize(newSize,0);
@@ -74,6 +74,14 @@ public:
 	void write(const void *buffer,const l_addr_t count,RHandle &handle);
 	void write(const void *buffer,const l_addr_t count,const l_addr_t _position);
 
+	/* -- Copies count bytes from srcPosition in src to destPosition in this file
+	 * - The data never passes through user space if the kernel supports copy_file_range()
+	 *   between the two files (and on reflink capable file systems like btrfs and XFS the
+	 *   extents may even be shared instead of copied).  Otherwise it falls back to pread/pwrite
+	 * - src may be this object, but the two ranges must not overlap
+	 */
+	void copyFrom(CMultiFile &src,const l_addr_t srcPosition,const l_addr_t count,const l_addr_t destPosition);
+
 	void setSize(const l_addr_t newSize);
 
 	void sync() const;
@@ -123,6 +131,8 @@ private:
 	void prvSetSize(const l_addr_t newSize,const l_addr_t forWriteSize);
 	void setFileSize(const int fileHandle,const f_addr_t newFileSize);
 
+	static void copyStrip(int srcFileHandle,f_addr_t srcWhere,int destFileHandle,f_addr_t destWhere,size_t count);
+
 	const string buildFilename(size_t which);
 	static const string buildFilename(size_t which,const string &initialFilename);
 };
@@ -43,6 +43,8 @@ public:
 	void prepend(const l_addr_t count);
 
 	void remove(const l_addr_t where,const l_addr_t count);
+	// makes several removals and insertions at once (see TPoolFile::RSpaceEdit)
+	void editSpace(const vector<typename pool_file_t::RSpaceEdit> &edits);
 	void clear();
 
 
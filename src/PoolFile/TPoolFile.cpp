@@ -83,6 +83,7 @@
 #include <istring>
 
 #include <endian_util.h>
+#include <CTrace.h>
 
 #include "TPoolFile.h"
 #include "TStaticPoolAccesser.h"
@@ -1023,6 +1024,15 @@ template<class l_addr_t,class p_addr_t>
 	return getPoolSize(getPoolIdByName(poolName));
 }
 
+template<class l_addr_t,class p_addr_t>
+	const size_t TPoolFile<l_addr_t,p_addr_t>::getPoolBlockCount(const poolId_t poolId) const
+{
+	if(!isValidPoolId(poolId))
+		throw runtime_error(string(__func__)+" -- invalid poolId parameter: "+istring(poolId));
+
+	return SAT[poolId].size();
+}
+
 template<class l_addr_t,class p_addr_t>
 	void TPoolFile<l_addr_t,p_addr_t>::writeMetaData(CMultiFile *f,bool writeSAT)
 {
@@ -1945,6 +1955,148 @@ dprintf("removeSpace - case 4/4\n");
 	backupSAT();
 }
 
+template<class l_addr_t,class p_addr_t>
+	void TPoolFile<l_addr_t,p_addr_t>::editSpace(const poolId_t poolId,const vector<RSpaceEdit> &edits)
+{
+	/*
+	 * This does what a removeSpace() and insertSpace() for each edit (from the last to the first) 
+	 * would do, but builds the pool's new SAT in one pass over the old one.  The logical starts are
+	 * assigned as the new blocks are appended so nothing needs to be offset after each edit, and 
+	 * the cache invalidation, block joining and SAT backup are each done once.
+	 */
+
+	if(!opened)
+		throw runtime_error(string(__func__)+" -- no file is open");
+
+	if(!isValidPoolId(poolId))
+		throw runtime_error(string(__func__)+" -- invalid poolId: "+istring(poolId));
+
+	const alignment_t bAlignment=pools[poolId].alignment;
+	const l_addr_t bPoolSize=pools[poolId].size;
+	const l_addr_t pePoolSize=bPoolSize/bAlignment;
+	const l_addr_t pePoolMaxSize=maxLogicalAddress/bAlignment;
+
+	// validate all the edits before changing anything
+	l_addr_t peNewPoolSize=pePoolSize;
+	bool anyRemoves=false;
+	for(size_t t=0;t<edits.size();t++)
+	{
+		const RSpaceEdit &edit=edits[t];
+		if(edit.where>pePoolSize || pePoolSize-edit.where<edit.removeCount)
+			throw runtime_error(string(__func__)+" -- out of range where "+istring(edit.where)+" and removeCount "+istring(edit.removeCount)+" for pool ("+getPoolDescription(poolId)+")");
+		if(t>0 && (edit.where<edits[t-1].where || edit.where-edits[t-1].where<edits[t-1].removeCount))
+			throw runtime_error(string(__func__)+" -- edits are not sorted or they overlap at where "+istring(edit.where)+" for pool ("+getPoolDescription(poolId)+")");
+
+		peNewPoolSize-=edit.removeCount;
+		if(pePoolMaxSize-peNewPoolSize<edit.insertCount)
+			throw runtime_error(string(__func__)+" -- insufficient logical address space to insert "+istring(edit.insertCount)+" elements into pool ("+getPoolDescription(poolId)+")");
+		peNewPoolSize+=edit.insertCount;
+
+		if(edit.removeCount>0)
+			anyRemoves=true;
+	}
+
+	invalidateAllCachedBlocks(false,poolId);
+
+	const blocksize_t maxBlockSize=getMaxBlockSizeFromAlignment(bAlignment);
+	const vector<RLogicalBlock> &oldSAT=SAT[poolId];
+	vector<RLogicalBlock> newSAT;
+	newSAT.reserve(oldSAT.size()+edits.size()*2);
+
+	l_addr_t newLogicalStart=0;
+	auto appendBlock=[&](const p_addr_t physicalStart,const l_addr_t size)
+	{
+		RLogicalBlock block;
+		block.logicalStart=newLogicalStart;
+		block.physicalStart=physicalStart;
+		block.size=size;
+		newSAT.push_back(block);
+		newLogicalStart+=size;
+	};
+	auto appendNewSpace=[&](const l_addr_t bCount)
+	{
+		for(l_addr_t bDone=0;bDone<bCount;)
+		{
+			const l_addr_t size=min((l_addr_t)maxBlockSize,bCount-bDone);
+			appendBlock(pasm.alloc(size),size);
+			bDone+=size;
+		}
+	};
+
+	size_t e=0;
+	l_addr_t bRemoveEnd=0; // the end of a removal which may continue into the next block(s)
+	for(size_t t=0;t<oldSAT.size();t++)
+	{
+		const RLogicalBlock &block=oldSAT[t];
+		const l_addr_t blockEnd=block.logicalStart+block.size;
+
+		// what is left of the block is [pos,blockEnd) and is at physical address cur
+		l_addr_t pos=block.logicalStart;
+		p_addr_t cur=block.physicalStart;
+		bool remaining=true;
+
+		// removes [pos,removeEnd) from the front of what is left of the block
+		auto removeHead=[&](const l_addr_t removeEnd)
+		{
+			if(removeEnd<=pos)
+				return;
+			if(removeEnd>=blockEnd)
+			{
+				pasm.free(cur);
+				remaining=false;
+			}
+			else
+			{
+				cur=pasm.partial_free(cur,cur+(removeEnd-pos),blockEnd-removeEnd);
+				pos=removeEnd;
+			}
+		};
+
+		removeHead(bRemoveEnd);
+
+		while(remaining && e<edits.size() && edits[e].where*bAlignment<blockEnd)
+		{
+			const l_addr_t bWhere=edits[e].where*bAlignment;
+			const l_addr_t bRemoveCount=edits[e].removeCount*bAlignment;
+			const l_addr_t bInsertCount=edits[e].insertCount*bAlignment;
+			e++;
+
+			if(bRemoveCount==0 && bInsertCount==0)
+				continue;
+
+			if(bWhere>pos)
+			{ // keep the part of the block before the edit
+				const p_addr_t rest=pasm.split_block(cur,bWhere-pos);
+				appendBlock(cur,bWhere-pos);
+				cur=rest;
+				pos=bWhere;
+			}
+
+			appendNewSpace(bInsertCount);
+
+			bRemoveEnd=bWhere+bRemoveCount;
+			removeHead(bRemoveEnd);
+		}
+
+		if(remaining)
+			appendBlock(cur,blockEnd-pos);
+	}
+
+	// edits at the end of the pool
+	for(;e<edits.size();e++)
+		appendNewSpace(edits[e].insertCount*bAlignment);
+
+	SAT[poolId].swap(newSAT);
+	pools[poolId].size=newLogicalStart;
+
+	joinAdjacentBlocks(poolId);
+
+	if(anyRemoves)
+		pasm.make_file_smallest();
+
+	backupSAT();
+}
+
 template<class l_addr_t,class p_addr_t>
 	void TPoolFile<l_addr_t,p_addr_t>::moveData(const poolId_t destPoolId,const l_addr_t peDestWhere,const poolId_t srcPoolId,const l_addr_t peSrcWhere,const l_addr_t peCount)
 {
@@ -2224,6 +2376,96 @@ dprintf("moveData -- case 6/6\n");
 	backupSAT();
 }
 
+template<class l_addr_t,class p_addr_t>
+	void TPoolFile<l_addr_t,p_addr_t>::copyData(const poolId_t destPoolId,const l_addr_t peDestWhere,TPoolFile<l_addr_t,p_addr_t> &srcPoolFile,const poolId_t srcPoolId,const l_addr_t peSrcWhere,const l_addr_t peCount)
+{
+	/*
+	 * Rather than reading the data into a cached block and writing it back out one pool
+	 * element at a time, this walks the src and dest SATs together and asks the CMultiFile
+	 * to copy each physically contiguous run directly from one file to the other
+	 */
+
+	if(!opened)
+		throw runtime_error(string(__func__)+" -- no file is open");
+	if(!srcPoolFile.opened)
+		throw runtime_error(string(__func__)+" -- no src file is open");
+	if(peCount==0)
+		return;
+
+	// validate the parameters
+	if(!srcPoolFile.isValidPoolId(srcPoolId))
+		throw runtime_error(string(__func__)+" -- invalid srcPoolId: "+istring(srcPoolId));
+	if(!isValidPoolId(destPoolId))
+		throw runtime_error(string(__func__)+" -- invalid destPoolId: "+istring(destPoolId));
+
+	const alignment_t alignment=pools[destPoolId].alignment;
+	if(srcPoolFile.pools[srcPoolId].alignment!=alignment)
+		throw runtime_error(string(__func__)+" -- src and dest pools do not have the same alignment");
+
+	const l_addr_t srcPoolSize=srcPoolFile.pools[srcPoolId].size/alignment;
+	if(peSrcWhere>srcPoolSize || (srcPoolSize-peSrcWhere)<peCount)
+		throw runtime_error(string(__func__)+" -- invalid peSrcWhere/peCount parameters: "+istring(peSrcWhere)+"/"+istring(peCount));
+	const l_addr_t destPoolSize=pools[destPoolId].size/alignment;
+	if(peDestWhere>destPoolSize || (destPoolSize-peDestWhere)<peCount)
+		throw runtime_error(string(__func__)+" -- invalid peDestWhere/peCount parameters: "+istring(peDestWhere)+"/"+istring(peCount));
+	if(&srcPoolFile==this && srcPoolId==destPoolId && peSrcWhere<peDestWhere+peCount && peDestWhere<peSrcWhere+peCount)
+		throw runtime_error(string(__func__)+" -- src and dest regions overlap");
+
+	l_addr_t srcByteWhere=peSrcWhere*alignment;
+	l_addr_t destByteWhere=peDestWhere*alignment;
+	l_addr_t byteCount=peCount*alignment;
+
+	// get any modified data in the affected regions onto disk before copying from the files
+	srcPoolFile.syncCachedBlocks(srcPoolId,srcByteWhere,byteCount,false);
+	syncCachedBlocks(destPoolId,destByteWhere,byteCount,false);
+
+	const vector<RLogicalBlock> &srcSAT=srcPoolFile.SAT[srcPoolId];
+	const vector<RLogicalBlock> &destSAT=SAT[destPoolId];
+
+	bool dummy;
+	size_t srcIndex=srcPoolFile.findSATBlockContaining(srcPoolId,srcByteWhere,dummy);
+	size_t destIndex=findSATBlockContaining(destPoolId,destByteWhere,dummy);
+
+	// coalesce pieces that are physically contiguous in both files into a single copy
+	p_addr_t runSrcStart=0,runDestStart=0,runLength=0;
+	while(byteCount>0)
+	{
+		const RLogicalBlock &srcBlock=srcSAT[srcIndex];
+		const RLogicalBlock &destBlock=destSAT[destIndex];
+
+		const l_addr_t srcOffset=srcByteWhere-srcBlock.logicalStart;
+		const l_addr_t destOffset=destByteWhere-destBlock.logicalStart;
+		const l_addr_t len=min(byteCount,(l_addr_t)min(srcBlock.size-srcOffset,destBlock.size-destOffset));
+
+		const p_addr_t srcPhysical=srcBlock.physicalStart+srcOffset;
+		const p_addr_t destPhysical=destBlock.physicalStart+destOffset;
+		if(runLength>0 && runSrcStart+runLength==srcPhysical && runDestStart+runLength==destPhysical)
+			runLength+=len;
+		else
+		{
+			if(runLength>0)
+				blockFile.copyFrom(srcPoolFile.blockFile,runSrcStart+LEADING_DATA_SIZE,runLength,runDestStart+LEADING_DATA_SIZE);
+			runSrcStart=srcPhysical;
+			runDestStart=destPhysical;
+			runLength=len;
+		}
+
+		srcByteWhere+=len;
+		destByteWhere+=len;
+		byteCount-=len;
+
+		if(srcByteWhere==srcBlock.logicalStart+srcBlock.size)
+			srcIndex++;
+		if(destByteWhere==destBlock.logicalStart+destBlock.size)
+			destIndex++;
+	}
+	if(runLength>0)
+		blockFile.copyFrom(srcPoolFile.blockFile,runSrcStart+LEADING_DATA_SIZE,runLength,runDestStart+LEADING_DATA_SIZE);
+
+	// bring any cached blocks in the dest region up to date with what's now on disk
+	syncCachedBlocks(destPoolId,peDestWhere*alignment,peCount*alignment,true);
+}
+
 template<class l_addr_t,class p_addr_t>
 	void TPoolFile<l_addr_t,p_addr_t>::clearPool(const poolId_t poolId)
 {
@@ -2253,6 +2495,7 @@ template<class l_addr_t,class p_addr_t>
 template<class l_addr_t,class p_addr_t>
 	template<class pool_element_t> void TPoolFile<l_addr_t,p_addr_t>::cacheBlock(const l_addr_t peWhere,const TStaticPoolAccesser<pool_element_t,TPoolFile<l_addr_t,p_addr_t> > *accesser)
 {
+	TRACE_SCOPE("TPoolFile::cacheBlock");
 	std::unique_lock<std::mutex> lock(accesserInfoMutex);
 
 		// assume is valid
@@ -2302,6 +2545,8 @@ template<class l_addr_t,class p_addr_t>
 				throw runtime_error(string(__func__)+" -- invalid peWhere "+istring(peWhere)+" for pool ("+getPoolDescription(poolId)+")");
 			}
 
+			TRACE_COUNT("TPoolFile cache misses",1);
+
 			bool dummy;
 			const size_t SATIndex=findSATBlockContaining(poolId,byteWhere,dummy);
 
@@ -2442,6 +2687,51 @@ template<class l_addr_t,class p_addr_t>
 	}
 }
 
+template<class l_addr_t,class p_addr_t>
+	void TPoolFile<l_addr_t,p_addr_t>::syncCachedBlocks(const poolId_t poolId,const l_addr_t byteStart,const l_addr_t byteCount,const bool reread)
+{
+	/*
+	 * Unlike invalidateCachedBlock(), this leaves the cached blocks (and the accessers referencing
+	 * them) in place.  Either any modified data within the given region is written to disk, or
+	 * (when reread is true) the cached data is refreshed from what has been written to disk
+	 */
+	std::unique_lock<std::mutex> lock(accesserInfoMutex);
+
+	const l_addr_t byteStop=byteStart+byteCount;
+	for(int which=0;which<2;which++)
+	{
+		const set<RCachedBlock *> &cachedBlocks= which==0 ? activeCachedBlocks : unreferencedCachedBlocks;
+		for(auto i=cachedBlocks.begin();i!=cachedBlocks.end();i++)
+		{
+			RCachedBlock *cachedBlock=(*i);
+			if(cachedBlock->poolId!=poolId || cachedBlock->logicalStart>=byteStop || (cachedBlock->logicalStart+cachedBlock->size)<=byteStart)
+				continue;
+
+			bool atStartOfBlock;
+			const size_t SATIndex=findSATBlockContaining(poolId,cachedBlock->logicalStart,atStartOfBlock);
+			const p_addr_t physicalWhere=SAT[poolId][SATIndex].physicalStart+LEADING_DATA_SIZE;
+
+			if(reread)
+			{
+				blockFile.read(cachedBlock->buffer,cachedBlock->size,physicalWhere);
+				cachedBlock->dirty=false;
+			}
+			else
+			{
+				bool dirty=cachedBlock->dirty;
+				for(size_t t=0;!dirty && t<accessers.size();t++)
+					dirty=(accessers[t]->cachedBlock==cachedBlock && accessers[t]->dirty);
+
+				if(dirty)
+				{
+					blockFile.write(cachedBlock->buffer,cachedBlock->size,physicalWhere);
+					cachedBlock->dirty=false;
+				}
+			}
+		}
+	}
+}
+
 template<class l_addr_t,class p_addr_t>
 	template<class pool_element_t> void TPoolFile<l_addr_t,p_addr_t>::addAccesser(const TStaticPoolAccesser<pool_element_t,TPoolFile<l_addr_t,p_addr_t> > *accesser)
 {
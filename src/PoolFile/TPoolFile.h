@@ -126,6 +126,18 @@ public:
 	const l_addr_t getPoolSize(poolId_t poolId) const;
 	const l_addr_t getPoolSize(const string poolName) const;
 
+	// the number of blocks in the SAT that the pool is made of (a measure of how fragmented it has become)
+	const size_t getPoolBlockCount(const poolId_t poolId) const;
+
+	// one of a list of changes to a pool's space made all at once by TPoolAccesser::editSpace() 
+	// (the list is sorted by where and the removed ranges don't overlap)
+	struct RSpaceEdit
+	{
+		l_addr_t where;		// in pool elements, the position before any of the edits are made
+		l_addr_t removeCount;	// elements to remove starting at where
+		l_addr_t insertCount;	// (uninitialized) elements to insert at where in place of the removed ones
+	};
+
 	template<class pool_element_t> TStaticPoolAccesser<pool_element_t,TPoolFile<l_addr_t,p_addr_t> > createPool(const string poolName,const bool throwOnExistance=true);
 
 	void removePool(const poolId_t poolId);
@@ -250,8 +262,13 @@ private:
 	// Pool modification
 	void insertSpace(const poolId_t poolId,const l_addr_t peWhere,const l_addr_t peCount);
 	void removeSpace(const poolId_t poolId,const l_addr_t peWhere,const l_addr_t peCount);
+		// makes all the edits in one pass over the pool's SAT (see RSpaceEdit)
+	void editSpace(const poolId_t poolId,const vector<RSpaceEdit> &edits);
 		// moves peCount pool-elements of data from the srcPoolId at peSrcWhere to the destPoolId at peDestWhere
 	void moveData(const poolId_t destPoolId,const l_addr_t peDestWhere,const poolId_t srcPoolId,const l_addr_t peSrcWhere,const l_addr_t peCount);
+		// copies peCount pool-elements of data from srcPoolId at peSrcWhere in srcPoolFile to the (already existing) space in destPoolId at peDestWhere
+		// the data is copied directly between the underlying files without going through the cached blocks
+	void copyData(const poolId_t destPoolId,const l_addr_t peDestWhere,TPoolFile<l_addr_t,p_addr_t> &srcPoolFile,const poolId_t srcPoolId,const l_addr_t peSrcWhere,const l_addr_t peCount);
 
 	// Pool Data Access
 	struct RCachedBlock
@@ -283,6 +300,7 @@ private:
 	void invalidateCachedBlock(RCachedBlock *cachedBlock);
 	template<class pool_element_t> void unreferenceCachedBlock(const TStaticPoolAccesser<pool_element_t,TPoolFile<l_addr_t,p_addr_t> > *accesser);
 	void invalidateAllCachedBlocks(bool allPools=true,poolId_t poolId=0);
+	void syncCachedBlocks(const poolId_t poolId,const l_addr_t byteStart,const l_addr_t byteCount,const bool reread);
 	template<class pool_element_t> void addAccesser(const TStaticPoolAccesser<pool_element_t,TPoolFile<l_addr_t,p_addr_t> > *accesser);
 	template<class pool_element_t> void removeAccesser(const TStaticPoolAccesser<pool_element_t,TPoolFile<l_addr_t,p_addr_t> > *accesser);
 
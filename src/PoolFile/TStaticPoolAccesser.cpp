@@ -28,6 +28,7 @@
 #define __TStaticPoolAccesser_CPP__
 
 #include <stdexcept>
+#include <algorithm>
 
 #include <istring>
 
@@ -166,7 +167,10 @@ template <class pool_element_t,class pool_file_t> void TStaticPoolAccesser<pool_
 template <class pool_element_t,class pool_file_t> void TStaticPoolAccesser<pool_element_t,pool_file_t>::copyData(l_addr_t destWhere,const TStaticPoolAccesser<pool_element_t,pool_file_t> &src,l_addr_t srcWhere,l_addr_t length)
 {
 	if (&src == this) {
-		throw runtime_error(string(__func__)+" -- src and dest accesser cannot be the same");
+		// one accesser only caches one block at a time, so read through another one
+		const TStaticPoolAccesser<pool_element_t,pool_file_t> other(*this);
+		copyData(destWhere,other,srcWhere,length);
+		return;
 	}
 
 	if(srcWhere>src.getSize())
@@ -178,25 +182,88 @@ template <class pool_element_t,class pool_file_t> void TStaticPoolAccesser<pool_
 		throw(runtime_error(string(__func__)+" -- invalid destWhere parameter: "+istring(destWhere)));
 	if((getSize()-destWhere)<length)
 		throw(runtime_error(string(__func__)+" -- invalid destWhere/length parameters: "+istring(destWhere)+"/"+istring(length)));
-		
-	// ??? change this to memmove later
-	// 	- remember to set the dirty flag
-	l_addr_t srcP=srcWhere;
-	l_addr_t destP=destWhere;
-	for(l_addr_t t=0;t<length;t++)
-		operator[](destP++)=src[srcP++];
+
+	if(length==0)
+		return;
+
+	const bool samePool=(src.poolFile==poolFile && src.poolId==poolId);
+	const bool overlapping=samePool && srcWhere<destWhere+length && destWhere<srcWhere+length;
+
+	// when copying a sizable amount of data let the file copy the physical extents directly (between
+	// pool files, i.e. to and from the clipboard, or between pools, i.e. to temp pools) rather than
+	// bringing every block through the cache
+	if(!overlapping && length*sizeof(pool_element_t)>=poolFile->getMaxBlockSizeFromAlignment(sizeof(pool_element_t)))
+	{
+		poolFile->copyData(poolId,destWhere,*src.poolFile,src.poolId,srcWhere,length);
+		return;
+	}
+
+	// otherwise memmove between the src and dest cached blocks a block at a time (going backwards
+	// if the regions overlap such that going forwards would overwrite data not yet copied)
+	if(overlapping && destWhere>srcWhere)
+	{
+		l_addr_t srcP=srcWhere+length;
+		l_addr_t destP=destWhere+length;
+		while(length>0)
+		{
+			if((destP-1)>endAddress || (destP-1)<startAddress)
+				cacheBlock(destP-1);
+			if((srcP-1)>src.endAddress || (srcP-1)<src.startAddress)
+				src.cacheBlock(srcP-1);
+
+			const l_addr_t itemsToCopy=min<l_addr_t>(length,min<l_addr_t>(destP-startAddress,srcP-src.startAddress));
+			srcP-=itemsToCopy;
+			destP-=itemsToCopy;
+
+			memmove(cacheBuffer+(destP-startAddress),src.cacheBuffer+(srcP-src.startAddress),itemsToCopy*sizeof(pool_element_t));
+
+			dirty=true;
+			length-=itemsToCopy;
+		}
+	}
+	else
+	{
+		l_addr_t srcP=srcWhere;
+		l_addr_t destP=destWhere;
+		while(length>0)
+		{
+			if(destP>endAddress || destP<startAddress)
+				cacheBlock(destP);
+			if(srcP>src.endAddress || srcP<src.startAddress)
+				src.cacheBlock(srcP);
+
+			const l_addr_t itemsToCopy=min<l_addr_t>(length,min<l_addr_t>(endAddress-destP+1,src.endAddress-srcP+1));
+
+			memmove(cacheBuffer+(destP-startAddress),src.cacheBuffer+(srcP-src.startAddress),itemsToCopy*sizeof(pool_element_t));
+
+			dirty=true;
+			length-=itemsToCopy;
+			srcP+=itemsToCopy;
+			destP+=itemsToCopy;
+		}
+	}
 }
 
 template <class pool_element_t,class pool_file_t> void TStaticPoolAccesser<pool_element_t,pool_file_t>::zeroData(l_addr_t where,l_addr_t length)
 {
+	if(where>getSize())
+		throw(runtime_error(string(__func__)+" -- invalid where parameter: "+istring(where)));
 	if((getSize()-where)<length)
 		throw(runtime_error(string(__func__)+" -- invalid where/length parameters: "+istring(where)+"/"+istring(length)));
 
-	// ??? change this to memset later
-	// 	- remember to set the dirty flag
-	const l_addr_t l=where+length;
-	for(l_addr_t t=where;t<l;t++)
-		operator[](t)=0;
+	while(length>0)
+	{
+		if(where>endAddress || where<startAddress)
+			cacheBlock(where);
+
+		const l_addr_t itemsToZero=min<l_addr_t>(length,endAddress-where+1);
+
+		memset(cacheBuffer+(where-startAddress),0,itemsToZero*sizeof(pool_element_t));
+
+		dirty=true;
+		length-=itemsToZero;
+		where+=itemsToZero;
+	}
 }
 
 template <class pool_element_t,class pool_file_t> void TStaticPoolAccesser<pool_element_t,pool_file_t>::cacheBlock(l_addr_t where) const
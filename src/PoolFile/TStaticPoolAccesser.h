@@ -86,6 +86,7 @@ public:
 
 
 	// bulk transfer methods
+		// copyData behaves like memmove when src is the same pool (or even this accesser) and the regions overlap
 	void copyData(l_addr_t destWhere,const TStaticPoolAccesser<pool_element_t,pool_file_t> &src,l_addr_t srcWhere,l_addr_t length);
 	void zeroData(l_addr_t where,l_addr_t length);
 
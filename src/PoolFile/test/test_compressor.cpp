@@ -0,0 +1,123 @@
+#include "gtest/gtest.h"
+
+#include <math.h>
+
+#include <vector>
+
+#include "../../backend/DSP/Compressor.h"
+
+// a sine whose amplitude steps between quiet and loud, so the compressor attacks and releases several times
+static std::vector<mix_sample_t> makeSignal(const size_t count, const unsigned channel = 0) {
+	std::vector<mix_sample_t> signal(count);
+	for(size_t t = 0; t < count; ++t) {
+		const float amplitude = (t/3000)%2 ? 0.9f : 0.1f;
+		signal[t] = (mix_sample_t)(amplitude*MAX_SAMPLE*sin(t*0.0627+channel));
+	}
+	return signal;
+}
+
+static const size_t COUNT = 20000;
+
+// window, threshold, ratio, attack and release
+#define PARAMETERS 441, (sample_t)(0.3*MAX_SAMPLE), 4.0f, 100, 1000
+
+// the gains that processSample() applies to each sample
+static std::vector<double> perSampleGains(const std::vector<mix_sample_t> &level) {
+	CDSPCompressor compressor(PARAMETERS, 0, 1);
+	std::vector<double> gains;
+	for(const mix_sample_t l : level) {
+		gains.push_back(compressor.processSample(MAX_SAMPLE, l)/(double)MAX_SAMPLE);
+	}
+	return gains;
+}
+
+TEST(Compressor, block_matches_per_sample) {
+	const std::vector<mix_sample_t> input = makeSignal(COUNT);
+
+	CDSPCompressor perSample(PARAMETERS, 0, 1);
+	std::vector<mix_sample_t> expected;
+	for(const mix_sample_t s : input) {
+		expected.push_back(perSample.processSample(s, s));
+	}
+
+	// with a control point every sample, the only difference is calculating the gain in the log domain
+	CDSPCompressor block(PARAMETERS, 0, 1);
+	std::vector<mix_sample_t> output(COUNT);
+	block.processSamples(input.data(), input.data(), output.data(), 1000);
+	block.processSamples(input.data()+1000, input.data()+1000, output.data()+1000, COUNT-1000);
+
+	bool compressed = false;
+	for(size_t t = 0; t < COUNT; ++t) {
+		ASSERT_NEAR(output[t], expected[t], 1e-5*MAX_SAMPLE) << "at " << t;
+		compressed |= fabs(expected[t]) < 0.99*fabs(input[t]);
+	}
+	ASSERT_TRUE(compressed);
+}
+
+TEST(Compressor, lookahead) {
+	// the gain that follows the level at t is applied to the input from lookAheadTime samples before
+	const unsigned lookAheadTime = 77;
+	const std::vector<mix_sample_t> input = makeSignal(COUNT);
+	const std::vector<double> gains = perSampleGains(input);
+
+	CDSPCompressor block(PARAMETERS, lookAheadTime, 1);
+	std::vector<mix_sample_t> output(input);
+	// (in place, in uneven blocks)
+	for(size_t pos = 0; pos < COUNT; pos += 333) {
+		block.processSamples(output.data()+pos, input.data()+pos, output.data()+pos, std::min((size_t)333, COUNT-pos));
+	}
+
+	for(size_t t = 0; t < COUNT; ++t) {
+		const double expected = t < lookAheadTime ? 0 : input[t-lookAheadTime]*gains[t];
+		ASSERT_NEAR(output[t], expected, 1e-5*MAX_SAMPLE) << "at " << t;
+	}
+}
+
+TEST(Compressor, control_interval) {
+	// the gain is exact at each control point and linearly interpolated from the previous one in between
+	const unsigned controlInterval = 32, lookAheadTime = 10;
+	const std::vector<mix_sample_t> input = makeSignal(COUNT);
+	const std::vector<double> gains = perSampleGains(input);
+
+	CDSPCompressor block(PARAMETERS, lookAheadTime, controlInterval);
+	std::vector<mix_sample_t> output(COUNT);
+	block.processSamples(input.data(), input.data(), output.data(), COUNT);
+
+	for(size_t t = lookAheadTime; t < COUNT; ++t) {
+		const size_t i = t%controlInterval;
+		const double from = t < controlInterval ? 1.0 : gains[t-i-1];
+		const double to = gains[t-i+controlInterval-1];
+		const double expected = input[t-lookAheadTime]*(from+(to-from)*(i+1)/controlInterval);
+		ASSERT_NEAR(output[t], expected, 1e-5*MAX_SAMPLE) << "at " << t;
+	}
+}
+
+TEST(Compressor, frames_match_per_frame) {
+	const unsigned frameSize = 2, lookAheadTime = 50;
+	const std::vector<mix_sample_t> left = makeSignal(COUNT, 0), right = makeSignal(COUNT, 1);
+	std::vector<mix_sample_t> frames;
+	for(size_t t = 0; t < COUNT; ++t) {
+		frames.push_back(left[t]);
+		frames.push_back(right[t]);
+	}
+
+	// processSampleFrame()'s gains, found by running it on frames of full scale samples
+	CDSPCompressor perFrame(PARAMETERS, 0, 1);
+	std::vector<double> gains;
+	for(size_t t = 0; t < COUNT; ++t) {
+		mix_sample_t unit[2] = { MAX_SAMPLE, MAX_SAMPLE };
+		perFrame.processSampleFrame(unit, &frames[t*frameSize], frameSize);
+		gains.push_back(unit[0]/(double)MAX_SAMPLE);
+	}
+
+	CDSPCompressor block(PARAMETERS, lookAheadTime, 1);
+	std::vector<mix_sample_t> output(frames.size());
+	block.processSampleFrames(frames.data(), frames.data(), output.data(), frameSize, COUNT);
+
+	for(size_t t = 0; t < COUNT; ++t) {
+		for(unsigned c = 0; c < frameSize; ++c) {
+			const double expected = t < lookAheadTime ? 0 : frames[(t-lookAheadTime)*frameSize+c]*gains[t];
+			ASSERT_NEAR(output[t*frameSize+c], expected, 1e-5*MAX_SAMPLE) << "at " << t << " channel " << c;
+		}
+	}
+}
@@ -0,0 +1,249 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../backend/CCueIndex.h"
+
+// a brute-force model of what CCueIndex should answer
+struct Cue {
+	std::string name;
+	sample_pos_t time;
+	bool isAnchored;
+};
+
+static bool scanName(const std::vector<Cue> &cues, const std::string &name, size_t &index) {
+	for(size_t i = 0; i < cues.size(); ++i) {
+		if(cues[i].name == name) { index = i; return true; }
+	}
+	return false;
+}
+
+// finds the lowest indexed cue whose time is the least (or greatest) one that passes the given test
+template<class T> static bool scanTime(const std::vector<Cue> &cues, bool latest, T passes, size_t &index) {
+	bool found = false;
+	for(size_t i = 0; i < cues.size(); ++i) {
+		if(!passes(cues[i].time)) {
+			continue;
+		}
+		if(!found || (latest ? cues[i].time > cues[index].time : cues[i].time < cues[index].time)) {
+			index = i;
+			found = true;
+		}
+	}
+	return found;
+}
+
+static std::vector<size_t> scanUnanchored(const std::vector<Cue> &cues, sample_pos_t from, sample_pos_t to) {
+	std::vector<size_t> indexes;
+	for(size_t i = 0; i < cues.size(); ++i) {
+		if(!cues[i].isAnchored && cues[i].time >= from && cues[i].time < to) { indexes.push_back(i); }
+	}
+	std::stable_sort(indexes.begin(), indexes.end(), [&](size_t a, size_t b) { return cues[a].time < cues[b].time; });
+	return indexes;
+}
+
+static void checkAgainstModel(const CCueIndex &index, const std::vector<Cue> &cues) {
+	ASSERT_EQ(index.getSize(), cues.size());
+
+	for(const char *name : { "a", "b", "c", "d", "e", "missing" }) {
+		size_t expected = 0, actual = 0;
+		const bool found = scanName(cues, name, expected);
+		ASSERT_EQ(index.findName(name, actual), found) << name;
+		if(found) { ASSERT_EQ(actual, expected) << name; }
+	}
+
+	for(sample_pos_t time = -5; time < 70; ++time) {
+		size_t expected = 0, actual = 0;
+		bool found;
+
+		found = scanTime(cues, false, [&](sample_pos_t t) { return t == time; }, expected);
+		ASSERT_EQ(index.findAt(time, actual), found) << "at " << time;
+		if(found) { ASSERT_EQ(actual, expected) << "at " << time; }
+
+		found = scanTime(cues, false, [&](sample_pos_t t) { return t >= time; }, expected);
+		ASSERT_EQ(index.findAtOrAfter(time, actual), found) << "at or after " << time;
+		if(found) { ASSERT_EQ(actual, expected) << "at or after " << time; }
+
+		found = scanTime(cues, false, [&](sample_pos_t t) { return t > time; }, expected);
+		ASSERT_EQ(index.findAfter(time, actual), found) << "after " << time;
+		if(found) { ASSERT_EQ(actual, expected) << "after " << time; }
+
+		found = scanTime(cues, true, [&](sample_pos_t t) { return t <= time; }, expected);
+		ASSERT_EQ(index.findAtOrBefore(time, actual), found) << "at or before " << time;
+		if(found) { ASSERT_EQ(actual, expected) << "at or before " << time; }
+
+		found = scanTime(cues, true, [&](sample_pos_t t) { return t < time; }, expected);
+		ASSERT_EQ(index.findBefore(time, actual), found) << "before " << time;
+		if(found) { ASSERT_EQ(actual, expected) << "before " << time; }
+	}
+
+	std::vector<size_t> indexes;
+	index.getUnanchoredInRange(10, 40, indexes);
+	ASSERT_EQ(indexes, scanUnanchored(cues, 10, 40));
+}
+
+TEST(CueIndex, basic) {
+	CCueIndex index;
+	std::vector<Cue> cues;
+	checkAgainstModel(index, cues);
+
+	index.append("b", 20, false); cues.push_back({ "b", 20, false });
+	index.append("a", 10, true);  cues.push_back({ "a", 10, true });
+	index.append("b", 10, false); cues.push_back({ "b", 10, false });
+	index.insert(1, "c", 20, false); cues.insert(cues.begin()+1, { "c", 20, false });
+	checkAgainstModel(index, cues);
+
+	size_t i;
+	ASSERT_TRUE(index.findName("b", i)); ASSERT_EQ(i, 0u);
+	ASSERT_TRUE(index.findAt(20, i)); ASSERT_EQ(i, 0u);
+	ASSERT_TRUE(index.findAtOrBefore(15, i)); ASSERT_EQ(i, 2u);
+
+	index.remove(0); cues.erase(cues.begin());
+	index.setTime(0, 5); cues[0].time = 5;
+	checkAgainstModel(index, cues);
+
+	EXPECT_THROW(index.remove(cues.size()), std::exception);
+	EXPECT_THROW(index.setTime(cues.size(), 0), std::exception);
+	EXPECT_THROW(index.insert(cues.size()+1, "x", 0, false), std::exception);
+
+	index.clear();
+	cues.clear();
+	checkAgainstModel(index, cues);
+}
+
+TEST(CueIndex, remove_and_compact) {
+	// removing enough cues without any inserts in between makes it compact the dead slots away
+	CCueIndex index;
+	std::vector<Cue> cues;
+	for(int t = 0; t < 300; ++t) {
+		index.append(std::string(1, 'a'+t%5), (t*7)%61, t%4 == 0);
+		cues.push_back({ std::string(1, 'a'+t%5), (t*7)%61, t%4 == 0 });
+	}
+
+	for(int round = 0; round < 3; ++round) {
+		while(cues.size() > 20) {
+			const size_t i = (cues.size()*5)/7;
+			index.remove(i);
+			cues.erase(cues.begin()+i);
+			if(cues.size()%16 == 0) {
+				checkAgainstModel(index, cues);
+			}
+		}
+		checkAgainstModel(index, cues);
+
+		// and the compacted index keeps working
+		for(int t = 0; t < 150; ++t) {
+			index.append("e", t%50, false);
+			cues.push_back({ "e", t%50, false });
+		}
+		checkAgainstModel(index, cues);
+	}
+
+	size_t i;
+	ASSERT_FALSE(index.findAfter(MAX_LENGTH, i));
+}
+
+TEST(CueIndex, offset_times) {
+	// without anchored cues at or after 'from' the times are changed in place
+	{
+		CCueIndex index;
+		std::vector<Cue> cues;
+		for(int t = 0; t < 10; ++t) {
+			index.append(std::string(1, 'a'+t%5), t*5, t == 1);
+			cues.push_back({ std::string(1, 'a'+t%5), t*5, t == 1 });
+		}
+
+		std::vector<size_t> moved;
+		index.offsetTimes(20, 7, moved);
+		std::vector<size_t> expected;
+		for(size_t i = 0; i < cues.size(); ++i) {
+			if(cues[i].time >= 20) { cues[i].time += 7; expected.push_back(i); }
+		}
+		ASSERT_EQ(moved, expected);
+		checkAgainstModel(index, cues);
+
+		// moving back before the cue preceding them changes the order
+		index.offsetTimes(20, -18, moved);
+		for(size_t i = 0; i < cues.size(); ++i) {
+			if(cues[i].time >= 20) { cues[i].time -= 18; }
+		}
+		checkAgainstModel(index, cues);
+	}
+
+	// anchored cues stay put and the moved ones pass them
+	{
+		CCueIndex index;
+		std::vector<Cue> cues;
+		for(int t = 0; t < 10; ++t) {
+			index.append("a", t*5, t%3 == 0);
+			cues.push_back({ "a", t*5, t%3 == 0 });
+		}
+
+		std::vector<size_t> moved;
+		index.offsetTimes(12, 11, moved);
+		std::vector<size_t> expected;
+		for(size_t i = 0; i < cues.size(); ++i) {
+			if(!cues[i].isAnchored && cues[i].time >= 12) { cues[i].time += 11; expected.push_back(i); }
+		}
+		ASSERT_EQ(moved, expected);
+		checkAgainstModel(index, cues);
+	}
+}
+
+TEST(CueIndex, random_against_scan) {
+	std::mt19937 random(1234);
+	auto uniform = [&](int lo, int hi) { return std::uniform_int_distribution<int>(lo, hi)(random); };
+
+	CCueIndex index;
+	std::vector<Cue> cues;
+	for(int step = 0; step < 3000; ++step) {
+		const int op = uniform(0, 9);
+		const std::string name(1, (char)('a'+uniform(0, 4)));
+		const sample_pos_t time = uniform(0, 60);
+		const bool isAnchored = uniform(0, 3) == 0;
+
+		if(op < 3 || cues.empty()) {
+			index.append(name, time, isAnchored);
+			cues.push_back({ name, time, isAnchored });
+		} else if(op == 3) {
+			const size_t i = uniform(0, cues.size());
+			index.insert(i, name, time, isAnchored);
+			cues.insert(cues.begin()+i, { name, time, isAnchored });
+		} else if(op < 7) {
+			// removing more than adding, in runs, makes the index compact itself now and then
+			for(int n = uniform(1, 3); n > 0 && !cues.empty(); --n) {
+				const size_t i = uniform(0, cues.size()-1);
+				index.remove(i);
+				cues.erase(cues.begin()+i);
+			}
+		} else if(op < 9) {
+			const size_t i = uniform(0, cues.size()-1);
+			index.setTime(i, time);
+			cues[i].time = time;
+		} else {
+			const sample_pos_t delta = uniform(-3, 5);
+			std::vector<size_t> moved;
+			index.offsetTimes(time, delta, moved);
+			std::vector<size_t> expected = scanUnanchored(cues, time, MAX_LENGTH);
+			for(size_t i : expected) { cues[i].time += delta; }
+			std::sort(moved.begin(), moved.end());
+			std::sort(expected.begin(), expected.end());
+			ASSERT_EQ(moved, expected) << "step " << step;
+		}
+
+		if(step%10 == 0 || cues.size() < 5) {
+			checkAgainstModel(index, cues);
+			if(HasFatalFailure()) { FAIL() << "step " << step; }
+		}
+	}
+
+	// empty it out completely
+	while(!cues.empty()) {
+		index.remove(0);
+		cues.erase(cues.begin());
+	}
+	checkAgainstModel(index, cues);
+}
@@ -0,0 +1,68 @@
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include "../../backend/CGraphParamValueNode.h"
+
+static std::vector<CGraphParamValueNodeList> makeCurves() {
+	std::vector<CGraphParamValueNodeList> curves;
+	curves.push_back(singleValueToGraph(0.75));
+	curves.push_back({ CGraphParamValueNode(0.0, 0.0), CGraphParamValueNode(1.0, 1.0) });
+	curves.push_back({ CGraphParamValueNode(0.0, 1.0), CGraphParamValueNode(0.3, 0.2), CGraphParamValueNode(0.31, 0.9), CGraphParamValueNode(0.8, 0.5), CGraphParamValueNode(1.0, 0.0) });
+	// nodes at the same position make segments of no length
+	curves.push_back({ CGraphParamValueNode(0.0, 0.5), CGraphParamValueNode(0.5, 0.1), CGraphParamValueNode(0.5, 0.8), CGraphParamValueNode(1.0, 0.8) });
+	return curves;
+}
+
+// the values of count calls to next() (which is going past the end of the curve when count > length)
+static std::vector<double> perValue(const CGraphParamValueNodeList &nodes, const sample_pos_t length, const size_t count) {
+	CGraphParamValueIterator i(nodes, length);
+	std::vector<double> values;
+	for(size_t t = 0; t < count; ++t) {
+		values.push_back(i.next());
+	}
+	return values;
+}
+
+TEST(GraphParamValueIterator, block_matches_next) {
+	for(const CGraphParamValueNodeList &nodes : makeCurves()) {
+		for(const sample_pos_t length : { (sample_pos_t)1, (sample_pos_t)2, (sample_pos_t)37, (sample_pos_t)1000, (sample_pos_t)44101 }) {
+			const size_t count = length+10;
+			const std::vector<double> expected = perValue(nodes, length, count);
+
+			for(const size_t blockSize : { (size_t)1, (size_t)7, (size_t)256, count }) {
+				CGraphParamValueIterator doubles(nodes, length), floats(nodes, length);
+				std::vector<double> d(count);
+				std::vector<float> f(count);
+				for(size_t pos = 0; pos < count; pos += blockSize) {
+					const size_t n = std::min(blockSize, count-pos);
+					doubles.next(d.data()+pos, n);
+					floats.next(f.data()+pos, n);
+				}
+
+				for(size_t t = 0; t < count; ++t) {
+					ASSERT_EQ(d[t], expected[t]) << "length " << length << " block size " << blockSize << " at " << t;
+					ASSERT_EQ(f[t], (float)expected[t]) << "length " << length << " block size " << blockSize << " at " << t;
+				}
+			}
+		}
+	}
+}
+
+TEST(GraphParamValueIterator, mixed_calls) {
+	// switching between next() and the block version keeps going from the same place
+	const CGraphParamValueNodeList nodes = makeCurves()[2];
+	const sample_pos_t length = 5000;
+	const std::vector<double> expected = perValue(nodes, length, length);
+
+	CGraphParamValueIterator i(nodes, length);
+	std::vector<double> values;
+	while((sample_pos_t)values.size() < length) {
+		values.push_back(i.next());
+		double block[100];
+		const size_t n = std::min((size_t)100, (size_t)length-values.size());
+		i.next(block, n);
+		values.insert(values.end(), block, block+n);
+	}
+	ASSERT_EQ(values, expected);
+}
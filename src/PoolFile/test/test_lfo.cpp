@@ -0,0 +1,34 @@
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <vector>
+
+#include "../../backend/ALFO.h"
+
+TEST(LFO, block_matches_next_value) {
+	ASSERT_GT(gLFORegistry.getCount(), 0u);
+	for(size_t type = 0; type < gLFORegistry.getCount(); ++type) {
+		for(const float freq : { 0.5f, 3.0f, 441.0f }) {
+			const CLFODescription desc(1.0f, freq, 30.0f, type);
+			const size_t count = 100000;
+
+			std::unique_ptr<ALFO> perValue(gLFORegistry.createLFO(desc, 44100));
+			std::vector<float> expected;
+			for(size_t t = 0; t < count; ++t) {
+				expected.push_back(perValue->nextValue());
+			}
+
+			for(const size_t blockSize : { (size_t)1, (size_t)5, (size_t)4096 }) {
+				std::unique_ptr<ALFO> block(gLFORegistry.createLFO(desc, 44100));
+				std::vector<float> values(count);
+				for(size_t pos = 0; pos < count; pos += blockSize) {
+					block->nextValues(values.data()+pos, std::min(blockSize, count-pos));
+				}
+
+				for(size_t t = 0; t < count; ++t) {
+					ASSERT_EQ(values[t], expected[t]) << gLFORegistry.getName(type) << " at " << freq << "Hz with block size " << blockSize << " at " << t;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,179 @@
+#include "gtest/gtest.h"
+
+#include <math.h>
+#include <string.h>
+
+#include <random>
+#include <vector>
+
+#include "../../backend/lossless_sample_codec.h"
+
+// encodes then decodes samples and checks that they came back bit for bit, returning the coded block
+static std::vector<uint8_t> roundTrip(const std::vector<sample_t> &samples) {
+	std::vector<uint8_t> coded;
+	losslessEncodeBlock(samples.data(), samples.size(), coded);
+	EXPECT_FALSE(coded.empty());
+
+	std::vector<sample_t> decoded(samples.size());
+	losslessDecodeBlock(coded.data(), coded.size(), decoded.data(), decoded.size());
+	EXPECT_EQ(memcmp(decoded.data(), samples.data(), samples.size()*sizeof(sample_t)), 0);
+	return coded;
+}
+
+// whether the block was coded with a predictor, and if so which order
+static bool predictorOrder(const std::vector<uint8_t> &coded, unsigned &order) {
+	if(coded[0] == 0) { // verbatim
+		return false;
+	}
+	order = coded[1];
+	return true;
+}
+
+// a sample from a 16 bit file
+static sample_t from16(const int v) {
+	return convert_sample<int16_t, sample_t>((int16_t)v);
+}
+
+TEST(LosslessCodec, silence) {
+	for(size_t count : { (size_t)1, (size_t)3, (size_t)LOSSLESS_CODEC_BLOCK_SIZE }) {
+		const std::vector<sample_t> silence(count, 0);
+		const std::vector<uint8_t> coded = roundTrip(silence);
+		if(count == LOSSLESS_CODEC_BLOCK_SIZE) {
+			ASSERT_LT(coded.size(), count*sizeof(sample_t)/16);
+		}
+	}
+}
+
+TEST(LosslessCodec, full_scale) {
+	std::vector<sample_t> samples;
+	for(size_t t = 0; t < LOSSLESS_CODEC_BLOCK_SIZE; ++t) {
+		samples.push_back(t%2 ? MAX_SAMPLE : MIN_SAMPLE);
+	}
+	roundTrip(samples);
+
+	// a full scale square wave
+	for(size_t t = 0; t < LOSSLESS_CODEC_BLOCK_SIZE; ++t) {
+		samples[t] = (t/50)%2 ? MAX_SAMPLE : MIN_SAMPLE;
+	}
+	roundTrip(samples);
+
+#ifdef SAMPLE_TYPE_FLOAT
+	// beyond full scale, and values which can't be coded as integers
+	const float specials[] = { 1.0f, -1.0f, 2.0f, -2.0f, 3.5f, -1e9f, 1e-30f, -0.0f, INFINITY, -INFINITY, NAN };
+	samples.assign(std::begin(specials), std::end(specials));
+	roundTrip(samples);
+	for(const float s : specials) {
+		roundTrip(std::vector<sample_t>(LOSSLESS_CODEC_BLOCK_SIZE, s));
+	}
+#endif
+}
+
+TEST(LosslessCodec, random) {
+	std::mt19937 random(99);
+
+	// 16 bit white noise
+	std::vector<sample_t> samples;
+	for(size_t t = 0; t < LOSSLESS_CODEC_BLOCK_SIZE; ++t) {
+		samples.push_back(from16(std::uniform_int_distribution<int>(-32768, 32767)(random)));
+	}
+	roundTrip(samples);
+
+#ifdef SAMPLE_TYPE_FLOAT
+	// arbitrary floats, and arbitrary bit patterns
+	for(size_t t = 0; t < LOSSLESS_CODEC_BLOCK_SIZE; ++t) {
+		samples[t] = std::uniform_real_distribution<float>(-1.0f, 1.0f)(random);
+	}
+	roundTrip(samples);
+
+	for(size_t t = 0; t < LOSSLESS_CODEC_BLOCK_SIZE; ++t) {
+		const uint32_t bits = random();
+		memcpy(&samples[t], &bits, sizeof(bits));
+	}
+	roundTrip(samples);
+
+	// a smooth signal which isn't made of integers
+	for(size_t t = 0; t < LOSSLESS_CODEC_BLOCK_SIZE; ++t) {
+		samples[t] = 0.7f*sinf(t*0.01f);
+	}
+	roundTrip(samples);
+#endif
+}
+
+#ifdef SAMPLE_TYPE_FLOAT
+TEST(LosslessCodec, loaded_integers_are_coded_as_integers) {
+	// samples loaded from 16 or 24 bit files aren't multiples of a power of 2, but they still shouldn't be coded as arbitrary floats
+	std::mt19937 random(3);
+	std::vector<sample_t> samples16, samples24;
+	for(size_t t = 0; t < LOSSLESS_CODEC_BLOCK_SIZE; ++t) {
+		samples16.push_back(from16(std::uniform_int_distribution<int>(-4000, 4000)(random)));
+		int24_t v;
+		v.set(std::uniform_int_distribution<int>(-1000000, 1000000)(random));
+		samples24.push_back(convert_sample<int24_t, float>(v));
+	}
+	// (about 13 and 21 bits of noise)
+	ASSERT_LT(roundTrip(samples16).size(), samples16.size()*15/8);
+	ASSERT_LT(roundTrip(samples24).size(), samples24.size()*23/8);
+}
+#endif
+
+TEST(LosslessCodec, short_final_block) {
+	std::mt19937 random(5);
+	for(size_t count = 1; count < 40; ++count) {
+		std::vector<sample_t> samples;
+		for(size_t t = 0; t < count; ++t) {
+			samples.push_back(from16(std::uniform_int_distribution<int>(-300, 300)(random)));
+		}
+		roundTrip(samples);
+	}
+
+	std::vector<sample_t> samples;
+	for(size_t t = 0; t < 1234; ++t) {
+		samples.push_back(from16((int)(10000*sin(t*0.05))));
+	}
+	roundTrip(samples);
+}
+
+TEST(LosslessCodec, every_predictor_order) {
+	std::mt19937 random(11);
+	auto noise = [&](int n) { return std::uniform_int_distribution<int>(-n, n)(random); };
+
+	std::vector<sample_t> samples[4];
+	int walk = 0;
+	for(size_t t = 0; t < LOSSLESS_CODEC_BLOCK_SIZE; ++t) {
+		// white noise is best left alone
+		samples[0].push_back(from16(noise(20000)));
+		// a random walk is best predicted from the last sample
+		walk = std::max(-32768, std::min(32767, walk+noise(100)));
+		samples[1].push_back(from16(walk));
+		// a slow sine with some noise is best predicted by a line (predicting more of its curve would amplify the noise more)
+		samples[2].push_back(from16((int)(30000*sin(t*0.01))+noise(2)));
+		// a faster, clean, sine is best predicted by a parabola
+		samples[3].push_back(from16((int)(30000*sin(t*0.05))));
+	}
+
+	for(unsigned expected = 0; expected <= 3; ++expected) {
+		unsigned order;
+		ASSERT_TRUE(predictorOrder(roundTrip(samples[expected]), order)) << expected;
+		ASSERT_EQ(order, expected);
+	}
+}
+
+TEST(LosslessCodec, invalid_data) {
+	std::vector<sample_t> samples;
+	for(size_t t = 0; t < 100; ++t) {
+		samples.push_back(from16((int)(1000*sin(t*0.1))));
+	}
+	const std::vector<uint8_t> coded = roundTrip(samples);
+
+	std::vector<sample_t> decoded(samples.size());
+	EXPECT_THROW(losslessDecodeBlock(coded.data(), 0, decoded.data(), decoded.size()), std::exception);
+	EXPECT_THROW(losslessDecodeBlock(coded.data(), coded.size()/2, decoded.data(), decoded.size()), std::exception);
+
+	std::vector<uint8_t> badHeader = coded;
+	badHeader[0] = 77;
+	EXPECT_THROW(losslessDecodeBlock(badHeader.data(), badHeader.size(), decoded.data(), decoded.size()), std::exception);
+
+	std::vector<uint8_t> out;
+	std::vector<sample_t> tooMany(LOSSLESS_CODEC_BLOCK_SIZE+1);
+	EXPECT_THROW(losslessEncodeBlock(tooMany.data(), tooMany.size(), out), std::exception);
+}
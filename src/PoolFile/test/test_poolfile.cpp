@@ -242,3 +242,175 @@ TEST(PoolFile, one_pool) {
 	}
 }
 
+
+TEST(PoolFile, copy_between_files) {
+	// use different block sizes so that the src and dest blocks don't line up
+	TPoolFile <uint32_t, uint64_t> f1(256, "testpool");
+	TPoolFile <uint32_t, uint64_t> f2(100, "testpool");
+	unlink("test1.pf");
+	unlink("test2.pf");
+	f1.openFile("test1.pf");
+	f2.openFile("test2.pf");
+
+	{
+		TPoolAccesser<uint32_t, decltype(f1)> a = f1.createPool<uint32_t>("src");
+		TPoolAccesser<uint32_t, decltype(f2)> b = f2.createPool<uint32_t>("dest");
+
+		// build the src with several inserts so that it isn't physically contiguous
+		for (int c = 0; c < 10; ++c) {
+			a.insert(a.getSize()/2, 100+c);
+		}
+		const size_t size = a.getSize();
+		for(size_t t = 0; t < size; ++t) { a[t] = t; } // leaves a's last cached block dirty
+
+		b.insert(0, 10);
+		for(size_t t = 0; t < 10; ++t) { b[t] = 1000000+t; }
+
+		// copy everything after the 10 existing elements, appending the space needed
+		b.copyData(10, a, 0, size, true);
+		ASSERT_EQ(b.getSize(), 10+size);
+		for(size_t t = 0; t < 10; ++t) { ASSERT_EQ(b[t], 1000000+t); }
+		for(size_t t = 0; t < size; ++t) { ASSERT_EQ(b[10+t], t); }
+
+		// overwrite part of it again from an offset within the src while b has a block cached
+		b[5] = 7;
+		b.copyData(6, a, 300, 500);
+		ASSERT_EQ(b[5], 7);
+		for(size_t t = 0; t < 500; ++t) { ASSERT_EQ(b[6+t], 300+t); }
+		for(size_t t = 506; t < 10+size; ++t) { ASSERT_EQ(b[t], t-10); }
+	}
+
+	f2.closeFile(false, false);
+	f2.openFile("test2.pf");
+	{
+		auto b = f2.getPoolAccesser<uint32_t>("dest");
+		ASSERT_EQ(b[5], 7);
+		for(size_t t = 0; t < 500; ++t) { ASSERT_EQ(b[6+t], 300+t); }
+		for(size_t t = 506; t < b.getSize(); ++t) { ASSERT_EQ(b[t], t-10); }
+	}
+}
+
+TEST(PoolFile, bulk_copy_and_zero) {
+	TPoolFile <uint32_t, uint64_t> f(256, "testpool");
+	unlink("test.pf");
+	f.openFile("test.pf");
+
+	{
+		TPoolAccesser<uint32_t, decltype(f)> a = f.createPool<uint32_t>("foo");
+		TPoolAccesser<uint32_t, decltype(f)> t = f.createPool<uint32_t>("temp");
+
+		for (int c = 0; c < 10; ++c) {
+			a.insert(a.getSize()/2, 100+c);
+		}
+		const size_t size = a.getSize();
+		for(size_t i = 0; i < size; ++i) { a[i] = i; }
+
+		// copy to another pool in the same file (extent path)
+		t.copyData(0, a, 0, size, true);
+		for(size_t i = 0; i < size; ++i) { ASSERT_EQ(t[i], i); }
+
+		// overlapping copy toward the end of the pool spanning several blocks must behave like memmove
+		auto b = a;
+		a.copyData(10, b, 0, size-10);
+		for(size_t i = 0; i < 10; ++i) { ASSERT_EQ(a[i], i); }
+		for(size_t i = 10; i < size; ++i) { ASSERT_EQ(a[i], i-10); }
+
+		// and toward the beginning
+		a.copyData(0, b, 10, size-10);
+		for(size_t i = 0; i < size-10; ++i) { ASSERT_EQ(a[i], i); }
+
+		a.zeroData(5, size-10);
+		for(size_t i = 0; i < 5; ++i) { ASSERT_EQ(a[i], i); }
+		for(size_t i = 5; i < size-5; ++i) { ASSERT_EQ(a[i], 0); }
+		for(size_t i = size-5; i < size; ++i) { ASSERT_EQ(a[i], i-10); }
+		EXPECT_THROW(a.zeroData(size+1, 0), std::exception);
+	}
+}
+
+TEST(PoolFile, copy_within_one_accesser) {
+	TPoolFile <uint32_t, uint64_t> f(256, "testpool");
+	unlink("test.pf");
+	f.openFile("test.pf");
+
+	{
+		TPoolAccesser<uint32_t, decltype(f)> a = f.createPool<uint32_t>("foo");
+		a.append(1000);
+		const size_t size = a.getSize();
+		for(size_t i = 0; i < size; ++i) { a[i] = i; }
+
+		// the src being the dest accesser itself works like memmove too, forwards and backwards
+		a.copyData(10, a, 0, size-10);
+		for(size_t i = 0; i < 10; ++i) { ASSERT_EQ(a[i], i); }
+		for(size_t i = 10; i < size; ++i) { ASSERT_EQ(a[i], i-10); }
+
+		a.copyData(0, a, 10, size-10);
+		for(size_t i = 0; i < size-10; ++i) { ASSERT_EQ(a[i], i); }
+
+		// not overlapping
+		a.copyData(size/2, a, 0, size/2);
+		for(size_t i = 0; i < size/2; ++i) { ASSERT_EQ(a[size/2+i], i); }
+
+		// and appending to itself
+		a.copyData(size, a, 0, size, true);
+		ASSERT_EQ(a.getSize(), 2*size);
+		for(size_t i = 0; i < size; ++i) { ASSERT_EQ(a[size+i], a[i]); }
+
+		EXPECT_THROW(a.copyData(0, a, 1, a.getSize()), std::exception);
+	}
+}
+
+TEST(PoolFile, edit_space) {
+	TPoolFile <uint32_t, uint64_t> f(256, "testpool");
+	unlink("test.pf");
+	f.openFile("test.pf");
+
+	{
+		typedef decltype(f)::RSpaceEdit RSpaceEdit;
+		TPoolAccesser<uint32_t, decltype(f)> a = f.createPool<uint32_t>("foo");
+
+		// build a fragmented pool and a model of what should be in it
+		std::vector<uint32_t> model;
+		for (int c = 0; c < 10; ++c) {
+			a.insert(a.getSize()/2, 100+c);
+		}
+		for(size_t i = 0; i < a.getSize(); ++i) { a[i] = i; model.push_back(i); }
+
+		// removals within a block, across blocks, of whole blocks, insertions and replacements
+		const std::vector<RSpaceEdit> edits = {
+			{ 0, 3, 0 },
+			{ 10, 0, 5 },
+			{ 20, 100, 0 },
+			{ 150, 10, 70 },
+			{ 300, 1, 1 },
+			{ 700, 200, 0 },
+			{ (uint32_t)model.size(), 0, 20 },
+		};
+		a.editSpace(edits);
+
+		// apply the same edits to the model from the last to the first
+		std::vector<int64_t> expected(model.begin(), model.end());
+		for(size_t t = edits.size(); t > 0; --t) {
+			const RSpaceEdit &e = edits[t-1];
+			expected.erase(expected.begin()+e.where, expected.begin()+e.where+e.removeCount);
+			expected.insert(expected.begin()+e.where, e.insertCount, -1);
+		}
+
+		ASSERT_EQ(a.getSize(), expected.size());
+		for(size_t i = 0; i < expected.size(); ++i) {
+			if(expected[i] >= 0) {
+				ASSERT_EQ(a[i], expected[i]) << "at " << i;
+			}
+		}
+
+		// the inserted space is usable
+		for(size_t i = 0; i < a.getSize(); ++i) { a[i] = i*3; }
+		for(size_t i = 0; i < a.getSize(); ++i) { ASSERT_EQ(a[i], i*3); }
+
+		// overlapping or unsorted edits are rejected without changing anything
+		const size_t size = a.getSize();
+		EXPECT_THROW(a.editSpace({ { 10, 5, 0 }, { 12, 1, 0 } }), std::exception);
+		EXPECT_THROW(a.editSpace({ { 10, 0, 0 }, { 5, 1, 0 } }), std::exception);
+		EXPECT_THROW(a.editSpace({ { (uint32_t)size, 1, 0 } }), std::exception);
+		ASSERT_EQ(a.getSize(), size);
+	}
+}
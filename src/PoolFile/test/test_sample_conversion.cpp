@@ -0,0 +1,150 @@
+#include "gtest/gtest.h"
+
+#include <random>
+#include <vector>
+
+#include "../../backend/sample_conversion.h"
+
+// odd so that every kernel's scalar tail gets used too
+static const size_t COUNT = 1037;
+
+static std::vector<float> makeFloats() {
+	std::mt19937 random(42);
+	std::uniform_real_distribution<float> uniform(-1.2f, 1.2f);
+	std::vector<float> samples = { 0.0f, -0.0f, 1.0f, -1.0f, 1.5f, -1.5f, 1e-9f, -1e-9f, 0.5f, -0.5f, 1.0f/32767.0f, -1.0f/32768.0f, 100.0f, -100.0f };
+	while(samples.size() < COUNT) {
+		samples.push_back(uniform(random));
+	}
+	return samples;
+}
+
+template<typename int_t> static std::vector<int_t> makeInts(const int_fast32_t lo, const int_fast32_t hi) {
+	std::mt19937 random(7);
+	std::uniform_int_distribution<int_fast32_t> uniform(lo, hi);
+	std::vector<int_t> samples = { 0, 1, -1, (int_t)lo, (int_t)hi };
+	while(samples.size() < COUNT) {
+		samples.push_back((int_t)uniform(random));
+	}
+	return samples;
+}
+
+class SampleConversion : public ::testing::TestWithParam<const char *> {
+protected:
+	void SetUp() override {
+		if(!setSampleConversionKernels(GetParam())) {
+			GTEST_SKIP() << GetParam() << " kernels are not supported by this CPU";
+		}
+		ASSERT_STREQ(getSampleConversionKernelName(), GetParam());
+	}
+};
+
+TEST_P(SampleConversion, float_to_int) {
+	const std::vector<float> src = makeFloats();
+
+	std::vector<int16_t> dest16(COUNT);
+	convertSamples(src.data(), dest16.data(), COUNT);
+	for(size_t t = 0; t < COUNT; ++t) {
+		ASSERT_EQ(dest16[t], (convert_sample<float, int16_t>(src[t]))) << "at " << t << " for " << src[t];
+	}
+
+	std::vector<int24_t> dest24(COUNT);
+	convertSamples(src.data(), dest24.data(), COUNT);
+	for(size_t t = 0; t < COUNT; ++t) {
+		ASSERT_EQ(dest24[t].get(), (convert_sample<float, int24_t>(src[t]).get())) << "at " << t << " for " << src[t];
+	}
+
+	std::vector<int32_t> dest32(COUNT);
+	convertSamples(src.data(), dest32.data(), COUNT);
+	for(size_t t = 0; t < COUNT; ++t) {
+		ASSERT_EQ(dest32[t], (convert_sample<float, int32_t>(src[t]))) << "at " << t << " for " << src[t];
+	}
+}
+
+TEST_P(SampleConversion, int_to_float) {
+	const std::vector<int16_t> src16 = makeInts<int16_t>(-32768, 32767);
+	std::vector<float> dest(COUNT);
+	convertSamples(src16.data(), dest.data(), COUNT);
+	for(size_t t = 0; t < COUNT; ++t) {
+		ASSERT_EQ(dest[t], (convert_sample<int16_t, float>(src16[t]))) << "at " << t;
+	}
+
+	const std::vector<int32_t> src24 = makeInts<int32_t>(-8388608, 8388607);
+	std::vector<int24_t> src24Packed(COUNT);
+	for(size_t t = 0; t < COUNT; ++t) {
+		src24Packed[t].set(src24[t]);
+	}
+	convertSamples(src24Packed.data(), dest.data(), COUNT);
+	for(size_t t = 0; t < COUNT; ++t) {
+		ASSERT_EQ(dest[t], (convert_sample<int24_t, float>(src24Packed[t]))) << "at " << t;
+	}
+
+	const std::vector<int32_t> src32 = makeInts<int32_t>(INT32_MIN, INT32_MAX);
+	convertSamples(src32.data(), dest.data(), COUNT);
+	for(size_t t = 0; t < COUNT; ++t) {
+		ASSERT_EQ(dest[t], (convert_sample<int32_t, float>(src32[t]))) << "at " << t;
+	}
+}
+
+TEST_P(SampleConversion, interleave) {
+	const std::vector<float> src = makeFloats();
+	const size_t frames = COUNT/3;
+	for(unsigned channelCount = 1; channelCount <= 3; ++channelCount) {
+		const float *channels[MAX_CHANNELS];
+		for(unsigned c = 0; c < channelCount; ++c) {
+			channels[c] = src.data()+c*frames;
+		}
+
+		std::vector<float> interleaved(frames*channelCount);
+		interleaveSamples(channels, channelCount, interleaved.data(), frames);
+		for(size_t i = 0; i < frames; ++i) {
+			for(unsigned c = 0; c < channelCount; ++c) {
+				ASSERT_EQ(interleaved[i*channelCount+c], channels[c][i]);
+			}
+		}
+
+		std::vector<float> back(frames*channelCount);
+		float *backChannels[MAX_CHANNELS];
+		for(unsigned c = 0; c < channelCount; ++c) {
+			backChannels[c] = back.data()+c*frames;
+		}
+		deinterleaveSamples(interleaved.data(), channelCount, backChannels, frames);
+		ASSERT_EQ(back, std::vector<float>(src.begin(), src.begin()+frames*channelCount));
+
+		// and converting while interleaving
+		std::vector<int16_t> interleaved16(frames*channelCount);
+		interleaveSamples(channels, channelCount, interleaved16.data(), frames);
+		for(size_t i = 0; i < frames; ++i) {
+			for(unsigned c = 0; c < channelCount; ++c) {
+				ASSERT_EQ(interleaved16[i*channelCount+c], (convert_sample<float, int16_t>(channels[c][i])));
+			}
+		}
+	}
+}
+
+TEST_P(SampleConversion, dither) {
+	// the dithered output is the same whatever the kernels, and stays within an LSB of the undithered output
+	const std::vector<float> src = makeFloats();
+	for(RSampleDither::DitherTypes type : { RSampleDither::dtTriangular, RSampleDither::dtShaped }) {
+		std::vector<int16_t> dest(COUNT), expected(COUNT), undithered(COUNT);
+		RSampleDither dither(type, 2), expectedDither(type, 2);
+
+		// in uneven blocks to check that the state carries over
+		convertSamples(src.data(), dest.data(), 502, &dither);
+		convertSamples(src.data()+502, dest.data()+502, COUNT-502, &dither);
+
+		ASSERT_TRUE(setSampleConversionKernels("generic"));
+		convertSamples(src.data(), expected.data(), 502, &expectedDither);
+		convertSamples(src.data()+502, expected.data()+502, COUNT-502, &expectedDither);
+		convertSamples(src.data(), undithered.data(), COUNT);
+		ASSERT_TRUE(setSampleConversionKernels(GetParam()));
+
+		ASSERT_EQ(dest, expected);
+		if(type == RSampleDither::dtTriangular) {
+			for(size_t t = 0; t < COUNT; ++t) {
+				ASSERT_LE(abs(dest[t]-undithered[t]), 1) << "at " << t;
+			}
+		}
+	}
+}
+
+INSTANTIATE_TEST_SUITE_P(Kernels, SampleConversion, ::testing::Values("generic", "sse2", "avx2"));
@@ -38,6 +38,8 @@ using namespace std;
 
 #include "CRunMacroAction.h"
 
+#include <CTrace.h>
+
 
 // ----------------------------------------------------------------------
 // -- AActionFactory ----------------------------------------------------
@@ -47,6 +49,7 @@ CMacroRecorder AActionFactory::macroRecorder;
 
 AActionFactory::AActionFactory(const string _actionName,const string _actionDescription,AActionDialog *_channelSelectDialog,AActionDialog *_dialog,bool _willResize,bool _crossfadeEdgesIsApplicable) :
 	requiresALoadedSound(true),
+	previewIsApplicable(false),
 	selectionPositionsAreApplicable(true),
 
 	actionName(_actionName),
@@ -64,6 +67,14 @@ AActionFactory::~AActionFactory()
 {
 }
 
+APreviewProcessor *AActionFactory::manufacturePreviewProcessor(const CActionSound *actionSound,const CActionParameters *actionParameters) const
+{
+	std::unique_ptr<AAction> action(manufactureAction(actionSound,actionParameters));
+	if(!action)
+		return NULL;
+	return action->createPreviewProcessor(actionSound);
+}
+
 #include <CNestedDataFile/CNestedDataFile.h>
 // ??? need to pass a flag for 'allowUndo'
 bool AActionFactory::performAction(CLoadedSound *loadedSound,CActionParameters *actionParameters,bool showChannelSelectDialog,bool actionParametersAlreadySetup,bool &wentOntoUndoStack)
@@ -102,7 +113,24 @@ bool AActionFactory::performAction(CLoadedSound *loadedSound,CActionParameters *
 			{
 				dialog->setTitle(getName());
 				dialog->wasShown=true;
-				if(!dialog->show(actionSound.get(),actionParameters))
+
+				// let the dialog preview the action while it's shown
+				dialog->setPreviewContext((previewIsApplicable && requiresALoadedSound) ? this : NULL,loadedSound);
+				bool shown;
+				try
+				{
+					shown=dialog->show(actionSound.get(),actionParameters);
+				}
+				catch(...)
+				{
+					dialog->stopPreview();
+					dialog->setPreviewContext(NULL,NULL);
+					throw;
+				}
+				dialog->stopPreview();
+				dialog->setPreviewContext(NULL,NULL);
+
+				if(!shown)
 					return false;
 			}
 		}
@@ -137,8 +165,14 @@ bool AActionFactory::performAction(CLoadedSound *loadedSound,CActionParameters *
 			{
 				if(ret && result==AAction::curYes)
 				{
+					if(gCompressUndoData)
+						action->compressUndoData();
+
 					loadedSound->actions.push(action);
 					wentOntoUndoStack=true;
+
+					if(gUndoHistoryBudgetMB>0)
+						loadedSound->limitUndoHistory((uint64_t)gUndoHistoryBudgetMB*1024*1024);
 				}
 				else 
 				{
@@ -210,6 +244,9 @@ AAction::AAction(const AActionFactory *_factory,const CActionSound *_actionSound
 
 	preactionChannelCount(_actionSound ? _actionSound->sound->getChannelCount() : 0),
 
+	firstUndoPoolKey(0),endUndoPoolKey(0),
+	undoDataIsCompressed(false),
+
 	factory(_factory),
 
 	actionSound(_actionSound ? new CActionSound(*_actionSound) : NULL),
@@ -261,6 +298,8 @@ bool AAction::doAction(CSoundPlayerChannel *channel,bool prepareForUndo,bool _wi
 	if(done)
 		throw runtime_error(string(__func__)+" -- action has already been done");
 
+	TRACE_SCOPE("AAction::doAction");
+
 	bool doingAMacro=dynamic_cast<CRunMacroAction *>(this)!=NULL;
 
 	done=true;
@@ -299,13 +338,21 @@ bool AAction::doAction(CSoundPlayerChannel *channel,bool prepareForUndo,bool _wi
 					restoreOutputRoutes=channel->getOutputRoutes();
 			}
 
+			firstUndoPoolKey=actionSound->sound->getNextTempAudioPoolKey();
+
 			std::unique_ptr<CActionSound> _actionSound(actionSound.get() ? new CActionSound(*actionSound) : NULL);
 
 			if(crossfadeEdgesIsApplicable)
+			{
+				TRACE_SCOPE("AAction::prepareForInnerCrossfade");
 				prepareForInnerCrossfade(_actionSound.get());
+			}
 
-		
-			bool ret=doActionSizeSafe(_actionSound.get(),prepareForUndo && canUndo()==curYes);
+			bool ret;
+			{
+				TRACE_SCOPE("AAction::doActionSizeSafe");
+				ret=doActionSizeSafe(_actionSound.get(),prepareForUndo && canUndo()==curYes);
+			}
 
 			// restore the original value for isModified unless we didn't prepare for undo
 			if(!ret)
@@ -326,7 +373,10 @@ bool AAction::doAction(CSoundPlayerChannel *channel,bool prepareForUndo,bool _wi
 			{
 				if(crossfadeEdgesIsApplicable)
 				{
-					crossfadeEdges(_actionSound.get());
+					{
+						TRACE_SCOPE("AAction::crossfadeEdges");
+						crossfadeEdges(_actionSound.get());
+					}
 			
 					// again, make sure that the start and stop positions are in range after the crossfade
 					if(_actionSound->start<0)
@@ -341,6 +391,8 @@ bool AAction::doAction(CSoundPlayerChannel *channel,bool prepareForUndo,bool _wi
 				}
 			}
 		
+			endUndoPoolKey=actionSound->sound->getNextTempAudioPoolKey();
+
 			if(channel!=NULL)
 			{
 				vector<int16_t> dummy;
@@ -409,6 +461,8 @@ void AAction::undoAction(CSoundPlayerChannel *channel)
 	if(!factory->requiresALoadedSound)
 		throw runtime_error(string(__func__)+" -- cannot undo an action that did not require a loaded sound");
 
+	TRACE_SCOPE("AAction::undoAction");
+
 	bool undoingAMacro=dynamic_cast<CRanMacroAction *>(this)!=NULL;
 
 	if(!undoingAMacro)
@@ -416,6 +470,8 @@ void AAction::undoAction(CSoundPlayerChannel *channel)
 		undoActionRecursionCount++;
 		try
 		{
+			decompressUndoData();
+
 			// willResize is set from doAction, and it's needed value should be consistent with the way the action will be undone
 			CSoundLocker sl(actionSound->sound, willResize);
 
@@ -884,6 +940,40 @@ void AAction::uncrossfadeEdges()
 }
 
 
+void AAction::compressUndoData()
+{
+	if(!done || undoDataIsCompressed || !actionSound.get())
+		return;
+
+	CSoundLocker sl(actionSound->sound, true);
+	for(unsigned key=firstUndoPoolKey;key<endUndoPoolKey;key++)
+		actionSound->sound->compressTempAudioPools(key);
+	undoDataIsCompressed=true;
+}
+
+void AAction::decompressUndoData()
+{
+	if(!undoDataIsCompressed)
+		return;
+
+	CSoundLocker sl(actionSound->sound, true);
+	for(unsigned key=firstUndoPoolKey;key<endUndoPoolKey;key++)
+		actionSound->sound->decompressTempAudioPools(key);
+	undoDataIsCompressed=false;
+}
+
+uint64_t AAction::getUndoDataSize() const
+{
+	if(!actionSound.get())
+		return 0;
+
+	CSoundLocker sl(actionSound->sound, false);
+	uint64_t size=0;
+	for(unsigned key=firstUndoPoolKey;key<endUndoPoolKey;key++)
+		size+=actionSound->sound->getTempAudioPoolsSize(key);
+	return size;
+}
+
 void AAction::freeAllTempPools()
 {
 	try
@@ -923,6 +1013,8 @@ void AAction::freeAllTempPools()
 // ??? if I thought it was going to be happening... I should lock the undo TPoolFile before changing its size in case 2 threads were using it at the same time
 void AAction::moveSelectionToTempPools(const CActionSound *actionSound,const MoveModes moveMode,sample_pos_t replaceLength,sample_pos_t fudgeFactor)
 {
+	TRACE_SCOPE("AAction::moveSelectionToTempPools");
+
 	if(tempAudioPoolKey!=-1)
 		throw runtime_error(string(__func__)+" -- selection already moved");
 
@@ -48,6 +48,7 @@ class CSoundPlayerChannel;
 class AActionDialog;
 class CActionParameters;
 class ASoundClipboard;
+class APreviewProcessor;
 
 
 #include "CSound.h" // really only necesary because of CSound::RCue
@@ -105,6 +106,12 @@ public:
 	// this flag indicates whether this action requires the 'active' sound from the sound manager; defaults to true; can be modified by the derived class
 	bool requiresALoadedSound; 
 
+	// this flag indicates whether the action created by this factory implements AAction::createPreviewProcessor(); defaults to false; can be modified by the derived class
+	bool previewIsApplicable;
+
+	// manufactures the action with the given parameters only to return its preview processor (or NULL if it has none)
+	APreviewProcessor *manufacturePreviewProcessor(const CActionSound *actionSound,const CActionParameters *actionParameters) const;
+
 	// this flag indicates whether this action is affected by selection positions; defaults to true; can be modified by the dereived class
 	// 	(it is not equivalent in implications to crossfadeEdges is applicable (i.e. selection positions are applicable to the CBurnToCDAction, but crossfadingTheEdiges is not)
 	// 	(this flag is used by the macro recording/playing to know if it needs to ask the user how to set the selection positions when the macro is played back)
@@ -177,6 +184,9 @@ public:
 
 	void setOrigIsModified() { origIsModified=true; }
 
+	// returns the number of bytes in the working file used to be able to undo this action
+	uint64_t getUndoDataSize() const;
+
 	static vector<ASoundClipboard *> clipboards;
 
 	// counts how many recursions of doAction are taking place
@@ -220,6 +230,11 @@ protected:
 	// this method can be overloaded to return false, if the action does not warrent saving the file (i.e. the user will not be prompted)
 	virtual bool doesWarrantSaving() const;
 
+	// This can be overridden to return a new APreviewProcessor which does the same DSP as doActionSizeSafe()
+	// would to actionSound's selection, but on blocks of audio at a time as it's being played.  The factory
+	// should also set previewIsApplicable to true.
+	virtual APreviewProcessor *createPreviewProcessor(const CActionSound *actionSound) const { return NULL; }
+
 	// This can be overridden to return something other than it's default implementation.
 	// It can return false if this is not possibly known and it will tell the user than an inner crossfade cannot be done for that particular action
 	// It is necessary for an inner crossfade to know from where to backup data to be able to crossfade with the new selection after the action.
@@ -272,6 +287,14 @@ private:
 	// - note, willResize includes not only changing the length of the data, but also moving data into undo pools and such
 	bool doAction(CSoundPlayerChannel *channel,bool prepareForUndo,bool willResize,bool crossfadeEdgesIsApplicable);
 
+	// losslessly compresses the temp pools that doAction() left for undoing the action (undoAction() decompresses them)
+	void compressUndoData();
+	void decompressUndoData();
+
+	// the range of temp pool keys created while doAction() ran [firstUndoPoolKey,endUndoPoolKey)
+	unsigned firstUndoPoolKey,endUndoPoolKey;
+	bool undoDataIsCompressed;
+
 	CanUndoResults canUndo() const;
 
 
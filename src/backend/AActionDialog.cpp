@@ -20,10 +20,65 @@
 
 #include "AActionDialog.h"
 
-AActionDialog::AActionDialog()
+#include "AAction.h"
+#include "APreviewProcessor.h"
+#include "CLoadedSound.h"
+#include "CSoundPlayerChannel.h"
+
+AActionDialog::AActionDialog() :
+	previewFactory(NULL),
+	previewLoadedSound(NULL),
+	previewing(false),
+	previewStartedPlaying(false)
 {
 }
 
 AActionDialog::~AActionDialog()
 {
 }
+
+void AActionDialog::setPreviewContext(const AActionFactory *factory,CLoadedSound *loadedSound)
+{
+	previewFactory=factory;
+	previewLoadedSound=loadedSound;
+}
+
+bool AActionDialog::canPreview() const
+{
+	return previewFactory!=NULL && previewLoadedSound!=NULL;
+}
+
+void AActionDialog::startPreview(const CActionSound *actionSound,const CActionParameters *actionParameters)
+{
+	if(!canPreview())
+		return;
+
+	APreviewProcessor *processor=previewFactory->manufacturePreviewProcessor(actionSound,actionParameters);
+	if(processor==NULL)
+		return;
+
+	CSoundPlayerChannel *channel=previewLoadedSound->channel;
+	channel->setPreviewProcessor(processor);
+
+	if(!previewing)
+	{
+		previewing=true;
+		previewStartedPlaying=!channel->isPlaying();
+		if(previewStartedPlaying)
+			channel->play(0,CSoundPlayerChannel::ltLoopNormal,true);
+	}
+}
+
+void AActionDialog::stopPreview()
+{
+	if(!previewing)
+		return;
+
+	CSoundPlayerChannel *channel=previewLoadedSound->channel;
+	if(previewStartedPlaying)
+		channel->stop();
+	channel->setPreviewProcessor(NULL);
+
+	previewing=false;
+	previewStartedPlaying=false;
+}
@@ -30,6 +30,8 @@ class AActionDialog;
 
 class CActionParameters;
 class CActionSound;
+class AActionFactory;
+class CLoadedSound;
 
 /*
  * Any dialog shown to the user for an action to be performed should derived from 
@@ -61,6 +63,29 @@ public:
 
 	// performAction sets this to true if a dialog was shown else false
 	bool wasShown;
+
+	/*
+	 * Previewing: if the action can be previewed, the dialog can let the user hear it with the
+	 * parameter values currently on the dialog.  While previewing, the sound's selection is played
+	 * looped through the action's APreviewProcessor.  startPreview() can be called again whenever 
+	 * the parameters change to hear the new values right away.  Preview stops when the dialog is 
+	 * done being shown.
+	 */
+	bool canPreview() const;
+	void startPreview(const CActionSound *actionSound,const CActionParameters *actionParameters);
+	void stopPreview();
+	bool isPreviewing() const { return previewing; }
+
+private:
+	friend class AActionFactory;
+
+	// called by performAction() around show(); factory is NULL if the action can't be previewed
+	void setPreviewContext(const AActionFactory *factory,CLoadedSound *loadedSound);
+
+	const AActionFactory *previewFactory;
+	CLoadedSound *previewLoadedSound;
+	bool previewing;
+	bool previewStartedPlaying; // true if the player wasn't already playing when preview started
 };
 
 #endif
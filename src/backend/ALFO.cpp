@@ -66,6 +66,12 @@ ALFO::~ALFO()
 {
 }
 
+void ALFO::nextValues(float *values,size_t count)
+{
+	for(size_t t=0;t<count;t++)
+		values[t]=nextValue();
+}
+
 
 
 
@@ -96,6 +102,12 @@ public:
 		return 1.0;
 	}
 
+	void nextValues(float *values,size_t count)
+	{
+		for(size_t t=0;t<count;t++)
+			values[t]=1.0;
+	}
+
 	const float getValue(const sample_pos_t time) const
 	{
 		return 1.0;
@@ -134,6 +146,12 @@ public:
 		return sinf((counter++)*frequency);
 	}
 
+	void nextValues(float *values,size_t count)
+	{
+		for(size_t t=0;t<count;t++)
+			values[t]=sinf((counter++)*frequency);
+	}
+
 	const float getValue(const sample_pos_t time) const
 	{
 		return sinf((time+initial)*frequency);
@@ -169,6 +187,12 @@ public:
 		return (sinf((counter++)*frequency)+1.0)/2.0;
 	}
 
+	void nextValues(float *values,size_t count)
+	{
+		for(size_t t=0;t<count;t++)
+			values[t]=(sinf((counter++)*frequency)+1.0)/2.0;
+	}
+
 	const float getValue(const sample_pos_t time) const
 	{
 		return (sinf((time+initial)*frequency)+1.0)/2.0;
@@ -195,6 +219,13 @@ public:
 		return fabs(CSinLFO::nextValue());
 	}
 
+	void nextValues(float *values,size_t count)
+	{
+		CSinLFO::nextValues(values,count);
+		for(size_t t=0;t<count;t++)
+			values[t]=fabs(values[t]);
+	}
+
 	const float getValue(const sample_pos_t time) const
 	{
 		return fabs(CSinLFO::getValue(time));
@@ -230,6 +261,15 @@ public:
 		return v;
 	}
 
+	void nextValues(float *values,size_t count)
+	{
+		for(size_t t=0;t<count;t++)
+		{
+			values[t]=(counter++)/div-1.0;
+			counter%=mod;
+		}
+	}
+
 	const float getValue(const sample_pos_t time) const
 	{
 		return (time%mod)/div-1.0;
@@ -263,6 +303,15 @@ public:
 		return v;
 	}
 
+	void nextValues(float *values,size_t count)
+	{
+		for(size_t t=0;t<count;t++)
+		{
+			values[t]=(counter++)/div;
+			counter%=mod;
+		}
+	}
+
 	const float getValue(const sample_pos_t time) const
 	{
 		return (time%mod)/div;
@@ -292,6 +341,16 @@ public:
 		return -v;
 	}
 
+	void nextValues(float *values,size_t count)
+	{
+		for(size_t t=0;t<count;t++)
+		{
+			const float v=(counter++)/div-1.0;
+			counter%=mod;
+			values[t]=-v;
+		}
+	}
+
 	const float getValue(const sample_pos_t time) const
 	{
 		return -(time%mod)/div-1.0;
@@ -321,6 +380,16 @@ public:
 		return 1.0-v;
 	}
 
+	void nextValues(float *values,size_t count)
+	{
+		for(size_t t=0;t<count;t++)
+		{
+			const float v=(counter++)/div;
+			counter%=mod;
+			values[t]=1.0-v;
+		}
+	}
+
 	const float getValue(const sample_pos_t time) const
 	{
 		return 1.0-(time%mod)/div;
@@ -346,6 +415,13 @@ public:
 		return CSinLFO::nextValue()>=0.0 ? 1.0 : -1.0;
 	}
 
+	void nextValues(float *values,size_t count)
+	{
+		CSinLFO::nextValues(values,count);
+		for(size_t t=0;t<count;t++)
+			values[t]=values[t]>=0.0 ? 1.0 : -1.0;
+	}
+
 	const float getValue(const sample_pos_t time) const
 	{
 		return CSinLFO::getValue(time)>=0.0 ? 1.0 : -1.0;
@@ -370,6 +446,13 @@ public:
 		return CSinLFO::nextValue()>=0.0 ? 1.0 : 0.0;
 	}
 
+	void nextValues(float *values,size_t count)
+	{
+		CSinLFO::nextValues(values,count);
+		for(size_t t=0;t<count;t++)
+			values[t]=values[t]>=0.0 ? 1.0 : 0.0;
+	}
+
 	const float getValue(const sample_pos_t time) const
 	{
 		return CSinLFO::getValue(time)>=0.0 ? 1.0 : 0.0;
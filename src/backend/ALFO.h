@@ -35,6 +35,8 @@ class CNestedDataFile;
  *  	- Sometimes, however,  it is not possible to write the algorithm using an LFO and not knowing the LFO function because
  *  	  some algorithms may need to determine things from the integral or derivative of the function.  I could have each 
  *  	  LFO implementation to supply these related functions too, but as of now, I haven't needed it.
+ *  - nextValues() produces exactly what count calls to nextValue() would, but with one virtual call
+ *    per block instead of per sample; the implementations override it with a tight loop
  */
 class ALFO
 {
@@ -42,6 +44,7 @@ public:
 	virtual ~ALFO();
 
 	virtual const float nextValue()=0;
+	virtual void nextValues(float *values,size_t count);
 	virtual const float getValue(sample_pos_t time) const=0; // time is in samples, that is not seconds or ms
 
 protected:
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2026 - agent
+ *
+ * This file is part of ReZound, an audio editing application.
+ *
+ * ReZound is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * ReZound is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+#ifndef __APreviewProcessor_H__
+#define __APreviewProcessor_H__
+
+#include "../../config/common.h"
+
+#include <stddef.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "CSound_defs.h"
+#include "CActionSound.h"
+
+/*
+ * An action can return one of these from AAction::createPreviewProcessor() so that its DSP can
+ * be heard on the fly while the user is still adjusting its parameters on the dialog, instead of
+ * doing the action (and writing the whole selection to disk and preparing undo) and then undoing
+ * it.  CSoundPlayerChannel runs the audio that it prebuffers through it while previewing.
+ *
+ * The processing is done in blocks on the prebuffering thread.  It must be restartable: reset()
+ * is called before the first block and whenever playback jumps (at the loop point or after a 
+ * seek) so that no DSP state (i.e. filter history or an echo) carries across the jump.
+ */
+class APreviewProcessor
+{
+public:
+	virtual ~APreviewProcessor() { }
+
+	virtual void reset()=0;
+
+	// processes frameCount frames of interleaved audio (channelCount samples per frame) in place,
+	// where the first frame came from the given position in the sound and the rest follow it
+	virtual void process(sample_t *buffer,unsigned channelCount,size_t frameCount,sample_pos_t position)=0;
+};
+
+
+/*
+ * A preview processor for the many actions which run a DSP object per channel over each sample of the 
+ * selection.  createDSP is called for each of the action's channels on reset() and processSample() is
+ * given that DSP object and each sample in turn.  The channels that the action isn't applied to are 
+ * left alone.
+ */
+template<class dsp_t> class TPerChannelPreviewProcessor : public APreviewProcessor
+{
+public:
+	typedef std::function<dsp_t *()> FCreateDSP;
+	typedef std::function<sample_t(dsp_t &dsp,const sample_t s)> FProcessSample;
+
+	TPerChannelPreviewProcessor(const CActionSound *actionSound,const FCreateDSP &_createDSP,const FProcessSample &_processSample) :
+		channelCount(actionSound->sound->getChannelCount()),
+		createDSP(_createDSP),
+		processSample(_processSample),
+		dsps(channelCount)
+	{
+		for(unsigned i=0;i<channelCount;i++)
+			doChannel[i]=actionSound->doChannel[i];
+	}
+
+	virtual ~TPerChannelPreviewProcessor()
+	{
+	}
+
+	void reset()
+	{
+		for(unsigned i=0;i<channelCount;i++)
+			dsps[i].reset(doChannel[i] ? createDSP() : NULL);
+	}
+
+	void process(sample_t *buffer,unsigned bufferChannelCount,size_t frameCount,sample_pos_t position)
+	{
+		for(unsigned i=0;i<channelCount && i<bufferChannelCount;i++)
+		{
+			if(!dsps[i])
+				continue;
+
+			dsp_t &dsp=*dsps[i];
+			sample_t *b=buffer+i;
+			for(size_t t=0;t<frameCount;t++,b+=bufferChannelCount)
+				*b=processSample(dsp,*b);
+		}
+	}
+
+private:
+	const unsigned channelCount;
+	bool doChannel[MAX_CHANNELS];
+
+	const FCreateDSP createDSP;
+	const FProcessSample processSample;
+
+	std::vector<std::unique_ptr<dsp_t>> dsps;
+};
+
+#endif
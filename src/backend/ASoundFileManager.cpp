@@ -309,6 +309,20 @@ bool ASoundFileManager::saveAs(const string _filename,bool _saveAsRaw)
 bool ASoundFileManager::savePartial(const CSound *sound,const string _filename,const sample_pos_t saveStart,const sample_pos_t saveLength,bool useLastUserPrefs)
 {
 	string filename=_filename;
+	const ASoundTranslator *translator=prepareToSave(filename);
+	if(translator==NULL)
+		return false;
+
+	if(translator->saveSound(filename,sound,saveStart,saveLength,useLastUserPrefs))
+	{
+		updateReopenHistory(filename);
+		return true;
+	}
+	return false;
+}
+
+const ASoundTranslator *ASoundFileManager::prepareToSave(string &filename)
+{
 	bool first=true;
 
 askAgain:
@@ -316,7 +330,7 @@ askAgain:
 	if(filename=="" || !first)
 	{
 		if(!gFrontendHooks->promptForSaveSoundFilename(filename,saveAsRaw))
-			return false;
+			return NULL;
 	}
 
 	first=false;
@@ -330,14 +344,7 @@ askAgain:
 			goto askAgain;
 	}
 
-	const ASoundTranslator *translator=ASoundTranslator::findTranslator(filename,true,saveAsRaw);
-
-	if(translator->saveSound(filename,sound,saveStart,saveLength,useLastUserPrefs))
-	{
-		updateReopenHistory(filename);
-		return true;
-	}
-	return false;
+	return ASoundTranslator::findTranslator(filename,true,saveAsRaw);
 }
 
 bool ASoundFileManager::close(CloseTypes closeType,CLoadedSound *closeWhichSound)
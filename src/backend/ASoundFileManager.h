@@ -63,6 +63,11 @@ public:
 		// returns false if something was cancelled
 	bool savePartial(const CSound *sound,const string filename,const sample_pos_t saveStart,const sample_pos_t saveLength,bool useLastUserPrefs);
 
+		// does the interactive part of savePartial() (prompting for a filename if it's "", confirming
+		// overwriting, etc) and returns the translator to save with, or NULL if it was cancelled.
+		// filename is modified if the user chose another.  Must be called from the main thread.
+	const ASoundTranslator *prepareToSave(string &filename);
+
 	enum CloseTypes { ctSaveYesNoStop,ctSaveYesNoCancel,ctSaveNone };
 		// returns false if something was cancelled
 	bool close(CloseTypes closeType,CLoadedSound *closeWhichSound=NULL); // if nothing is passed for closeWhichSound, then the active sound is closed
@@ -74,6 +79,8 @@ public:
 
 	const size_t getReopenHistorySize() const;
 	const string getReopenHistoryItem(const size_t index) const;
+	// invoked whenever a file is successfully opened, new file created, file recorded, saveAs-ed, etc
+	void updateReopenHistory(const string filename);
 
 	// return the CLoadedSound object associated with the sound window which is currently 'focused'
 	// return NULL if there is no focused window
@@ -112,9 +119,6 @@ protected:
 	virtual void destroyWindow(CLoadedSound *loaded)=0;
 
 
-	// invoked whenever a file is successfully opened, new file created, file recorded, saveAs-ed, etc
-	void updateReopenHistory(const string filename);
-
 private:
 
 	ASoundPlayer *soundPlayer;
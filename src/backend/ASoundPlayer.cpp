@@ -27,12 +27,14 @@
 
 #include "CSound.h"
 #include "CSoundPlayerChannel.h"
+#include "rt_allocation_check.h"
 
 #include "settings.h"
 
 #include "unit_conv.h"
 
-ASoundPlayer::ASoundPlayer()
+ASoundPlayer::ASoundPlayer() :
+	prebufferUnderrunCount(0)
 {
 #ifdef HAVE_FFTW
 	analyzerPlan=NULL;
@@ -115,6 +117,7 @@ void ASoundPlayer::mixSoundPlayerChannels(const unsigned nChannels,sample_t * co
 	// so that the caller wouldn't eat any CPU time doing anything with the silence returned
 
 	{
+		CRealtimeSection rt;
 		std::unique_lock<std::mutex> ml(m);
 		for(set<CSoundPlayerChannel *>::iterator i=soundPlayerChannels.begin();i!=soundPlayerChannels.end();i++)
 			(*i)->mixOntoBuffer(nChannels,buffer,bufferSize);
@@ -130,7 +133,8 @@ void ASoundPlayer::mixSoundPlayerChannels(const unsigned nChannels,sample_t * co
 			size_t p=i;
 			sample_t peak=resetPeakLevels[i] ? 0 : peakLevels[i];
 			resetPeakLevels[i]=false;
-			sample_t maxRMSLevel=resetMaxRMSLevels[i] ? 0 : maxRMSLevels[i];
+			// the max is tracked in power (squared level) so the sqrt is only done once per buffer
+			double maxRMSPower=resetMaxRMSLevels[i] ? 0 : (double)maxRMSLevels[i]*maxRMSLevels[i];
 			resetMaxRMSLevels[i]=false;
 			for(size_t t=0;t<bufferSize;t++)
 			{
@@ -144,16 +148,16 @@ void ASoundPlayer::mixSoundPlayerChannels(const unsigned nChannels,sample_t * co
 					peak=s;
 
 				// update the RMS level detectors
-				sample_t RMSLevel=RMSLevelDetectors[i].readLevel(s);
+				const double RMSPower=RMSLevelDetectors[i].readPower(s);
 
-				// RMSLevel=max(maxRMSLevel,RMSLevel)
-				if(maxRMSLevel<RMSLevel)
-					maxRMSLevel=RMSLevel;
+				// maxRMSPower=max(maxRMSPower,RMSPower)
+				if(maxRMSPower<RMSPower)
+					maxRMSPower=RMSPower;
 
 				p+=nChannels;
 			}
 		
-			maxRMSLevels[i]=maxRMSLevel;
+			maxRMSLevels[i]=(sample_t)sqrt(maxRMSPower);
 			peakLevels[i]=peak;
 		}
 
@@ -558,6 +562,19 @@ ASoundPlayer *ASoundPlayer::createInitializedSoundPlayer()
 				INITIALIZE_PLAYER(CPulseSoundPlayer)
 #endif
 			}
+			else if(method=="offline")
+			{ // no audio hardware, but the channels are mixed as if there were (see CNULLSoundPlayer.h)
+				CNULLSoundPlayer::ROfflineParams params;
+				params.sampleRate=gDesiredOutputSampleRate;
+				params.channelCount=gDesiredOutputChannelCount;
+				params.periodSize=gDesiredOutputBufferSize;
+
+				initializeThrewException=false;
+				delete soundPlayer;
+				soundPlayer=new CNULLSoundPlayer(params);
+				soundPlayer->initialize();
+				break;
+			}
 			else if(method=="null")
 			{
 				INITIALIZE_PLAYER(CNULLSoundPlayer)
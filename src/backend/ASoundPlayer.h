@@ -25,6 +25,7 @@
 
 class ASoundPlayer;
 
+#include <atomic>
 #include <mutex>
 #include <set>
 #include <vector>
@@ -143,6 +144,9 @@ public:
 	const size_t getFrequency(size_t index) const; // returns the frequency of the value at the index within the vector return from getFrequencyAnalysis
 	const size_t getFrequencyAnalysisOctaveStride() const; // return the number of bands per octave returned by getFrequencyAnalysis
 
+	// returns the number of times a playing channel's prebuffered audio ran out before the end was reached (i.e. silence was heard where there should have been audio)
+	const unsigned getPrebufferUnderrunCount() const { return prebufferUnderrunCount; }
+
 protected:
 
 	ASoundPlayer();
@@ -185,6 +189,8 @@ private:
 #endif
 
 	mutable TMemoryPipe<sample_t> samplingForStereoPhaseMeters;
+
+	std::atomic<unsigned> prebufferUnderrunCount; // incremented by CSoundPlayerChannel::mixOntoBuffer()
 };
 
 
@@ -24,6 +24,8 @@
 
 #include <stdexcept>
 
+#include <CTrace.h>
+
 vector<const ASoundTranslator *> ASoundTranslator::registeredTranslators;
 
 ASoundTranslator::ASoundTranslator()
@@ -36,6 +38,8 @@ ASoundTranslator::~ASoundTranslator()
 
 bool ASoundTranslator::loadSound(const string filename,CSound *sound) const
 {
+	TRACE_SCOPE("ASoundTranslator::loadSound");
+
 	try
 	{
 		CSoundLocker sl(sound, true);
@@ -74,6 +78,8 @@ bool ASoundTranslator::saveSound(const string filename,const CSound *sound,bool
 
 bool ASoundTranslator::saveSound(const string filename,const CSound *sound,const sample_pos_t saveStart,const sample_pos_t saveLength,bool useLastUserPrefs) const
 {
+	TRACE_SCOPE("ASoundTranslator::saveSound");
+
 	CSoundLocker sl(sound, false);
 	/*
 	 * ??? A nice feature that would be good now that saving a file can be cancelled
@@ -52,6 +52,7 @@ public:
 	virtual bool handlesExtension(const string extension,const string filename) const=0;
 	virtual bool supportsFormat(const string filename) const=0; // this will only get called iff the file exists and is a regular file
 	virtual bool handlesRaw() const { return(false); }	// only the raw translator implementation should override this to return true
+	virtual bool canSaveInBackground() const { return(true); }	// should return false if onSaveSound() uses the frontend (other than the easy coders and CStatusBar) even when useLastUserPrefs is true
 
 	virtual const vector<string> getFormatNames() const=0;			// return a list of format names than this derivation handles
 	virtual const vector<vector<string> > getFormatFileMasks() const=0;	// return a group of filemasks for each format name that is supported (i.e. "*.wav")
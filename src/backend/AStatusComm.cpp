@@ -62,7 +62,9 @@ const string AStatusComm::breakIntoLines(const string _s)
 
 void Error(const string &message,VSeverity severity,bool reformatIfNeeded)
 {
-	if (gStatusComm) {
+	if (CStatusCommRelay::getCurrentScope()) {
+		CStatusCommRelay::getCurrentScope()->getRelay().relayError(message,severity,reformatIfNeeded);
+	} else if (gStatusComm) {
 		gStatusComm->error(message,severity,reformatIfNeeded);
 	} else {
 		fprintf(stderr, "error -- %s", message.c_str());
@@ -71,7 +73,9 @@ void Error(const string &message,VSeverity severity,bool reformatIfNeeded)
 
 void Warning(const string &message,bool reformatIfNeeded)
 {
-	if (gStatusComm) {
+	if (CStatusCommRelay::getCurrentScope()) {
+		CStatusCommRelay::getCurrentScope()->getRelay().relayWarning(message,reformatIfNeeded);
+	} else if (gStatusComm) {
 		gStatusComm->warning(message,reformatIfNeeded);
 	} else {
 		fprintf(stderr, "warning -- %s", message.c_str());
@@ -80,7 +84,9 @@ void Warning(const string &message,bool reformatIfNeeded)
 
 void Message(const string &message,bool reformatIfNeeded)
 {
-	if (gStatusComm) {
+	if (CStatusCommRelay::getCurrentScope()) {
+		CStatusCommRelay::getCurrentScope()->getRelay().relayMessage(message,reformatIfNeeded);
+	} else if (gStatusComm) {
 		gStatusComm->message(message,reformatIfNeeded);
 	} else {
 		fprintf(stderr, "%s", message.c_str());
@@ -89,6 +95,8 @@ void Message(const string &message,bool reformatIfNeeded)
 
 VAnswer Question(const string &message,/*VQuestion*/int options,bool reformatIfNeeded)
 {
+	if(CStatusCommRelay::getCurrentScope())
+		return(CStatusCommRelay::getCurrentScope()->getRelay().relayQuestion(message,options,reformatIfNeeded));
 	assert(gStatusComm);
 	return(gStatusComm->question(message,options,reformatIfNeeded));
 }
@@ -111,6 +119,124 @@ void endAllProgressBars()
 }
 
 
+// --- CStatusCommRelay --------------------------------
+
+#include <chrono>
+
+thread_local CStatusCommRelay::CWorkerScope *CStatusCommRelay::currentScope=NULL;
+
+CStatusCommRelay::CStatusCommRelay() :
+	woken(false),
+	cancelled(false)
+{
+}
+
+CStatusCommRelay::~CStatusCommRelay()
+{
+	// whatever wasn't serviced is dropped (questions can't be pending since their workers would still be waiting)
+	for(size_t t=0;t<requests.size();t++)
+	{
+		if(requests[t]->type!=rtQuestion)
+			delete requests[t];
+	}
+}
+
+void CStatusCommRelay::service(unsigned timeoutMS)
+{
+	std::deque<RRequest *> todo;
+	{
+		std::unique_lock<std::mutex> l(mutex);
+		if(requests.empty() && !woken)
+			cond.wait_for(l,std::chrono::milliseconds(timeoutMS),[this]{ return !requests.empty() || woken; });
+		woken=false;
+		todo.swap(requests);
+	}
+
+	// the frontend is called without holding the mutex so the other workers aren't held up by a dialog
+	for(size_t t=0;t<todo.size();t++)
+	{
+		RRequest *r=todo[t];
+		switch(r->type)
+		{
+		case rtError:
+			Error(r->message,(VSeverity)r->arg,r->reformatIfNeeded);
+			delete r;
+			break;
+		case rtWarning:
+			Warning(r->message,r->reformatIfNeeded);
+			delete r;
+			break;
+		case rtMessage:
+			Message(r->message,r->reformatIfNeeded);
+			delete r;
+			break;
+		case rtQuestion:
+		{
+			const VAnswer answer=Question(r->message,r->arg,r->reformatIfNeeded);
+			std::unique_lock<std::mutex> l(mutex);
+			r->answer=answer;
+			r->answered=true;
+			cond.notify_all();
+			break;
+		}
+		}
+	}
+}
+
+void CStatusCommRelay::wake()
+{
+	std::unique_lock<std::mutex> l(mutex);
+	woken=true;
+	cond.notify_all();
+}
+
+void CStatusCommRelay::post(RRequest *request)
+{
+	std::unique_lock<std::mutex> l(mutex);
+	requests.push_back(request);
+	cond.notify_all();
+}
+
+void CStatusCommRelay::relayError(const string &message,VSeverity severity,bool reformatIfNeeded)
+{
+	post(new RRequest{rtError,message,(int)severity,reformatIfNeeded,defaultAns,false});
+}
+
+void CStatusCommRelay::relayWarning(const string &message,bool reformatIfNeeded)
+{
+	post(new RRequest{rtWarning,message,0,reformatIfNeeded,defaultAns,false});
+}
+
+void CStatusCommRelay::relayMessage(const string &message,bool reformatIfNeeded)
+{
+	post(new RRequest{rtMessage,message,0,reformatIfNeeded,defaultAns,false});
+}
+
+VAnswer CStatusCommRelay::relayQuestion(const string &message,int options,bool reformatIfNeeded)
+{
+	RRequest r{rtQuestion,message,options,reformatIfNeeded,defaultAns,false};
+	post(&r);
+
+	std::unique_lock<std::mutex> l(mutex);
+	cond.wait(l,[&r]{ return r.answered; });
+	return r.answer;
+}
+
+
+CStatusCommRelay::CWorkerScope::CWorkerScope(CStatusCommRelay &_relay,std::atomic<int> *_progress) :
+	relay(_relay),
+	progress(_progress),
+	prevScope(currentScope)
+{
+	currentScope=this;
+}
+
+CStatusCommRelay::CWorkerScope::~CWorkerScope()
+{
+	currentScope=prevScope;
+}
+
+
 // --- CStatusBar --------------------------------------
 
 #include <sys/time.h>
@@ -129,7 +255,8 @@ static unsigned long getCurrentMilliseconds()
 }
 
 CStatusBar::CStatusBar(const string title,const sample_pos_t firstValue,const sample_pos_t lastValue,const bool showCancelButton) :
-	handle(gStatusComm->beginProgressBar(title,showCancelButton)),
+	workerScope(CStatusCommRelay::getCurrentScope()),
+	handle(workerScope ? -1 : gStatusComm->beginProgressBar(title,showCancelButton)),
 	sub(firstValue),
 	valueDiff(lastValue-firstValue),
 	div( valueDiff<100 ? 1 : ((valueDiff+100-1)/100) ),
@@ -149,7 +276,10 @@ void CStatusBar::reset()
 {
 	lastProgress=0;
 	initialTime=getCurrentMilliseconds();
-	gStatusComm->updateProgressBar(handle,0,"","");
+	if(workerScope)
+		updateWorker(0);
+	else if(handle!=-1)
+		gStatusComm->updateProgressBar(handle,0,"","");
 }
 
 void CStatusBar::hide()
@@ -161,6 +291,13 @@ void CStatusBar::hide()
 	}
 }
 
+bool CStatusBar::updateWorker(const sample_pos_t progress)
+{
+	if(workerScope->progress)
+		*workerScope->progress=(int)(progress*mul);
+	return workerScope->relay.isCancelled();
+}
+
 #include "unit_conv.h" // for seconds_to_string
 
 const string CStatusBar::getTimeRemaining()
@@ -86,6 +86,91 @@ VAnswer Question(const string &message,/*VQuestion*/int options,bool reformatIfN
 
 
 
+/*
+	The frontend may only be used from the main thread.  This class lets work 
+	that is done on other threads still use the easy coders and CStatusBar.
+
+	The main thread constructs a CStatusCommRelay and calls service() until the
+	workers are finished.  Each worker constructs a CStatusCommRelay::CWorkerScope 
+	on its own stack for the time that it is working.  Inside the scope, Error(),
+	Warning() and Message() are queued to be shown by the main thread in service(),
+	and Question() blocks until service() has gotten the user's answer.  A 
+	CStatusBar constructed inside the scope shows nothing (the main thread should
+	show one progress bar for all the workers) but it reports its progress to the
+	scope, and its update() returns true after cancel() has been called.
+*/
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+class CStatusCommRelay
+{
+public:
+	CStatusCommRelay();
+	virtual ~CStatusCommRelay();
+
+	// to be called from the main thread: shows the queued messages and asks the pending
+	// questions, waiting at most timeoutMS for one to arrive if there are none
+	void service(unsigned timeoutMS);
+
+	// makes service() return early (i.e. when a worker has finished)
+	void wake();
+
+	void cancel() { cancelled=true; }
+	bool isCancelled() const { return cancelled; }
+
+	class CWorkerScope
+	{
+	public:
+		// progress (0 to 100) is where a CStatusBar constructed inside this scope writes its progress
+		CWorkerScope(CStatusCommRelay &relay,std::atomic<int> *progress=NULL);
+		virtual ~CWorkerScope();
+
+		CStatusCommRelay &getRelay() const { return relay; }
+
+	private:
+		friend class CStatusCommRelay;
+		friend class CStatusBar;
+
+		CStatusCommRelay &relay;
+		std::atomic<int> * const progress;
+		CWorkerScope * const prevScope;
+	};
+
+	// returns the scope the calling thread is working in, or NULL if it is not a worker
+	static CWorkerScope *getCurrentScope() { return currentScope; }
+
+	// used by the easy coders when called inside a CWorkerScope
+	void relayError(const string &message,VSeverity severity,bool reformatIfNeeded);
+	void relayWarning(const string &message,bool reformatIfNeeded);
+	void relayMessage(const string &message,bool reformatIfNeeded);
+	VAnswer relayQuestion(const string &message,int options,bool reformatIfNeeded);
+
+private:
+	enum RequestTypes { rtError,rtWarning,rtMessage,rtQuestion };
+	struct RRequest
+	{
+		RequestTypes type;
+		string message;
+		int arg; // severity or question options
+		bool reformatIfNeeded;
+		VAnswer answer;
+		bool answered;
+	};
+
+	std::mutex mutex;
+	std::condition_variable cond;
+	std::deque<RRequest *> requests; // questions point to the asking worker's stack; the rest are owned by the queue
+	bool woken;
+	std::atomic<bool> cancelled;
+
+	void post(RRequest *request);
+
+	static thread_local CWorkerScope *currentScope;
+};
+
+
+
 /*
 	I made this class to make adding status bars to actions relatively painless. 
 
@@ -103,12 +188,13 @@ public:
 	CStatusBar(const string title,const sample_pos_t firstValue,const sample_pos_t lastValue,const bool showCancelButton=false);
 	virtual ~CStatusBar();
 
-	inline bool update(const sample_pos_t value) { const sample_pos_t progress=(value-sub)/div; return progress!=lastProgress && handle!=-1 && gStatusComm->updateProgressBar(handle,(int)((lastProgress=progress)*mul),getTimeElapsed(),getTimeRemaining()); }
+	inline bool update(const sample_pos_t value) { const sample_pos_t progress=(value-sub)/div; return progress!=lastProgress && (workerScope ? updateWorker(lastProgress=progress) : (handle!=-1 && gStatusComm->updateProgressBar(handle,(int)((lastProgress=progress)*mul),getTimeElapsed(),getTimeRemaining()))); }
 
 	void reset();
 	void hide();
 	
 private:
+	CStatusCommRelay::CWorkerScope * const workerScope; // non-NULL when constructed on a worker thread
 	int handle;
 	const sample_pos_t sub;
 	const sample_pos_t valueDiff;
@@ -119,6 +205,8 @@ private:
 
 	const string getTimeElapsed();
 	const string getTimeRemaining();
+
+	bool updateWorker(const sample_pos_t progress);
 };
 
 #endif
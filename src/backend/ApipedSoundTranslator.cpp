@@ -31,6 +31,7 @@
 #include <signal.h>
 
 #include <stdexcept>
+#include <mutex>
 
 #include "mypopen.h"
 
@@ -87,10 +88,10 @@ void ApipedSoundTranslator::removeExistingFile(const string filename)
 	typedef void (*sighandler_t) (int);
 #endif
 
-static sighandler_t origSIGPIPE_Handler;
-bool ApipedSoundTranslator::SIGPIPECaught;
+thread_local bool ApipedSoundTranslator::SIGPIPECaught;
 void SIGPIPE_Handler(int sig)
 {
+	// a SIGPIPE caused by write() goes to the thread that did the write, so this only flags the save that caused it
 	ApipedSoundTranslator::SIGPIPECaught=true;
 }
 
@@ -99,16 +100,12 @@ void ApipedSoundTranslator::setupSIGPIPEHandler()
 	SIGPIPECaught=false;
 
 	// setup a signal handler to handle a SIGPIPE in case the application crashes or doesn't like something
-	origSIGPIPE_Handler=signal(SIGPIPE,SIGPIPE_Handler);
+	// (this is done only once and left in place since saves may run in parallel and saving and restoring 
+	// the original handler around each one would race)
+	static std::once_flag installed;
+	std::call_once(installed,[]{ signal(SIGPIPE,SIGPIPE_Handler); });
 }
 
-void ApipedSoundTranslator::restoreOrigSIGPIPEHandler()
-{
-	if(origSIGPIPE_Handler!=NULL && origSIGPIPE_Handler!=SIG_ERR)
-		signal(SIGPIPE,origSIGPIPE_Handler);
-}
-
-
 FILE *ApipedSoundTranslator::popen(const string cmdLine,const string mode,FILE **errStream)
 {
 	FILE *p=mypopen(cmdLine.c_str(),mode.c_str(),errStream);
@@ -46,8 +46,7 @@ protected:
 	static void removeExistingFile(const string filename);		// should be done before attempting to open pipe
 
 	static void setupSIGPIPEHandler(); 				// should be called and SIGPIPECaught checked whenever saving and writing to pipe
-	static void restoreOrigSIGPIPEHandler(); 			// should be called after saving is finished or when an exception is caught and bailing
-	static bool SIGPIPECaught;
+	static thread_local bool SIGPIPECaught;				// per thread since the saving thread is the one that gets the SIGPIPE
 
 	static FILE *popen(const string cmdLine,const string mode,FILE **errStream);
 	static int pclose(FILE *p);
@@ -27,6 +27,9 @@
 #ifdef ENABLE_ALSA
 
 
+#include <errno.h>
+#include <stdint.h>
+
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -34,17 +37,46 @@
 #include <istring>
 
 #include "settings.h"
+#include "rt_allocation_check.h"
+#include "sample_conversion.h"
+#include "alsa_util.h"
+
+#define DEFAULT_PERIOD_SIZE_FRAMES 1024 // used unless gALSAOutputPeriodSize says otherwise
 
-#warning use these values from the registry globals
-#define PERIOD_SIZE_FRAMES 1024
-#define PERIOD_COUNT 2
+
+// converts interleaved sample_t frames into the device's buffer whose format is dest_t
+template<typename dest_t> static void writeToAreas(const snd_pcm_channel_area_t *areas,const snd_pcm_uframes_t offset,const snd_pcm_uframes_t frames,const unsigned channelCount,const sample_t *src)
+{
+	if(areasAreInterleaved(areas,channelCount,sizeof(dest_t)*8))
+	{
+		convertSamples(src,(dest_t *)areaAddress(areas[0],offset),frames*channelCount);
+		return;
+	}
+
+	for(unsigned c=0;c<channelCount;c++)
+	{
+		uint8_t *dest=areaAddress(areas[c],offset);
+		const size_t step=areas[c].step/8;
+		const sample_t *s=src+c;
+		for(snd_pcm_uframes_t t=0;t<frames;t++)
+		{
+			*(dest_t *)dest=convert_sample<sample_t,dest_t>(*s);
+			dest+=step;
+			s+=channelCount;
+		}
+	}
+}
 
 
 CALSASoundPlayer::CALSASoundPlayer() :
 	ASoundPlayer(),
 
 	initialized(false),
-	playback_handle(NULL)
+	playback_handle(NULL),
+	nativeFormat(false),
+	useMmap(false),
+	periodSize(0),
+	periodCount(0)
 {
 }
 
@@ -95,8 +127,9 @@ void CALSASoundPlayer::initialize()
 			devices[0].channelCount=channelCount; // make note of the number of channels for this device (??? which is only device zero for now)
 
 
-			// set to interleaved access
-			if((err = snd_pcm_hw_params_set_access(playback_handle, hw_params, SND_PCM_ACCESS_RW_INTERLEAVED)) < 0)
+			// set to interleaved access, mmapped if possible so that the data can be mixed directly into the device's buffer
+			useMmap=gALSAUseMmap && snd_pcm_hw_params_set_access(playback_handle, hw_params, SND_PCM_ACCESS_MMAP_INTERLEAVED)>=0;
+			if(!useMmap && (err = snd_pcm_hw_params_set_access(playback_handle, hw_params, SND_PCM_ACCESS_RW_INTERLEAVED)) < 0)
 				throw runtime_error(string(__func__)+" -- cannot set access type -- "+snd_strerror(err));
 
 
@@ -105,24 +138,20 @@ void CALSASoundPlayer::initialize()
 				throw runtime_error(string(__func__)+" -- cannot set periods to integer only -- "+snd_strerror(err));
 
 
-			// set period size
-			snd_pcm_uframes_t period_size=PERIOD_SIZE_FRAMES;
+			// set period size (the device may not support exactly what was asked for)
+			periodSize=gALSAOutputPeriodSize!=0 ? gALSAOutputPeriodSize : DEFAULT_PERIOD_SIZE_FRAMES;
 			int dir=0;
-			if((err = snd_pcm_hw_params_set_period_size_near(playback_handle, hw_params, &period_size, &dir)) < 0)
+			if((err = snd_pcm_hw_params_set_period_size_near(playback_handle, hw_params, &periodSize, &dir)) < 0)
 				throw runtime_error(string(__func__)+" -- cannot set period size -- "+snd_strerror(err));
 
 
-			// set number of periods 
-			unsigned int periods=PERIOD_COUNT;
-			if((err = snd_pcm_hw_params_set_periods(playback_handle, hw_params, periods, 0)) < 0)
+			// set number of periods (the buffer size is the period size times this)
+			periodCount=gDesiredOutputBufferCount;
+			dir=0;
+			if((err = snd_pcm_hw_params_set_periods_near(playback_handle, hw_params, &periodCount, &dir)) < 0)
 				throw runtime_error(string(__func__)+" -- cannot set periods -- "+snd_strerror(err));
 
 
-			// and then set the buffer size (what .. what's this difference between buffers and periods?)
-			if((err = snd_pcm_hw_params_set_buffer_size(playback_handle, hw_params, (PERIOD_COUNT*PERIOD_SIZE_FRAMES) )) < 0)
-				throw runtime_error(string(__func__)+" -- cannot set buffer size -- "+snd_strerror(err));
-
-
 			// set sample format
 			vector<snd_pcm_format_t> formatsToTry;
 #ifndef WORDS_BIGENDIAN
@@ -164,17 +193,22 @@ void CALSASoundPlayer::initialize()
 			}
 			if(!found)
 				throw runtime_error(string(__func__)+" -- cannot set sample format -- "+snd_strerror(err));
+			nativeFormat= playback_format==formatsToTry[0];
 
 
 			// set the hardware parameters
 			if((err = snd_pcm_hw_params(playback_handle, hw_params)) < 0)
 				throw runtime_error(string(__func__)+" -- cannot set parameters -- "+snd_strerror(err));
 
+			// make note of what was actually granted
+			snd_pcm_hw_params_get_period_size(hw_params, &periodSize, &dir);
+			snd_pcm_hw_params_get_periods(hw_params, &periodCount, &dir);
+
 			snd_pcm_hw_params_free(hw_params);
 
 
 
-			/* tell ALSA to wake us up whenever PERIOD_SIZE_FRAMES or more frames of playback data can be delivered. Also, tell ALSA that we'll start the device ourselves. */
+			/* tell ALSA to wake us up whenever periodSize or more frames of playback data can be delivered. Also, tell ALSA that we'll start the device ourselves. */
 
 			if((err = snd_pcm_sw_params_malloc(&sw_params)) < 0)
 				throw runtime_error(string(__func__)+" -- cannot allocate software parameters structure -- "+snd_strerror(err));
@@ -182,16 +216,18 @@ void CALSASoundPlayer::initialize()
 			if((err = snd_pcm_sw_params_current(playback_handle, sw_params)) < 0)
 				throw runtime_error(string(__func__)+" -- cannot initialize software parameters structure -- "+snd_strerror(err));
 
-			if((err = snd_pcm_sw_params_set_avail_min(playback_handle, sw_params, PERIOD_SIZE_FRAMES)) < 0)
+			if((err = snd_pcm_sw_params_set_avail_min(playback_handle, sw_params, periodSize)) < 0)
 				throw runtime_error(string(__func__)+" -- cannot set minimum available count -- "+snd_strerror(err));
 
-			if((err = snd_pcm_sw_params_set_start_threshold(playback_handle, sw_params, 0)) < 0)
-				throw runtime_error(string(__func__)+" -- cannot set start threshold -- "+snd_strerror(err));
-
-			// make xruns not interrupt anything
 			snd_pcm_uframes_t boundary;
 			if((err = snd_pcm_sw_params_get_boundary(sw_params, &boundary)) < 0)
 				throw runtime_error(string(__func__)+" -- cannot get boundary -- "+snd_strerror(err));
+
+			// mmapThreadWork() starts the device itself once the buffer has been filled
+			if((err = snd_pcm_sw_params_set_start_threshold(playback_handle, sw_params, useMmap ? boundary : 0)) < 0)
+				throw runtime_error(string(__func__)+" -- cannot set start threshold -- "+snd_strerror(err));
+
+			// make xruns not interrupt anything
 			if((err = snd_pcm_sw_params_set_stop_threshold(playback_handle, sw_params, boundary)) < 0)
 				throw runtime_error(string(__func__)+" -- cannot set stop threshold -- "+snd_strerror(err));
 
@@ -215,7 +251,7 @@ void CALSASoundPlayer::initialize()
 			playThread = std::make_unique<stdx::thread>([this]() { threadWork(); });
 
 			initialized=true;
-			fprintf(stderr, "ALSA player initialized\n");
+			fprintf(stderr, "ALSA player initialized (%s, %u periods of %u frames)\n",useMmap ? "mmap" : "read/write",periodCount,(unsigned)periodSize);
 		}
 		catch(...)
 		{
@@ -266,12 +302,21 @@ void CALSASoundPlayer::threadWork()
 {
 	try
 	{
+		if(gRealtimeAudioThreadPriority>0 || gLockMemoryForRealtimeAudio)
+			makeThreadRealtime(gRealtimeAudioThreadPriority,gLockMemoryForRealtimeAudio);
+
+		if(useMmap)
+		{
+			mmapThreadWork();
+			return;
+		}
+
 		int err;
-		std::vector<sample_t> buffer(PERIOD_SIZE_FRAMES*devices[0].channelCount*2); 
+		std::vector<sample_t> buffer(periodSize*devices[0].channelCount*2); 
 			// these are possibly used if sample format conversion is required
-		std::vector<int16_t> buffer__int16_t(PERIOD_SIZE_FRAMES*devices[0].channelCount);
-		std::vector<int32_t> buffer__int32_t(PERIOD_SIZE_FRAMES*devices[0].channelCount);
-		std::vector<float> buffer__float(PERIOD_SIZE_FRAMES*devices[0].channelCount);
+		std::vector<int16_t> buffer__int16_t(periodSize*devices[0].channelCount);
+		std::vector<int32_t> buffer__int32_t(periodSize*devices[0].channelCount);
+		std::vector<float> buffer__float(periodSize*devices[0].channelCount);
 
 		snd_pcm_format_t format=playback_format;
 
@@ -318,7 +363,7 @@ void CALSASoundPlayer::threadWork()
 		while(!stdx::this_thread::is_cancelled())
 		{
 			// can mixChannels throw any exception???
-			mixSoundPlayerChannels(devices[0].channelCount,buffer.data(),PERIOD_SIZE_FRAMES);
+			mixSoundPlayerChannels(devices[0].channelCount,buffer.data(),periodSize);
 
 			// wait till the interface is ready for data, or 1 second has elapsed.
 			if((err = snd_pcm_wait (playback_handle, 1000)) < 0)
@@ -336,55 +381,46 @@ void CALSASoundPlayer::threadWork()
 					throw runtime_error(string(__func__)+" -- unknown ALSA avail update return value: "+istring(frames_to_deliver));
 			}
 
-			if(frames_to_deliver<PERIOD_SIZE_FRAMES)
-				throw runtime_error(string(__func__)+" -- frames_to_deliver is less than PERIOD_SIZE_FRAMES: "+istring(frames_to_deliver)+"<"+istring(PERIOD_SIZE_FRAMES));
+			if(frames_to_deliver<(snd_pcm_sframes_t)periodSize)
+				throw runtime_error(string(__func__)+" -- frames_to_deliver is less than the period size: "+istring(frames_to_deliver)+"<"+istring(periodSize));
 
-#warning probably should abstract this into a since it could be used several places
 			switch(conv)
 			{
 				case 0:	// no conversion necessary
 				{
-					if((err=snd_pcm_writei(playback_handle, buffer.data(), PERIOD_SIZE_FRAMES)) < 0)
+					if((err=snd_pcm_writei(playback_handle, buffer.data(), periodSize)) < 0)
 						fprintf(stderr, "ALSA write failed (%s)\n", snd_strerror(err));
 				}
 				break;
 
 				case 1:	// we need to convert float->int16_t
 				{ 
-					unsigned l=PERIOD_SIZE_FRAMES*devices[0].channelCount;
-					for(unsigned t=0;t<l;t++)
-						buffer__int16_t[t]=convert_sample<float,int16_t>((float)buffer[t]);
-					if((err=snd_pcm_writei(playback_handle, buffer__int16_t.data(), PERIOD_SIZE_FRAMES)) < 0)
+					convertSamples(buffer.data(),buffer__int16_t.data(),periodSize*devices[0].channelCount);
+					if((err=snd_pcm_writei(playback_handle, buffer__int16_t.data(), periodSize)) < 0)
 						fprintf(stderr, "ALSA write failed (%s)\n", snd_strerror(err));
 				}
 				break;
 
 				case 2:	// we need to convert int16_t->float
 				{ 
-					unsigned l=PERIOD_SIZE_FRAMES*devices[0].channelCount;
-					for(unsigned t=0;t<l;t++)
-						buffer__float[t]=convert_sample<int16_t,float>((int16_t)buffer[t]);
-					if((err=snd_pcm_writei(playback_handle, buffer__float.data(), PERIOD_SIZE_FRAMES)) < 0)
+					convertSamples(buffer.data(),buffer__float.data(),periodSize*devices[0].channelCount);
+					if((err=snd_pcm_writei(playback_handle, buffer__float.data(), periodSize)) < 0)
 						fprintf(stderr, "ALSA write failed (%s)\n", snd_strerror(err));
 				}
 				break;
 
 				case 3:	// we need to convert float->int32_t
 				{ 
-					unsigned l=PERIOD_SIZE_FRAMES*devices[0].channelCount;
-					for(unsigned t=0;t<l;t++)
-						buffer__int32_t[t]=convert_sample<float,int32_t>((float)buffer[t]);
-					if((err=snd_pcm_writei(playback_handle, buffer__int32_t.data(), PERIOD_SIZE_FRAMES)) < 0)
+					convertSamples(buffer.data(),buffer__int32_t.data(),periodSize*devices[0].channelCount);
+					if((err=snd_pcm_writei(playback_handle, buffer__int32_t.data(), periodSize)) < 0)
 						fprintf(stderr, "ALSA write failed (%s)\n", snd_strerror(err));
 				}
 				break;
 
 				case 4:	// we need to convert int16_t->int32_t
 				{ 
-					unsigned l=PERIOD_SIZE_FRAMES*devices[0].channelCount;
-					for(unsigned t=0;t<l;t++)
-						buffer__int32_t[t]=convert_sample<int16_t,int32_t>((int16_t)buffer[t]);
-					if((err=snd_pcm_writei(playback_handle, buffer__int32_t.data(), PERIOD_SIZE_FRAMES)) < 0)
+					convertSamples(buffer.data(),buffer__int32_t.data(),periodSize*devices[0].channelCount);
+					if((err=snd_pcm_writei(playback_handle, buffer__int32_t.data(), periodSize)) < 0)
 						fprintf(stderr, "ALSA write failed (%s)\n", snd_strerror(err));
 				}
 				break;
@@ -405,4 +441,85 @@ void CALSASoundPlayer::threadWork()
 	}
 }
 
+/*
+ * Mixes a period at a time straight into the device's buffer when the device's format is sample_t's
+ * (else mixes into a buffer and converts into the device's buffer) so that there's no copy through 
+ * snd_pcm_writei().  The device is started once its buffer has been filled, and again after an xrun.
+ */
+void CALSASoundPlayer::mmapThreadWork()
+{
+	const unsigned channelCount=devices[0].channelCount;
+	std::vector<sample_t> buffer(periodSize*channelCount);
+
+	const unsigned formatWidth=snd_pcm_format_physical_width(playback_format);
+
+	int err;
+	while(!stdx::this_thread::is_cancelled())
+	{
+		const snd_pcm_sframes_t avail=snd_pcm_avail_update(playback_handle);
+		if(avail<0)
+		{
+			recoverFromError(playback_handle,avail);
+			continue;
+		}
+
+		if((snd_pcm_uframes_t)avail<periodSize)
+		{
+			if(snd_pcm_state(playback_handle)==SND_PCM_STATE_PREPARED)
+			{ // the buffer is full, so start playing it
+				if((err = snd_pcm_start(playback_handle)) < 0)
+					recoverFromError(playback_handle,err);
+			}
+			// wait till the interface is ready for data, or 1 second has elapsed.
+			else if((err = snd_pcm_wait(playback_handle, 1000)) < 0)
+				recoverFromError(playback_handle,err);
+			continue;
+		}
+
+		// deliver a period (in more than one piece if it wraps around the end of the device's buffer)
+		snd_pcm_uframes_t remaining=periodSize;
+		while(remaining>0)
+		{
+			const snd_pcm_channel_area_t *areas;
+			snd_pcm_uframes_t offset;
+			snd_pcm_uframes_t frames=remaining;
+			if((err = snd_pcm_mmap_begin(playback_handle, &areas, &offset, &frames)) < 0)
+			{
+				recoverFromError(playback_handle,err);
+				break;
+			}
+
+			// the areas are normally interleaved in one block, but a plugin could have arranged them otherwise
+			if(nativeFormat && areasAreInterleaved(areas,channelCount,formatWidth))
+				mixSoundPlayerChannels(channelCount,(sample_t *)areaAddress(areas[0],offset),frames);
+			else
+			{
+				mixSoundPlayerChannels(channelCount,buffer.data(),frames);
+				switch(formatWidth)
+				{
+				case 16:
+					writeToAreas<int16_t>(areas,offset,frames,channelCount,buffer.data());
+					break;
+				case 32:
+					if(snd_pcm_format_float(playback_format)==1)
+						writeToAreas<float>(areas,offset,frames,channelCount,buffer.data());
+					else
+						writeToAreas<int32_t>(areas,offset,frames,channelCount,buffer.data());
+					break;
+				default:
+					throw runtime_error(string(__func__)+" -- no conversion determined");
+				}
+			}
+
+			const snd_pcm_sframes_t committed=snd_pcm_mmap_commit(playback_handle, offset, frames);
+			if(committed<0 || (snd_pcm_uframes_t)committed!=frames)
+			{
+				recoverFromError(playback_handle,committed<0 ? committed : -EPIPE);
+				break;
+			}
+			remaining-=frames;
+		}
+	}
+}
+
 #endif // ENABLE_ALSA
@@ -50,10 +50,15 @@ private:
 	bool initialized;
 	snd_pcm_t *playback_handle;
 	snd_pcm_format_t playback_format;
+	bool nativeFormat;		// true if playback_format is the same as sample_t
+	bool useMmap;			// true if the device's buffer is written directly rather than with snd_pcm_writei()
+	snd_pcm_uframes_t periodSize;	// as granted by the device (gDesiredOutputBufferSize is only asked for)
+	unsigned periodCount;
 
 	std::unique_ptr<stdx::thread> playThread;
 
 	void threadWork();
+	void mmapThreadWork();
 };
 
 #endif // ENABLE_ALSA
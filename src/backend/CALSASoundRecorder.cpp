@@ -22,6 +22,9 @@
 
 #ifdef ENABLE_ALSA
 
+#include <errno.h>
+#include <stdint.h>
+
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -30,6 +33,9 @@
 
 #include "settings.h"
 #include "AStatusComm.h"
+#include "rt_allocation_check.h"
+#include "sample_conversion.h"
+#include "alsa_util.h"
 
 // ??? edit this to be able to detect necessary parameters from the typeof sample_t
 // 	or I need to convert to 16bit 
@@ -40,17 +46,39 @@
 	#define ALSA_PCM_FORMAT SND_PCM_FORMAT_S16_LE
 #endif
 
-// ??? as the sample rate is lower these need to be lower so that onData is called more often and the view meters on the record dialog don't seem to lag
+// converts from the device's buffer whose format is src_t into interleaved sample_t frames
+template<typename src_t> static void readFromAreas(const snd_pcm_channel_area_t *areas,const snd_pcm_uframes_t offset,const snd_pcm_uframes_t frames,const unsigned channelCount,sample_t *dest)
+{
+	if(areasAreInterleaved(areas,channelCount,sizeof(src_t)*8))
+	{
+		convertSamples((const src_t *)areaAddress(areas[0],offset),dest,frames*channelCount);
+		return;
+	}
 
-#define PERIOD_SIZE_FRAMES 8192
-#define PERIOD_COUNT 2
+	for(unsigned c=0;c<channelCount;c++)
+	{
+		const uint8_t *src=areaAddress(areas[c],offset);
+		const size_t step=areas[c].step/8;
+		sample_t *d=dest+c;
+		for(snd_pcm_uframes_t t=0;t<frames;t++)
+		{
+			*d=convert_sample<src_t,sample_t>(*(const src_t *)src);
+			src+=step;
+			d+=channelCount;
+		}
+	}
+}
 
 
 CALSASoundRecorder::CALSASoundRecorder() :
 	ASoundRecorder(),
 
 	initialized(false),
-	capture_handle(NULL)
+	capture_handle(NULL),
+	nativeFormat(false),
+	useMmap(false),
+	periodSize(0),
+	periodCount(0)
 {
 }
 
@@ -99,8 +127,9 @@ void CALSASoundRecorder::initialize(CSound *sound)
 				throw runtime_error(string(__func__)+" -- cannot set channel count -- "+snd_strerror(err));
 
 
-			// set to interleaved access
-			if((err = snd_pcm_hw_params_set_access(capture_handle, hw_params, SND_PCM_ACCESS_RW_INTERLEAVED)) < 0)
+			// set to interleaved access, mmapped if possible so that the data can be read directly from the device's buffer
+			useMmap=gALSAUseMmap && snd_pcm_hw_params_set_access(capture_handle, hw_params, SND_PCM_ACCESS_MMAP_INTERLEAVED)>=0;
+			if(!useMmap && (err = snd_pcm_hw_params_set_access(capture_handle, hw_params, SND_PCM_ACCESS_RW_INTERLEAVED)) < 0)
 				throw runtime_error(string(__func__)+" -- cannot set access type -- "+snd_strerror(err));
 
 
@@ -109,24 +138,21 @@ void CALSASoundRecorder::initialize(CSound *sound)
 				throw runtime_error(string(__func__)+" -- cannot set periods to integer only -- "+snd_strerror(err));
 
 
-			// set period size
-			snd_pcm_uframes_t period_size=PERIOD_SIZE_FRAMES;
+			// set period size (the device may not support exactly what was asked for)
+			// ??? as the sample rate is lower this needs to be lower so that onData is called more often and the view meters on the record dialog don't seem to lag
+			periodSize=gDesiredInputBufferSize;
 			int dir=0;
-			if((err = snd_pcm_hw_params_set_period_size_near(capture_handle, hw_params, &period_size, &dir)) < 0)
+			if((err = snd_pcm_hw_params_set_period_size_near(capture_handle, hw_params, &periodSize, &dir)) < 0)
 				throw runtime_error(string(__func__)+" -- cannot set period size -- "+snd_strerror(err));
 
 
-			// set number of periods 
-			unsigned int periods=PERIOD_COUNT;
-			if((err = snd_pcm_hw_params_set_periods(capture_handle, hw_params, periods, 0)) < 0)
+			// set number of periods (the buffer size is the period size times this)
+			periodCount=gDesiredInputBufferCount;
+			dir=0;
+			if((err = snd_pcm_hw_params_set_periods_near(capture_handle, hw_params, &periodCount, &dir)) < 0)
 				throw runtime_error(string(__func__)+" -- cannot set periods -- "+snd_strerror(err));
 
 
-			// and then set the buffer size (what .. what's this difference between buffers and periods?)
-			if((err = snd_pcm_hw_params_set_buffer_size(capture_handle, hw_params, (PERIOD_COUNT*PERIOD_SIZE_FRAMES) )) < 0)
-				throw runtime_error(string(__func__)+" -- cannot set buffer size -- "+snd_strerror(err));
-
-
 			// set sample format
 			vector<snd_pcm_format_t> formatsToTry;
 #ifndef WORDS_BIGENDIAN
@@ -168,16 +194,21 @@ void CALSASoundRecorder::initialize(CSound *sound)
 			}
 			if(!found)
 				throw runtime_error(string(__func__)+" -- cannot set sample format -- "+snd_strerror(err));
+			nativeFormat= capture_format==formatsToTry[0];
 
 
 			// set the hardware parameters
 			if((err = snd_pcm_hw_params(capture_handle, hw_params)) < 0)
 				throw runtime_error(string(__func__)+" -- cannot set parameters -- "+snd_strerror(err));
 
+			// make note of what was actually granted
+			snd_pcm_hw_params_get_period_size(hw_params, &periodSize, &dir);
+			snd_pcm_hw_params_get_periods(hw_params, &periodCount, &dir);
+
 			snd_pcm_hw_params_free(hw_params);
 
 
-			/* tell ALSA to wake us up whenever PERIOD_SIZE_FRAMES or more frames of captured data can be delivered. Also, tell ALSA that we'll start the device ourselves. */
+			/* tell ALSA to wake us up whenever periodSize or more frames of captured data can be delivered. Also, tell ALSA that we'll start the device ourselves. */
 
 			if((err = snd_pcm_sw_params_malloc(&sw_params)) < 0)
 				throw runtime_error(string(__func__)+" -- cannot allocate software parameters structure -- "+snd_strerror(err));
@@ -185,7 +216,7 @@ void CALSASoundRecorder::initialize(CSound *sound)
 			if((err = snd_pcm_sw_params_current(capture_handle, sw_params)) < 0)
 				throw runtime_error(string(__func__)+" -- cannot initialize software parameters structure -- "+snd_strerror(err));
 
-			if((err = snd_pcm_sw_params_set_avail_min(capture_handle, sw_params, PERIOD_SIZE_FRAMES)) < 0)
+			if((err = snd_pcm_sw_params_set_avail_min(capture_handle, sw_params, periodSize)) < 0)
 				throw runtime_error(string(__func__)+" -- cannot set minimum available count -- "+snd_strerror(err));
 
 			if((err = snd_pcm_sw_params_set_start_threshold(capture_handle, sw_params, 0)) < 0)
@@ -301,14 +332,23 @@ void CALSASoundRecorder::threadWork()
 {
 	try
 	{
+		if(gRealtimeAudioThreadPriority>0 || gLockMemoryForRealtimeAudio)
+			makeThreadRealtime(gRealtimeAudioThreadPriority,gLockMemoryForRealtimeAudio);
+
+		if(useMmap)
+		{
+			mmapThreadWork();
+			return;
+		}
+
 		const unsigned channelCount=getSound()->getChannelCount();
 
 		int err;
-		std::vector<sample_t> buffer(PERIOD_SIZE_FRAMES*channelCount*2); 
+		std::vector<sample_t> buffer(periodSize*channelCount*2); 
 			// these are possibly used if sample format conversion is required
-		std::vector<int16_t> buffer__int16_t(PERIOD_SIZE_FRAMES*channelCount);
-		std::vector<int32_t> buffer__int32_t(PERIOD_SIZE_FRAMES*channelCount);
-		std::vector<float> buffer__float(PERIOD_SIZE_FRAMES*channelCount);
+		std::vector<int16_t> buffer__int16_t(periodSize*channelCount);
+		std::vector<int32_t> buffer__int32_t(periodSize*channelCount);
+		std::vector<float> buffer__float(periodSize*channelCount);
 
 		snd_pcm_format_t format=capture_format;
 
@@ -353,8 +393,8 @@ void CALSASoundRecorder::threadWork()
 					throw runtime_error(string(__func__)+" -- unknown ALSA avail update return value: "+istring(frames_ready));
 			}
 
-				// not absolutely necessary to wait for the exact amount I don't believe ??? but I don't think it hurts.. but code below assumes it's PERIOD_SIZE frames that are ready to read
-			if(frames_ready<PERIOD_SIZE_FRAMES)
+				// not absolutely necessary to wait for the exact amount I don't believe ??? but I don't think it hurts.. but code below assumes it's periodSize frames that are ready to read
+			if(frames_ready<(snd_pcm_sframes_t)periodSize)
 			{
 				if(frames_ready==0)
 				{
@@ -362,7 +402,7 @@ void CALSASoundRecorder::threadWork()
 					continue;
 				}
 				else
-					throw runtime_error(string(__func__)+" -- frames_to_deliver is less than PERIOD_SIZE_FRAMES: "+istring(frames_ready)+"<"+istring(PERIOD_SIZE_FRAMES));
+					throw runtime_error(string(__func__)+" -- frames_to_deliver is less than the period size: "+istring(frames_ready)+"<"+istring(periodSize));
 			}
 
 /*
@@ -370,43 +410,36 @@ void CALSASoundRecorder::threadWork()
 */
 
 			snd_pcm_sframes_t len;
-#warning probably should abstract this into a since it could be used several places
 			switch(conv)
 			{
 				case 0:	// no conversion necessary
 				{
-					if((len=snd_pcm_readi(capture_handle, buffer.data(), PERIOD_SIZE_FRAMES)) < 0)
+					if((len=snd_pcm_readi(capture_handle, buffer.data(), periodSize)) < 0)
 						fprintf(stderr, "ALSA read failed (%s)\n", snd_strerror(len));
 				}
 				break;
 
 				case 1:	// we need to convert int16_t->sample_t
 				{ 
-					unsigned l=PERIOD_SIZE_FRAMES*channelCount;
-					if((err=snd_pcm_readi(capture_handle, buffer__int16_t.data(), PERIOD_SIZE_FRAMES)) < 0)
+					if((err=snd_pcm_readi(capture_handle, buffer__int16_t.data(), periodSize)) < 0)
 						fprintf(stderr, "ALSA read failed (%s)\n", snd_strerror(err));
-					for(unsigned t=0;t<l;t++)
-						buffer[t]=convert_sample<int16_t,sample_t>(buffer__int16_t[t]);
+					convertSamples(buffer__int16_t.data(),buffer.data(),periodSize*channelCount);
 				}
 				break;
 
 				case 2:	// we need to convert int32_t->sample_t
 				{ 
-					unsigned l=PERIOD_SIZE_FRAMES*channelCount;
-					if((err=snd_pcm_readi(capture_handle, buffer__int32_t.data(), PERIOD_SIZE_FRAMES)) < 0)
+					if((err=snd_pcm_readi(capture_handle, buffer__int32_t.data(), periodSize)) < 0)
 						fprintf(stderr, "ALSA read failed (%s)\n", snd_strerror(err));
-					for(unsigned t=0;t<l;t++)
-						buffer[t]=convert_sample<int32_t,sample_t>(buffer__int32_t[t]);
+					convertSamples(buffer__int32_t.data(),buffer.data(),periodSize*channelCount);
 				}
 				break;
 
 				case 3:	// we need to convert float->sample_t
 				{ 
-					unsigned l=PERIOD_SIZE_FRAMES*channelCount;
-					if((err=snd_pcm_readi(capture_handle, buffer__float.data(), PERIOD_SIZE_FRAMES)) < 0)
+					if((err=snd_pcm_readi(capture_handle, buffer__float.data(), periodSize)) < 0)
 						fprintf(stderr, "ALSA read failed (%s)\n", snd_strerror(err));
-					for(unsigned t=0;t<l;t++)
-						buffer[t]=convert_sample<float,sample_t>(buffer__float[t]);
+					convertSamples(buffer__float.data(),buffer.data(),periodSize*channelCount);
 				}
 				break;
 
@@ -414,7 +447,7 @@ void CALSASoundRecorder::threadWork()
 					throw runtime_error(string(__func__)+" -- no conversion determined");
 			}
 
-			onData(buffer.data(),PERIOD_SIZE_FRAMES);
+			onData(buffer.data(),periodSize);
 
 		}
 	}
@@ -428,4 +461,89 @@ void CALSASoundRecorder::threadWork()
 	}
 }
 
+/*
+ * Hands the recorded data to onData() a period at a time straight from the device's buffer when the 
+ * device's format is sample_t's (else converts it into a buffer first) so that there's no copy through
+ * snd_pcm_readi().  The device is restarted after an xrun.
+ */
+void CALSASoundRecorder::mmapThreadWork()
+{
+	const unsigned channelCount=getSound()->getChannelCount();
+	std::vector<sample_t> buffer(periodSize*channelCount);
+
+	const unsigned formatWidth=snd_pcm_format_physical_width(capture_format);
+
+	int err;
+	if((err = snd_pcm_start(capture_handle)) < 0)
+		throw runtime_error(string(__func__)+" -- snd_pcm_start failed -- "+snd_strerror(err));
+
+	while(!stdx::this_thread::is_cancelled())
+	{
+		if(snd_pcm_state(capture_handle)==SND_PCM_STATE_PREPARED)
+		{ // restart after recovering from an xrun
+			if((err = snd_pcm_start(capture_handle)) < 0)
+				throw runtime_error(string(__func__)+" -- snd_pcm_start failed -- "+snd_strerror(err));
+		}
+
+		const snd_pcm_sframes_t avail=snd_pcm_avail_update(capture_handle);
+		if(avail<0)
+		{
+			recoverFromError(capture_handle,avail);
+			continue;
+		}
+
+		if((snd_pcm_uframes_t)avail<periodSize)
+		{
+			// wait till the interface has data ready, or 1 second has elapsed.
+			if((err = snd_pcm_wait(capture_handle, 1000)) < 0)
+				recoverFromError(capture_handle,err);
+			continue;
+		}
+
+		// read a period (in more than one piece if it wraps around the end of the device's buffer)
+		snd_pcm_uframes_t remaining=periodSize;
+		while(remaining>0)
+		{
+			const snd_pcm_channel_area_t *areas;
+			snd_pcm_uframes_t offset;
+			snd_pcm_uframes_t frames=remaining;
+			if((err = snd_pcm_mmap_begin(capture_handle, &areas, &offset, &frames)) < 0)
+			{
+				recoverFromError(capture_handle,err);
+				break;
+			}
+
+			// the areas are normally interleaved in one block, but a plugin could have arranged them otherwise
+			if(nativeFormat && areasAreInterleaved(areas,channelCount,formatWidth))
+				onData((sample_t *)areaAddress(areas[0],offset),frames);
+			else
+			{
+				switch(formatWidth)
+				{
+				case 16:
+					readFromAreas<int16_t>(areas,offset,frames,channelCount,buffer.data());
+					break;
+				case 32:
+					if(snd_pcm_format_float(capture_format)==1)
+						readFromAreas<float>(areas,offset,frames,channelCount,buffer.data());
+					else
+						readFromAreas<int32_t>(areas,offset,frames,channelCount,buffer.data());
+					break;
+				default:
+					throw runtime_error(string(__func__)+" -- no conversion determined");
+				}
+				onData(buffer.data(),frames);
+			}
+
+			const snd_pcm_sframes_t committed=snd_pcm_mmap_commit(capture_handle, offset, frames);
+			if(committed<0 || (snd_pcm_uframes_t)committed!=frames)
+			{
+				recoverFromError(capture_handle,committed<0 ? committed : -EPIPE);
+				break;
+			}
+			remaining-=frames;
+		}
+	}
+}
+
 #endif // ENABLE_ALSA
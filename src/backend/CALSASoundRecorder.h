@@ -47,10 +47,15 @@ private:
 	bool initialized;
 	snd_pcm_t *capture_handle;
 	snd_pcm_format_t capture_format;
+	bool nativeFormat;		// true if capture_format is the same as sample_t
+	bool useMmap;			// true if the device's buffer is read directly rather than with snd_pcm_readi()
+	snd_pcm_uframes_t periodSize;	// as granted by the device (gDesiredInputBufferSize is only asked for)
+	unsigned periodCount;
 
 	std::unique_ptr<stdx::thread> recordThread;
 
 	void threadWork();
+	void mmapThreadWork();
 };
 
 #endif // ENABLE_ALSA
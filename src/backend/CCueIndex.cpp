@@ -0,0 +1,290 @@
+/*
+ * Copyright (C) 2026 - agent
+ *
+ * This file is part of ReZound, an audio editing application.
+ *
+ * ReZound is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * ReZound is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+#include "CCueIndex.h"
+
+#include <stdexcept>
+
+#include <istring>
+
+CCueIndex::CCueIndex() :
+	liveTree(1,0),
+	liveCount(0),
+	timeIndex(RTimeOrder(&slots)),
+	nameIndex(RNameOrder(&slots))
+{
+}
+
+CCueIndex::~CCueIndex()
+{
+}
+
+void CCueIndex::clear()
+{
+	slots.clear();
+	liveTree.assign(1,0);
+	liveCount=0;
+	timeIndex.clear();
+	nameIndex.clear();
+}
+
+void CCueIndex::append(const string &name,const sample_pos_t time,const bool isAnchored)
+{
+	appendSlot(name,time,isAnchored);
+}
+
+void CCueIndex::insert(size_t index,const string &name,const sample_pos_t time,const bool isAnchored)
+{
+	if(index>liveCount)
+		throw runtime_error(string(__func__)+" -- index is out of bounds: "+istring(index));
+
+	if(index==liveCount)
+	{
+		appendSlot(name,time,isAnchored);
+		return;
+	}
+
+	// there is no room between the slots so rebuild them all with the new cue in place
+	vector<RSlot> oldSlots;
+	oldSlots.swap(slots);
+	clear();
+
+	size_t t=0;
+	for(size_t i=0;i<oldSlots.size();i++)
+	{
+		if(!oldSlots[i].isLive)
+			continue;
+		if(t++==index)
+			appendSlot(name,time,isAnchored);
+		appendSlot(oldSlots[i].name,oldSlots[i].time,oldSlots[i].isAnchored);
+	}
+}
+
+void CCueIndex::remove(size_t index)
+{
+	if(index>=liveCount)
+		throw runtime_error(string(__func__)+" -- index is out of bounds: "+istring(index));
+
+	const size_t slot=getSlot(index);
+	timeIndex.erase(slot);
+	nameIndex.erase(slot);
+	slots[slot].isLive=false;
+	slots[slot].name.clear();
+
+	for(size_t i=slot+1;i<liveTree.size();i+=i&(~i+1))
+		liveTree[i]--;
+	liveCount--;
+
+	// don't let the dead slots outnumber the live ones by much
+	if(slots.size()>2*liveCount+64)
+		compact();
+}
+
+void CCueIndex::setTime(size_t index,const sample_pos_t time)
+{
+	if(index>=liveCount)
+		throw runtime_error(string(__func__)+" -- index is out of bounds: "+istring(index));
+
+	const size_t slot=getSlot(index);
+	timeIndex.erase(slot);
+	slots[slot].time=time;
+	timeIndex.insert(slot);
+}
+
+bool CCueIndex::findName(const string &name,size_t &index) const
+{
+	const name_index_t::const_iterator i=nameIndex.lower_bound(name_key_t(&name,0));
+	if(i==nameIndex.end() || slots[*i].name!=name)
+		return false;
+	index=getIndex(*i);
+	return true;
+}
+
+bool CCueIndex::findAt(const sample_pos_t time,size_t &index) const
+{
+	const time_index_t::const_iterator i=timeIndex.lower_bound(time_key_t(time,0));
+	if(i==timeIndex.end() || slots[*i].time!=time)
+		return false;
+	index=getIndex(*i);
+	return true;
+}
+
+bool CCueIndex::findAtOrAfter(const sample_pos_t time,size_t &index) const
+{
+	const time_index_t::const_iterator i=timeIndex.lower_bound(time_key_t(time,0));
+	if(i==timeIndex.end())
+		return false;
+	index=getIndex(*i);
+	return true;
+}
+
+bool CCueIndex::findAfter(const sample_pos_t time,size_t &index) const
+{
+	if(time==MAX_LENGTH)
+		return false;
+	return findAtOrAfter(time+1,index);
+}
+
+bool CCueIndex::findAtOrBefore(const sample_pos_t time,size_t &index) const
+{
+	time_index_t::const_iterator i=timeIndex.upper_bound(time_key_t(time,slots.size()));
+	if(i==timeIndex.begin())
+		return false;
+	index=getIndex(*firstAtTime(--i));
+	return true;
+}
+
+bool CCueIndex::findBefore(const sample_pos_t time,size_t &index) const
+{
+	time_index_t::const_iterator i=timeIndex.lower_bound(time_key_t(time,0));
+	if(i==timeIndex.begin())
+		return false;
+	index=getIndex(*firstAtTime(--i));
+	return true;
+}
+
+void CCueIndex::getUnanchoredInRange(const sample_pos_t from,const sample_pos_t to,vector<size_t> &indexes) const
+{
+	indexes.clear();
+	for(time_index_t::const_iterator i=timeIndex.lower_bound(time_key_t(from,0));i!=timeIndex.end() && slots[*i].time<to;i++)
+	{
+		if(!slots[*i].isAnchored)
+			indexes.push_back(getIndex(*i));
+	}
+}
+
+void CCueIndex::offsetTimes(const sample_pos_t from,const sample_pos_t delta,vector<size_t> &indexes)
+{
+	indexes.clear();
+
+	const time_index_t::iterator first=timeIndex.lower_bound(time_key_t(from,0));
+
+	// if none of the cues at or after from are anchored, then all of them move and keep their order
+	// among themselves, so only the one before them has to be checked to see if the order changes
+	bool inPlace=true;
+	for(time_index_t::iterator i=first;i!=timeIndex.end() && inPlace;i++)
+		inPlace=!slots[*i].isAnchored;
+	if(inPlace && first!=timeIndex.begin() && first!=timeIndex.end())
+	{
+		time_index_t::iterator prev=first;
+		prev--;
+		inPlace=timeIndex.key_comp()(*prev,time_key_t(slots[*first].time+delta,*first));
+	}
+
+	if(inPlace)
+	{
+		indexes.reserve(distance(first,timeIndex.end()));
+		for(time_index_t::iterator i=first;i!=timeIndex.end();i++)
+		{
+			slots[*i].time+=delta;
+			indexes.push_back(getIndex(*i));
+		}
+		return;
+	}
+
+	// take the moved ones out and put them back after all have been changed, since moving any one may pass others that haven't been changed yet
+	vector<size_t> moved;
+	for(time_index_t::iterator i=first;i!=timeIndex.end();)
+	{
+		if(slots[*i].isAnchored)
+			i++;
+		else
+		{
+			moved.push_back(*i);
+			timeIndex.erase(i++);
+		}
+	}
+
+	indexes.reserve(moved.size());
+	for(size_t t=0;t<moved.size();t++)
+	{
+		slots[moved[t]].time+=delta;
+		timeIndex.insert(moved[t]);
+		indexes.push_back(getIndex(moved[t]));
+	}
+}
+
+void CCueIndex::appendSlot(const string &name,const sample_pos_t time,const bool isAnchored)
+{
+	const size_t slot=slots.size();
+
+	RSlot s;
+	s.time=time;
+	s.name=name;
+	s.isAnchored=isAnchored;
+	s.isLive=true;
+	slots.push_back(s);
+
+	// the new node at i in the tree counts the slots [i-lowbit(i),slot] (countLiveThrough(-1) is 0)
+	const size_t i=slot+1;
+	const size_t lowBit=i&(~i+1);
+	liveTree.push_back(1+countLiveThrough(slot-1)-countLiveThrough(i-lowBit-1));
+	liveCount++;
+
+	timeIndex.insert(slot);
+	nameIndex.insert(slot);
+}
+
+void CCueIndex::compact()
+{
+	vector<RSlot> oldSlots;
+	oldSlots.swap(slots);
+	clear();
+
+	for(size_t i=0;i<oldSlots.size();i++)
+	{
+		if(oldSlots[i].isLive)
+			appendSlot(oldSlots[i].name,oldSlots[i].time,oldSlots[i].isAnchored);
+	}
+}
+
+// returns the number of live slots in [0,slot]
+size_t CCueIndex::countLiveThrough(size_t slot) const
+{
+	size_t count=0;
+	for(size_t i=slot+1;i>0;i-=i&(~i+1))
+		count+=liveTree[i];
+	return count;
+}
+
+size_t CCueIndex::getSlot(const size_t index) const
+{
+	// find the last tree position whose prefix count is <= index; the slot after it is the (index+1)th live one
+	size_t pos=0;
+	size_t remaining=index;
+	size_t step=1;
+	while((step<<1)<liveTree.size())
+		step<<=1;
+	for(;step>0;step>>=1)
+	{
+		if(pos+step<liveTree.size() && liveTree[pos+step]<=remaining)
+		{
+			pos+=step;
+			remaining-=liveTree[pos];
+		}
+	}
+	return pos; // tree position pos+1 is slot pos
+}
+
+CCueIndex::time_index_t::const_iterator CCueIndex::firstAtTime(time_index_t::const_iterator i) const
+{
+	return timeIndex.lower_bound(time_key_t(slots[*i].time,0));
+}
+
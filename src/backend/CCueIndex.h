@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2026 - agent
+ *
+ * This file is part of ReZound, an audio editing application.
+ *
+ * ReZound is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * ReZound is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+#ifndef __CCueIndex_H__
+#define __CCueIndex_H__
+
+
+#include "../../config/common.h"
+
+#include <stddef.h>
+
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "CSound_defs.h"
+
+/*
+ * This is an in-memory index of a sound's cues kept alongside the cue pool in CSound.  The cues
+ * are identified by their index in the pool (the order they were added) which does not change
+ * when a cue's time does, so the frontend may hold onto an index while dragging a cue around.
+ *
+ * Each cue occupies a slot and the slots stay in the same order as the indexes, but a removed
+ * cue only marks its slot dead instead of moving all the following ones.  A Fenwick tree counting
+ * the live slots maps between slots and indexes.  The slots are ordered by (time,slot) and by
+ * (name,slot) so that among cues with the same time or name the lowest index is found first.
+ *
+ *	append, remove, setTime and the find methods are O(log n)
+ *	insert in the middle is O(n log n) (it is only used to undo a removal)
+ *	offsetTimes is O(k log n) for the k cues that are moved, but when that doesn't change their
+ *	order with respect to the other cues (i.e. there are no anchored cues among them) the times
+ *	are changed in place without reinserting anything
+ */
+class CCueIndex
+{
+public:
+	CCueIndex();
+	virtual ~CCueIndex();
+
+	void clear();
+	size_t getSize() const { return liveCount; }
+
+	void append(const string &name,const sample_pos_t time,const bool isAnchored);
+	void insert(size_t index,const string &name,const sample_pos_t time,const bool isAnchored);
+	void remove(size_t index);
+	void setTime(size_t index,const sample_pos_t time);
+
+	// these return false if there is no such cue, else set index to the lowest indexed cue of those found
+	bool findName(const string &name,size_t &index) const;
+	bool findAt(const sample_pos_t time,size_t &index) const;		// time == the given time
+	bool findAtOrAfter(const sample_pos_t time,size_t &index) const;	// the earliest time >= the given time
+	bool findAfter(const sample_pos_t time,size_t &index) const;		// the earliest time > the given time
+	bool findAtOrBefore(const sample_pos_t time,size_t &index) const;	// the latest time <= the given time
+	bool findBefore(const sample_pos_t time,size_t &index) const;	// the latest time < the given time
+
+	// sets indexes to the unanchored cues whose times are in [from,to) in order of time
+	void getUnanchoredInRange(const sample_pos_t from,const sample_pos_t to,vector<size_t> &indexes) const;
+
+	// adds delta to the time of every unanchored cue at or after 'from' and sets indexes to the cues that were moved
+	void offsetTimes(const sample_pos_t from,const sample_pos_t delta,vector<size_t> &indexes);
+
+private:
+	struct RSlot
+	{
+		sample_pos_t time;
+		string name;
+		bool isAnchored;
+		bool isLive;
+	};
+
+	vector<RSlot> slots;
+
+	// the indexes hold slots and order them by what's in slots[] so that offsetTimes() can change the times in place
+	typedef pair<sample_pos_t,size_t> time_key_t;
+	struct RTimeOrder
+	{
+		typedef void is_transparent;
+		const vector<RSlot> *slots;
+		RTimeOrder(const vector<RSlot> *_slots) : slots(_slots) {}
+
+		time_key_t key(const size_t slot) const { return time_key_t((*slots)[slot].time,slot); }
+		bool operator()(const size_t a,const size_t b) const { return key(a)<key(b); }
+		bool operator()(const size_t a,const time_key_t &b) const { return key(a)<b; }
+		bool operator()(const time_key_t &a,const size_t b) const { return a<key(b); }
+	};
+	typedef set<size_t,RTimeOrder> time_index_t;
+
+	typedef pair<const string *,size_t> name_key_t;
+	struct RNameOrder
+	{
+		typedef void is_transparent;
+		const vector<RSlot> *slots;
+		RNameOrder(const vector<RSlot> *_slots) : slots(_slots) {}
+
+		static bool less(const string &a,const size_t as,const string &b,const size_t bs) { const int c=a.compare(b); return c<0 || (c==0 && as<bs); }
+		bool operator()(const size_t a,const size_t b) const { return less((*slots)[a].name,a,(*slots)[b].name,b); }
+		bool operator()(const size_t a,const name_key_t &b) const { return less((*slots)[a].name,a,*b.first,b.second); }
+		bool operator()(const name_key_t &a,const size_t b) const { return less(*a.first,a.second,(*slots)[b].name,b); }
+	};
+	typedef set<size_t,RNameOrder> name_index_t;
+
+	vector<size_t> liveTree; // 1-based Fenwick tree counting the live slots
+	size_t liveCount;
+	time_index_t timeIndex;
+	name_index_t nameIndex;
+
+	void appendSlot(const string &name,const sample_pos_t time,const bool isAnchored);
+	void compact();
+
+	size_t countLiveThrough(size_t slot) const;
+	size_t getIndex(const size_t slot) const { return countLiveThrough(slot)-1; }
+	size_t getSlot(const size_t index) const;
+
+	// returns the entry of the lowest indexed cue with the same time as i
+	time_index_t::const_iterator firstAtTime(time_index_t::const_iterator i) const;
+
+	// the orders point into slots
+	CCueIndex(const CCueIndex &src);
+	CCueIndex &operator=(const CCueIndex &rhs);
+};
+
+#endif
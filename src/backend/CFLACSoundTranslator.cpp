@@ -41,6 +41,8 @@
 
 #include "CSound.h"
 #include "AStatusComm.h"
+#include "sample_conversion.h"
+#include "settings.h"
 
 CFLACSoundTranslator::CFLACSoundTranslator()
 {
@@ -135,34 +137,41 @@ protected:
 		if((pos+sampleframes_read)>sound->getLength())
 			sound->addSpace(sound->getLength(),REALLOC_FILE_SIZE);
 
+		if(convertedBuffer.size()<sampleframes_read)
+		{
+			convertedBuffer.resize(sampleframes_read);
+			narrowedBuffer.resize(sampleframes_read*sizeof(int32_t));
+		}
+
 		for(unsigned i=0;i<channelCount;i++)
 		{
 			const FLAC__int32 *src=buffer[i];
-			CRezPoolAccesser &dest=*(accessers[i]);
+			sample_t *converted=convertedBuffer.data();
 
 			if(bitRate==16)
 			{
+				// the FLAC__int32 src seems to actually be 16bit (maybe this changes depending on the file?)
+				int16_t *narrowed=(int16_t *)narrowedBuffer.data();
 				for(unsigned t=0;t<sampleframes_read;t++)
-					// the FLAC__int32 src seems to actually be 16bit (maybe this changes depending on the file?)
-					dest[pos+t]=convert_sample<int16_t,sample_t>(src[t]);
+					narrowed[t]=src[t];
+				convertSamples(narrowed,converted,sampleframes_read);
 			}
 			else if(bitRate==24)
 			{
+				int24_t *narrowed=(int24_t *)narrowedBuffer.data();
 				for(unsigned t=0;t<sampleframes_read;t++)
-				{
-					int24_t sd;
-					sd.set(src[t]);
-					dest[pos+t]=convert_sample<int24_t,sample_t>(sd);
-				}
+					narrowed[t].set(src[t]);
+				convertSamples(narrowed,converted,sampleframes_read);
 			}
 			else if(bitRate==32)
-			{
-				for(unsigned t=0;t<sampleframes_read;t++)
-					dest[pos+t]=convert_sample<int32_t,sample_t>(src[t]);
-			}
+				convertSamples((const int32_t *)src,converted,sampleframes_read);
 			else
 			{ // warned user already
+				continue;
 			}
+
+			accessers[i]->seek(pos);
+			accessers[i]->write(converted,sampleframes_read);
 		}
 
 		pos+=sampleframes_read;
@@ -210,6 +219,10 @@ private:
 	sample_pos_t pos;
 
 	CRezPoolAccesser *accessers[MAX_CHANNELS];
+
+	// a channel of a block at a time is narrowed from FLAC__int32 to the type it is, then converted to sample_t
+	std::vector<uint8_t> narrowedBuffer;
+	std::vector<sample_t> convertedBuffer;
 };
 
 bool CFLACSoundTranslator::onLoadSound(const string filename,CSound *sound) const
@@ -288,19 +301,29 @@ bool CFLACSoundTranslator::onSaveSound(const string filename,const CSound *sound
 		}
 
 
+		std::vector<sample_t> srcBuffer(BUFFER_SIZE);
+		std::vector<int16_t> convertedBuffer(BUFFER_SIZE);
+
+		// each channel is converted separately so each gets its own dither state
+		std::vector<RSampleDither> dithers(sound->getChannelCount(),RSampleDither((RSampleDither::DitherTypes)gExportDither,1));
+
 		sample_pos_t pos=0;
 		while(pos<saveLength)
 		{
 			const sample_pos_t len=min((sample_pos_t)BUFFER_SIZE,saveLength-pos);
 			for(unsigned i=0;i<sound->getChannelCount();i++)
 			{
-				const CRezPoolAccesser src=sound->getAudio(i);
+				CRezPoolAccesser src=sound->getAudio(i);
 				FLAC__int32 *dest=buffers[i];
 
+				src.seek(pos+saveStart);
+				src.read(srcBuffer.data(),len);
+
 				if(bitRate==16)
 				{
+					convertSamples(srcBuffer.data(),convertedBuffer.data(),len,&dithers[i]);
 					for(sample_pos_t t=0;t<len;t++)
-						dest[t]=convert_sample<sample_t,int16_t>(src[t+pos+saveStart]);
+						dest[t]=convertedBuffer[t];
 				}
 				else
 					throw runtime_error(string(__func__)+" -- internal error -- unhandled bitRate: "+istring(bitRate));
@@ -22,6 +22,7 @@
 
 #include <stdexcept>
 #include <string>
+#include <algorithm>
 #include <stdio.h>
 
 #include <istring>
@@ -237,21 +238,71 @@ const double CGraphParamValueIterator::next()
 	}
 	else
 	{
-		if(nodeIndex>nodes.size()-2)
+		if(!beginNextSegment())
 			return 0.0;
+		return next();
+	}
+}
 
-		sample_pos_t segmentStartPosition,segmentStopPosition,_segmentLength;
-		double segmentStopValue;
-		interpretGraphNodes(nodes,nodeIndex++,iterationLength,segmentStartPosition,segmentStartValue,segmentStopPosition,segmentStopValue,_segmentLength);
-		segmentStopValueStartValueDiff=segmentStopValue-segmentStartValue;
-		segmentLength=_segmentLength;
-			// actually, only -1 when on the last segment
-		segmentLengthSub1=segmentLength-(nodeIndex==nodes.size()-1 ? 1 : 0);
+void CGraphParamValueIterator::next(double *values,size_t count)
+{
+	fill(values,count);
+}
 
-		t=0.0;
-		return next();
+void CGraphParamValueIterator::next(float *values,size_t count)
+{
+	fill(values,count);
+}
+
+// the same arithmetic as next(), but a whole run of the current segment at a time in a loop without any branches the compiler can't vectorize
+template<class value_t> void CGraphParamValueIterator::fill(value_t *values,size_t count)
+{
+	while(count>0)
+	{
+		if(t<segmentLength)
+		{
+			const size_t n=(size_t)min((double)count,segmentLength-t);
+
+			const double startValue=segmentStartValue;
+			const double diff=segmentStopValueStartValueDiff;
+			const double lengthSub1=segmentLengthSub1;
+			const double t0=t;
+			for(size_t k=0;k<n;k++)
+			{
+				const double d=startValue+((diff*(t0+(double)k))/lengthSub1);
+				values[k]=std::isnan(d) ? startValue : d;
+			}
+
+			t+=n;
+			values+=n;
+			count-=n;
+		}
+		else if(!beginNextSegment())
+		{
+			for(size_t k=0;k<count;k++)
+				values[k]=0.0;
+			return;
+		}
 	}
 }
 
+// returns false if there are no more segments
+bool CGraphParamValueIterator::beginNextSegment()
+{
+	if(nodeIndex>nodes.size()-2)
+		return false;
+
+	sample_pos_t segmentStartPosition,segmentStopPosition,_segmentLength;
+	double segmentStopValue;
+	interpretGraphNodes(nodes,nodeIndex++,iterationLength,segmentStartPosition,segmentStartValue,segmentStopPosition,segmentStopValue,_segmentLength);
+	segmentStopValueStartValueDiff=segmentStopValue-segmentStartValue;
+	segmentLength=_segmentLength;
+		// actually, only -1 when on the last segment
+	segmentLengthSub1=segmentLength-(nodeIndex==nodes.size()-1 ? 1 : 0);
+
+	t=0.0;
+	return true;
+}
+
 
 
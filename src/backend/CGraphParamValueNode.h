@@ -87,11 +87,18 @@ public:
 
 	const double next();
 
+	// fills values with the next count values, exactly as count calls to next() would
+	void next(double *values,size_t count);
+	void next(float *values,size_t count);
+
 private:
 	const CGraphParamValueNodeList nodes;
 	const sample_pos_t iterationLength;
 	unsigned nodeIndex;
 	double t,segmentLength,segmentLengthSub1,segmentStartValue,segmentStopValueStartValueDiff;
+
+	bool beginNextSegment();
+	template<class value_t> void fill(value_t *values,size_t count);
 };
 
 #endif
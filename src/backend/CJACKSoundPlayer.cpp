@@ -34,6 +34,7 @@
 #include "settings.h"
 #include "AFrontendHooks.h"
 #include "AStatusComm.h"
+#include "sample_conversion.h"
 
 /*
  * Ask the mailing list about the hangup signal and I probably want to catch it and not die
@@ -197,14 +198,10 @@ int CJACKSoundPlayer::processAudio(jack_nframes_t nframes,void *arg)
 
 		// copy interlaced tempBuffer to 'out[0..n-1]' (and converting the sample type as needed)
 		const unsigned channelCount=that->devices[0].channelCount;
+		jack_default_audio_sample_t *out[MAX_CHANNELS];
 		for(unsigned i=0;i<channelCount;i++)
-		{
-			jack_default_audio_sample_t *out=(jack_default_audio_sample_t *)jack_port_get_buffer(that->output_ports[i],nframes);
-
-			const sample_t *tt=tempBuffer+i;
-			for(unsigned t=0;t<nframes;t++,tt+=channelCount)
-				out[t]=convert_sample<sample_t,jack_default_audio_sample_t>(*tt);
-		}
+			out[i]=(jack_default_audio_sample_t *)jack_port_get_buffer(that->output_ports[i],nframes);
+		deinterleaveSamples(tempBuffer,channelCount,out,nframes);
 	}
 	catch(exception &e)
 	{
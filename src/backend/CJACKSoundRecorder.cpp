@@ -34,6 +34,7 @@
 #include "settings.h"
 #include "AFrontendHooks.h"
 #include "AStatusComm.h"
+#include "sample_conversion.h"
 
 
 CJACKSoundRecorder::CJACKSoundRecorder() :
@@ -166,14 +167,10 @@ int CJACKSoundRecorder::processAudio(jack_nframes_t nframes,void *arg)
 
 		// convert the recorded buffer to the native type and give to ASoundRecorder::onData
 		const unsigned channelCount=that->getSound()->getChannelCount();
+		const jack_default_audio_sample_t *in[MAX_CHANNELS];
 		for(unsigned i=0;i<channelCount;i++)
-		{
-			const jack_default_audio_sample_t * const in=(jack_default_audio_sample_t *)jack_port_get_buffer(that->input_ports[i],nframes);
-
-			sample_t *tt=tempBuffer+i;
-			for(unsigned t=0;t<nframes;t++,tt+=channelCount)
-				(*tt)=convert_sample<jack_default_audio_sample_t,sample_t>(in[t]);
-		}
+			in[i]=(const jack_default_audio_sample_t *)jack_port_get_buffer(that->input_ports[i],nframes);
+		interleaveSamples(in,channelCount,tempBuffer,nframes);
 		that->onData(tempBuffer,nframes);
 	}
 	catch(exception &e)
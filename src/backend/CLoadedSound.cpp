@@ -57,6 +57,26 @@ void CLoadedSound::clearUndoHistory()
 	}
 }
 
+void CLoadedSound::limitUndoHistory(uint64_t maxBytes)
+{
+	// take the actions off newest first, stopping at the first one that goes over
+	vector<AAction *> keep;
+	uint64_t total=0;
+	while(!actions.empty())
+	{
+		total+=actions.top()->getUndoDataSize();
+		if(total>maxBytes && !keep.empty())
+			break;
+		keep.push_back(actions.top());
+		actions.pop();
+	}
+
+	clearUndoHistory();
+
+	for(size_t t=keep.size();t>0;t--)
+		actions.push(keep[t-1]);
+}
+
 const string CLoadedSound::getFilename() const
 {
 	return(filename);
@@ -41,6 +41,9 @@ public:
 
 	void clearUndoHistory();
 
+	// forgets the oldest actions until the undo data of those remaining uses at most maxBytes (but always keeps the last action)
+	void limitUndoHistory(uint64_t maxBytes);
+
 	const string getFilename() const;
 	void changeFilename(const string newFilename);
 
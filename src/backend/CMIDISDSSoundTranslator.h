@@ -33,6 +33,7 @@ public:
 
 	bool handlesExtension(const string extension,const string filename) const;
 	bool supportsFormat(const string filename) const;
+	bool canSaveInBackground() const { return(false); } // always prompts and talks to a device
 
 	const vector<string> getFormatNames() const;
 	const vector<vector<string> > getFormatFileMasks() const;
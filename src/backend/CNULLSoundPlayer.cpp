@@ -0,0 +1,252 @@
+/* 
+ * Copyright (C) 2026 - agent
+ * 
+ * This file is part of ReZound, an audio editing application.
+ * 
+ * ReZound is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ * 
+ * ReZound is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+#include "CNULLSoundPlayer.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include <stdexcept>
+#include <thread>
+
+#include <istring>
+
+CNULLSoundPlayer::RStats::RStats() :
+	periodCount(0),
+	deadlineMisses(0),
+	prebufferUnderruns(0),
+	totalSeconds(0.0),
+	maxSeconds(0.0)
+{
+	for(size_t t=0;t<NULL_PLAYER_HISTOGRAM_BUCKETS;t++)
+		histogram[t]=0;
+}
+
+CNULLSoundPlayer::CNULLSoundPlayer() :
+	ASoundPlayer(),
+
+	isOffline(false),
+	initialized(false),
+	outputFile(NULL),
+	underrunCountAtReset(0)
+{
+}
+
+CNULLSoundPlayer::CNULLSoundPlayer(const ROfflineParams &_params) :
+	ASoundPlayer(),
+
+	isOffline(true),
+	params(_params),
+	initialized(false),
+	outputFile(NULL),
+	underrunCountAtReset(0)
+{
+}
+
+CNULLSoundPlayer::~CNULLSoundPlayer()
+{
+	if(isOffline)
+		deinitialize();
+}
+
+bool CNULLSoundPlayer::isInitialized() const
+{
+	return initialized;
+}
+
+void CNULLSoundPlayer::initialize()
+{
+	if(!isOffline)
+	{ // as a place holder it never initializes
+		ASoundPlayer::initialize();
+		return;
+	}
+
+	if(initialized)
+		throw runtime_error(string(__func__)+" -- already initialized");
+
+	if(params.sampleRate<=0)
+		throw runtime_error(string(__func__)+" -- invalid sample rate: "+istring(params.sampleRate));
+	if(params.channelCount<=0 || params.channelCount>MAX_CHANNELS)
+		throw runtime_error(string(__func__)+" -- invalid channel count: "+istring(params.channelCount));
+	if(params.periodSize<=0)
+		throw runtime_error(string(__func__)+" -- invalid period size: "+istring(params.periodSize));
+	if(params.speed<0.0)
+		throw runtime_error(string(__func__)+" -- invalid speed: "+istring(params.speed));
+
+	try
+	{
+		devices[0].channelCount=params.channelCount; // ??? only device zero
+		devices[0].sampleRate=params.sampleRate;
+
+		buffer.resize(params.periodSize*params.channelCount);
+		periodDuration=std::chrono::duration_cast<render_clock_t::duration>(std::chrono::duration<double>((double)params.periodSize/params.sampleRate/(params.speed>0.0 ? params.speed : 1.0)));
+
+		if(params.outputFilename!="")
+		{
+			outputFile=fopen(params.outputFilename.c_str(),"wb");
+			if(outputFile==NULL)
+				throw runtime_error(string(__func__)+" -- error opening "+params.outputFilename+" -- "+strerror(errno));
+		}
+
+		ASoundPlayer::initialize();
+
+		resetStats();
+
+		initialized=true;
+
+		if(params.threaded)
+			renderThread=std::make_unique<stdx::thread>([this]() { threadWork(); });
+	}
+	catch(...)
+	{
+		initialized=false;
+		if(outputFile)
+		{
+			fclose(outputFile);
+			outputFile=NULL;
+		}
+		ASoundPlayer::deinitialize();
+		throw;
+	}
+}
+
+void CNULLSoundPlayer::deinitialize()
+{
+	if(!isOffline)
+	{
+		ASoundPlayer::deinitialize();
+		return;
+	}
+
+	if(initialized)
+	{
+		ASoundPlayer::deinitialize();
+
+		// stop render thread
+		if(renderThread)
+		{
+			renderThread->join();
+			renderThread.reset();
+		}
+
+		if(outputFile)
+		{
+			fclose(outputFile);
+			outputFile=NULL;
+		}
+
+		initialized=false;
+	}
+}
+
+void CNULLSoundPlayer::renderPeriods(size_t periodCount,const std::function<bool()> &keepGoing)
+{
+	if(!initialized)
+		throw runtime_error(string(__func__)+" -- not initialized");
+	if(renderThread)
+		throw runtime_error(string(__func__)+" -- the render thread is running");
+
+	render_clock_t::time_point nextDeadline=render_clock_t::now();
+	while((periodCount--)>0 && (!keepGoing || keepGoing()))
+		renderPeriod(nextDeadline);
+}
+
+void CNULLSoundPlayer::threadWork()
+{
+	try
+	{
+		render_clock_t::time_point nextDeadline=render_clock_t::now();
+		while(!stdx::this_thread::is_cancelled())
+			renderPeriod(nextDeadline);
+	}
+	catch(exception &e)
+	{
+		fprintf(stderr,"exception caught in render thread: %s\n",e.what());
+	}
+}
+
+void CNULLSoundPlayer::renderPeriod(render_clock_t::time_point &nextDeadline)
+{
+	const render_clock_t::time_point start=render_clock_t::now();
+	mixSoundPlayerChannels(params.channelCount,buffer.data(),params.periodSize);
+	const render_clock_t::duration elapsed=render_clock_t::now()-start;
+
+	{
+		const double seconds=std::chrono::duration<double>(elapsed).count();
+
+		size_t bucket=0;
+		for(uint64_t us=(uint64_t)(seconds*1e6);us>=2 && bucket<NULL_PLAYER_HISTOGRAM_BUCKETS-1;us>>=1)
+			bucket++;
+
+		std::unique_lock<std::mutex> l(statsMutex);
+		stats.periodCount++;
+		if(elapsed>periodDuration)
+			stats.deadlineMisses++;
+		stats.totalSeconds+=seconds;
+		stats.maxSeconds=max(stats.maxSeconds,seconds);
+		stats.histogram[bucket]++;
+	}
+
+	if(outputFile && fwrite(buffer.data(),sizeof(sample_t),buffer.size(),outputFile)!=buffer.size())
+		throw runtime_error(string(__func__)+" -- error writing to "+params.outputFilename+" -- "+strerror(errno));
+
+	if(params.speed>0.0)
+	{
+		nextDeadline+=periodDuration;
+		const render_clock_t::time_point now=render_clock_t::now();
+		if(nextDeadline<now)
+			nextDeadline=now; // fell behind, so start the clock over rather than rushing to catch up (a sound card would have played silence)
+		else
+			std::this_thread::sleep_until(nextDeadline);
+	}
+}
+
+const CNULLSoundPlayer::RStats CNULLSoundPlayer::getStats() const
+{
+	std::unique_lock<std::mutex> l(statsMutex);
+	RStats s=stats;
+	s.prebufferUnderruns=getPrebufferUnderrunCount()-underrunCountAtReset;
+	return s;
+}
+
+void CNULLSoundPlayer::resetStats()
+{
+	std::unique_lock<std::mutex> l(statsMutex);
+	stats=RStats();
+	underrunCountAtReset=getPrebufferUnderrunCount();
+}
+
+void CNULLSoundPlayer::printStats(FILE *f) const
+{
+	const RStats s=getStats();
+
+	fprintf(f,"periods: %llu  deadline misses: %llu  prebuffer underruns: %u\n",(unsigned long long)s.periodCount,(unsigned long long)s.deadlineMisses,s.prebufferUnderruns);
+	fprintf(f,"mix time per period: mean %.1fus  max %.1fus  deadline %.1fus\n",
+		s.periodCount>0 ? s.totalSeconds*1e6/s.periodCount : 0.0,
+		s.maxSeconds*1e6,
+		std::chrono::duration<double>(periodDuration).count()*1e6
+	);
+	for(size_t t=0;t<NULL_PLAYER_HISTOGRAM_BUCKETS;t++)
+	{
+		if(s.histogram[t]>0)
+			fprintf(f,"\t%8lluus - %8lluus: %llu\n",t==0 ? 0ULL : (1ULL<<t),(2ULL<<t),(unsigned long long)s.histogram[t]);
+	}
+}
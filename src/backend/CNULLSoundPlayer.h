@@ -23,19 +23,102 @@
 
 #include "../../config/common.h"
 
+#include <stdint.h>
+#include <stdio.h>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "stdx/thread"
+
 #include "ASoundPlayer.h"
 
-/* an object of this class is just a place holder for when no audio output method is compilable */
+/*
+ * By default an object of this class is just a place holder for when no audio output method is 
+ * compilable or none could be initialized.  It never initializes.
+ *
+ * Given ROfflineParams it is instead an offline driver which calls mixSoundPlayerChannels() one
+ * period at a time as a sound card would but without any audio hardware.  The periods can be
+ * paced at real time (or some multiple of it) or rendered as fast as possible.  The time each
+ * mix takes is recorded in a histogram along with the number of deadline misses and prebuffer 
+ * underruns so that changes to playback and prebuffering can be measured on a headless machine.
+ * The rendered output can be written to a file as raw interleaved sample_t in the native byte 
+ * order.
+ *
+ * If params.threaded is true, initialize() starts a thread that renders until deinitialize(), 
+ * otherwise the caller renders by calling renderPeriods().
+ */
 class CNULLSoundPlayer : public ASoundPlayer
 {
 public:
-	CNULLSoundPlayer() {}
-	virtual ~CNULLSoundPlayer() {}
+	struct ROfflineParams
+	{
+		unsigned sampleRate;
+		unsigned channelCount;
+		size_t periodSize;	// in frames
+		double speed;		// 1.0 paces the periods at real time, 2.0 twice as fast, ..., 0 renders as fast as possible
+		bool threaded;
+		string outputFilename;	// "" to not write the output anywhere
+
+		ROfflineParams() : sampleRate(44100),channelCount(2),periodSize(1024),speed(1.0),threaded(true),outputFilename("") { }
+	};
+
+	#define NULL_PLAYER_HISTOGRAM_BUCKETS 24
+	struct RStats
+	{
+		uint64_t periodCount;
+		uint64_t deadlineMisses;	// periods whose mix took longer than the period lasts (at the given speed)
+		unsigned prebufferUnderruns;
+		double totalSeconds;		// time spent in mixSoundPlayerChannels()
+		double maxSeconds;
+		uint64_t histogram[NULL_PLAYER_HISTOGRAM_BUCKETS]; // [0] counts mixes that took < 2us, [i] counts mixes that took [2^i,2^(i+1))us, and the last also counts anything longer
+
+		RStats();
+	};
+
+	CNULLSoundPlayer();
+	CNULLSoundPlayer(const ROfflineParams &offlineParams);
+	virtual ~CNULLSoundPlayer();
 
-	bool isInitialized() const { return false; }
+	void initialize();
+	void deinitialize();
+	bool isInitialized() const;
 
 	void aboutToRecord() {}
 	void doneRecording() {}
+
+	// renders periodCount periods on the calling thread, or fewer if keepGoing is given and returns false before a period
+	// it's an error to call this when not initialized or when initialized with params.threaded
+	void renderPeriods(size_t periodCount,const std::function<bool()> &keepGoing=nullptr);
+
+	const RStats getStats() const;
+	void resetStats();
+	void printStats(FILE *f) const;
+
+private:
+	typedef std::chrono::steady_clock render_clock_t;
+
+	const bool isOffline;
+	const ROfflineParams params;
+	bool initialized;
+
+	FILE *outputFile;
+	vector<sample_t> buffer;
+	render_clock_t::duration periodDuration; // how long a period lasts at the given speed
+
+	std::unique_ptr<stdx::thread> renderThread;
+	void threadWork();
+
+	// mixes one period and waits for nextDeadline if pacing
+	void renderPeriod(render_clock_t::time_point &nextDeadline);
+
+	mutable std::mutex statsMutex;
+	RStats stats;
+	unsigned underrunCountAtReset;
 };
 
 #endif
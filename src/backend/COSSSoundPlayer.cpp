@@ -45,6 +45,7 @@
 #include <istring>
 
 #include "settings.h"
+#include "sample_conversion.h"
 
 #define BUFFER_COUNT gDesiredOutputBufferCount
 #define BUFFER_SIZE_FRAMES gDesiredOutputBufferSize
@@ -331,9 +332,7 @@ void COSSSoundPlayer::threadWork()
 			
 			// if(initialized to S16) ???
 			{ // we need to convert float->int16_t
-				unsigned l=BUFFER_SIZE_FRAMES*gDesiredOutputChannelCount;
-				for(unsigned t=0;t<l;t++)
-					buffer__int16_t[t]=convert_sample<float,int16_t>(buffer[t]);
+				convertSamples(buffer.data(),buffer__int16_t.data(),BUFFER_SIZE_FRAMES*gDesiredOutputChannelCount);
 				if((len=write(audio_fd,buffer__int16_t.data(),BUFFER_SIZE_FRAMES*sizeof(int16_t)*gDesiredOutputChannelCount))!=(int)BUFFER_SIZE_BYTES(sizeof(int16_t)))
 					fprintf(stderr,"warning: didn't write whole buffer -- only wrote %d of %d bytes\n",len,BUFFER_SIZE_BYTES((int)sizeof(int16_t)));
 			}
@@ -42,6 +42,7 @@
 
 #include "settings.h"
 #include "AStatusComm.h"
+#include "sample_conversion.h"
 
 // ??? edit this to be able to detect necessary parameters from the typeof sample_t
 // 	or I need to convert to 16bit 
@@ -329,8 +330,7 @@ void COSSSoundRecorder::threadWork()
 				if(bits==16)
 				{ // need to convert int16_t -> float
 					write_buffer=_converted_buffer;
-					for(int t=0;t<samplesRead;t++)
-						_converted_buffer[t]=convert_sample<int16_t,float>(((int16_t *)read_buffer)[t]);
+					convertSamples((const int16_t *)read_buffer,_converted_buffer,samplesRead);
 				}
 #else
 				#error unhandled SAMPLE_TYPE_xxx define
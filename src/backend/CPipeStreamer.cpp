@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2026 - agent
+ *
+ * This file is part of ReZound, an audio editing application.
+ *
+ * ReZound is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * ReZound is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+#include "CPipeStreamer.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+CPipeStreamer::CPipeStreamer(int _fd,bool _closeWhenFinished,size_t bufferSize) :
+	fd(_fd),
+	closeWhenFinished(_closeWhenFinished),
+	buffer(bufferSize>0 ? bufferSize : (size_t)DEFAULT_BUFFER_SIZE),
+	readPos(0),
+	writePos(0),
+	used(0),
+	finishing(false),
+	finished(false),
+	abandon(false),
+	error(0)
+{
+	if(fd<0)
+		throw runtime_error(string(__func__)+" -- invalid file descriptor");
+
+#ifdef F_SETPIPE_SZ
+	// ask for a 1MB pipe (this fails harmlessly if fd isn't a pipe or it's over /proc/sys/fs/pipe-max-size)
+	fcntl(fd,F_SETPIPE_SZ,1024*1024);
+#endif
+
+	feederThread=std::make_unique<stdx::thread>([this]() { feed(); });
+}
+
+CPipeStreamer::~CPipeStreamer()
+{
+	{
+		std::unique_lock<std::mutex> l(mutex);
+		abandon=true;
+		cond.notify_all();
+	}
+	if(feederThread->joinable())
+		feederThread->join();
+
+	if(!finished)
+		closeFD();
+}
+
+void CPipeStreamer::write(const void *_data,size_t size)
+{
+	const char *data=(const char *)_data;
+
+	std::unique_lock<std::mutex> l(mutex);
+	while(size>0)
+	{
+		cond.wait(l,[this]{ return used<buffer.size() || error!=0; });
+		throwIfError();
+
+		// copy what fits contiguously after writePos
+		const size_t n=std::min(size,std::min(buffer.size()-used,buffer.size()-writePos));
+		memcpy(&buffer[writePos],data,n);
+		writePos=(writePos+n)%buffer.size();
+		used+=n;
+		data+=n;
+		size-=n;
+
+		cond.notify_all();
+	}
+}
+
+void CPipeStreamer::finish()
+{
+	{
+		std::unique_lock<std::mutex> l(mutex);
+		finishing=true;
+		cond.notify_all();
+	}
+	feederThread->join();
+
+	finished=true;
+	closeFD();
+
+	std::unique_lock<std::mutex> l(mutex);
+	throwIfError();
+}
+
+void CPipeStreamer::feed()
+{
+	// get EPIPE from write() instead of being killed by SIGPIPE when the child exits early
+	sigset_t sigs;
+	sigemptyset(&sigs);
+	sigaddset(&sigs,SIGPIPE);
+	pthread_sigmask(SIG_BLOCK,&sigs,NULL);
+
+	std::unique_lock<std::mutex> l(mutex);
+	for(;;)
+	{
+		cond.wait(l,[this]{ return used>0 || finishing || abandon; });
+		if(abandon || (used==0 && finishing))
+			return;
+
+		// write outside of the lock so that write() can keep filling the buffer meanwhile
+		const size_t n=std::min(used,buffer.size()-readPos);
+		const char * const data=&buffer[readPos];
+		l.unlock();
+		const ssize_t written=::write(fd,data,n);
+		const int err=errno;
+		l.lock();
+
+		if(written<0)
+		{
+			if(err==EINTR)
+				continue;
+			error=err;
+			cond.notify_all();
+			return;
+		}
+
+		readPos=(readPos+written)%buffer.size();
+		used-=written;
+		cond.notify_all();
+	}
+}
+
+void CPipeStreamer::closeFD()
+{
+	if(closeWhenFinished)
+		close(fd);
+}
+
+void CPipeStreamer::throwIfError()
+{
+	if(error!=0)
+	{
+		if(error==EPIPE)
+			throw runtime_error(string(__func__)+" -- the receiving process exited before all the data was written to it");
+		else
+			throw runtime_error(string(__func__)+" -- error writing to pipe -- "+strerror(error));
+	}
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2026 - agent
+ *
+ * This file is part of ReZound, an audio editing application.
+ *
+ * ReZound is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * ReZound is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+#ifndef __CPipeStreamer_H__
+#define __CPipeStreamer_H__
+
+#include "../../config/common.h"
+
+#include <stddef.h>
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "stdx/thread"
+
+/*
+ * This class streams data into a pipe to a child process (i.e. an encoder or cdrdao).
+ *
+ * write() copies the data into a large buffer and returns right away unless the buffer is full.
+ * A feeder thread moves the data from the buffer into the pipe.  So reading the pool file and
+ * converting the samples happen while the child is busy with the previous data, instead of
+ * waiting on it every few kilobytes like fwrite() to a popen()-ed stream does.  The pipe's own
+ * capacity is also raised where the OS allows it (Linux's F_SETPIPE_SZ) so the child can read
+ * bigger chunks at a time.
+ *
+ * If the child exits or the pipe breaks, the next write() (or finish()) throws.
+ *
+ * The file descriptor is not closed by this class unless closeWhenFinished is given (i.e. when it
+ * belongs to a FILE * from popen(), pclose() should be called after finish()).
+ */
+class CPipeStreamer
+{
+public:
+	CPipeStreamer(int fd,bool closeWhenFinished=false,size_t bufferSize=DEFAULT_BUFFER_SIZE);
+	virtual ~CPipeStreamer(); // abandons any data not yet written if finish() wasn't called
+
+	void write(const void *data,size_t size);
+
+	// waits until all the data has been written to the pipe, then closes it if closeWhenFinished was given
+	void finish();
+
+	enum { DEFAULT_BUFFER_SIZE=4*1024*1024 };
+
+private:
+	const int fd;
+	const bool closeWhenFinished;
+
+	std::vector<char> buffer;
+	size_t readPos,writePos,used; // a ring buffer
+
+	std::mutex mutex;
+	std::condition_variable cond;
+	bool finishing,finished,abandon;
+	int error; // errno from the feeder thread
+
+	std::unique_ptr<stdx::thread> feederThread;
+
+	void feed();
+	void closeFD();
+	void throwIfError();
+};
+
+#endif
@@ -29,9 +29,11 @@
 #include <CPath.h>
 
 #include <istring>
+#include <CTrace.h>
 
 #include "settings.h"
 #include "unit_conv.h" // for seconds_to_string()
+#include "lossless_sample_codec.h"
 
 
 /* TODO:
@@ -41,18 +43,8 @@
 		- make some macros for doing this since I do it in several places
 		- I have already fixed some of the methods
 
-	- the peak chunk mantainance is not absolutly perfect... if I delete a portion of the data and thus remove some of the 
-	  entries in the peak chunk data, the min and maxes aren't exactly correct now because the PEAK_CHUNK_SIZE samples which 
-	  were calculated for teh originaly data is now scewed a little on top of the new data... normally not enough to worry 
-	  about in just a frontend rendering of it... However overtime this error in the peak chunk data accumulates which is 
-	  why I have a refresh button which recalculates all the peak data.  Perhaps there is some other method which could better 
-	  reduce or eliminate this error without completely recaclulating the peak chunk data anytime an operation is done on a 
-	  channel... perhaps with undo, I could store the peak chunk data in temp pools just as I did the audio data and could 
-	  just as readily restore it on undo
 */
 
-// ??? I could just set peakChunk data for space that I know I just silenced to min=max=0 and not bother setting it dirty
-
 
 #define PEAK_CHUNK_SIZE 500
 
@@ -71,6 +63,8 @@
 #define AUDIO_POOL_NAME "Channel "
 #define PEAK_CHUNK_POOL_NAME "PeakChunk "
 #define TEMP_AUDIO_POOL_NAME "TempAudioPool_"
+#define TEMP_PEAK_CHUNK_POOL_NAME "TempPeakChunkPool_"
+#define COMPRESSED_TEMP_AUDIO_POOL_NAME "CompressedTempAudioPool_"
 #define CUES_POOL_NAME "Cues"
 #define NOTES_POOL_NAME "UserNotes"
 
@@ -85,6 +79,8 @@ CSound::CSound() :
 
 	metaInfoPoolID(0),
 
+	invalidatedPeakStart(1),invalidatedPeakStop(0),
+
 	tempAudioPoolKeyCounter(1),
 
 	_isModified(true),
@@ -105,11 +101,14 @@ CSound::CSound(const string &_filename,const unsigned _sampleRate,const unsigned
 
 	metaInfoPoolID(0),
 
+	invalidatedPeakStart(1),invalidatedPeakStop(0),
+
 	tempAudioPoolKeyCounter(1),
 
 	_isModified(true),
 
-	cueAccesser(NULL)
+	cueAccesser(NULL),
+	adjustCuesOnSpaceChanges(true)
 {
 	for(unsigned t=0;t<MAX_CHANNELS;t++)
 		peakChunkAccessers[t]=NULL;
@@ -237,7 +236,12 @@ const CRezPoolAccesser CSound::getTempAudio(unsigned tempAudioPoolKey,unsigned c
  * 
  *  - This information is stored in a pool of RPeakChunk struct objects in the
  *    pool file for this sound object.  And a min and max is stored for every
- *    PEAK_CHUNK_SIZE samples.
+ *    PEAK_CHUNK_SIZE samples (or less).
+ *  - The chunks are not on a fixed grid.  When the audio is structurally modified
+ *    (space added or removed, moved to/from temp pools, rotated) the chunks are 
+ *    split at the edit points and moved right along with the audio, so only the 
+ *    chunks at the edges of an edit have to be recalculated.  peakChunkStarts[]
+ *    holds where each chunk begins so the chunks can be found with a binary search.
  *  - The RPeakChunk struct has a bool flag, 'dirty', that get's set to true
  *    for every chunk that we need to re-calculate the min and max for.  This 
  *    is necessary when perhaps an action modifies the data, so the view on 
@@ -249,7 +253,7 @@ const CRezPoolAccesser CSound::getTempAudio(unsigned tempAudioPoolKey,unsigned c
  *    Otherwise, we can use the precalculated information.
  *
  *  - When using the precalculated information:
- *	    - I could simply return peakChunks[floor(dataPos/PEAK_CHUNK_SIZE)], but I 
+ *	    - I could simply return the chunk containing dataPos, but I 
  *	      don't since the next time getPeakValue is called, it may have skipped over
  *	      more than a chunk size, so the min and max would not necessarily be accurate.
  *	    - So, I also have the caller pass in the dataPos of the next time this method
@@ -301,23 +305,27 @@ if(dataPos==getLength()-1)
 	}
 	else
 	{
-		// scale down and truncate the data positions to offsets into the peak chunk information 
-		// which only ranges [0,size/PEAK_CHUNK_SIZE]
-		sample_pos_t firstChunk=dataPos/PEAK_CHUNK_SIZE;
-		sample_pos_t lastChunk=nextDataPos/PEAK_CHUNK_SIZE;
+		// find the chunks containing the data positions
+		const vector<sample_pos_t> &peakChunkStart=peakChunkStarts[channel];
+		const size_t firstChunk=findPeakChunk(channel,dataPos);
+		size_t lastChunk=findPeakChunk(channel,nextDataPos);
+		if(lastChunk<=firstChunk)
+			lastChunk=firstChunk+1;
 
 		RPeakChunk ret;
 
+		std::lock_guard<std::mutex> l(peakChunkMutex);
+
 #warning see about using a const CPeakChunkRezPoolAccesser here
 		CPeakChunkRezPoolAccesser &peakChunkAccesser=*(peakChunkAccessers[channel]);
 
 		// don't attempt to read from skipped chunks that don't exist
-		if(lastChunk>peakChunkAccesser.getSize())
+		if(lastChunk>(size_t)peakChunkAccesser.getSize())
 			lastChunk=peakChunkAccesser.getSize();
 
 		// - we combine all the mins and maxes of the peak chunk information between [firstChunk and lastChunk)
 		// - Also, if any chunk is dirty along the way, we recalculate it
-		for(sample_pos_t t=firstChunk;t<lastChunk;t++)
+		for(size_t t=firstChunk;t<lastChunk;t++)
 		{
 			RPeakChunk &p=peakChunkAccesser[t];
 
@@ -325,13 +333,10 @@ if(dataPos==getLength()-1)
 			if(p.dirty)
 			{
 				//printf("recalculating peak chunk data for: %lld\n",(long long)t);
-				sample_pos_t start=t*PEAK_CHUNK_SIZE;
-				sample_pos_t end=start+PEAK_CHUNK_SIZE;
-				if(start<getLength())
+				const sample_pos_t start=peakChunkStart[t];
+				const sample_pos_t end=min(peakChunkStart[t+1],dataAccesser.getSize());
+				if(start<end)
 				{
-					if(end>getLength())
-						end=getLength();
-
 					sample_t _min=dataAccesser[start];
 					sample_t _max=dataAccesser[start];
 
@@ -369,27 +374,51 @@ void CSound::invalidatePeakData(unsigned channel,sample_pos_t start,sample_pos_t
 	if(channel>=channelCount)
 		throw(runtime_error(string(__func__)+" -- channel parameter is out of change: "+istring(channel)));
 
-	// ??? check ranges of start and stop
-
 	CPeakChunkRezPoolAccesser &peakChunkAccesser=*(peakChunkAccessers[channel]);
+	if(peakChunkAccesser.getSize()<=0 || start>stop)
+		return;
 
-	// fudge one peak chunk size longer
-	if(stop<MAX_LENGTH-PEAK_CHUNK_SIZE)
+	noteInvalidatedPeakRange(start,stop);
+
+	std::lock_guard<std::mutex> l(peakChunkMutex);
+	const size_t firstChunk=findPeakChunk(channel,start);
+	const size_t lastChunk=min(findPeakChunk(channel,stop),(size_t)peakChunkAccesser.getSize()-1);
+
+	for(size_t t=firstChunk;t<=lastChunk;t++)
+		peakChunkAccesser[t].dirty=true;
+}
+
+void CSound::noteInvalidatedPeakRange(sample_pos_t start,sample_pos_t stop)
+{
+	std::lock_guard<std::mutex> l(invalidatedPeakRangeMutex);
+	if(invalidatedPeakStart>invalidatedPeakStop)
+	{
+		invalidatedPeakStart=start;
+		invalidatedPeakStop=stop;
+	}
+	else
 	{
-		stop+=PEAK_CHUNK_SIZE;
-		if(stop>getLength()-1)
-			stop=getLength()-1;
+		invalidatedPeakStart=min(invalidatedPeakStart,start);
+		invalidatedPeakStop=max(invalidatedPeakStop,stop);
 	}
+}
 
-	const sample_pos_t firstChunk=start/PEAK_CHUNK_SIZE;
-	const sample_pos_t lastChunk=stop/PEAK_CHUNK_SIZE;
+bool CSound::getInvalidatedPeakRange(sample_pos_t &start,sample_pos_t &stop)
+{
+	std::lock_guard<std::mutex> l(invalidatedPeakRangeMutex);
+	if(invalidatedPeakStart>invalidatedPeakStop)
+		return false;
 
-	for(sample_pos_t t=firstChunk;t<=lastChunk;t++)
-		peakChunkAccesser[t].dirty=true;
+	start=invalidatedPeakStart;
+	stop=invalidatedPeakStop;
+	invalidatedPeakStart=1;
+	invalidatedPeakStop=0;
+	return true;
 }
 
 void CSound::invalidatePeakData(const bool doChannel[MAX_CHANNELS],sample_pos_t start,sample_pos_t stop)
 {
+	TRACE_SCOPE("CSound::invalidatePeakData");
 	for(sample_pos_t t=0;t<channelCount;t++)
 	{
 		if(doChannel[t])
@@ -399,6 +428,7 @@ void CSound::invalidatePeakData(const bool doChannel[MAX_CHANNELS],sample_pos_t
 
 void CSound::invalidateAllPeakData()
 {
+	TRACE_SCOPE("CSound::invalidateAllPeakData");
 	deletePeakChunkAccessers();
 	createPeakChunkAccessers();
 }
@@ -428,6 +458,7 @@ void CSound::prvAddChannel(bool addAudioSpaceForNewChannel,bool doZeroData)
 
 		CPeakChunkRezPoolAccesser peakChunkPool=poolFile.createPool<RPeakChunk>(peakChunkPoolName);
 		peakChunkAccessers[channelCount]=new CPeakChunkRezPoolAccesser(peakChunkPool);
+		peakChunkStarts[channelCount].assign(1,0);
 
 		channelCount++;
 		addedToChannelCount=true;
@@ -442,6 +473,8 @@ void CSound::prvAddChannel(bool addAudioSpaceForNewChannel,bool doZeroData)
 
 		poolFile.removePool(audioPoolName,false);
 		delete peakChunkAccessers[channelCount];
+		peakChunkAccessers[channelCount]=NULL;
+		peakChunkStarts[channelCount].clear();
 		poolFile.removePool(peakChunkPoolName,false);
 
 		throw;
@@ -489,6 +522,10 @@ void CSound::removeChannel()
 	const string audioPoolName=AUDIO_POOL_NAME+istring(channelCount);
 	const string peakChunkPoolName=PEAK_CHUNK_POOL_NAME+istring(channelCount-1);
 
+	delete peakChunkAccessers[channelCount-1];
+	peakChunkAccessers[channelCount-1]=NULL;
+	peakChunkStarts[channelCount-1].clear();
+
 	poolFile.removePool(audioPoolName);
 	poolFile.removePool(peakChunkPoolName);
 
@@ -697,6 +734,32 @@ void CSound::removeSpace(const bool whichChannels[MAX_CHANNELS],sample_pos_t whe
 	matchUpChannelLengths(maxLength);
 }
 
+void CSound::editSpace(const vector<RSpaceEdit> &edits,bool doZeroData)
+{
+	ASSERT_RESIZE_LOCK
+
+	for(size_t t=0;t<edits.size();t++)
+	{
+		const RSpaceEdit &edit=edits[t];
+		if(edit.where>size)
+			throw(runtime_error(string(__func__)+" -- where parameter out of range: "+istring(edit.where)));
+		if(edit.removeLength>(size-edit.where))
+			throw(runtime_error(string(__func__)+" -- removeLength parameter out of range: "+istring(edit.removeLength)));
+		if(t>0 && (edit.where<edits[t-1].where || edit.where-edits[t-1].where<edits[t-1].removeLength))
+			throw(runtime_error(string(__func__)+" -- edits are not sorted or they overlap at where: "+istring(edit.where)));
+	}
+
+	if(edits.empty())
+		return;
+
+	for(unsigned t=0;t<channelCount;t++)
+		editSpaceOfChannel(t,edits,doZeroData);
+
+	adjustCues(edits);
+
+	matchUpChannelLengths(NIL_SAMPLE_POS);
+}
+
 unsigned CSound::moveDataToTemp(const bool whichChannels[MAX_CHANNELS],sample_pos_t where,sample_pos_t length,sample_pos_t fudgeFactor,sample_pos_t maxLength)
 {
 	ASSERT_RESIZE_LOCK 
@@ -706,6 +769,7 @@ unsigned CSound::moveDataToTemp(const bool whichChannels[MAX_CHANNELS],sample_po
 
 unsigned CSound::copyDataToTemp(const bool whichChannels[MAX_CHANNELS],sample_pos_t where,sample_pos_t length)
 {
+	TRACE_SCOPE("CSound::copyDataToTemp");
 	ASSERT_SIZE_LOCK 
 
 	if(where>size)
@@ -804,7 +868,167 @@ void CSound::removeTempAudioPools(unsigned tempAudioPoolKey)
 		const string tempAudioPoolName=createTempAudioPoolName(tempAudioPoolKey,t);
 		if(poolFile.containsPool(tempAudioPoolName))
 			poolFile.removePool(tempAudioPoolName);
+
+		const string tempPeakChunkPoolName=createTempPeakChunkPoolName(tempAudioPoolKey,t);
+		if(poolFile.containsPool(tempPeakChunkPoolName))
+			poolFile.removePool(tempPeakChunkPoolName);
+
+		const string compressedPoolName=createCompressedTempAudioPoolName(tempAudioPoolKey,t);
+		if(poolFile.containsPool(compressedPoolName))
+			poolFile.removePool(compressedPoolName);
+	}
+}
+
+/*
+ * A compressed temp pool is:
+ * 	8 bytes		the number of samples (little endian)
+ * and for each LOSSLESS_CODEC_BLOCK_SIZE samples (the last may have less):
+ * 	4 bytes		the size of the coded block (little endian)
+ * 	...		the coded block
+ */
+typedef TPoolAccesser<uint8_t,CSound::PoolFile_t> CCompressedPoolAccesser;
+
+static void writeLE(vector<uint8_t> &out,uint64_t v,unsigned byteCount)
+{
+	for(unsigned t=0;t<byteCount;t++,v>>=8)
+		out.push_back((uint8_t)v);
+}
+
+static uint64_t readLE(const CCompressedPoolAccesser &src,unsigned byteCount)
+{
+	uint8_t buffer[8];
+	src.read(buffer,byteCount);
+	uint64_t v=0;
+	for(unsigned t=byteCount;t>0;t--)
+		v=(v<<8) | buffer[t-1];
+	return v;
+}
+
+uint64_t CSound::compressTempAudioPools(unsigned tempAudioPoolKey)
+{
+	TRACE_SCOPE("CSound::compressTempAudioPools");
+	ASSERT_RESIZE_LOCK
+
+	uint64_t compressedSize=0;
+	for(unsigned t=0;t<MAX_CHANNELS;t++)
+	{
+		const string tempAudioPoolName=createTempAudioPoolName(tempAudioPoolKey,t);
+		if(!poolFile.containsPool(tempAudioPoolName))
+			continue;
+
+		const string compressedPoolName=createCompressedTempAudioPoolName(tempAudioPoolKey,t);
+		if(poolFile.containsPool(compressedPoolName)) // ??? shouldn't happen
+			poolFile.removePool(compressedPoolName);
+
+		CRezPoolAccesser src=poolFile.getPoolAccesser<sample_t>(tempAudioPoolName);
+		CCompressedPoolAccesser dest=poolFile.createPool<uint8_t>(compressedPoolName);
+		try
+		{
+			const sample_pos_t length=src.getSize();
+
+			vector<uint8_t> coded;
+			writeLE(coded,length,8);
+			dest.write(&coded[0],coded.size(),true);
+
+			sample_t buffer[LOSSLESS_CODEC_BLOCK_SIZE];
+			src.seek(0);
+			for(sample_pos_t pos=0;pos<length;)
+			{
+				const size_t count=(size_t)min((sample_pos_t)LOSSLESS_CODEC_BLOCK_SIZE,length-pos);
+				src.read(buffer,count);
+
+				coded.clear();
+				writeLE(coded,0,4);
+				losslessEncodeBlock(buffer,count,coded);
+				const uint64_t blockSize=coded.size()-4;
+				for(unsigned i=0;i<4;i++)
+					coded[i]=(uint8_t)(blockSize>>(i*8));
+				dest.write(&coded[0],coded.size(),true);
+
+				pos+=count;
+			}
+		}
+		catch(...)
+		{
+			// leave the original
+			poolFile.removePool(compressedPoolName);
+			throw;
+		}
+
+		compressedSize+=dest.getSize();
+
+		poolFile.removePool(tempAudioPoolName);
+		const string tempPeakChunkPoolName=createTempPeakChunkPoolName(tempAudioPoolKey,t);
+		if(poolFile.containsPool(tempPeakChunkPoolName))
+			poolFile.removePool(tempPeakChunkPoolName);
+	}
+
+	return compressedSize;
+}
+
+void CSound::decompressTempAudioPools(unsigned tempAudioPoolKey)
+{
+	TRACE_SCOPE("CSound::decompressTempAudioPools");
+	ASSERT_RESIZE_LOCK
+
+	for(unsigned t=0;t<MAX_CHANNELS;t++)
+	{
+		const string compressedPoolName=createCompressedTempAudioPoolName(tempAudioPoolKey,t);
+		if(!poolFile.containsPool(compressedPoolName))
+			continue;
+
+		const string tempAudioPoolName=createTempAudioPoolName(tempAudioPoolKey,t);
+		if(poolFile.containsPool(tempAudioPoolName))
+			throw runtime_error(string(__func__)+" -- temp pool both exists and is compressed: "+tempAudioPoolName);
+
+		CCompressedPoolAccesser src=poolFile.getPoolAccesser<uint8_t>(compressedPoolName);
+		CInternalRezPoolAccesser dest=createTempAudioPool(tempAudioPoolKey,t);
+		try
+		{
+			src.seek(0);
+			const sample_pos_t length=readLE(src,8);
+
+			vector<uint8_t> coded;
+			sample_t buffer[LOSSLESS_CODEC_BLOCK_SIZE];
+			for(sample_pos_t pos=0;pos<length;)
+			{
+				const size_t count=(size_t)min((sample_pos_t)LOSSLESS_CODEC_BLOCK_SIZE,length-pos);
+				const size_t blockSize=readLE(src,4);
+				if(blockSize==0 || blockSize>(size_t)(src.getSize()-src.tell()))
+					throw runtime_error(string(__func__)+" -- invalid block size in "+compressedPoolName);
+
+				coded.resize(blockSize);
+				src.read(&coded[0],blockSize);
+				losslessDecodeBlock(&coded[0],blockSize,buffer,count);
+				dest.write(buffer,count,true);
+
+				pos+=count;
+			}
+		}
+		catch(...)
+		{
+			// leave the compressed copy
+			poolFile.removePool(tempAudioPoolName);
+			throw;
+		}
+
+		poolFile.removePool(compressedPoolName);
+	}
+}
+
+uint64_t CSound::getTempAudioPoolsSize(unsigned tempAudioPoolKey) const
+{
+	uint64_t size=0;
+	for(unsigned t=0;t<MAX_CHANNELS;t++)
+	{
+		const string poolNames[3]={ createTempAudioPoolName(tempAudioPoolKey,t), createTempPeakChunkPoolName(tempAudioPoolKey,t), createCompressedTempAudioPoolName(tempAudioPoolKey,t) };
+		for(size_t i=0;i<3;i++)
+		{
+			if(poolFile.containsPool(poolNames[i]))
+				size+=poolFile.getPoolSize(poolNames[i]);
+		}
 	}
+	return size;
 }
 
 void CSound::appendForFudgeFactor(CInternalRezPoolAccesser dest,const CInternalRezPoolAccesser src,sample_pos_t srcWhere,sample_pos_t fudgeFactor)
@@ -842,7 +1066,20 @@ void CSound::rotateLeft(const bool whichChannels[MAX_CHANNELS],const sample_pos_
 			CInternalRezPoolAccesser accesser=getAudioInternal(i);
 			
 			accesser.moveData(stop-amount+1,accesser,start,amount);
-			invalidatePeakData(i,start,stop); // for want of a more efficient way (I already tried using move data on the peak accessers with the same parametesr as the previous call except /PEAK_CHUNK_SIZE, but error after many many operations was unacceptable)  ??? perhaps I need a flag which means 'how dirty' and it would absolutely recalculate it if it was just so dirty)
+
+			if(peakChunkAccessers[i]!=NULL)
+			{ // move the peak chunks for the rotated data the same way
+				const size_t first=splitPeakChunk(i,start);
+				const size_t middle=splitPeakChunk(i,start+amount);
+				const size_t last=splitPeakChunk(i,stop+1);
+
+				peakChunkAccessers[i]->moveData(last-(middle-first),*(peakChunkAccessers[i]),first,middle-first);
+				rebuildPeakChunkStarts(i,first,last);
+
+				joinPeakChunks(i,last);
+				joinPeakChunks(i,last-(middle-first));
+				joinPeakChunks(i,first);
+			}
 		}
 	}
 
@@ -864,7 +1101,20 @@ void CSound::rotateRight(const bool whichChannels[MAX_CHANNELS],const sample_pos
 			CInternalRezPoolAccesser accesser=getAudioInternal(i);
 			
 			accesser.moveData(start,accesser,stop-amount+1,amount);
-			invalidatePeakData(i,start,stop); // for want of a more efficient way 
+
+			if(peakChunkAccessers[i]!=NULL)
+			{ // move the peak chunks for the rotated data the same way
+				const size_t first=splitPeakChunk(i,start);
+				const size_t middle=splitPeakChunk(i,stop-amount+1);
+				const size_t last=splitPeakChunk(i,stop+1);
+
+				peakChunkAccessers[i]->moveData(first,*(peakChunkAccessers[i]),middle,last-middle);
+				rebuildPeakChunkStarts(i,first,last);
+
+				joinPeakChunks(i,last);
+				joinPeakChunks(i,first+(last-middle));
+				joinPeakChunks(i,first);
+			}
 		}
 	}
 }
@@ -910,9 +1160,6 @@ void CSound::addSpaceToChannel(unsigned channel,sample_pos_t where,sample_pos_t
 
 	CInternalRezPoolAccesser accesser=getAudioInternal(channel);
 
-	const sample_pos_t peakChunkCountHave=peakChunkAccessers[channel]==NULL ? 0 : peakChunkAccessers[channel]->getSize();
-	const sample_pos_t peakChunkCountNeeded=calcPeakChunkCount(accesser.getSize()+length);
-
 	// modify the audio data pools
 	accesser.insert(where,length);
 
@@ -921,18 +1168,11 @@ void CSound::addSpaceToChannel(unsigned channel,sample_pos_t where,sample_pos_t
 
 	if(peakChunkAccessers[channel]!=NULL)
 	{
-		// add more peak chunks if the needed size is more than we have
-		if(peakChunkCountNeeded>peakChunkCountHave)
-		{
-			const sample_pos_t insertWhere=where/PEAK_CHUNK_SIZE;
-			const sample_pos_t insertCount=peakChunkCountNeeded-peakChunkCountHave;
-
-			peakChunkAccessers[channel]->insert(insertWhere,insertCount);
-			for(sample_pos_t t=0;t<insertCount;t++)
-				(*(peakChunkAccessers[channel]))[insertWhere+t].dirty=true;
-		}
-		else // just mark the one we inserted into as dirty
-			(*(peakChunkAccessers[channel]))[where/PEAK_CHUNK_SIZE].dirty=true;
+		// insert chunks for the new space (which are known to be min=max=0 if it was zeroed)
+		const size_t index=splitPeakChunk(channel,where);
+		const size_t insertCount=insertPeakChunks(channel,index,length,doZeroData);
+		joinPeakChunks(channel,index+insertCount);
+		joinPeakChunks(channel,index);
 	}
 }
 
@@ -943,26 +1183,144 @@ void CSound::removeSpaceFromChannel(unsigned channel,sample_pos_t where,sample_p
 
 	CInternalRezPoolAccesser accesser=getAudioInternal(channel);
 
-	const sample_pos_t peakChunkCountHave=peakChunkAccessers[channel]==NULL ? 0 : peakChunkAccessers[channel]->getSize();
-	const sample_pos_t peakChunkCountNeeded=calcPeakChunkCount(accesser.getSize()-length);
-
 	accesser.remove(where,length);
 
 	if(peakChunkAccessers[channel]!=NULL)
 	{
-		// modify the peak data pools if the size is dropping below the required size 
-		if(peakChunkCountHave>peakChunkCountNeeded)
+		// remove the chunks for the removed space
+		const size_t first=splitPeakChunk(channel,where);
+		const size_t last=splitPeakChunk(channel,where+length);
+		removePeakChunks(channel,first,last);
+		joinPeakChunks(channel,first);
+	}
+}
+
+void CSound::editSpaceOfChannel(unsigned channel,const vector<RSpaceEdit> &edits,bool doZeroData)
+{
+	CInternalRezPoolAccesser accesser=getAudioInternal(channel);
+
+	// modify the audio data pool
+	vector<PoolFile_t::RSpaceEdit> poolEdits(edits.size());
+	for(size_t t=0;t<edits.size();t++)
+	{
+		poolEdits[t].where=edits[t].where;
+		poolEdits[t].removeCount=edits[t].removeLength;
+		poolEdits[t].insertCount=edits[t].insertLength;
+	}
+	accesser.editSpace(poolEdits);
+
+	if(doZeroData)
+	{
+		sample_pos_t delta=0; // how far the edits so far have moved the positions after them
+		for(size_t t=0;t<edits.size();t++)
+		{
+			accesser.zeroData(edits[t].where+delta,edits[t].insertLength);
+			delta+=edits[t].insertLength-edits[t].removeLength;
+		}
+	}
+
+	if(peakChunkAccessers[channel]==NULL)
+		return;
+
+	/*
+	 * Rebuild the peak chunks from the chunk before the first edit through the end in memory doing
+	 * what splitPeakChunk(), insertPeakChunks(), removePeakChunks() and joinPeakChunks() do for a
+	 * single edit, then write them back at once.
+	 */
+	CPeakChunkRezPoolAccesser &peakChunks=*(peakChunkAccessers[channel]);
+	vector<sample_pos_t> &peakChunkStart=peakChunkStarts[channel];
+
+	size_t firstIndex=findPeakChunk(channel,edits.front().where);
+	if(firstIndex>0)
+		firstIndex--;
+	const size_t oldCount=peakChunks.getSize();
+
+	vector<RPeakChunk> oldChunks(oldCount-firstIndex);
+	for(size_t t=firstIndex;t<oldCount;t++)
+		oldChunks[t-firstIndex]=peakChunks[t];
+
+	vector<RPeakChunk> newChunks;
+	newChunks.reserve(oldChunks.size()+edits.size()*2);
+
+	bool atEdit=false; // true when the next chunk appended comes after an edit boundary and might be joined with the one before it
+	auto appendChunk=[&](const RPeakChunk &p)
+	{
+		if(atEdit && !newChunks.empty() && (newChunks.back().size+p.size)<=PEAK_CHUNK_SIZE)
+		{
+			RPeakChunk &p1=newChunks.back();
+			if(!p1.dirty && !p.dirty)
+			{ // both are up to date, so the joined one is too
+				p1.min=min(p1.min,p.min);
+				p1.max=max(p1.max,p.max);
+			}
+			else
+				p1.dirty=true;
+			p1.size+=p.size;
+		}
+		else
+			newChunks.push_back(p);
+		atEdit=false;
+	};
+
+	// walks through the old chunks up to position 'to' copying them to newChunks if 'keep' is true
+	sample_pos_t pos=peakChunkStart[firstIndex];
+	size_t index=0;
+	sample_pos_t offset=0; // how much of oldChunks[index] has been walked through
+	auto walkChunks=[&](const sample_pos_t to,const bool keep)
+	{
+		while(pos<to)
 		{
-			const sample_pos_t removeWhere=where/PEAK_CHUNK_SIZE;
-			const sample_pos_t removeCount=peakChunkCountHave-peakChunkCountNeeded;
+			const RPeakChunk &p=oldChunks[index];
+			const sample_pos_t length=min((sample_pos_t)(p.size-offset),to-pos);
+			if(keep)
+			{
+				RPeakChunk piece=p;
+				piece.size=length;
+				if(length!=p.size)
+					piece.dirty=true;
+				appendChunk(piece);
+			}
+			pos+=length;
+			offset+=length;
+			if(offset>=p.size)
+			{
+				index++;
+				offset=0;
+			}
+		}
+	};
 
-			peakChunkAccessers[channel]->remove(removeWhere,removeCount);
-		}	
+	for(size_t t=0;t<edits.size();t++)
+	{
+		const RSpaceEdit &edit=edits[t];
+		walkChunks(edit.where,true);
+		walkChunks(edit.where+edit.removeLength,false);
+		atEdit=true;
 
-		// make the a the peak chunk at where recalculate
-		if((where/PEAK_CHUNK_SIZE)<peakChunkAccessers[channel]->getSize())
-			(*(peakChunkAccessers[channel]))[where/PEAK_CHUNK_SIZE].dirty=true;
+		// chunks for the new space (which are known to be min=max=0 if it was zeroed)
+		for(sample_pos_t done=0;done<edit.insertLength;)
+		{
+			RPeakChunk p;
+			p.size=min((sample_pos_t)PEAK_CHUNK_SIZE,edit.insertLength-done);
+			p.min=p.max=0;
+			p.dirty=!doZeroData;
+			appendChunk(p);
+			done+=p.size;
+		}
+		atEdit=true;
 	}
+	walkChunks(peakChunkStart.back(),true);
+
+	peakChunks.remove(firstIndex,oldCount-firstIndex);
+	peakChunks.append(newChunks.size());
+	for(size_t t=0;t<newChunks.size();t++)
+		peakChunks[firstIndex+t]=newChunks[t];
+
+	peakChunkStart.resize(firstIndex+newChunks.size()+1);
+	for(size_t t=firstIndex;t<firstIndex+newChunks.size();t++)
+		peakChunkStart[t+1]=peakChunkStart[t]+newChunks[t-firstIndex].size;
+
+	noteInvalidatedPeakRange(edits.front().where,MAX_LENGTH);
 }
 
 void CSound::copyDataFromChannel(unsigned tempAudioPoolKey,unsigned channel,sample_pos_t where,sample_pos_t length)
@@ -987,25 +1345,25 @@ void CSound::moveDataOutOfChannel(unsigned tempAudioPoolKey,unsigned channel,sam
 
 	CInternalRezPoolAccesser srcAccesser=getAudioInternal(channel);
 
-	const sample_pos_t peakChunkCountHave=peakChunkAccessers[channel]==NULL ? 0 : peakChunkAccessers[channel]->getSize();
-	const sample_pos_t peakChunkCountNeeded=calcPeakChunkCount(srcAccesser.getSize()-length);
-
 	destAccesser.moveData(0,srcAccesser,where,length);
 
 	if(peakChunkAccessers[channel]!=NULL)
 	{
-		// modify the peak data pools if the size is dropping below the required size 
-		if(peakChunkCountHave>peakChunkCountNeeded)
-		{
-			const sample_pos_t removeWhere=where/PEAK_CHUNK_SIZE;
-			const sample_pos_t removeCount=peakChunkCountHave-peakChunkCountNeeded;
+		// move the chunks for the moved data into a temp pool alongside the temp audio pool so they can come back with it
+		const size_t first=splitPeakChunk(channel,where);
+		const size_t last=splitPeakChunk(channel,where+length);
 
-			peakChunkAccessers[channel]->remove(removeWhere,removeCount);
-		}
+		CPeakChunkRezPoolAccesser tempPeakChunks=poolFile.createPool<RPeakChunk>(createTempPeakChunkPoolName(tempAudioPoolKey,channel));
+		tempPeakChunks.moveData(0,*(peakChunkAccessers[channel]),first,last-first);
+
+		// (the chunks are now gone from the channel, so just fix up the start positions)
+		vector<sample_pos_t> &peakChunkStart=peakChunkStarts[channel];
+		peakChunkStart.erase(peakChunkStart.begin()+first,peakChunkStart.begin()+last);
+		for(size_t t=first;t<peakChunkStart.size();t++)
+			peakChunkStart[t]-=length;
+		noteInvalidatedPeakRange(where,MAX_LENGTH);
 
-		// make the a the peak chunk at where recalculate
-		if((where/PEAK_CHUNK_SIZE)<peakChunkAccessers[channel]->getSize())
-			(*(peakChunkAccessers[channel]))[where/PEAK_CHUNK_SIZE].dirty=true;
+		joinPeakChunks(channel,first);
 	}
 }
 
@@ -1016,9 +1374,6 @@ void CSound::moveDataIntoChannel(unsigned tempAudioPoolKey,unsigned channelInTem
 
 	CInternalRezPoolAccesser destAccesser=getAudioInternal(channelInAudio);
 
-	const sample_pos_t peakChunkCountHave=peakChunkAccessers[channelInAudio]==NULL ? 0 : peakChunkAccessers[channelInAudio]->getSize();
-	const sample_pos_t peakChunkCountNeeded=calcPeakChunkCount(destAccesser.getSize()+length);
-
 	CInternalRezPoolAccesser srcAccesser=getTempDataInternal(tempAudioPoolKey,channelInTempPool);
 	if(length>srcAccesser.getSize())
 		throw(runtime_error(string(__func__)+" -- length parameter out of range: "+istring(length)));
@@ -1028,22 +1383,51 @@ void CSound::moveDataIntoChannel(unsigned tempAudioPoolKey,unsigned channelInTem
 	if(removeTempAudioPool)
 		poolFile.removePool(createTempAudioPoolName(tempAudioPoolKey,channelInTempPool));
 
+	const string tempPeakChunkPoolName=createTempPeakChunkPoolName(tempAudioPoolKey,channelInTempPool);
 	if(peakChunkAccessers[channelInAudio]!=NULL)
 	{
-		// add more peak chunks if the needed size is more than we have
-		if(peakChunkCountNeeded>peakChunkCountHave)
+		const size_t index=splitPeakChunk(channelInAudio,where);
+		size_t insertCount=0;
+
+		// bring back the chunks that moveDataOutOfChannel() put aside for this data if there are any
+		// (the temp audio may have had more appended to it since then, so only whole chunks within length are moved)
+		sample_pos_t lengthMoved=0;
+		if(poolFile.containsPool(tempPeakChunkPoolName))
 		{
-			const sample_pos_t insertWhere=where/PEAK_CHUNK_SIZE;
-			const sample_pos_t insertCount=peakChunkCountNeeded-peakChunkCountHave;
+			CPeakChunkRezPoolAccesser tempPeakChunks=poolFile.getPoolAccesser<RPeakChunk>(tempPeakChunkPoolName);
+
+			vector<sample_pos_t> &peakChunkStart=peakChunkStarts[channelInAudio];
+			const size_t tempPeakChunkCount=tempPeakChunks.getSize();
+			while(insertCount<tempPeakChunkCount && (length-lengthMoved)>=tempPeakChunks[insertCount].size)
+				lengthMoved+=tempPeakChunks[insertCount++].size;
 
-			peakChunkAccessers[channelInAudio]->insert(insertWhere,insertCount);
-			for(sample_pos_t t=0;t<insertCount;t++)
-				(*(peakChunkAccessers[channelInAudio]))[insertWhere+t].dirty=true;
+			if(insertCount>0)
+			{
+				peakChunkAccessers[channelInAudio]->moveData(index,tempPeakChunks,0,insertCount);
+				peakChunkStart.insert(peakChunkStart.begin()+index,insertCount,where);
+				for(size_t t=index+insertCount;t<peakChunkStart.size();t++)
+					peakChunkStart[t]+=lengthMoved;
+				rebuildPeakChunkStarts(channelInAudio,index,index+insertCount);
+				noteInvalidatedPeakRange(where,MAX_LENGTH);
+			}
+
+			// keep the remaining temp chunks lined up with the remaining temp audio
+			if(lengthMoved<length && tempPeakChunks.getSize()>0)
+			{
+				tempPeakChunks[0].size-=min<sample_pos_t>(length-lengthMoved,tempPeakChunks[0].size);
+				tempPeakChunks[0].dirty=true;
+			}
 		}
-		else // just mark the one we inserted into as dirty
-			(*(peakChunkAccessers[channelInAudio]))[where/PEAK_CHUNK_SIZE].dirty=true;
+
+		if(lengthMoved<length)
+			insertCount+=insertPeakChunks(channelInAudio,index+insertCount,length-lengthMoved,false);
+
+		joinPeakChunks(channelInAudio,index+insertCount);
+		joinPeakChunks(channelInAudio,index);
 	}
 
+	if(removeTempAudioPool && poolFile.containsPool(tempPeakChunkPoolName))
+		poolFile.removePool(tempPeakChunkPoolName);
 }
 
 void CSound::silenceSound(unsigned channel,sample_pos_t where,sample_pos_t length,bool doInvalidatePeakData,bool showProgressBar)
@@ -1056,7 +1440,7 @@ void CSound::silenceSound(unsigned channel,sample_pos_t where,sample_pos_t lengt
 		invalidatePeakData(channel,where,where+length);
 }
 
-#include "DSP/TSoundStretcher.h"
+#include "DSP/SincResampler.h"
 
 void CSound::mixSound(unsigned channel,sample_pos_t where,const CRezPoolAccesser src,sample_pos_t srcWhere,unsigned srcSampleRate,sample_pos_t length,MixMethods mixMethod,SourceFitTypes fitSrc,bool doInvalidatePeakData,bool showProgressBar)
 {
@@ -1081,7 +1465,7 @@ void CSound::mixSound(unsigned channel,sample_pos_t where,const CRezPoolAccesser
 		{
 			if(fitSrc==sftChangeRate)
 			{
-				TSoundStretcher<const CRezPoolAccesser> srcStretcher(src,srcWhere,src.getSize()-srcWhere,length);
+				TSincSoundStretcher<const CRezPoolAccesser> srcStretcher(src,srcWhere,src.getSize()-srcWhere,length,(CDSPSincResampler::Qualities)gSampleRateConversionQuality);
 				const sample_pos_t last=where+length;
 				if(showProgressBar)
 				{
@@ -1103,7 +1487,7 @@ void CSound::mixSound(unsigned channel,sample_pos_t where,const CRezPoolAccesser
 		}
 		else if(srcSampleRate!=destSampleRate)
 		{ // do sample rate conversion
-			TSoundStretcher<const CRezPoolAccesser> srcStretcher(src,srcWhere,(sample_pos_t)((sample_fpos_t)length/destSampleRate*srcSampleRate),length);
+			TSincSoundStretcher<const CRezPoolAccesser> srcStretcher(src,srcWhere,(sample_pos_t)((sample_fpos_t)length/destSampleRate*srcSampleRate),length,(CDSPSincResampler::Qualities)gSampleRateConversionQuality);
 			const sample_pos_t last=where+length;
 			if(showProgressBar)
 			{
@@ -1141,7 +1525,7 @@ void CSound::mixSound(unsigned channel,sample_pos_t where,const CRezPoolAccesser
 		{
 			if(fitSrc==sftChangeRate)
 			{
-				TSoundStretcher<const CRezPoolAccesser> srcStretcher(src,srcWhere,src.getSize()-srcWhere,length);
+				TSincSoundStretcher<const CRezPoolAccesser> srcStretcher(src,srcWhere,src.getSize()-srcWhere,length,(CDSPSincResampler::Qualities)gSampleRateConversionQuality);
 				const sample_pos_t last=where+length;
 				if(showProgressBar)
 				{
@@ -1163,7 +1547,7 @@ void CSound::mixSound(unsigned channel,sample_pos_t where,const CRezPoolAccesser
 		}
 		else if(srcSampleRate!=destSampleRate)
 		{
-			TSoundStretcher<const CRezPoolAccesser> srcStretcher(src,srcWhere,(sample_pos_t)((sample_fpos_t)length/destSampleRate*srcSampleRate),length);
+			TSincSoundStretcher<const CRezPoolAccesser> srcStretcher(src,srcWhere,(sample_pos_t)((sample_fpos_t)length/destSampleRate*srcSampleRate),length,(CDSPSincResampler::Qualities)gSampleRateConversionQuality);
 			const sample_pos_t last=where+length;
 			if(showProgressBar)
 			{
@@ -1206,7 +1590,7 @@ void CSound::mixSound(unsigned channel,sample_pos_t where,const CRezPoolAccesser
 		{
 			if(fitSrc==sftChangeRate)
 			{
-				TSoundStretcher<const CRezPoolAccesser> srcStretcher(src,srcWhere,src.getSize()-srcWhere,length);
+				TSincSoundStretcher<const CRezPoolAccesser> srcStretcher(src,srcWhere,src.getSize()-srcWhere,length,(CDSPSincResampler::Qualities)gSampleRateConversionQuality);
 				const sample_pos_t last=where+length;
 				if(showProgressBar)
 				{
@@ -1228,7 +1612,7 @@ void CSound::mixSound(unsigned channel,sample_pos_t where,const CRezPoolAccesser
 		}
 		else if(srcSampleRate!=destSampleRate)
 		{
-			TSoundStretcher<const CRezPoolAccesser> srcStretcher(src,srcWhere,(sample_pos_t)((sample_fpos_t)length/destSampleRate*srcSampleRate),length);
+			TSincSoundStretcher<const CRezPoolAccesser> srcStretcher(src,srcWhere,(sample_pos_t)((sample_fpos_t)length/destSampleRate*srcSampleRate),length,(CDSPSincResampler::Qualities)gSampleRateConversionQuality);
 			const sample_pos_t last=where+length;
 			if(showProgressBar)
 			{
@@ -1271,7 +1655,7 @@ void CSound::mixSound(unsigned channel,sample_pos_t where,const CRezPoolAccesser
 		{
 			if(fitSrc==sftChangeRate)
 			{
-				TSoundStretcher<const CRezPoolAccesser> srcStretcher(src,srcWhere,src.getSize()-srcWhere,length);
+				TSincSoundStretcher<const CRezPoolAccesser> srcStretcher(src,srcWhere,src.getSize()-srcWhere,length,(CDSPSincResampler::Qualities)gSampleRateConversionQuality);
 				const sample_pos_t last=where+length;
 				if(showProgressBar)
 				{
@@ -1293,7 +1677,7 @@ void CSound::mixSound(unsigned channel,sample_pos_t where,const CRezPoolAccesser
 		}
 		else if(srcSampleRate!=destSampleRate)
 		{
-			TSoundStretcher<const CRezPoolAccesser> srcStretcher(src,srcWhere,(sample_pos_t)((sample_fpos_t)length/destSampleRate*srcSampleRate),length);
+			TSincSoundStretcher<const CRezPoolAccesser> srcStretcher(src,srcWhere,(sample_pos_t)((sample_fpos_t)length/destSampleRate*srcSampleRate),length,(CDSPSincResampler::Qualities)gSampleRateConversionQuality);
 			const sample_pos_t last=where+length;
 			if(showProgressBar)
 			{
@@ -1336,7 +1720,7 @@ void CSound::mixSound(unsigned channel,sample_pos_t where,const CRezPoolAccesser
 		{
 			if(fitSrc==sftChangeRate)
 			{
-				TSoundStretcher<const CRezPoolAccesser> srcStretcher(src,srcWhere,src.getSize()-srcWhere,length);
+				TSincSoundStretcher<const CRezPoolAccesser> srcStretcher(src,srcWhere,src.getSize()-srcWhere,length,(CDSPSincResampler::Qualities)gSampleRateConversionQuality);
 				const sample_pos_t last=where+length;
 				if(showProgressBar)
 				{
@@ -1358,7 +1742,7 @@ void CSound::mixSound(unsigned channel,sample_pos_t where,const CRezPoolAccesser
 		}
 		else if(srcSampleRate!=destSampleRate)
 		{
-			TSoundStretcher<const CRezPoolAccesser> srcStretcher(src,srcWhere,(sample_pos_t)((sample_fpos_t)length/destSampleRate*srcSampleRate),length);
+			TSincSoundStretcher<const CRezPoolAccesser> srcStretcher(src,srcWhere,(sample_pos_t)((sample_fpos_t)length/destSampleRate*srcSampleRate),length,(CDSPSincResampler::Qualities)gSampleRateConversionQuality);
 			const sample_pos_t last=where+length;
 			if(showProgressBar)
 			{
@@ -1530,6 +1914,7 @@ void CSound::verifySAT()
 
 void CSound::flush()
 {
+	TRACE_SCOPE("CSound::flush");
 	poolFile.flushData();
 }
 
@@ -1805,14 +2190,13 @@ void CSound::createPeakChunkAccessers()
 {
 	if(poolFile.isOpen())
 	{
-		sample_pos_t peakCount=calcPeakChunkCount(size);
 		for(unsigned i=0;i<channelCount;i++)
 		{
-			peakChunkAccessers[i]=new CPeakChunkRezPoolAccesser(poolFile.createPool<RPeakChunk>(PEAK_CHUNK_POOL_NAME+istring(i),false));
-			peakChunkAccessers[i]->clear();
-			peakChunkAccessers[i]->append(peakCount);
-			for(sample_pos_t t=0;t<peakCount;t++)
-				(*(peakChunkAccessers[i]))[t].dirty=true;
+			// (recreated rather than reused in case it was written with a different RPeakChunk layout)
+			poolFile.removePool(PEAK_CHUNK_POOL_NAME+istring(i),false);
+			peakChunkAccessers[i]=new CPeakChunkRezPoolAccesser(poolFile.createPool<RPeakChunk>(PEAK_CHUNK_POOL_NAME+istring(i)));
+			peakChunkStarts[i].assign(1,0);
+			insertPeakChunks(i,0,getAudioInternal(i).getSize(),false);
 		}
 	}
 }
@@ -1825,17 +2209,125 @@ void CSound::deletePeakChunkAccessers()
 		{
 			delete peakChunkAccessers[t];
 			peakChunkAccessers[t]=NULL;
+			peakChunkStarts[t].clear();
 		}
 	}
 }
 
-// returns the number of peak chunks that there needs to be for the given size
-sample_pos_t CSound::calcPeakChunkCount(sample_pos_t givenSize)
+// returns the index of the peak chunk containing where (or the number of chunks if where is at or past the end)
+size_t CSound::findPeakChunk(unsigned channel,sample_pos_t where) const
 {
-	sample_pos_t v=((sample_pos_t)ceil(((sample_fpos_t)givenSize)/((sample_fpos_t)PEAK_CHUNK_SIZE)));
-	if(v<=0)
-		v=1;
-	return(v);
+	const vector<sample_pos_t> &peakChunkStart=peakChunkStarts[channel];
+	if(peakChunkStart.size()<=1 || where>=peakChunkStart.back())
+		return(peakChunkStart.empty() ? 0 : peakChunkStart.size()-1);
+	return((upper_bound(peakChunkStart.begin(),peakChunkStart.end(),where)-peakChunkStart.begin())-1);
+}
+
+// makes a chunk begin at where (splitting the chunk containing where if necessary) and returns the index of that chunk
+size_t CSound::splitPeakChunk(unsigned channel,sample_pos_t where)
+{
+	vector<sample_pos_t> &peakChunkStart=peakChunkStarts[channel];
+	const size_t index=findPeakChunk(channel,where);
+	if(index>=peakChunkStart.size()-1 || peakChunkStart[index]==where)
+		return(index);
+
+	CPeakChunkRezPoolAccesser &peakChunks=*(peakChunkAccessers[channel]);
+	const sample_pos_t leftSize=where-peakChunkStart[index];
+	peakChunks.insert(index+1,1);
+	peakChunks[index+1].size=peakChunks[index].size-leftSize;
+	peakChunks[index+1].dirty=true;
+	peakChunks[index].size=leftSize;
+	peakChunks[index].dirty=true;
+
+	peakChunkStart.insert(peakChunkStart.begin()+index+1,where);
+	return(index+1);
+}
+
+// joins the chunk at index with the one before it if they would not be larger than PEAK_CHUNK_SIZE together
+void CSound::joinPeakChunks(unsigned channel,size_t index)
+{
+	CPeakChunkRezPoolAccesser &peakChunks=*(peakChunkAccessers[channel]);
+	if(index<=0 || index>=(size_t)peakChunks.getSize())
+		return;
+
+	const RPeakChunk p2=peakChunks[index];
+	RPeakChunk &p1=peakChunks[index-1];
+	if((p1.size+p2.size)>PEAK_CHUNK_SIZE)
+		return;
+
+	if(!p1.dirty && !p2.dirty)
+	{ // both are up to date, so the joined one is too
+		p1.min=min(p1.min,p2.min);
+		p1.max=max(p1.max,p2.max);
+	}
+	else
+		p1.dirty=true;
+	p1.size+=p2.size;
+
+	peakChunks.remove(index,1);
+	peakChunkStarts[channel].erase(peakChunkStarts[channel].begin()+index);
+}
+
+// inserts new chunks at index to cover length samples and returns how many were inserted
+size_t CSound::insertPeakChunks(unsigned channel,size_t index,sample_pos_t length,bool zeroed)
+{
+	if(length<=0)
+		return(0);
+
+	CPeakChunkRezPoolAccesser &peakChunks=*(peakChunkAccessers[channel]);
+	vector<sample_pos_t> &peakChunkStart=peakChunkStarts[channel];
+
+	const size_t insertCount=(length+PEAK_CHUNK_SIZE-1)/PEAK_CHUNK_SIZE;
+	const sample_pos_t where=peakChunkStart[index];
+	peakChunks.insert(index,insertCount);
+	peakChunkStart.insert(peakChunkStart.begin()+index,insertCount,where);
+	for(size_t t=0;t<insertCount;t++)
+	{
+		RPeakChunk &p=peakChunks[index+t];
+		p.size= t==insertCount-1 ? length-(t*PEAK_CHUNK_SIZE) : PEAK_CHUNK_SIZE;
+		p.min=p.max=0;
+		p.dirty=!zeroed;
+		peakChunkStart[index+t]+=t*PEAK_CHUNK_SIZE;
+	}
+	for(size_t t=index+insertCount;t<peakChunkStart.size();t++)
+		peakChunkStart[t]+=length;
+
+	noteInvalidatedPeakRange(where,MAX_LENGTH);
+
+	return(insertCount);
+}
+
+// removes the chunks [firstIndex,lastIndex)
+void CSound::removePeakChunks(unsigned channel,size_t firstIndex,size_t lastIndex)
+{
+	if(firstIndex>=lastIndex)
+		return;
+
+	vector<sample_pos_t> &peakChunkStart=peakChunkStarts[channel];
+	const sample_pos_t length=peakChunkStart[lastIndex]-peakChunkStart[firstIndex];
+
+	noteInvalidatedPeakRange(peakChunkStart[firstIndex],MAX_LENGTH);
+
+	peakChunkAccessers[channel]->remove(firstIndex,lastIndex-firstIndex);
+	peakChunkStart.erase(peakChunkStart.begin()+firstIndex,peakChunkStart.begin()+lastIndex);
+	for(size_t t=firstIndex;t<peakChunkStart.size();t++)
+		peakChunkStart[t]-=length;
+}
+
+// recalculates the start positions of the chunks after firstIndex up through lastIndex after chunks have been rearranged within that range
+void CSound::rebuildPeakChunkStarts(unsigned channel,size_t firstIndex,size_t lastIndex)
+{
+	CPeakChunkRezPoolAccesser &peakChunks=*(peakChunkAccessers[channel]);
+	vector<sample_pos_t> &peakChunkStart=peakChunkStarts[channel];
+	for(size_t t=firstIndex;t<lastIndex;t++)
+		peakChunkStart[t+1]=peakChunkStart[t]+peakChunks[t].size;
+
+	noteInvalidatedPeakRange(peakChunkStart[firstIndex],peakChunkStart[lastIndex]);
+}
+
+const string CSound::createTempPeakChunkPoolName(unsigned tempAudioPoolKey,unsigned channel)
+{
+	return(TEMP_PEAK_CHUNK_POOL_NAME+istring(tempAudioPoolKey)+"_"+istring(channel));
 }
 
 
@@ -1844,6 +2336,11 @@ const string CSound::createTempAudioPoolName(unsigned tempAudioPoolKey,unsigned
 	return(TEMP_AUDIO_POOL_NAME+istring(tempAudioPoolKey)+"_"+istring(channel));
 }
 
+const string CSound::createCompressedTempAudioPoolName(unsigned tempAudioPoolKey,unsigned channel)
+{
+	return(COMPRESSED_TEMP_AUDIO_POOL_NAME+istring(tempAudioPoolKey)+"_"+istring(channel));
+}
+
 CSound::CInternalRezPoolAccesser CSound::createTempAudioPool(unsigned tempAudioPoolKey,unsigned channel)
 {
 	return(poolFile.createPool<sample_t>(createTempAudioPoolName(tempAudioPoolKey,channel)));
@@ -1857,7 +2354,7 @@ void CSound::removeAllTempAudioPools()
 		const string _poolName=poolFile.getPoolNameById(poolId);
 		const char *poolName=_poolName.c_str();
 			// ??? since I'm using strstr, string probably needs/has some string searching methods
-		if(strstr(poolName,TEMP_AUDIO_POOL_NAME)==poolName)
+		if(strstr(poolName,TEMP_AUDIO_POOL_NAME)==poolName || strstr(poolName,TEMP_PEAK_CHUNK_POOL_NAME)==poolName || strstr(poolName,COMPRESSED_TEMP_AUDIO_POOL_NAME)==poolName)
 		{
 			poolFile.removePool(poolId);
 			t--;
@@ -1920,8 +2417,12 @@ void CSound::ensureNonZeroLength()
 			a.append(1);
 			a[a.getSize()-1]=0;
 
-			// I would also do it for peakChunkAccessers, but I handled that 
-			// by always insisting on at least 1 chunk in calcPeakChunkCount
+			if(peakChunkAccessers[t]!=NULL)
+			{
+				peakChunkAccessers[t]->clear();
+				peakChunkStarts[t].assign(1,0);
+				insertPeakChunks(t,0,1,true);
+			}
 		}
 		size=1;
 	}
@@ -1970,7 +2471,7 @@ void CSound::setCueTime(size_t index,sample_pos_t newTime)
 	(*cueAccesser)[index].time=newTime;
 
 	// update cueIndex
-	rebuildCueIndex();
+	cueIndex.setTime(index,newTime);
 }
 
 const bool CSound::isCueAnchored(size_t index) const
@@ -1989,21 +2490,21 @@ void CSound::addCue(const string &name,const sample_pos_t time,const bool isAnch
 	(*cueAccesser)[cueAccesser->getSize()-1]=RCue(name.c_str(),time,isAnchored);
 
 	// update cueIndex
-	cueIndex.insert(map<sample_pos_t,size_t>::value_type(time,cueAccesser->getSize()-1));
+	cueIndex.append(name,time,isAnchored);
 }
 
 void CSound::insertCue(size_t index,const string &name,const sample_pos_t time,const bool isAnchored)
 {
 	if(name.size()>=MAX_SOUND_CUE_NAME_LENGTH-1)
 		throw(runtime_error(string(__func__)+" -- cue name too long"));
-	if(index>cueAccesser->getSize())
+	if(index>(size_t)cueAccesser->getSize())
 		throw(runtime_error(string(__func__)+" -- invalid index: "+istring(index)));
 
 	cueAccesser->insert(index,1);
 	(*cueAccesser)[index]=RCue(name.c_str(),time,isAnchored);
 
 	// update cueIndex
-	rebuildCueIndex();
+	cueIndex.insert(index,name,time,isAnchored);
 }
 
 void CSound::removeCue(size_t index)
@@ -2013,75 +2514,39 @@ void CSound::removeCue(size_t index)
 	cueAccesser->remove(index,1);
 
 	// update cueIndex
-	rebuildCueIndex();
+	cueIndex.remove(index);
 }
 
 size_t CSound::__default_cue_index;
 bool CSound::containsCue(const string &name,size_t &index) const
 {
-	for(size_t t=0;t<cueAccesser->getSize();t++)
-	{
-		if(strncmp((*cueAccesser)[t].name,name.c_str(),MAX_SOUND_CUE_NAME_LENGTH)==0)
-		{
-			index=t;
-			return true;
-		}
-	}
-	return false;
+	// only so much of the name is stored
+	return cueIndex.findName(name.substr(0,MAX_SOUND_CUE_NAME_LENGTH),index);
 }
 
 bool CSound::findCue(const sample_pos_t time,size_t &index) const
 {
-	const map<sample_pos_t,size_t>::const_iterator i=cueIndex.find(time);
-
-	if(i!=cueIndex.end())
-	{
-		index=i->second;
-		return true;
-	}
-	else
-		return false;
+	return cueIndex.findAt(time,index);
 }
 
 bool CSound::findNearestCue(const sample_pos_t time,size_t &index,sample_pos_t &distance) const
 {
-	if(cueIndex.empty())
-		return false;
+	size_t before,after;
+	const bool foundBefore=cueIndex.findBefore(time,before);
+	const bool foundAfter=cueIndex.findAtOrAfter(time,after);
 
-	map<sample_pos_t,size_t>::const_iterator i=cueIndex.lower_bound(time);
+	if(!foundBefore && !foundAfter)
+		return false;
 
-	if(i!=cueIndex.begin())
+	if(foundBefore && (!foundAfter || (time-getCueTime(before))<(getCueTime(after)-time)))
 	{
-		if(i==cueIndex.end())
-		{
-			i--; // go back one
-			index=i->second;
-			distance=(sample_pos_t)sample_fpos_fabs((sample_fpos_t)time-(sample_fpos_t)i->first);
-		}
-		else
-		{
-			map<sample_pos_t,size_t>::const_iterator pi=i;
-			pi--;
-
-			const sample_pos_t d1=(sample_pos_t)sample_fpos_fabs((sample_fpos_t)time-(sample_fpos_t)pi->first);
-			const sample_pos_t d2=(sample_pos_t)sample_fpos_fabs((sample_fpos_t)time-(sample_fpos_t)i->first);
-
-			if(d1<d2)
-			{
-				index=pi->second;
-				distance=d1;
-			}
-			else
-			{
-				index=i->second;
-				distance=d2;
-			}
-		}
+		index=before;
+		distance=time-getCueTime(before);
 	}
 	else
 	{
-		index=i->second;
-		distance=(sample_pos_t)sample_fpos_fabs((sample_fpos_t)time-(sample_fpos_t)i->first);
+		index=after;
+		distance=getCueTime(after)-time;
 	}
 
 	return true;
@@ -2089,70 +2554,37 @@ bool CSound::findNearestCue(const sample_pos_t time,size_t &index,sample_pos_t &
 
 bool CSound::findPrevCue(const sample_pos_t time,size_t &index) const
 {
-	map<sample_pos_t,size_t>::const_iterator i=cueIndex.find(time);
-	if(i==cueIndex.end())
+	size_t i;
+	if(!cueIndex.findAt(time,i))
 		return false;
 
-	if(i!=cueIndex.begin())
-		i--;
-	index=i->second;
+	// stay at the one at time if it's the first
+	cueIndex.findBefore(time,i);
+	index=i;
 	return true;
 }
 
 bool CSound::findNextCue(const sample_pos_t time,size_t &index) const
 {
-	map<sample_pos_t,size_t>::const_iterator i=cueIndex.find(time);
-	if(i==cueIndex.end())
+	size_t i;
+	if(!cueIndex.findAt(time,i))
 		return false;
 
-	i++;
-	if(i==cueIndex.end())
-		return false;
-	index=i->second;
-	return true;
+	return cueIndex.findAfter(time,index);
 }
 
 bool CSound::findPrevCueInTime(const sample_pos_t time,size_t &index) const
 {
-	if(cueIndex.empty())
-		return false;
-
-	// upper_bound returns the element that is greater than the position where 'time' would be inserted if it were
-	map<sample_pos_t,size_t>::const_iterator i=cueIndex.upper_bound(time);
-
-	if(i==cueIndex.end())
-	{
-		i--;
-		index=i->second;
-		return true; // ok return the last cue in time
-	}
-	else
-	{
-		if(i==cueIndex.begin())
-			return false; // ok, so time is are prior to all cues 
-		i--;
-		index=i->second;
-		return true; // ok we're at the cue prior to the one upper_bound found
-	}
+	return cueIndex.findAtOrBefore(time,index);
 }
 
 bool CSound::findNextCueInTime(const sample_pos_t time,size_t &index) const
 {
-	// upper_bound returns the element that is greater than the position where 'time' would be inserted if it were
-	map<sample_pos_t,size_t>::const_iterator i=cueIndex.upper_bound(time);
-
-	if(i!=cueIndex.end())
-	{
-		index=i->second;
-		return true;
-	}
-	else
-		return false;
+	return cueIndex.findAfter(time,index);
 }
 
 const string CSound::getUnusedCueName(const string &prefix) const
 {
-	// ??? containsCue is not the most efficient, but we're not talking about huge amounts of data here
 	for(unsigned t=1;t<200;t++)
 	{
 		if(!containsCue(prefix+istring(t)))
@@ -2184,34 +2616,84 @@ void CSound::adjustCues(const sample_pos_t pos1,const sample_pos_t pos2)
 	if(!adjustCuesOnSpaceChanges)
 		return;
 
+	vector<size_t> indexes;
+	sample_pos_t delta;
 	if(pos1<pos2)
 	{ // added data
-		sample_pos_t addedLength=pos2-pos1;
-		for(size_t t=0;t<getCueCount();t++)
-		{
-			if(isCueAnchored(t))
-				continue; // ignore
-
-			if(getCueTime(t)>=pos1)
-				setCueTime(t,getCueTime(t)+addedLength);
-		}
+		cueIndex.offsetTimes(pos1,delta=pos2-pos1,indexes);
 	}
 	else // if(pos2<=pos1)
 	{ // removed data
-		sample_pos_t removedLength=pos1-pos2;
-		for(size_t t=0;t<getCueCount();t++)
+		if(pos1-pos2>1)
 		{
-			if(isCueAnchored(t))
-				continue; // ignore
-
-			if(getCueTime(t)>pos2 && getCueTime(t)<pos1)
-				removeCue(t--);
-			else if(getCueTime(t)>=pos1)
-				setCueTime(t,getCueTime(t)-removedLength);
+			// remove the cues within the removed space (from the last so the indexes of the rest don't change)
+			cueIndex.getUnanchoredInRange(pos2+1,pos1,indexes);
+			sort(indexes.begin(),indexes.end());
+			for(size_t t=indexes.size();t>0;t--)
+				removeCue(indexes[t-1]);
 		}
 
+		cueIndex.offsetTimes(pos1,delta=pos2-pos1,indexes);
 	}
 
+	// cueIndex has already been updated, write the new times to the pool in the order they're stored
+	sort(indexes.begin(),indexes.end());
+	for(size_t t=0;t<indexes.size();t++)
+		(*cueAccesser)[indexes[t]].time+=delta;
+}
+
+/*
+ * This does what adjustCues(where+removeLength,where) then adjustCues(where,where+insertLength)
+ * for each edit from the last to the first would do, but in one pass over the cues
+ */
+void CSound::adjustCues(const vector<RSpaceEdit> &edits)
+{
+	if(!adjustCuesOnSpaceChanges || edits.empty())
+		return;
+
+	// delta[i] is how far the edits before edits[i] move the positions at or after edits[i].where
+	vector<sample_pos_t> delta(edits.size());
+	delta[0]=0;
+	for(size_t t=1;t<edits.size();t++)
+		delta[t]=delta[t-1]+edits[t-1].insertLength-edits[t-1].removeLength;
+
+	CCuePoolAccesser &cues=*cueAccesser;
+	const sample_pos_t cueCount=cues.getSize();
+	sample_pos_t kept=0;
+	for(sample_pos_t t=0;t<cueCount;t++)
+	{
+		RCue cue=cues[t];
+		if(!cue.isAnchored)
+		{
+			const sample_pos_t time=cue.time;
+
+			// find the last edit at or before the cue
+			size_t i=edits.size();
+			for(size_t l=0,h=edits.size();l<h;)
+			{
+				const size_t m=(l+h)/2;
+				if(edits[m].where<=time)
+				{
+					i=m;
+					l=m+1;
+				}
+				else
+					h=m;
+			}
+
+			if(i<edits.size())
+			{
+				const RSpaceEdit &edit=edits[i];
+				if(time>edit.where && time<edit.where+edit.removeLength)
+					continue; // removed
+				cue.time=time+delta[i]+edit.insertLength-(time>=edit.where+edit.removeLength ? edit.removeLength : 0);
+			}
+		}
+		cues[kept++]=cue;
+	}
+	if(kept<cueCount)
+		cues.remove(kept,cueCount-kept);
+
 	// update cueIndex
 	rebuildCueIndex();
 }
@@ -2245,7 +2727,10 @@ void CSound::rebuildCueIndex()
 	cueIndex.clear();
 
 	for(size_t t=0;t<cueAccesser->getSize();t++)
-		cueIndex.insert(map<sample_pos_t,size_t>::value_type(getCueTime(t),t));
+	{
+		const RCue &cue=(*cueAccesser)[t];
+		cueIndex.append(cue.name,cue.time,cue.isAnchored);
+	}
 }
 
 // -----------------------------------------------------
@@ -27,8 +27,11 @@
 
 #include <string>
 #include <map>
+#include <vector>
+#include <mutex>
 
 #include "CSound_defs.h"
+#include "CCueIndex.h"
 #include <endian_util.h>
 
 // it would be nice if I didn't have to include all this ???
@@ -48,6 +51,7 @@ public:
 private:
 	friend class CSound;
 	bool dirty;
+	uint32_t size; // number of samples this chunk covers (at most PEAK_CHUNK_SIZE)
 };
 
 class CSound
@@ -99,6 +103,15 @@ public:
 	void invalidatePeakData(const bool doChannel[MAX_CHANNELS],sample_pos_t start,sample_pos_t stop);
 	void invalidateAllPeakData();
 
+	/*
+	 * - Returns the range of sample positions (in any channel) whose peak data has been invalidated 
+	 *   or whose audio was moved since the last call, and resets it.  Returns false if nothing changed
+	 * - This is meant for a view that caches what it has rendered so that it only has to throw
+	 *   away the part of its cache which is now stale
+	 * - Space added or removed is reported from the point of the change through the end of the sound
+	 */
+	bool getInvalidatedPeakRange(sample_pos_t &start,sample_pos_t &stop);
+
 
 
 	sample_pos_t getLength() const		{ return size; }
@@ -164,6 +177,24 @@ public:
 	void removeSpace(const bool whichChannels[MAX_CHANNELS],sample_pos_t where,sample_pos_t length,sample_pos_t maxLength=NIL_SAMPLE_POS);
 
 
+	struct RSpaceEdit
+	{
+		sample_pos_t where;		// position before any of the edits are made
+		sample_pos_t removeLength;	// samples to remove starting at where
+		sample_pos_t insertLength;	// samples of space to insert at where in place of the removed ones
+	};
+
+	/*
+	 * - Makes all the given removals and insertions of space to all channels at once
+	 * - edits must be sorted by where and the removed ranges must not overlap
+	 * - The result is the same as calling removeSpace() and addSpace() for each edit from the last
+	 *   to the first, but the audio pools, peak chunks and cues are each updated in one pass
+	 *   which makes a difference when there are thousands of edits
+	 * - If 'doZeroData' is true, then the newly created space will be initialized to zero
+	 */
+	void editSpace(const vector<RSpaceEdit> &edits,bool doZeroData=false);
+
+
 	/*
 	 * - Moves 'length' samples of data from position 'where' for each channel where whichChannels[i] is true to a newly created temporary pool in the pool file for this sound object
 	 * - If all channels were not affected, then each channel that was affected will have 'length' samples of silence appended to it
@@ -216,6 +247,22 @@ public:
 	 */
 	void removeTempAudioPools(unsigned tempAudioPoolKey);
 
+	/*
+	 * - Replaces the temporary pools associated with 'tempAudioPoolKey' with a losslessly compressed copy of
+	 *   their audio (see lossless_sample_codec.h) and returns the number of bytes the compressed copy uses
+	 * - The temp peak chunk pools are dropped; moving the data back into a channel recalculates them
+	 * - Nothing is done for channels that have no temp pool or have already been compressed
+	 * - decompressTempAudioPools() must be called before the temp pools are used again
+	 */
+	uint64_t compressTempAudioPools(unsigned tempAudioPoolKey);
+	void decompressTempAudioPools(unsigned tempAudioPoolKey);
+
+	// returns the number of bytes used by the temporary pools associated with 'tempAudioPoolKey' (compressed or not)
+	uint64_t getTempAudioPoolsSize(unsigned tempAudioPoolKey) const;
+
+	// returns the key that will be returned by the next method that creates temporary pools (keys only increase)
+	unsigned getNextTempAudioPoolKey() const { return tempAudioPoolKeyCounter; }
+
 	// rotates 'amount' samples of data in the specified channel to the left or right between the 'start' and 'stop' positions
 	void rotateLeft(const bool whichChannels[MAX_CHANNELS],const sample_pos_t start,const sample_pos_t stop,const sample_pos_t amount);
 	void rotateRight(const bool whichChannels[MAX_CHANNELS],const sample_pos_t start,const sample_pos_t stop,const sample_pos_t amount);
@@ -445,6 +492,7 @@ private:
 
 	void addSpaceToChannel(unsigned channel,sample_pos_t where,sample_pos_t length,bool doZeroData);
 	void removeSpaceFromChannel(unsigned channel,sample_pos_t where,sample_pos_t length);
+	void editSpaceOfChannel(unsigned channel,const vector<RSpaceEdit> &edits,bool doZeroData);
 	void copyDataFromChannel(unsigned tempAudioPoolKey,unsigned channel,sample_pos_t where,sample_pos_t length);
 	void moveDataOutOfChannel(unsigned tempAudioPoolKey,unsigned channel,sample_pos_t where,sample_pos_t length);
 	void moveDataIntoChannel(unsigned tempAudioPoolKey,unsigned channelInTempPool,unsigned channelInAudio,sample_pos_t where,sample_pos_t length,bool removeTempAudioPool);
@@ -476,6 +524,13 @@ private:
 
 	typedef TPoolAccesser<RPeakChunk,PoolFile_t > CPeakChunkRezPoolAccesser;
 	CPeakChunkRezPoolAccesser *peakChunkAccessers[MAX_CHANNELS];
+	vector<sample_pos_t> peakChunkStarts[MAX_CHANNELS]; // the sample position where each peak chunk begins plus a last entry for the channel's length
+
+	mutable std::mutex peakChunkMutex; // getPeakData() and invalidatePeakData() may be called from other threads than the one that's drawing (e.g. a waveform render thread) while the size is locked
+
+	mutable std::mutex invalidatedPeakRangeMutex;
+	sample_pos_t invalidatedPeakStart,invalidatedPeakStop; // nothing is invalidated when start>stop
+	void noteInvalidatedPeakRange(sample_pos_t start,sample_pos_t stop);
 
 	unsigned tempAudioPoolKeyCounter;
 
@@ -484,10 +539,11 @@ private:
 
 	typedef TPoolAccesser<RCue,PoolFile_t> CCuePoolAccesser;
 	CCuePoolAccesser *cueAccesser;
-	map<sample_pos_t,size_t> cueIndex; // index into cueAccesser by time
+	CCueIndex cueIndex; // indexes into cueAccesser by time and by name
 	bool adjustCuesOnSpaceChanges;
 
 	void adjustCues(const sample_pos_t pos1,const sample_pos_t pos2);
+	void adjustCues(const vector<RSpaceEdit> &edits);
 	void createCueAccesser();
 	void deleteCueAccesser();
 	void rebuildCueIndex();
@@ -497,10 +553,19 @@ private:
 
 	void createPeakChunkAccessers();
 	void deletePeakChunkAccessers();
-	
-	static sample_pos_t calcPeakChunkCount(sample_pos_t givenSize);
+
+	// peak chunk maintenance for when the audio is structurally modified (the chunks move along with the audio)
+	size_t findPeakChunk(unsigned channel,sample_pos_t where) const;
+	size_t splitPeakChunk(unsigned channel,sample_pos_t where);
+	void joinPeakChunks(unsigned channel,size_t index);
+	size_t insertPeakChunks(unsigned channel,size_t index,sample_pos_t length,bool zeroed);
+	void removePeakChunks(unsigned channel,size_t firstIndex,size_t lastIndex);
+	void rebuildPeakChunkStarts(unsigned channel,size_t firstIndex,size_t lastIndex);
+
+	static const string createTempPeakChunkPoolName(unsigned tempAudioPoolKey,unsigned channel);
 
 	static const string createTempAudioPoolName(unsigned tempAudioPoolKey,unsigned channel);
+	static const string createCompressedTempAudioPoolName(unsigned tempAudioPoolKey,unsigned channel);
 	CInternalRezPoolAccesser createTempAudioPool(unsigned tempAudioPoolKey,unsigned channel);
 	void removeAllTempAudioPools();
 
@@ -28,11 +28,14 @@
 #include <utility>
 
 #include <istring>
+#include <CTrace.h>
 
 #include "CSound.h"
 #include "ASoundPlayer.h"
 #include "DSP/TSoundStretcher.h"
 #include "settings.h"
+#include "rt_allocation_check.h"
+#include "APreviewProcessor.h"
 
 	// ??? I need to make the FRAMES_PER_CHUNK value depend on the sample rate (and put a min on it) so that sound of a lower sample rate dont have a playposition with less resolution
 	//   make the macro just resolve to a data-member which has been calculated from the sampleRate .. it's almost never used in a stack array's size
@@ -91,12 +94,16 @@
 CSoundPlayerChannel::CSoundPlayerChannel(ASoundPlayer *_player,CSound *_sound) :
 	sound(_sound),
 	prebufferPosition(0),
+	previewProcessorChanged(false),
+	previewNextPosition(MAX_LENGTH),
 	prebufferThread(this),
 
 	framesConsumedFromAudioPipe(0),
 
 	prebufferedAudioPipe(1),
 	prebufferedPositionsPipe(1),
+
+	mixingState((RMixingState *)allocLockedMemory(sizeof(RMixingState))),
 	
 	prepared_channelCount(0),
 	prepared_sampleRate(0),
@@ -119,7 +126,11 @@ CSoundPlayerChannel::CSoundPlayerChannel(ASoundPlayer *_player,CSound *_sound) :
 		// start out with something selected
 	startPosition(sound->getLength()/2-sound->getLength()/4),
 	stopPosition(sound->getLength()/2+sound->getLength()/4),
-	outputRoute(0)
+	outputRoute(0),
+
+	compiledRoutes(NULL),
+	compiledRouteCount(0),
+	compiledRouteCapacity(0)
 {
 	for(size_t t=0;t<MAX_CHANNELS;t++) {
 		muted[t]=false;
@@ -135,6 +146,9 @@ CSoundPlayerChannel::CSoundPlayerChannel(ASoundPlayer *_player,CSound *_sound) :
 CSoundPlayerChannel::~CSoundPlayerChannel()
 {
 	deinit();
+
+	freeLockedMemory(compiledRoutes,compiledRouteCapacity*sizeof(RCompiledRoute));
+	freeLockedMemory(mixingState,sizeof(RMixingState));
 }
 
 CSound *CSoundPlayerChannel::getSound() const
@@ -168,7 +182,7 @@ void CSoundPlayerChannel::play(sample_pos_t position,LoopTypes _loopType,bool _p
 
 	// zero out previous frame for interpolation
 	for(size_t t=0;t<MAX_CHANNELS;t++)
-		prevLast2Frames[0][t]=prevLast2Frames[1][t]=0;
+		mixingState->prevLast2Frames[0][t]=mixingState->prevLast2Frames[1][t]=0;
 	prevLastFrameOffset=0.0;
 
 	if(_loopType==ltLoopNone && !_playSelectionOnly)
@@ -603,10 +617,13 @@ void CSoundPlayerChannel::mixOntoBuffer(const unsigned nChannels,sample_t * cons
 		return;
 
 	// protecting from any method that also reads/clears the prebuffering queue
-	std::unique_lock<std::mutex> l(prebufferReadingMutex, std::try_to_lock); // ??? the mutex needs to be locked in RAM (perhaps just the whole *this object if possible)
+	std::unique_lock<std::mutex> l(prebufferReadingMutex, std::try_to_lock);
 	if(!l.owns_lock())
 		return;
 
+	TRACE_SCOPE("CSoundPlayerChannel::mixOntoBuffer");
+	TRACE_COUNTER("prebuffered audio samples",prebufferedAudioPipe.getSize());
+
 #if 0 // printout of prebuffered status
 	printf("\r                                                                         \r");
 	for(int t=0;t<prebufferedPositionsPipe.getSize();t++)
@@ -619,6 +636,8 @@ void CSoundPlayerChannel::mixOntoBuffer(const unsigned nChannels,sample_t * cons
 		// here the pipe has emptied and we're no longer prebuffering so go ahead and shut down the playing state
 		if(!prebuffering)
 			playingHasEnded(); /* ??? Eeek.. this could affect JACK .. does trip() call the function directly or schedule it to happen?  does the event do anything indeterminate .. moreover the Trigger object needs to be locked in RAM (would be if whole object was locked)*/
+		else
+			player->prebufferUnderrunCount++; // the prebuffering thread hasn't kept up
 		return;
 	}
 	
@@ -629,9 +648,8 @@ void CSoundPlayerChannel::mixOntoBuffer(const unsigned nChannels,sample_t * cons
 
 	const unsigned channelCount=prepared_channelCount;
 
-	#define READ_SIZE ((size_t)4096)
-	sample_t _readBuffer[(READ_SIZE+2)*MAX_CHANNELS]; /* ??? for JACK, needs to be locked from swapping out .. is stack, so can that happen?  perhaps this needs to point to a std::vector with locked-memory allocator*/
-	sample_t *readBuffer=_readBuffer+(2*MAX_CHANNELS); // make readBuffer have two valid frames worth of space before the pointer for interpolation purposes
+	sample_t (* const prevLast2Frames)[MAX_CHANNELS]=mixingState->prevLast2Frames;
+	sample_t * const readBuffer=mixingState->readBuffer+(2*MAX_CHANNELS); // make readBuffer have two valid frames worth of space before the pointer for interpolation purposes
 
 	sample_t *oBuffer=_oBuffer;
 	int outputBufferLength=_oBufferLength;
@@ -663,7 +681,7 @@ void CSoundPlayerChannel::mixOntoBuffer(const unsigned nChannels,sample_t * cons
 			}
 
 			framesRead=min(gapSignalLength-gapSignalPosition,
-					min((sample_pos_t)READ_SIZE, (sample_pos_t)maxFramesToRead)
+					min((sample_pos_t)MIX_READ_SIZE, (sample_pos_t)maxFramesToRead)
 				);
 			memcpy(readBuffer,gapSignalBuffer.data()+(gapSignalPosition*channelCount),framesRead*channelCount*sizeof(sample_t));
 			gapSignalPosition+=framesRead;
@@ -671,9 +689,13 @@ void CSoundPlayerChannel::mixOntoBuffer(const unsigned nChannels,sample_t * cons
 		else
 		{ // read data from audio pipe
 			//                    maxFramesToRead could be 0 at very low play speeds
-			const int samplesRead=maxFramesToRead>0 ? prebufferedAudioPipe.read(readBuffer,min(READ_SIZE,(size_t)(maxFramesToRead*channelCount)),false) : 0;
+			const int samplesRead=maxFramesToRead>0 ? prebufferedAudioPipe.read(readBuffer,min(MIX_READ_SIZE,(size_t)(maxFramesToRead*channelCount)),false) : 0;
 			if(samplesRead<=0)
+			{
+				if(maxFramesToRead>0 && prebuffering)
+					player->prebufferUnderrunCount++; // ran out part way through the buffer
 				break; // no data available
+			}
 
 			framesRead=samplesRead/channelCount;
 
@@ -708,20 +730,24 @@ void CSoundPlayerChannel::mixOntoBuffer(const unsigned nChannels,sample_t * cons
 
 		bool didOutput=false;
 		const size_t _outputLengthToUse=outputLengthToUse*nChannels;
+		size_t r=0; // index into compiledRoutes
 		for(unsigned i=0;i<channelCount;i++)
 		{
-			if(!muted[i])  // ??? this memory needs to be locked for JACK's sake
+			const size_t firstRoute=r;
+			while(r<compiledRouteCount && compiledRoutes[r].audioChannel==i)
+				r++;
+
+			if(!muted[i])
 			{
 				// populate for interpolation
 				readBuffer[-(2*(int)channelCount)+(int)i]=prevLast2Frames[0][i]; 
 				readBuffer[-   (int)channelCount +(int)i]=prevLast2Frames[1][i];
 				const sample_t * const rreadBuffer=readBuffer-(2*channelCount);
 
-				const vector<bool> outputRouting=getOutputRoute(0,i); // ??? this needs to be put into a data member of memory NOT TO BE SWAPPED for jack's sake and it needs to be updated in updateAfterEdit()
-
-				for(size_t outputDeviceChannel=0;outputDeviceChannel<outputRouting.size();outputDeviceChannel++)
+				for(size_t route=firstRoute;route<r;route++)
 				{
-					if(outputRouting[outputDeviceChannel])
+					const unsigned outputDeviceChannel=compiledRoutes[route].deviceChannel;
+					if(outputDeviceChannel<nChannels)
 					{
 						sample_t *ooBuffer=oBuffer+outputDeviceChannel;
 
@@ -804,6 +830,8 @@ bool CSoundPlayerChannel::prebufferChunk()
 	if(paused && seekSpeed==1.0/*not seeking*/)
 		return false;
 
+	TRACE_SCOPE("CSoundPlayerChannel::prebufferChunk");
+
 	CSoundLocker sl(sound, false);
 	std::unique_lock<std::mutex> l(prebufferPositionMutex); /* ??? might be renaming this to prebufferWritingMutex */ 
 
@@ -982,6 +1010,9 @@ bool CSoundPlayerChannel::prebufferChunk()
 		}
 	}
 
+	if(previewProcessor || previewProcessorChanged)
+		runPreviewProcessor(buffer,bufferUsed/channelCount,prebufferPositionToWrite,pos1,pos2,positionInc>0 && playSpeedForPrebuffering==0,loopType);
+
 	// can unlock this now
 	sl.unlock();
 
@@ -1011,6 +1042,59 @@ bool CSoundPlayerChannel::prebufferChunk()
 	return ret;
 }
 
+void CSoundPlayerChannel::setPreviewProcessor(APreviewProcessor *processor)
+{
+	{
+		std::unique_lock<std::mutex> l(previewProcessorMutex);
+		pendingPreviewProcessor.reset(processor);
+		previewProcessorChanged=true;
+	}
+
+	// start prebuffering over from what's being heard now
+	unprebuffer(seekSpeed,startPosition,stopPosition);
+}
+
+// called from prebufferChunk() with prebufferPositionMutex locked
+void CSoundPlayerChannel::runPreviewProcessor(sample_t *buffer,size_t frameCount,sample_pos_t position,sample_pos_t loopStart,sample_pos_t loopStop,bool forward,LoopTypes loopType)
+{
+	{
+		std::unique_lock<std::mutex> l(previewProcessorMutex);
+		if(previewProcessorChanged)
+		{
+			previewProcessor=std::move(pendingPreviewProcessor);
+			previewProcessorChanged=false;
+			previewNextPosition=MAX_LENGTH;
+		}
+	}
+
+	if(!previewProcessor || frameCount<=0)
+		return;
+
+	if(!forward)
+	{ // the DSP doesn't make sense backwards or when skipping chunks to seek, just start it over when normal play resumes
+		previewNextPosition=MAX_LENGTH;
+		return;
+	}
+
+	if(position!=previewNextPosition)
+		previewProcessor->reset();
+
+	// the chunk wraps around to loopStart after loopStop if looping
+	size_t framesBeforeLoop=frameCount;
+	if(loopType!=ltLoopNone && position<=loopStop)
+		framesBeforeLoop=(size_t)min<sample_pos_t>(frameCount,loopStop-position+1);
+
+	previewProcessor->process(buffer,prepared_channelCount,framesBeforeLoop,position);
+	previewNextPosition=position+framesBeforeLoop;
+
+	if(framesBeforeLoop<frameCount)
+	{
+		previewProcessor->reset();
+		previewProcessor->process(buffer+framesBeforeLoop*prepared_channelCount,prepared_channelCount,frameCount-framesBeforeLoop,loopStart);
+		previewNextPosition=loopStart+(frameCount-framesBeforeLoop);
+	}
+}
+
 const vector<int16_t> CSoundPlayerChannel::getOutputRoutes() const
 {
 	vector<int16_t> v;
@@ -1067,6 +1151,7 @@ void CSoundPlayerChannel::updateAfterEdit(const vector<int16_t> &restoreOutputRo
 			a.clear();
 			createInitialOutputRoute();
 		}
+		compileOutputRoutes();
 
 		// reopen prebuffering queue
 		prebufferedAudioPipe.open();
@@ -1271,6 +1356,42 @@ const vector<bool> CSoundPlayerChannel::getOutputRoute(unsigned deviceIndex,unsi
 	return row;
 }
 
+/*
+	Rebuilds compiledRoutes from the output route table.  The caller must hold
+	prebufferReadingMutex.
+ */
+void CSoundPlayerChannel::compileOutputRoutes()
+{
+	const unsigned audioChannelCount=sound->getChannelCount();
+
+	vector<RCompiledRoute> routes;
+	for(unsigned i=0;i<audioChannelCount;i++)
+	{
+		const vector<bool> row=getOutputRoute(0,i);
+		for(size_t t=0;t<row.size();t++)
+		{
+			if(row[t])
+			{
+				RCompiledRoute route;
+				route.audioChannel=i;
+				route.deviceChannel=t;
+				routes.push_back(route);
+			}
+		}
+	}
+
+	if(routes.size()>compiledRouteCapacity)
+	{
+		RCompiledRoute *temp=(RCompiledRoute *)allocLockedMemory(routes.size()*sizeof(RCompiledRoute));
+		freeLockedMemory(compiledRoutes,compiledRouteCapacity*sizeof(RCompiledRoute));
+		compiledRoutes=temp;
+		compiledRouteCapacity=routes.size();
+	}
+
+	std::copy(routes.begin(),routes.end(),compiledRoutes);
+	compiledRouteCount=routes.size();
+}
+
 
 
 // --- Prebuffering Thread ---------------------------
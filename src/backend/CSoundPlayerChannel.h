@@ -26,6 +26,7 @@
 #include <vector>
 #include <condition_variable>
 #include <mutex>
+#include <atomic>
 
 #include "../../config/common.h"
 
@@ -36,6 +37,7 @@ class CSoundPlayerChannel;
 #include "CTrigger.h"
 #include "CSound_defs.h"
 class ASoundPlayer;
+class APreviewProcessor;
 
 class CSoundPlayerChannel
 {
@@ -88,6 +90,11 @@ public:
 	// pass an empty vector if this is not to restore, but possibly recreate the output routes
 	void updateAfterEdit(const vector<int16_t> &restoreOutputRoutes);
 
+	// runs the audio being played through the given processor (to preview an action) until it's
+	// set to something else or NULL.  Takes ownership of processor.  What was already prebuffered
+	// is discarded so that the change is heard right away.
+	void setPreviewProcessor(APreviewProcessor *processor);
+
 private: /* for ASoundPlayer only */
 	friend class ASoundPlayer;
 	CSoundPlayerChannel(ASoundPlayer *_player,CSound *_sound);
@@ -106,6 +113,14 @@ private: /* for ASoundPlayer only */
 	sample_pos_t prebufferPosition;
 	bool prebufferChunk();
 
+	// the preview processor is only used by prebufferChunk(); setPreviewProcessor() hands over a new one through pendingPreviewProcessor
+	std::unique_ptr<APreviewProcessor> previewProcessor;
+	std::unique_ptr<APreviewProcessor> pendingPreviewProcessor;
+	std::atomic<bool> previewProcessorChanged; // (atomic since prebufferChunk() peeks at it without previewProcessorMutex)
+	std::mutex previewProcessorMutex;
+	sample_pos_t previewNextPosition; // the position that would follow the last processed frame, or MAX_LENGTH after a reset
+	void runPreviewProcessor(sample_t *buffer,size_t frameCount,sample_pos_t position,sample_pos_t loopStart,sample_pos_t loopStop,bool forward,LoopTypes loopType);
+
 	void playingHasEnded();
 
 	class CPrebufferThread
@@ -136,8 +151,15 @@ private: /* for ASoundPlayer only */
 
 
 
-	sample_t prevLast2Frames[2][MAX_CHANNELS]; // ??? for JACK, this needs to be locked from swapping
-	sample_fpos_t prevLastFrameOffset; // ??? for JACK, this needs to be locked from swapping
+	// mixOntoBuffer() is called from the audio I/O callback which, with JACK, is a real-time thread, so
+	// its buffers are allocated once with allocLockedMemory() rather than on its stack or the heap
+	#define MIX_READ_SIZE ((size_t)4096)
+	struct RMixingState
+	{
+		sample_t prevLast2Frames[2][MAX_CHANNELS];
+		sample_t readBuffer[(MIX_READ_SIZE+2)*MAX_CHANNELS];
+	} *mixingState;
+	sample_fpos_t prevLastFrameOffset;
 
 	unsigned prepared_channelCount;
 	unsigned prepared_sampleRate;
@@ -178,6 +200,18 @@ private: /* for ASoundPlayer only */
 
 	void createInitialOutputRoute();
 	const vector<bool> getOutputRoute(unsigned deviceIndex,unsigned audioChannel) const;
+
+	// the output route table for device 0 compiled down to the (audio channel, device channel) pairs
+	// which are on, ordered by audio channel, so mixOntoBuffer() never has to read the pool file.  It
+	// is rebuilt by compileOutputRoutes() only while prebufferReadingMutex keeps mixOntoBuffer() out
+	struct RCompiledRoute
+	{
+		unsigned audioChannel;
+		unsigned deviceChannel;
+	};
+	RCompiledRoute *compiledRoutes; // allocated with allocLockedMemory()
+	size_t compiledRouteCount,compiledRouteCapacity;
+	void compileOutputRoutes();
 };
 
 #endif
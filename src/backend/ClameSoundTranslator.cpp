@@ -39,6 +39,9 @@
 #include "CSound.h"
 #include "AFrontendHooks.h"
 #include "AStatusComm.h"
+#include "CPipeStreamer.h"
+#include "sample_conversion.h"
+#include "settings.h"
 
 static string gPathToLame="";
 
@@ -185,6 +188,11 @@ bool ClameSoundTranslator::onLoadSound(const string filename,CSound *sound) cons
 		std::vector<int8_t> mem_buffer((bits/8)*BUFFER_SIZE*channelCount); // set this up so it deallocates itself
 		void * const buffer=mem_buffer.data();
 
+		std::vector<sample_t> channelBuffer(BUFFER_SIZE*channelCount);
+		sample_t *channels[MAX_CHANNELS];
+		for(unsigned c=0;c<channelCount;c++)
+			channels[c]=channelBuffer.data()+c*BUFFER_SIZE;
+
 		sample_pos_t pos=0;
 
 		CStatusBar statusBar("Loading Sound",0,100,true);
@@ -199,11 +207,12 @@ bool ClameSoundTranslator::onLoadSound(const string filename,CSound *sound) cons
 
 			if(bits==16)
 			{
+				lethe_many((int16_t *)buffer,chunkSize*channelCount);
+				deinterleaveSamples((const int16_t *)buffer,channelCount,channels,chunkSize);
 				for(unsigned c=0;c<channelCount;c++)
 				{
-					CRezPoolAccesser &accesser=*(accessers[c]);
-					for(unsigned i=0;i<chunkSize;i++)
-						accesser[pos+i]=convert_sample<int16_t,sample_t>(lethe(((int16_t *)buffer)[i*channelCount+c]));
+					accessers[c]->seek(pos);
+					accessers[c]->write(channels[c],chunkSize);
 				}
 			}
 			else
@@ -349,7 +358,6 @@ bool ClameSoundTranslator::onSaveSound(const string filename,const CSound *sound
 			throw runtime_error(string(__func__)+" -- lame aborted -- check stderr for more information");
 
 		waveHeader.convertToLE();
-		fwrite(&waveHeader,1,sizeof(waveHeader),p);
 
 		for(unsigned t=0;t<channelCount;t++)
 			accessers[t]=new CRezPoolAccesser(sound->getAudio(t));
@@ -357,44 +365,54 @@ bool ClameSoundTranslator::onSaveSound(const string filename,const CSound *sound
 		#define BUFFER_SIZE 4096
 
 		std::vector<int16_t> buffer(BUFFER_SIZE*channelCount);
+		std::vector<sample_t> interleavedBuffer(BUFFER_SIZE*channelCount);
+		std::vector<sample_t> channelBuffer(BUFFER_SIZE*channelCount);
+		sample_t *channels[MAX_CHANNELS];
+		for(unsigned c=0;c<channelCount;c++)
+			channels[c]=channelBuffer.data()+c*BUFFER_SIZE;
+		RSampleDither dither((RSampleDither::DitherTypes)gExportDither,channelCount);
 		sample_pos_t pos=0;
 
-		CStatusBar statusBar(_("Saving Sound"),0,saveLength,true);
-		while(pos<saveLength)
 		{
-			size_t chunkSize=BUFFER_SIZE;
-			if(pos+chunkSize>saveLength)
-				chunkSize=saveLength-pos;
+			// lame encodes while we read and convert the next buffer
+			CPipeStreamer stream(fileno(p));
+			stream.write(&waveHeader,sizeof(waveHeader));
 
-			for(unsigned c=0;c<channelCount;c++)
+			CStatusBar statusBar(_("Saving Sound"),0,saveLength,true);
+			while(pos<saveLength)
 			{
-				const CRezPoolAccesser &accesser=*(accessers[c]);
-				for(unsigned i=0;i<chunkSize;i++)
-					buffer[i*channelCount+c]=hetle( (convert_sample<sample_t,int16_t>(accesser[pos+i+saveStart])) );
-			}
+				size_t chunkSize=BUFFER_SIZE;
+				if(pos+(sample_pos_t)chunkSize>saveLength)
+					chunkSize=saveLength-pos;
 
-			pos+=chunkSize;
+				for(unsigned c=0;c<channelCount;c++)
+				{
+					accessers[c]->seek(pos+saveStart);
+					accessers[c]->read(channels[c],chunkSize);
+				}
+				interleaveSamples(channels,channelCount,interleavedBuffer.data(),chunkSize);
+				convertSamples(interleavedBuffer.data(),buffer.data(),chunkSize*channelCount,&dither);
+				hetle_many(buffer.data(),chunkSize*channelCount);
+
+				pos+=chunkSize;
 
-			if(SIGPIPECaught)
-				throw runtime_error(string(__func__)+" -- lame aborted -- check stderr for more information");
-			if(fwrite(buffer.data(),sizeof(int16_t)*channelCount,chunkSize,p)!=chunkSize)
-				fprintf(stderr,"%s -- dropped some data while writing\n",__func__);
+				stream.write(buffer.data(),sizeof(int16_t)*channelCount*chunkSize);
 
-			if(statusBar.update(pos))
-			{ // cancelled
-				ret=false;
-				goto cancelled;
+				if(statusBar.update(pos))
+				{ // cancelled
+					ret=false;
+					break;
+				}
 			}
-		}
 
-		cancelled:
+			if(ret)
+				stream.finish();
+		}
 
 		for(unsigned t=0;t<MAX_CHANNELS;t++)
 			delete accessers[t];
 
 		pclose(p);
-
-		restoreOrigSIGPIPEHandler();
 	}
 	catch(...)
 	{
@@ -402,8 +420,6 @@ bool ClameSoundTranslator::onSaveSound(const string filename,const CSound *sound
 			delete accessers[t];
 
 		pclose(p);
-	
-		restoreOrigSIGPIPEHandler();
 
 		throw;
 	}
@@ -35,6 +35,7 @@
 #include "CSound.h"
 #include "AStatusComm.h"
 #include "AFrontendHooks.h"
+#include "sample_conversion.h"
 
 #if (LIBAUDIOFILE_MAJOR_VERSION*10000+LIBAUDIOFILE_MINOR_VERSION*100+LIBAUDIOFILE_MICRO_VERSION) >= /*000204*/204
 	#define HANDLE_CUES_AND_MISC
@@ -207,6 +208,10 @@ bool ClibaudiofileSoundTranslator::loadSoundGivenSetup(const string filename,CSo
 			accessers[t]=new CRezPoolAccesser(sound->getAudio(t));
 
 		std::vector<sample_t> buffer((size_t)(afGetVirtualFrameSize(h,AF_DEFAULT_TRACK,1)*4096/sizeof(sample_t)));
+		std::vector<sample_t> channelBuffer((size_t)(channelCount*4096));
+		sample_t *channels[MAX_CHANNELS];
+		for(unsigned c=0;c<channelCount;c++)
+			channels[c]=channelBuffer.data()+c*4096;
 		sample_pos_t pos=0;
 		CStatusBar statusBar(_("Loading Sound"),0,afGetFrameCount(h,AF_DEFAULT_TRACK),true);
 		for(;;)
@@ -218,10 +223,11 @@ bool ClibaudiofileSoundTranslator::loadSoundGivenSetup(const string filename,CSo
 				if((pos+read)>accessers[0]->getSize())
 					sound->addSpace(sound->getLength(),10*sampleRate);
 
+				deinterleaveSamples(buffer.data(),channelCount,channels,read);
 				for(unsigned c=0;c<channelCount;c++)
 				{
-					for(int i=0;i<read;i++)
-						(*(accessers[c]))[pos+i]=buffer[i*channelCount+c];
+					accessers[c]->seek(pos);
+					accessers[c]->write(channels[c],read);
 				}
 				pos+=read;
 			}
@@ -515,6 +521,10 @@ bool ClibaudiofileSoundTranslator::saveSoundGivenSetup(const string filename,con
 			
 			// save the audio data
 			std::vector<sample_t> buffer((size_t)(channelCount*4096));
+			std::vector<sample_t> channelBuffer((size_t)(channelCount*4096));
+			sample_t *channels[MAX_CHANNELS];
+			for(unsigned c=0;c<channelCount;c++)
+				channels[c]=channelBuffer.data()+c*4096;
 			sample_pos_t pos=0;
 			AFframecount count=saveLength/4096;
 			CStatusBar statusBar(_("Saving Sound"),0,saveLength,true);
@@ -525,9 +535,10 @@ bool ClibaudiofileSoundTranslator::saveSoundGivenSetup(const string filename,con
 				{
 					for(unsigned c=0;c<channelCount;c++)
 					{
-						for(int i=0;i<chunkSize;i++)
-							buffer[i*channelCount+c]=(*(accessers[c]))[pos+i+saveStart];
+						accessers[c]->seek(pos+saveStart);
+						accessers[c]->read(channels[c],chunkSize);
 					}
+					interleaveSamples(channels,channelCount,buffer.data(),chunkSize);
 					if(afWriteFrames(h,AF_DEFAULT_TRACK,buffer.data(),chunkSize)!=chunkSize)
 						throw runtime_error(string(__func__)+" -- error writing audio data -- "+errorMessage);
 					pos+=chunkSize;
@@ -54,6 +54,7 @@
 #include "CSound.h"
 #include "AStatusComm.h"
 #include "AFrontendHooks.h"
+#include "sample_conversion.h"
 
 
 #ifdef WORDS_BIGENDIAN
@@ -272,6 +273,9 @@ bool ClibvorbisSoundTranslator::onLoadSound(const string filename,CSound *sound)
 		#define BIT_RATE 16
 
 		std::vector<sample_t> mem_buffer(4096);
+#if defined(SAMPLE_TYPE_S16)
+		std::vector<sample_t> channelBuffer(mem_buffer.size()); // the frames are deinterleaved into this
+#endif
 		sample_pos_t pos=0;
 		
 		int eof=0;
@@ -303,21 +307,22 @@ bool ClibvorbisSoundTranslator::onLoadSound(const string filename,CSound *sound)
 				if((pos+REALLOC_FILE_SIZE)>sound->getLength())
 					sound->addSpace(sound->getLength(),REALLOC_FILE_SIZE);
 
-				for(unsigned c=0;c<channelCount;c++)
-				{
-					CRezPoolAccesser &accesser=*(accessers[c]);
 #if defined(SAMPLE_TYPE_S16) 
-					// buffer points to frames of audio
-					for(int i=0;i<readLength;i++)
-						accesser[pos+i]=buffer[i*channelCount+c];
+				// buffer points to frames of audio
+				sample_t *channels[MAX_CHANNELS];
+				for(unsigned c=0;c<channelCount;c++)
+					channels[c]=channelBuffer.data()+c*readLength;
+				deinterleaveSamples(buffer,channelCount,channels,readLength);
 #elif defined(SAMPLE_TYPE_FLOAT)
-					// buffer points to arrays of samples of audio (1 array for each channel)
-					const float * const _buffer=buffer[c];
-					for(int i=0;i<readLength;i++)
-						accesser[pos+i]=_buffer[i];
+				// buffer points to arrays of samples of audio (1 array for each channel)
+				float * const * const channels=buffer;
 #else
-					#error unhandle SAMPLE_TYPE_xxx define
+				#error unhandle SAMPLE_TYPE_xxx define
 #endif
+				for(unsigned c=0;c<channelCount;c++)
+				{
+					accessers[c]->seek(pos);
+					accessers[c]->write(channels[c],readLength);
 				}
 
 				pos+=readLength;
@@ -484,7 +489,7 @@ bool ClibvorbisSoundTranslator::onSaveSound(const string filename,const CSound *
 	}
 
 
-	const CRezPoolAccesser *accessers[MAX_CHANNELS]={0};
+	CRezPoolAccesser *accessers[MAX_CHANNELS]={0};
 	for(unsigned t=0;t<channelCount;t++)
 		accessers[t]=new CRezPoolAccesser(sound->getAudio(t));
 
@@ -492,6 +497,8 @@ bool ClibvorbisSoundTranslator::onSaveSound(const string filename,const CSound *
 	{
 		#define CHUNK_SIZE 4096
 
+		std::vector<sample_t> chunkBuffer(CHUNK_SIZE);
+
 		ogg_packet op; // one Ogg bitstream page.  Vorbis packets are inside
 
 		sample_pos_t pos=0;
@@ -520,9 +527,9 @@ bool ClibvorbisSoundTranslator::onSaveSound(const string filename,const CSound *
 				const unsigned chunkSize= (t==chunkCount-1) ? (saveLength%CHUNK_SIZE) : CHUNK_SIZE;
 				for(unsigned c=0;c<channelCount;c++)
 				{
-					const CRezPoolAccesser &accesser=*(accessers[c]);
-					for(unsigned i=0;i<chunkSize;i++)
-						buffer[c][i]=convert_sample<sample_t,float>(accesser[pos+i+saveStart]);
+					accessers[c]->seek(pos+saveStart);
+					accessers[c]->read(chunkBuffer.data(),chunkSize);
+					convertSamples(chunkBuffer.data(),buffer[c],chunkSize);
 				}
 				pos+=chunkSize;
 
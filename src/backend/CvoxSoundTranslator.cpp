@@ -34,6 +34,7 @@
 #include "CSound.h"
 #include "AFrontendHooks.h"
 #include "AStatusComm.h"
+#include "CPipeStreamer.h"
 
 #include "settings.h"
 
@@ -210,6 +211,7 @@ bool CvoxSoundTranslator::onSaveSound(const string filename,const CSound *sound,
 		if(bits==16)
 		{
 			std::vector<int16_t> buffer(BUFFER_SIZE*channelCount);
+			CPipeStreamer stream(fileno(p));
 	
 			while(pos<saveLength)
 			{
@@ -225,30 +227,25 @@ bool CvoxSoundTranslator::onSaveSound(const string filename,const CSound *sound,
 				}
 				pos+=chunkSize;
 
-				if(SIGPIPECaught)
-					throw runtime_error(string(__func__)+" -- lame aborted -- check stderr for more information");
-
-				if(fwrite(buffer.data(),sizeof(int16_t)*channelCount,chunkSize,p)!=chunkSize)
-					fprintf(stderr,"%s -- dropped some data while writing\n",__func__);
+				stream.write(buffer.data(),sizeof(int16_t)*channelCount*chunkSize);
 
 				if(statusBar.update(pos))
 				{ // cancelled
 					ret=false;
-					goto cancelled;
+					break;
 				}
 			}
+
+			if(ret)
+				stream.finish();
 		}
 		else
 			throw runtime_error(string(__func__)+" -- internal error -- an unhandled bit rate of "+istring(bits));
 
-		cancelled:
-
 		for(unsigned t=0;t<MAX_CHANNELS;t++)
 			delete accessers[t];
 
 		pclose(p);
-
-		restoreOrigSIGPIPEHandler();
 	}
 	catch(...)
 	{
@@ -256,8 +253,6 @@ bool CvoxSoundTranslator::onSaveSound(const string filename,const CSound *sound,
 			delete accessers[t];
 
 		pclose(p);
-	
-		restoreOrigSIGPIPEHandler();
 
 		throw;
 	}
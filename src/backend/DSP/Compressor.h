@@ -23,10 +23,13 @@
 
 #include "../../config/common.h"
 
+#include <math.h>
+
 #include <algorithm>
 
 #include "../CSound_defs.h"
 
+#include "Delay.h"
 #include "LevelDetector.h"
 
 
@@ -102,14 +105,28 @@
  *
  * and this is as simple as I can get it
  *
+ * - processSamples() and processSampleFrames() are faster alternatives to calling processSample()
+ *   and processSampleFrame() for every sample.  They still follow the level and the attack and 
+ *   release every sample, but only calculate the gain every 'controlInterval' samples (and at the 
+ *   end of each call).  It's calculated in the log domain
+ *
+ * 	log2(g) = ((R-1)/(2*R)) * (log2(T^2) - log2(P))   (P being the level detector's power, L^2)
+ *
+ *   and the gain is linearly interpolated from one of these control points to the next.  They 
+ *   also delay the input by 'lookAheadTime' samples so that the gain reacts to the level that 
+ *   far ahead of the samples it's applied to (the output's first 'lookAheadTime' samples are 
+ *   whatever was in the delay line, silence).
+ *
  */
 class CDSPCompressor
 {
 public:
 	// all times are in samples
-	CDSPCompressor(unsigned _windowTime,sample_t _threshold,float _compressionRatio,unsigned _attackTime,unsigned _releaseTime) :
+	CDSPCompressor(unsigned _windowTime,sample_t _threshold,float _compressionRatio,unsigned _attackTime,unsigned _releaseTime,unsigned _lookAheadTime=0,unsigned _controlInterval=32) :
 		windowTime(_windowTime),
 		threshold(_threshold),
+		thresholdPower((double)_threshold*_threshold),
+		log2ThresholdPower(log2(thresholdPower)),
 		compressionRatio(_compressionRatio),
 
 		// have to take into account the ratio to be reached for the calculation 
@@ -118,7 +135,12 @@ public:
 		releaseVelocity((_compressionRatio-1.0)/_releaseTime),
 
 		bouncingRatio(1.0),
-		levelDetector(windowTime)
+		levelDetector(windowTime),
+
+		lookAheadTime(_lookAheadTime),
+		lookAheadFrameSize(0),
+		controlInterval(std::max(1u,std::min(_controlInterval,(unsigned)MAX_CONTROL_INTERVAL))),
+		prevGain(1.0f)
 	{
 		// ??? verify parameters?
 	}
@@ -130,17 +152,17 @@ public:
 	// using this is optional -- it is used to initialize the level detector -- see Note above
 	void initSample(const mix_sample_t s)
 	{
-		levelDetector.readLevel(s);
+		levelDetector.updateLevel(s);
 	}
 
 	const mix_sample_t processSample(const mix_sample_t inputSample,const mix_sample_t levelSample)
 	{
-		const mix_sample_t level=levelDetector.readLevel(levelSample);
+		const double power=levelDetector.readPower(levelSample);
 		
 		// ??? I need to allow compression ratio to also be less than 1 to act as an exciter
-		if(level>=threshold && bouncingRatio!=compressionRatio)
+		if(power>=thresholdPower && bouncingRatio!=compressionRatio)
 			bouncingRatio= min(bouncingRatio+attackVelocity,compressionRatio);
-		else if(level<threshold && bouncingRatio!=1.0)
+		else if(power<thresholdPower && bouncingRatio!=1.0)
 			bouncingRatio= max(bouncingRatio-releaseVelocity,1.0f);
 
 		// attempt to smooth out the way the attack sounds
@@ -148,7 +170,8 @@ public:
 		#define _bouncingRatio bouncingRatio
 
 		if(_bouncingRatio>1.0)
-			return (mix_sample_t)(inputSample * pow((double)threshold/(double)level,(_bouncingRatio-1.0)/_bouncingRatio) );
+			// (T/L)^e == (T^2/L^2)^(e/2) so the level never needs a sqrt
+			return (mix_sample_t)(inputSample * pow(thresholdPower/power,(_bouncingRatio-1.0)/(2.0*_bouncingRatio)) );
 		else
 			return inputSample;
 		
@@ -168,18 +191,17 @@ public:
 			levelSample=max(levelSample,l);
 		}
 			
-		const mix_sample_t level=levelDetector.readLevel(levelSample);
+		const double power=levelDetector.readPower(levelSample);
 		
 		// ??? I need to allow compression ratio to also be less than 1 to act as an exciter
-		if(level>=threshold && bouncingRatio!=compressionRatio)
+		if(power>=thresholdPower && bouncingRatio!=compressionRatio)
 			bouncingRatio= min(bouncingRatio+attackVelocity,compressionRatio);
-		else if(level<threshold && bouncingRatio!=1.0f)
+		else if(power<thresholdPower && bouncingRatio!=1.0f)
 			bouncingRatio= max(bouncingRatio-releaseVelocity,1.0f);
 
 		if(bouncingRatio>1.0f)
 		{
-			float g=pow((float)threshold/(float)level,(bouncingRatio-1.0f)/bouncingRatio);
-			//printf("%f=(%d/%d)**(%f/%f)\n",g,threshold,level,bouncingRatio-1.0,bouncingRatio);
+			float g=pow((float)(thresholdPower/power),(bouncingRatio-1.0f)/(2.0f*bouncingRatio));
 			if(g>1.0f)
 				g=1.0f;
 			for(unsigned t=0;t<frameSize;t++)
@@ -188,6 +210,21 @@ public:
 	}
 
 
+	// like calling processSample(input[t],levelInput[t]) for count samples except for how the gain is calculated (see above)
+	// output[t] is input[t-lookAheadTime] and input and output may be the same array
+	void processSamples(const mix_sample_t *input,const mix_sample_t *levelInput,mix_sample_t *output,size_t count)
+	{
+		processBlock(input,levelInput,output,1,count,false);
+	}
+
+	// like processSampleFrame() for frameCount interleaved frames of frameSize samples
+	// each frame's gain comes from the maximum absolute value in levelInputFrames's frame
+	void processSampleFrames(const mix_sample_t *inputFrames,const mix_sample_t *levelInputFrames,mix_sample_t *outputFrames,const unsigned frameSize,size_t frameCount)
+	{
+		processBlock(inputFrames,levelInputFrames,outputFrames,frameSize,frameCount,true);
+	}
+
+
 	const unsigned getWindowTime() const
 	{
 		return windowTime; // the value this was constructed with
@@ -197,6 +234,8 @@ public:
 private:
 	const unsigned windowTime;
 	const mix_sample_t threshold;
+	const double thresholdPower; // threshold^2, compared to the level detector's power
+	const double log2ThresholdPower;
 	const float compressionRatio;
 	const float attackVelocity;
 	const float releaseVelocity;
@@ -206,6 +245,81 @@ private:
 	float bouncingRatio;
 
 	CDSPRMSLevelDetector levelDetector;
+
+	enum { MAX_CONTROL_INTERVAL=256 };
+
+	const unsigned lookAheadTime;
+	unsigned lookAheadFrameSize; // what frameSize lookAheadDelay was set up for
+	TDSPDelay<mix_sample_t> lookAheadDelay; // delays interleaved frames by lookAheadTime*frameSize samples
+	const unsigned controlInterval;
+	float prevGain; // the gain at the last control point
+
+	// the gain that processSample() would apply at the given power and bouncingRatio
+	const float calculateGain(const double power,const bool limitToUnity) const
+	{
+		if(bouncingRatio<=1.0f || power<=0.0)
+			return 1.0f;
+		const float g=(float)exp2(((bouncingRatio-1.0)/(2.0*bouncingRatio))*(log2ThresholdPower-log2(power)));
+		return (limitToUnity && g>1.0f) ? 1.0f : g;
+	}
+
+	void processBlock(const mix_sample_t *input,const mix_sample_t *levelInput,mix_sample_t *output,const unsigned frameSize,size_t frameCount,const bool limitToUnity)
+	{
+		if(lookAheadTime>0 && lookAheadFrameSize!=frameSize)
+		{
+			lookAheadDelay.setDelayTime(lookAheadTime*frameSize);
+			lookAheadFrameSize=frameSize;
+		}
+
+		mix_sample_t delayed[MAX_CONTROL_INTERVAL*MAX_CHANNELS];
+		while(frameCount>0)
+		{
+			const size_t n=std::min(frameCount,(size_t)controlInterval);
+
+			// follow the level and the attack/release up to the control point
+			double power=0;
+			for(size_t t=0;t<n;t++)
+			{
+				const mix_sample_t *l=levelInput+t*frameSize;
+				mix_sample_t levelSample=l[0];
+				for(unsigned i=1;i<frameSize;i++)
+					levelSample=std::max(levelSample<0 ? -levelSample : levelSample,l[i]<0 ? -l[i] : l[i]);
+
+				power=levelDetector.readPower(levelSample);
+
+				// ??? I need to allow compression ratio to also be less than 1 to act as an exciter
+				if(power>=thresholdPower && bouncingRatio!=compressionRatio)
+					bouncingRatio= std::min(bouncingRatio+attackVelocity,compressionRatio);
+				else if(power<thresholdPower && bouncingRatio!=1.0f)
+					bouncingRatio= std::max(bouncingRatio-releaseVelocity,1.0f);
+			}
+			const float gain=calculateGain(power,limitToUnity);
+
+			const mix_sample_t *in=input;
+			if(lookAheadTime>0)
+			{
+				lookAheadDelay.processSamples(input,delayed,n*frameSize);
+				in=delayed;
+			}
+
+			// ramp from the last control point's gain to this one's
+			const float gainStep=(gain-prevGain)/n;
+			float g=prevGain;
+			for(size_t t=0;t<n;t++)
+			{
+				g+=gainStep;
+				for(unsigned i=0;i<frameSize;i++)
+					output[i]=(mix_sample_t)(in[i]*g);
+				in+=frameSize;
+				output+=frameSize;
+			}
+			prevGain=gain;
+
+			input+=n*frameSize;
+			levelInput+=n*frameSize;
+			frameCount-=n;
+		}
+	}
 };
 
 #endif
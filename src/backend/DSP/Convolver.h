@@ -23,7 +23,9 @@
 
 #include "../../config/common.h"
 
+#include <memory>
 #include <stdexcept>
+#include <vector>
 
 #include <istring>
 
@@ -55,6 +57,10 @@ public:
 	{
 		if(coefficientCount<1)
 			throw runtime_error(string(__func__)+" -- invalid coefficientCount: "+istring(coefficientCount));
+
+		// in the order that they line up with the delay's contiguous span of past samples
+		for(size_t t=coefficientCountSub1;t>0;t--)
+			reversedCoefficients.push_back(coefficients[t]);
 	}
 
 	virtual ~TSimpleConvolver()
@@ -64,8 +70,10 @@ public:
 	const sample_t processSample(const sample_t input)
 	{
 		coefficient_t output=input*coefficients[0];
-		for(unsigned t=coefficientCountSub1;t>0;t--)
-			output+=delay.getSample(t)*coefficients[t];
+		const coefficient_t *past=delay.getSpan(coefficientCountSub1); // past[k] is delay.getSample(coefficientCountSub1-k)
+		const coefficient_t *c=reversedCoefficients.data();
+		for(size_t k=0;k<coefficientCountSub1;k++)
+			output+=past[k]*c[k];
 
 		delay.putSample((coefficient_t)input);
 
@@ -77,6 +85,8 @@ private:
 	const size_t coefficientCount;
 	const size_t coefficientCountSub1;
 
+	std::vector<coefficient_t> reversedCoefficients; // coefficients[coefficientCount-1] down to coefficients[1]
+
 	TDSPDelay<coefficient_t> delay;
 };
 
@@ -124,8 +134,29 @@ typedef double fftw_real;
  *
  * 	And of course, the object can be safely destroyed without having 
  * 	read all the samples that were written.
+ *
+ * 	writeSamples(), readSamples(), skipSamples() and readEndingSamples()
+ * 	do the same as calling the single sample methods count times.
+ *
+ * 	The frequency-domain form of the filter kernel is kept in an
+ * 	RFFTConvolverKernel which does not change once it is made.  To convolve
+ * 	several channels with the same kernel, construct the first convolver
+ * 	with the kernel and the others with the first one's getKernel() so that
+ * 	the kernel is only transformed once.  Each convolver has its own buffers
+ * 	so different ones may be used by different threads at the same time, but
+ * 	(because fftw's planner is not thread-safe) they must be constructed,
+ * 	given new kernels and destroyed by one thread.
  */
 
+struct RFFTConvolverKernel
+{
+	size_t M; // length of filter kernel
+	size_t W; // fft window size
+
+	std::vector<fftw_real> real;
+	std::vector<fftw_real> img;
+};
+
 
 // ??? I should be able to remove the extra element I allocate and the setting of the last element to zero from when I was using macros to access the data (which I'm not doing anymore).. just make sure the current implementation wouldn't expact that extra element to be there
 template <class sample_t,class coefficient_t> class TFFTConvolverTimeDomainKernel
@@ -143,9 +174,6 @@ public:
 		p   (fftw_plan_r2r_1d(W, data.data(), xform.data(), FFTW_R2HC, FFTW_ESTIMATE)),
 		un_p(fftw_plan_r2r_1d(W, xform.data(), data.data(), FFTW_HC2R, FFTW_ESTIMATE)),
 
-		kernel_real(W/2+1),
-		kernel_img(W/2+1),
-
 		overlap(M-1),
 		overlapPos(0)
 	{
@@ -153,13 +181,36 @@ public:
 			throw runtime_error(string(__func__)+" -- fftw had an error creating plans");
 
 		// ??? might want to check coefficient_t against fftw_real
-		
-		prepareFilterKernel(filterKernel,data.data(),xform.data(),p,un_p);
+
+		kernel=prepareFilterKernel(filterKernel,data.data(),xform.data(),p,un_p);
 		//printf("chosen window size: %d\n",W);
 
 		reset();
 	}
 
+	// shares the already transformed kernel of another convolver
+	TFFTConvolverTimeDomainKernel(const std::shared_ptr<const RFFTConvolverKernel> &_kernel) :
+		M(_kernel->M),
+		W(_kernel->W),fW(W),
+		N(W-M+1),
+
+		data(W),dataPos(0),
+		xform(W+1),
+
+		p   (fftw_plan_r2r_1d(W, data.data(), xform.data(), FFTW_R2HC, FFTW_ESTIMATE)),
+		un_p(fftw_plan_r2r_1d(W, xform.data(), data.data(), FFTW_HC2R, FFTW_ESTIMATE)),
+
+		kernel(_kernel),
+
+		overlap(M-1),
+		overlapPos(0)
+	{
+		if(p==NULL || un_p==NULL)
+			throw runtime_error(string(__func__)+" -- fftw had an error creating plans");
+
+		reset();
+	}
+
 	virtual ~TFFTConvolverTimeDomainKernel()
 	{
 		fftw_destroy_plan(p);
@@ -173,12 +224,18 @@ public:
 		fftw_plan p    = fftw_plan_r2r_1d(W, data.data(), xform.data(), FFTW_R2HC, FFTW_ESTIMATE);
 		fftw_plan un_p = fftw_plan_r2r_1d(W, xform.data(), data.data(), FFTW_HC2R, FFTW_ESTIMATE);
 
-		prepareFilterKernel(filterKernel,data.data(),xform.data(),p,un_p);
+		// any other convolvers sharing the old kernel keep using it
+		kernel=prepareFilterKernel(filterKernel,data.data(),xform.data(),p,un_p);
 
 		fftw_destroy_plan(p);
 		fftw_destroy_plan(un_p);
 	}
 
+	const std::shared_ptr<const RFFTConvolverKernel> &getKernel() const
+	{
+		return kernel;
+	}
+
 
 	const size_t getChunkSize() const
 	{
@@ -195,6 +252,16 @@ public:
 		data[dataPos++]=s;
 	}
 
+	template<class src_t> void writeSamples(const src_t *src,const size_t count)
+	{
+		if(count>N-dataPos) // inappropriate use
+			throw runtime_error(string(__func__)+" -- more samples were written than TFFTConvolver::getChunkSize() ("+istring(N)+")");
+		fftw_real * const d=data.data()+dataPos;
+		for(size_t t=0;t<count;t++)
+			d[t]=src[t];
+		dataPos+=count;
+	}
+
 	void beginRead()
 	{
 		if(dataPos>N) // inappropriate use
@@ -210,6 +277,8 @@ public:
 
 			// ??? and here is where I could just as easily deconvolve by dividing with some flag
 		// multiply the frequency-domain kernel with the now frequency-domain audio
+		const fftw_real * const kernel_real=kernel->real.data();
+		const fftw_real * const kernel_img=kernel->img.data();
 		for(size_t t=0;t<=W/2;t++)
 		{
 			const fftw_real re=xform[t];
@@ -245,6 +314,27 @@ public:
 		return overlap[overlapPos++]/fW;
 	}
 
+	template<class dest_t> void readSamples(dest_t *dest,const size_t count)
+	{
+		const fftw_real * const s=data.data()+dataPos;
+		for(size_t t=0;t<count;t++)
+			dest[t]=s[t]/fW;
+		dataPos+=count;
+	}
+
+	void skipSamples(const size_t count)
+	{
+		dataPos+=count;
+	}
+
+	template<class dest_t> void readEndingSamples(dest_t *dest,const size_t count)
+	{
+		const fftw_real * const s=overlap.data()+overlapPos;
+		for(size_t t=0;t<count;t++)
+			dest[t]=s[t]/fW;
+		overlapPos+=count;
+	}
+
 	void reset()
 	{
 		dataPos=0;
@@ -286,8 +376,7 @@ private:
 	fftw_plan p;
 	fftw_plan un_p;
 
-	std::vector<fftw_real> kernel_real;
-	std::vector<fftw_real> kernel_img;
+	std::shared_ptr<const RFFTConvolverKernel> kernel;
 
 	std::vector<fftw_real> overlap;
 	size_t overlapPos;
@@ -310,7 +399,7 @@ private:
 		throw runtime_error(string(__func__)+" -- cannot handle a filter kernel of size "+istring(M)+" -- perhaps simply another element needs to be added to fftw_good_sizes");
 	}
 	
-	void prepareFilterKernel(const coefficient_t filterKernel[],fftw_real data[],fftw_real xform[],fftw_plan p,fftw_plan un_p)
+	const std::shared_ptr<const RFFTConvolverKernel> prepareFilterKernel(const coefficient_t filterKernel[],fftw_real data[],fftw_real xform[],fftw_plan p,fftw_plan un_p) const
 	{
 			// ??? perhaps a parameter could be passed that would indicate what the filterKernel is.. whether it's time-domain or freq domain already
 
@@ -323,12 +412,18 @@ private:
 		fftw_execute(p);
 		xform[W]=0; // to help out macros
 
-		// copy into kernel_real and kernel_img
+		// copy into kernel->real and kernel->img
+		std::shared_ptr<RFFTConvolverKernel> kernel=std::make_shared<RFFTConvolverKernel>();
+		kernel->M=M;
+		kernel->W=W;
+		kernel->real.resize(W/2+1);
+		kernel->img.resize(W/2+1);
 		for(size_t t=0;t<=W/2;t++)
 		{
-			kernel_real[t]=xform[t];
-			kernel_img[t]= (t==0 || t==W/2) ? 0 : xform[W-t];
+			kernel->real[t]=xform[t];
+			kernel->img[t]= (t==0 || t==W/2) ? 0 : xform[W-t];
 		}
+		return kernel;
 	}
 		
 };
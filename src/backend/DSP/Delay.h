@@ -23,6 +23,10 @@
 
 #include "../../config/common.h"
 
+#include <string.h>
+
+#include <algorithm>
+
 /* --- TDSPDelay --------------------------------
  *	- This class is uses a circular buffer to delay the input values by a certain delay time
  *	- There are several ways of retrieving samples out of the delay line.
@@ -34,14 +38,20 @@
  *	  0 to maxDelayTime-1.  Where 0 returns the most recent sample given to putSample and given
  *	  maxDelayTime-1 it returns the oldest sample in the delay line.
  *		- Likewise, the getSample(float delayTime) works in a similar way, but it can approximate
- *		  the sample that should appear at the given fractional delayTime.  NOTE: this method
- *		  doesn't work well if maxDelayTime is 1 since it only has one sample to work with.
+ *		  the sample that should appear at the given fractional delayTime by linear interpolation.
+ *		  getSampleHermite(float delayTime) does the same with a 4 point, 3rd order hermite 
+ *		  interpolator which sounds cleaner when the delay time is being modulated.
  *
  *      - To properly use getSample/putSample, getSample should be called first, then putSample should
  *	  be called after.  This is because of the simplest case of delaying by 1 sample, there is one
  *	  element in the buffer.  getSample returns the oldest value (the previous sample given to 
  *	  putSample, and putSample is then called to update that one element with the new sample.
  *
+ *	- The buffer's size is a power of two (at least 2 more than maxDelayTime) so positions wrap 
+ *	  with a mask rather than a division.  And it is mirrored: every sample is stored twice, 
+ *	  bufferSize elements apart, so that any span of the past can be read as a contiguous array 
+ *	  with getSpan().  processSamples() and putSamples() work on whole blocks.
+ *
  *      - the template parameter is the type of data to be delayed
  */
 template<class sample_t> class TDSPDelay
@@ -50,6 +60,8 @@ public:
 	TDSPDelay(const unsigned _maxDelayTime=1) :
 		buffer(NULL),
 		maxDelayTime(0),
+		bufferSize(0),
+		mask(0),
 
 		putPos(0)
 	{
@@ -63,10 +75,21 @@ public:
 
 		maxDelayTime=_maxDelayTime;
 
-		if(buffer!=NULL)
-			delete [] buffer;
-
-		buffer=new sample_t[maxDelayTime]; // expecting an exception on error rather than checking for NULL
+		// room for the interpolators to read a sample or two beyond maxDelayTime-1
+		size_t newBufferSize=4;
+		while(newBufferSize<(size_t)maxDelayTime+2)
+			newBufferSize<<=1;
+
+		if(newBufferSize!=bufferSize)
+		{
+			if(buffer!=NULL)
+				delete [] buffer;
+			buffer=NULL;
+
+			buffer=new sample_t[newBufferSize*2]; // expecting an exception on error rather than checking for NULL
+			bufferSize=newBufferSize;
+			mask=bufferSize-1;
+		}
 		clear();
 	}
 
@@ -78,8 +101,8 @@ public:
 
 	void clear()
 	{
-		memset(buffer,0,maxDelayTime*sizeof(*buffer));
-		putPos=2*maxDelayTime; // I don't start at zero because getSample(...) subtracts from the positions
+		memset(buffer,0,bufferSize*2*sizeof(*buffer));
+		putPos=0;
 	}
 
 	// give an input sample, returns the sample delayed by the constructed delay time
@@ -90,40 +113,105 @@ public:
 		return(output);
 	}
 
+	// processSample() for count samples
+	void processSamples(const sample_t *input,sample_t *output,size_t count)
+	{
+		// in pieces no longer than the delay so the oldest samples are read before they're overwritten
+		while(count>0)
+		{
+			const size_t n=std::min(count,(size_t)maxDelayTime);
+			const sample_t *oldest=getSpan(maxDelayTime-1);
+			std::copy(oldest,oldest+n,output);
+			putSamples(input,n);
+			input+=n;
+			output+=n;
+			count-=n;
+		}
+	}
+
 	void putSample(const sample_t s)
 	{
-		buffer[(++putPos)%maxDelayTime]=s;
+		const size_t p=(++putPos)&mask;
+		buffer[p]=s;
+		buffer[p+bufferSize]=s;
 	}
 
-	const sample_t getSample()
+	void putSamples(const sample_t *input,size_t count)
 	{
-		const sample_t s=buffer[(putPos+1)%maxDelayTime];
-		return(s);
+		while(count>0)
+		{
+			// as far as the end of the first copy
+			const size_t p=(putPos+1)&mask;
+			const size_t n=std::min(count,bufferSize-p);
+			std::copy(input,input+n,buffer+p);
+			std::copy(input,input+n,buffer+p+bufferSize);
+			putPos+=n;
+			input+=n;
+			count-=n;
+		}
 	}
 
-	const sample_t getSample(const unsigned delayTime)
+	const sample_t getSample() const
 	{
-		const sample_t s=buffer[(putPos-delayTime)%maxDelayTime];
-		return(s);
+		return buffer[(putPos+1-maxDelayTime)&mask];
 	}
 
-	const sample_t getSample(const float delayTime)
+	const sample_t getSample(const unsigned delayTime) const
 	{
-		const float fReadPos=putPos-delayTime;
-		const unsigned iReadPos=(unsigned)fReadPos; // floored
+		return buffer[(putPos-delayTime)&mask];
+	}
 
-		const float p2=fReadPos-iReadPos;
-		const float p1=1.0-p2;
+	const sample_t getSample(const float delayTime) const
+	{
+		// split the delay into whole samples and a fraction so the precision doesn't depend on how long the delay has been running
+		const unsigned iDelayTime=(unsigned)delayTime; // floored
+		const float f=delayTime-iDelayTime;
 
-		const sample_t s=(sample_t)(p1*buffer[(iReadPos)%maxDelayTime] + p2*buffer[(iReadPos+1)%maxDelayTime]);
-		return(s);
+		// s[1] is at iDelayTime and s[0] is one sample older
+		const sample_t *s=getSpan(iDelayTime+1);
+		return (sample_t)(f*s[0] + (1.0f-f)*s[1]);
+	}
+
+	const sample_t getSampleHermite(const float delayTime) const
+	{
+		const unsigned iDelayTime=(unsigned)delayTime; // floored
+		const float f=delayTime-iDelayTime;
+
+		// the four samples around the position from oldest to newest, s[2] is at iDelayTime (and there's nothing newer than delay 0)
+		const sample_t *s=getSpan(iDelayTime+2);
+		const float y0= iDelayTime>0 ? s[3] : s[2];
+		const float y1=s[2];
+		const float y2=s[1];
+		const float y3=s[0];
+
+		const float c1=0.5f*(y2-y0);
+		const float c2=y0-2.5f*y1+2.0f*y2-0.5f*y3;
+		const float c3=0.5f*(y3-y0)+1.5f*(y1-y2);
+		return (sample_t)(((c3*f+c2)*f+c1)*f+y1);
+	}
+
+	// returns a pointer to the sample at delayTime (up to maxDelayTime+1) followed by the newer 
+	// samples in order, ending with the most recent one at [delayTime].  Valid until the next put
+	const sample_t *getSpan(const unsigned delayTime) const
+	{
+		return buffer+((putPos-delayTime)&mask);
+	}
+
+	const unsigned getDelayTime() const
+	{
+		return maxDelayTime;
 	}
 
 
 private:
-	sample_t *buffer;
+	sample_t *buffer; // bufferSize elements and then a mirror of them
 	unsigned maxDelayTime;
+	size_t bufferSize;
+	size_t mask;
 	size_t putPos;
+
+	TDSPDelay(const TDSPDelay &src); // not implemented
+	const TDSPDelay &operator=(const TDSPDelay &rhs); // not implemented
 };
 
 #endif
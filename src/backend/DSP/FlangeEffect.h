@@ -85,9 +85,15 @@ public:
 	}
 
 	const mix_sample_t processSample(const mix_sample_t inputSample)
+	{
+		return processSample(inputSample,LFO->nextValue());
+	}
+
+	// for when the caller takes the LFO's values a block at a time with LFO->nextValues()
+	const mix_sample_t processSample(const mix_sample_t inputSample,const float LFOValue)
 	{
 		// calculate the delay time in samples from the LFO
-		const float _delayTime=(delayTime+(LFODepth*LFO->nextValue()));
+		const float _delayTime=(delayTime+(LFODepth*LFOValue));
 
 		// read a sample from the delay
 		const mix_sample_t delayedSample=delay.getSample(_delayTime);
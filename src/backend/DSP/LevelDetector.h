@@ -26,9 +26,10 @@
 #include <math.h>
 #include <string.h>
 
-#include "../CSound_defs.h"
+#include <algorithm>
+#include <vector>
 
-#include "Delay.h"
+#include "../CSound_defs.h"
 
 /* --- CDSPRMSLevelDetector --------------------------------------
  *
@@ -37,17 +38,18 @@
  *	- The windowTime given at construction is in samples not seconds
  *	- It is often necessary to initialize the object with 'windowTime' samples before even using the value from readLevel()
  *		- To do this, simply call readLevel() for the first 'windowTime' samples in the audio stream
+ *	- The power methods return the mean of the squares (the level squared).  Comparing that to a squared
+ *	  threshold saves taking a sqrt for every sample
+ *	- The running sum of the squares is exact with integer samples.  With floating point samples it is
+ *	  recalculated from the window every windowTime samples so that rounding errors can't accumulate
+ *	  over hours of audio
  */
 class CDSPRMSLevelDetector
 {
 public:
-	CDSPRMSLevelDetector(const unsigned _windowTime=1) :
-		window(_windowTime),
-		sumOfSquaredSamples(0.0),
-		windowTime(_windowTime),
-		iWindowTime(_windowTime)
+	CDSPRMSLevelDetector(const unsigned _windowTime=1)
 	{
-		// ??? based on windowTotals type and sample_t's type there is a maximum time I should impose on windowTime
+		setWindowTime(_windowTime);
 	}
 
 	virtual ~CDSPRMSLevelDetector()
@@ -56,29 +58,66 @@ public:
 
 	const mix_sample_t readCurrentLevel() const
 	{
-		// ??? I could avoid using sqrt by saying that I return the 'power' and not the 'level' and I would then have to square the value I compare this return value with, instead
-		return (mix_sample_t)sqrt(sumOfSquaredSamples/windowTime);
+		return (mix_sample_t)sqrt(readCurrentPower());
 	}
 
-	void updateLevel(mix_sample_t newSample)
+	const double readCurrentPower() const
 	{
-		// remove oldest sample from running statistic
-		sumOfSquaredSamples-=window.getSample();
+		return (double)sumOfSquaredSamples/span;
+	}
 
-		// add new sample to running statistic
-		const mix_sample_t temp=newSample*newSample;
-		sumOfSquaredSamples+=temp;
-		window.putSample(temp);
+	void updateLevel(const mix_sample_t newSample)
+	{
+		// replace the oldest sample's square in the running statistic with the new one's
+		const power_t square=(power_t)newSample*newSample;
+		sumOfSquaredSamples+=square-window[pos];
+		window[pos]=square;
+		if(++pos==span)
+		{
+			pos=0;
+			resum();
+		}
 	}
 
 	// every time you read the level, you have to supply the next sample in the audio stream
-	const mix_sample_t readLevel(mix_sample_t newSample)
+	const mix_sample_t readLevel(const mix_sample_t newSample)
 	{
 		const mix_sample_t currentAmplitude=readCurrentLevel();
 		updateLevel(newSample);
 		return currentAmplitude;
 	}
 
+	// like readLevel() but returns the power
+	const double readPower(const mix_sample_t newSample)
+	{
+		const double currentPower=readCurrentPower();
+		updateLevel(newSample);
+		return currentPower;
+	}
+
+	// calls readLevel() or readPower() for each of the count samples in input and writes the results to output
+	void readLevels(const mix_sample_t *input,mix_sample_t *output,const size_t count)
+	{
+		for(size_t t=0;t<count;t++)
+			output[t]=readLevel(input[t]);
+	}
+
+	void readPowers(const mix_sample_t *input,double *output,const size_t count)
+	{
+		for(size_t t=0;t<count;t++)
+			output[t]=readPower(input[t]);
+	}
+
+	// returns the largest power that readPower() would have returned for the count samples in input
+	// (the sqrt of it is the largest level)
+	const double readMaxPower(const mix_sample_t *input,const size_t count)
+	{
+		double maxPower=0;
+		for(size_t t=0;t<count;t++)
+			maxPower=std::max(maxPower,readPower(input[t]));
+		return maxPower;
+	}
+
 
 	const unsigned getWindowTime() const
 	{
@@ -88,19 +127,27 @@ public:
 	// will invalidate any previous information collected about the moving RMS
 	void setWindowTime(unsigned _windowTime) // in samples
 	{
-		window.setDelayTime(_windowTime);
-		windowTime=_windowTime;
 		iWindowTime=_windowTime;
+		span=std::max(_windowTime,1u);
 
+		window.assign(span,0);
+		pos=0;
 		sumOfSquaredSamples=0;
-		window.clear();
 	}
 
 private:
+#ifdef SAMPLE_TYPE_FLOAT
+	typedef double power_t;
+	void resum() { sumOfSquaredSamples=0; for(size_t t=0;t<span;t++) sumOfSquaredSamples+=window[t]; }
+#else
+	typedef int64_t power_t; // the sum is exact so there's nothing to correct
+	void resum() { }
+#endif
 
-	TDSPDelay<mix_sample_t> window; // used to know a past set of samples
-	double sumOfSquaredSamples;
-	double windowTime;
+	std::vector<power_t> window; // a circular buffer of the squares of the past windowTime samples
+	size_t pos; // where the next square goes (and the oldest square is)
+	power_t sumOfSquaredSamples;
+	size_t span; // windowTime, but at least 1
 	unsigned iWindowTime;
 };
 
@@ -112,19 +159,23 @@ private:
  *	- The windowTime given at construction is in samples not seconds
  *	- It is often necessary to initialize the object with 'windowTime' samples before even using the value from readLevel()
  *		- To do this, simply call readLevel() for the first 'windowTime' samples in the audio stream
+ *	- It keeps only the samples which could still become the maximum (each is larger than all those
+ *	  that came after it) in a ring buffer, so each sample costs O(1) amortized with no allocation
  */
-#include <map>
 class CDSPPeakLevelDetector
 {
 public:
 	CDSPPeakLevelDetector(const unsigned _windowTime) :
-		window(_windowTime),
-		windowTime(_windowTime)
+		windowTime(_windowTime),
+		span(std::max(_windowTime,1u)),
+		candidates(span),
+		first(0),
+		count(1),
+		position(0)
 	{
-		// initialize the history and the histogram
-		for(size_t t=0;t<windowTime;t++)
-			window.putSample(0);
-		histogram[0]=windowTime;
+		// the window starts out full of silence, which the newest of those zeros stands in for
+		candidates[0].value=0;
+		candidates[0].position=-1;
 	}
 
 	virtual ~CDSPPeakLevelDetector()
@@ -137,28 +188,33 @@ public:
 		// same abs value of the new sample
 		const sample_t newSample= _newSample<0 ? -_newSample : _newSample;
 
-		// get the oldest sample from the delay window
-		const sample_t oldestSample=window.getSample();
-
-		// add the new sample into the delay window
-		window.putSample(newSample);
-	
-		// remove the oldest sample from the histogram
-		map<sample_t,size_t>::iterator i1=histogram.find(oldestSample);
-		if(i1->second<=1)
-			histogram.erase(i1);
-		else
-			i1->second--;
-
-		// add the new sample to the hisogram
-		map<sample_t,size_t>::iterator i2=histogram.find(newSample);
-		if(i2!=histogram.end())
-			i2->second++;
-		else
-			histogram[newSample]=1;
-		
-		// return the largest value in the histogram
-		return histogram.rbegin()->first;
+		// the oldest sample leaves the window (only the first candidate can be that old)
+		if(count>0 && candidates[first].position<=position-(int64_t)span)
+		{
+			if(++first==span)
+				first=0;
+			count--;
+		}
+
+		// samples no larger than the new one can never be the maximum again
+		while(count>0 && candidates[last()].value<=newSample)
+			count--;
+
+		// add the new sample
+		count++;
+		RCandidate &c=candidates[last()];
+		c.value=newSample;
+		c.position=position++;
+
+		// the first candidate is the largest value in the window
+		return candidates[first].value;
+	}
+
+	// calls readLevel() for each of the count samples in input and writes the levels to output (input and output may be the same)
+	void readLevels(const sample_t *input,sample_t *output,const size_t count)
+	{
+		for(size_t t=0;t<count;t++)
+			output[t]=readLevel(input[t]);
 	}
 
 	const unsigned getWindowTime() const
@@ -167,9 +223,23 @@ public:
 	}
 
 private:
-	TDSPDelay<sample_t> window; // used to know a past set of samples
-	map<sample_t,size_t> histogram;
+	struct RCandidate
+	{
+		sample_t value;
+		int64_t position;
+	};
+
 	const unsigned windowTime;
+	const size_t span; // windowTime, but at least 1
+	std::vector<RCandidate> candidates; // a ring buffer of decreasing values, oldest first
+	size_t first,count;
+	int64_t position; // of the next sample
+
+	size_t last() const
+	{
+		const size_t i=first+count-1;
+		return i>=span ? i-span : i;
+	}
 };
 
 #endif
@@ -57,6 +57,7 @@ public:
 	CDSPNoiseGate(unsigned _windowTime,sample_t _threshold,unsigned _gainAttackTime,unsigned _gainReleaseTime) :
 		windowTime(_windowTime),
 		threshold(_threshold),
+		thresholdPower((double)_threshold*_threshold),
 		gainAttackVelocity(1.0f/(float)_gainAttackTime),
 		gainReleaseVelocity(1.0f/(float)_gainReleaseTime),
 	
@@ -73,16 +74,16 @@ public:
 	// using this is optional -- it is used to initialize the level detector -- see Note above
 	void initSample(const mix_sample_t s)
 	{
-		levelDetector.readLevel(s);
+		levelDetector.updateLevel(s);
 	}
 
 	const mix_sample_t processSample(const mix_sample_t s)
 	{
-		const mix_sample_t level=levelDetector.readLevel(s);
+		const double power=levelDetector.readPower(s);
 		
-		if(level<=threshold && gain>0.0f)
+		if(power<=thresholdPower && gain>0.0f)
 			gain= max(gain-gainAttackVelocity,0.0f);
-		else if(level>threshold && gain<1.0f)
+		else if(power>thresholdPower && gain<1.0f)
 			gain= min(gain+gainReleaseVelocity,1.0f);
 
 			// ??? should be able to make this 3 return statements in the 2 cases+else above
@@ -105,6 +106,7 @@ public:
 private:
 	const unsigned windowTime;
 	const mix_sample_t threshold;
+	const double thresholdPower; // threshold^2, compared to the level detector's power
 	const float gainAttackVelocity;
 	const float gainReleaseVelocity;
 
@@ -0,0 +1,348 @@
+/*
+ * Copyright (C) 2026 - agent
+ *
+ * This file is part of ReZound, an audio editing application.
+ *
+ * ReZound is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * ReZound is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+#ifndef __DSP_SincResampler_H__
+#define __DSP_SincResampler_H__
+
+#include "../../config/common.h"
+
+#include "../CSound_defs.h"
+
+#include <math.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <istring>
+
+/* --- CDSPSincResampler ------------------------
+ *	- This class converts a stream of samples by a fixed rate ratio using a band-limited
+ *	  (Kaiser windowed sinc) interpolator.  It is the high quality alternative to the 2-point
+ *	  linear interpolation that TSoundStretcher does.
+ *
+ *	- step is the number of input samples per output sample (i.e. srcRate/destRate).  When step
+ *	  is greater than 1 the filter's cutoff is lowered so that the output does not alias.
+ *
+ *	- The filter is precomputed as a polyphase table: one row of taps for each of phaseCount+1
+ *	  evenly spaced fractional positions between two input samples.  Each output sample is two
+ *	  dot products of contiguous floats (the rows either side of the exact position) which are
+ *	  then linearly interpolated.
+ *
+ *	- The object is a stream: give it input with putSamples() in blocks of any size and pull as
+ *	  much output as that input allows with getSamples().  The state carries across calls so the
+ *	  caller's block boundaries make no difference to the output.  The input is considered to be
+ *	  preceded by silence, and the caller should give putSilence(getFilterHalfLength()) at the end
+ *	  of the input to get the last output samples out.
+ */
+class CDSPSincResampler
+{
+public:
+	enum Qualities
+	{
+		qLow=0,		// 4 zero crossings, a fast but still band-limited interpolator
+		qMedium=1,	// 8 zero crossings
+		qHigh=2,	// 16 zero crossings
+		qBest=3		// 32 zero crossings, a very steep filter for mastering
+	};
+
+	// startOffset is the fractional input position of the first output sample (must be >=0)
+	CDSPSincResampler(const double _step,const Qualities quality=qHigh,const double startOffset=0.0) :
+		step(_step)
+	{
+		if(step<=0.0)
+			throw runtime_error(string(__func__)+" -- invalid step: "+istring(step));
+		if(startOffset<0.0)
+			throw runtime_error(string(__func__)+" -- invalid startOffset: "+istring(startOffset));
+
+		unsigned zeroCrossings;
+		double beta,rolloff;
+		switch(quality)
+		{
+		case qLow:	zeroCrossings=4;  phaseCount=32;  beta=5.0;  rolloff=0.85; break;
+		case qMedium:	zeroCrossings=8;  phaseCount=128; beta=7.0;  rolloff=0.90; break;
+		case qHigh:	zeroCrossings=16; phaseCount=256; beta=9.0;  rolloff=0.94; break;
+		case qBest:	zeroCrossings=32; phaseCount=512; beta=11.0; rolloff=0.97; break;
+		default:
+			throw runtime_error(string(__func__)+" -- invalid quality: "+istring((int)quality));
+		}
+
+		// cutoff as a fraction of the input's nyquist frequency
+		const double cutoff=rolloff*std::min(1.0,1.0/step);
+
+		// the filter spans this many input samples either side of the output position
+		halfLength=std::min((unsigned)ceil(zeroCrossings/cutoff),(unsigned)MAX_HALF_LENGTH);
+		tapCount=2*halfLength;
+
+		// keep the table a sane size for extreme downsampling ratios
+		while(phaseCount>16 && (size_t)(phaseCount+1)*tapCount>MAX_TABLE_SIZE)
+			phaseCount/=2;
+
+		buildTable(cutoff,beta);
+
+		// the first output sample needs halfLength-1 samples of (silent) history before it
+		history.assign(halfLength-1,0.0f);
+		pos=(halfLength-1)+startOffset;
+	}
+
+	unsigned getFilterHalfLength() const { return halfLength; }
+
+	void putSamples(const float *input,const size_t count)
+	{
+		compact();
+		history.insert(history.end(),input,input+count);
+	}
+
+	void putSilence(const size_t count)
+	{
+		compact();
+		history.resize(history.size()+count,0.0f);
+	}
+
+	// produces up to count samples into output as far as the input given so far allows and returns how many were produced
+	size_t getSamples(float *output,const size_t count)
+	{
+		const size_t available=history.size();
+		const float * const h=history.data();
+		const float * const tab=table.data();
+
+		size_t n;
+		for(n=0;n<count;n++)
+		{
+			const size_t i=(size_t)pos;
+			if(i+halfLength>=available)
+				break; // need more input
+
+			const double phasePos=(pos-i)*phaseCount;
+			const unsigned p=(unsigned)phasePos;
+			const float a=(float)(phasePos-p);
+
+			const float * const s=h+(i+1-halfLength);
+			const float * const h1=tab+(size_t)p*tapCount;
+			const float * const h2=h1+tapCount;
+
+			float acc1=0.0f,acc2=0.0f;
+			for(unsigned k=0;k<tapCount;k++)
+			{
+				acc1+=s[k]*h1[k];
+				acc2+=s[k]*h2[k];
+			}
+
+			output[n]=acc1+(acc2-acc1)*a;
+			pos+=step;
+		}
+
+		return n;
+	}
+
+private:
+	enum
+	{
+		MAX_HALF_LENGTH=8192,
+		MAX_TABLE_SIZE=(1<<21)
+	};
+
+	const double step;
+
+	unsigned halfLength;
+	unsigned tapCount;
+	unsigned phaseCount;
+	std::vector<float> table; // (phaseCount+1) rows of tapCount coefficients
+
+	std::vector<float> history;
+	double pos; // index into history of the next output sample's position
+
+	static double besselI0(const double x)
+	{
+		double sum=1.0,term=1.0;
+		for(unsigned k=1;k<64;k++)
+		{
+			term*=(x/(2.0*k))*(x/(2.0*k));
+			sum+=term;
+			if(term<sum*1e-12)
+				break;
+		}
+		return sum;
+	}
+
+	void buildTable(const double cutoff,const double beta)
+	{
+		table.resize((size_t)(phaseCount+1)*tapCount);
+		const double i0Beta=besselI0(beta);
+
+		for(unsigned p=0;p<=phaseCount;p++)
+		{
+			float * const row=&table[(size_t)p*tapCount];
+			const double frac=(double)p/phaseCount;
+
+			double sum=0.0;
+			for(unsigned k=0;k<tapCount;k++)
+			{
+				// distance from the output position to the input sample this tap multiplies
+				const double x=((double)k-(halfLength-1))-frac;
+				const double r=x/halfLength;
+
+				double v=0.0;
+				if(fabs(r)<1.0)
+				{
+					const double px=M_PI*cutoff*x;
+					const double sinc= x==0.0 ? 1.0 : sin(px)/px;
+					v=cutoff*sinc*besselI0(beta*sqrt(1.0-r*r))/i0Beta;
+				}
+				row[k]=v;
+				sum+=v;
+			}
+
+			// normalize every phase to unity gain at DC
+			if(sum!=0.0)
+			{
+				for(unsigned k=0;k<tapCount;k++)
+					row[k]/=sum;
+			}
+		}
+	}
+
+	// discard the history that no future output sample can reach anymore
+	void compact()
+	{
+		const size_t consumed=(size_t)pos+1-halfLength;
+		if(consumed>4096 && consumed>history.size()/2)
+		{
+			history.erase(history.begin(),history.begin()+consumed);
+			pos-=consumed;
+		}
+	}
+};
+
+
+/* --- TSincSoundStretcher ----------------------
+ *	- This is a drop-in for TSoundStretcher (with integral or fractional srcOffset and srcLength)
+ *	  for when the quality of the result matters more, like converting a whole sound's sample rate.
+ *	- It reads src[] in blocks and runs them through a CDSPSincResampler, so getSample() is just
+ *	  a read from a buffer.  getSamples() can be used to take the output in blocks instead.
+ *	- The source is considered silent outside of [srcOffset,srcOffset+srcLength)
+ */
+template<class src_type> class TSincSoundStretcher
+{
+public:
+	TSincSoundStretcher(const src_type &_src,const sample_fpos_t _srcOffset,const sample_fpos_t _srcLength,const sample_fpos_t _toLength,const CDSPSincResampler::Qualities quality=CDSPSincResampler::qHigh,unsigned _frameSize=1,unsigned _frameOffset=0) :
+		src(_src),
+		frameSize(_frameSize),
+		frameOffset(_frameOffset),
+		srcPos((sample_pos_t)sample_fpos_floor(_srcOffset)),
+		srcEnd((sample_pos_t)sample_fpos_floor(_srcOffset+_srcLength)),
+		flushed(false),
+		resampler((double)(_srcLength/_toLength),quality,(double)(_srcOffset-sample_fpos_floor(_srcOffset))),
+		outPos(0),
+		outCount(0)
+	{
+		if(frameSize==0)
+			throw(runtime_error(string(__func__)+" -- frameSize is 0"));
+		if(frameOffset>=frameSize)
+			throw(runtime_error(string(__func__)+" -- frameOffset is >= frameSize: "+istring(frameOffset)+">="+istring(frameSize)));
+		if(_toLength<=0)
+			throw(runtime_error(string(__func__)+" -- invalid toLength: "+istring((double)_toLength)));
+	}
+
+	const sample_t getSample()
+	{
+		if(outPos>=outCount)
+			refill();
+		return outBuffer[outPos++];
+	}
+
+	void getSamples(sample_t *dest,size_t count)
+	{
+		while(count>0)
+		{
+			if(outPos>=outCount)
+				refill();
+			const size_t n=std::min(count,outCount-outPos);
+			std::copy(outBuffer+outPos,outBuffer+outPos+n,dest);
+			outPos+=n;
+			dest+=n;
+			count-=n;
+		}
+	}
+
+private:
+	enum { BLOCK_SIZE=1024 };
+
+	const src_type src;
+	const sample_pos_t frameSize;
+	const sample_pos_t frameOffset;
+	sample_pos_t srcPos;
+	const sample_pos_t srcEnd;
+	bool flushed;
+
+	CDSPSincResampler resampler;
+
+	float inBuffer[BLOCK_SIZE];
+	float resampledBuffer[BLOCK_SIZE];
+	sample_t outBuffer[BLOCK_SIZE];
+	size_t outPos,outCount;
+
+	void refill()
+	{
+		outPos=0;
+		while((outCount=resampler.getSamples(resampledBuffer,BLOCK_SIZE))==0)
+		{
+			if(srcPos<srcEnd)
+			{ // feed the next block of the source
+				const size_t n=(size_t)std::min((sample_pos_t)BLOCK_SIZE,srcEnd-srcPos);
+				if(frameSize==1)
+				{
+					for(size_t t=0;t<n;t++)
+						inBuffer[t]=src[srcPos+t];
+				}
+				else
+				{
+					for(size_t t=0;t<n;t++)
+						inBuffer[t]=src[(srcPos+t)*frameSize+frameOffset];
+				}
+				resampler.putSamples(inBuffer,n);
+				srcPos+=n;
+			}
+			else if(!flushed)
+			{ // let the filter run off the end of the source
+				resampler.putSilence(resampler.getFilterHalfLength());
+				flushed=true;
+			}
+			else
+			{ // asked for more than toLength samples
+				std::fill(outBuffer,outBuffer+BLOCK_SIZE,(sample_t)0);
+				outCount=BLOCK_SIZE;
+				return;
+			}
+		}
+
+		for(size_t t=0;t<outCount;t++)
+		{
+#ifdef SAMPLE_TYPE_FLOAT
+			outBuffer[t]=resampledBuffer[t];
+#else
+			outBuffer[t]=ClipSample(lrintf(resampledBuffer[t]));
+#endif
+		}
+	}
+};
+
+#endif
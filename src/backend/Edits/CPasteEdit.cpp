@@ -408,7 +408,7 @@ static const vector<vector<bool> > getPasteChannels(AActionDialog *pasteChannels
 	static vector<vector<bool> > pasteChannels;
 	pasteChannels.clear();
 
-	if(pasteChannelsDialog->wasShown)
+	if(pasteChannelsDialog!=NULL && pasteChannelsDialog->wasShown)
 	{
 		const vector<vector<bool> > &m= *reinterpret_cast<const vector<vector<bool> > *>(pasteChannelsDialog->getUserData());
 		for(unsigned y=0;y<MAX_CHANNELS;y++)
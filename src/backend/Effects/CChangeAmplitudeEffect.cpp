@@ -55,11 +55,16 @@ bool CChangeAmplitudeEffect::doActionSizeSafe(CActionSound *actionSound,bool pre
 			CRezPoolAccesser dest=actionSound->sound->getAudio(i);
 		
 			CGraphParamValueIterator iter(volumeCurve,selectionLength);
-			for(sample_pos_t t=0;t<selectionLength;t++)
+			double gains[4096];
+			for(sample_pos_t t=0;t<selectionLength;)
 			{
-				dest[destPos++]=ClipSample(src[srcPos++]*iter.next());
+				const size_t n=(size_t)min((sample_pos_t)4096,selectionLength-t);
+				iter.next(gains,n);
+				for(size_t k=0;k<n;k++)
+					dest[destPos++]=ClipSample(src[srcPos++]*gains[k]);
+				t+=n;
 
-				if(statusBar.update(t))
+				if(statusBar.update(t-1))
 				{ // cancelled
 					if(prepareForUndo)
 						undoActionSizeSafe(actionSound);
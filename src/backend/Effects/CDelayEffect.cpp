@@ -22,6 +22,7 @@
 
 #include "../CActionParameters.h"
 #include "../CActionSound.h"
+#include "../APreviewProcessor.h"
 
 #include "../DSP/DelayEffect.h"
 #include "../unit_conv.h"
@@ -129,6 +130,21 @@ void CDelayEffect::undoActionSizeSafe(const CActionSound *actionSound)
 }
 
 
+APreviewProcessor *CDelayEffect::createPreviewProcessor(const CActionSound *actionSound) const
+{
+	// CDSPDelayEffect only points to the tap arrays, so the processor has to own a copy since it outlives this action
+	std::shared_ptr<vector<float>> taps(new vector<float>(tapTimes,tapTimes+tapCount));
+	taps->insert(taps->end(),tapGains,tapGains+tapCount);
+	taps->insert(taps->end(),tapFeedbacks,tapFeedbacks+tapCount);
+	const size_t tapCount=this->tapCount;
+
+	return new TPerChannelPreviewProcessor<CDSPDelayEffect>(
+		actionSound,
+		[taps,tapCount]() { return new CDSPDelayEffect(tapCount,&(*taps)[0],&(*taps)[tapCount],&(*taps)[tapCount*2]); },
+		[](CDSPDelayEffect &delayEffect,const sample_t s) { return ClipSample(delayEffect.processSample(s)); }
+	);
+}
+
 
 // ---------------------------------------------
 
@@ -137,6 +153,7 @@ void CDelayEffect::undoActionSizeSafe(const CActionSound *actionSound)
 CSimpleDelayEffectFactory::CSimpleDelayEffectFactory(AActionDialog *channelSelectDialog,AActionDialog *dialog) :
 	AActionFactory(N_("Simple Delay (Echo)"),"",channelSelectDialog,dialog)
 {
+	previewIsApplicable=true;
 }
 
 CSimpleDelayEffectFactory::~CSimpleDelayEffectFactory()
@@ -38,6 +38,8 @@ protected:
 	void undoActionSizeSafe(const CActionSound *actionSound);
 	CanUndoResults canUndo(const CActionSound *actionSound) const;
 
+	APreviewProcessor *createPreviewProcessor(const CActionSound *actionSound) const;
+
 private:
 	const size_t tapCount;
 
@@ -83,11 +83,16 @@ bool CFlangeEffect::doActionSizeSafe(CActionSound *actionSound,bool prepareForUn
 				);
 
 			sample_pos_t srcP=prepareForUndo ? 0 : start;
-			for(sample_pos_t t=start;t<=stop;t++)
+			float LFOValues[4096];
+			for(sample_pos_t t=start;t<=stop;)
 			{
-				dest[t]=ClipSample(flangeEffect.processSample(src[srcP++]));
+				const size_t n=(size_t)min((sample_pos_t)4096,stop-t+1);
+				LFO->nextValues(LFOValues,n);
+				for(size_t k=0;k<n;k++)
+					dest[t+k]=ClipSample(flangeEffect.processSample(src[srcP++],LFOValues[k]));
+				t+=n;
 
-				if(statusBar.update(t))
+				if(statusBar.update(t-1))
 				{ // cancelled
 					if(prepareForUndo)
 						undoActionSizeSafe(actionSound);
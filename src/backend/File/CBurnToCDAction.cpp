@@ -24,20 +24,98 @@
 #include "../CActionParameters.h"
 #include "../DSP/TSoundStretcher.h"
 #include "../AStatusComm.h"
+#include "../CPipeStreamer.h"
+#include "../mypopen.h"
 
 #include <istring>
 #include <CPath.h>
 
+#include <algorithm>
 #include <map>
+#include <memory>
 #include <vector>
 #include <utility>
 
+#include <errno.h>
+#include <string.h>
 #include <unistd.h> /* for unlink() and getuid()*/
 #include <stdlib.h> /* for system() */
 #include <sys/wait.h> /* for WEXITSTATUS */
 
 #include "parse_segment_cues.h"
 
+/*
+ * Writes each segment as 16bit, 44100Hz, stereo samples to the stream (which goes to cdrdao's
+ * stdin), one track after another.  This reads straight from the pool file so no temporary copy
+ * of the audio is ever written to disk.
+ */
+static void streamTracks(const CSound &sound,const segments_t &segments,const sample_pos_t fullLength,CPipeStreamer &stream)
+{
+	const unsigned channelCount=sound.getChannelCount();
+	const unsigned sampleRate=sound.getSampleRate();
+
+	#define BUFFER_SIZE 4096
+	int16_t buffer[BUFFER_SIZE*2];
+
+	for(segments_t::const_iterator i=segments.begin();i!=segments.end();i++)
+	{
+		const sample_pos_t srcStart=i->second.first;
+		const sample_pos_t srcStop=i->second.second;
+		const sample_pos_t srcLength=srcStop-srcStart;
+		const sample_fpos_t fDestLength=(sample_fpos_t)srcLength/sampleRate*44100;
+		const sample_pos_t destLength=(sample_pos_t)fDestLength;
+		const bool paddedForInterpolation=srcStop<(fullLength-8);
+
+		std::unique_ptr<const CRezPoolAccesser> t_src[MAX_CHANNELS];
+		std::unique_ptr<TSoundStretcher<const CRezPoolAccesser>> src[MAX_CHANNELS];
+		for(unsigned t=0;t<channelCount;t++)
+		{
+			t_src[t].reset(new CRezPoolAccesser(sound.getAudio(t)));
+			src[t].reset(new TSoundStretcher<const CRezPoolAccesser>(*(t_src[t]),srcStart,srcLength,fDestLength,1,0,paddedForInterpolation));
+		}
+
+		for(sample_pos_t pos=0;pos<destLength;)
+		{
+			const size_t chunkSize=(size_t)min((sample_pos_t)BUFFER_SIZE,destLength-pos);
+
+			// write out as stereo
+			if(channelCount==1)
+			{	/* write 1 channel as stereo */
+				for(size_t t=0;t<chunkSize;t++)
+					buffer[t*2]=buffer[t*2+1]=convert_sample<sample_t,int16_t>(src[0]->getSample());
+			}
+			else if(channelCount==2)
+			{
+				for(size_t t=0;t<chunkSize;t++)
+				{
+					buffer[t*2]=convert_sample<sample_t,int16_t>(src[0]->getSample());
+					buffer[t*2+1]=convert_sample<sample_t,int16_t>(src[1]->getSample());
+				}
+			}
+			else
+			{	/* write N number of channels as stereo where N>2 */
+				for(size_t t=0;t<chunkSize;t++)
+				{
+					mix_sample_t tleft=0;
+					mix_sample_t tright=0;
+					for(unsigned c=0;c<channelCount;c++)
+					{
+						if(c%2)
+							tright+=src[c]->getSample();
+						else
+							tleft+=src[c]->getSample();
+					}
+					buffer[t*2]=convert_sample<sample_t,int16_t>(ClipSample(tleft));
+					buffer[t*2+1]=convert_sample<sample_t,int16_t>(ClipSample(tright));
+				}
+			}
+
+			stream.write(buffer,chunkSize*2*sizeof(int16_t));
+			pos+=chunkSize;
+		}
+	}
+}
+
 CBurnToCDAction::CBurnToCDAction(const AActionFactory *factory,const CActionSound *_actionSound,const string _tempSpaceDir,const string _pathTo_cdrdao,const unsigned _burnSpeed,const unsigned _gapBetweenTracks,const string _device,const string _extra_cdrdao_options,const bool _selectionOnly,const bool _testOnly) :
 	AAction(factory,_actionSound),
 	tempSpaceDir(_tempSpaceDir),
@@ -61,7 +139,6 @@ bool CBurnToCDAction::doActionSizeSafe(CActionSound *actionSound,bool prepareFor
 	const sample_pos_t selectionStart= selectionOnly ? actionSound->start : 0;
 	const sample_pos_t selectionLength= selectionOnly ? actionSound->selectionLength() : sound.getLength();
 	const sample_pos_t fullLength=sound.getLength();
-	const unsigned channelCount=sound.getChannelCount();
 	const unsigned sampleRate=sound.getSampleRate();
 
 	if(!CPath(pathTo_cdrdao).exists())
@@ -162,140 +239,6 @@ bool CBurnToCDAction::doActionSizeSafe(CActionSound *actionSound,bool prepareFor
 		return false;
 	*/
 
-	// proceed to save files
-	{
-		CStatusBar statusBar(_("Writing Data to Burn"),0,(sample_pos_t)((sample_fpos_t)selectionLength/sampleRate*44100),true);
-		sample_pos_t statusTotal=0;
-		for(segments_t::iterator i=segments.begin();i!=segments.end();i++)
-		{
-			try
-			{
-				const string filename=i->first;
-				const sample_pos_t srcStart=i->second.first;
-				const sample_pos_t srcStop=i->second.second;
-				const sample_pos_t srcLength=srcStop-srcStart;
-				const sample_fpos_t fDestLength=(sample_fpos_t)srcLength/sampleRate*44100;
-				const sample_pos_t destLength=(sample_pos_t)fDestLength;
-				const bool paddedForInterpolation=srcStop<(fullLength-8);
-		
-				FILE *f=fopen(filename.c_str(),"w");
-				if(f==NULL)
-					throw runtime_error(string(__func__)+" -- error creating file: "+filename);
-
-				// write out as stereo, 16bit, 44100
-				if(channelCount==1)
-				{	/* write 1 channel as stereo */
-					const CRezPoolAccesser t_src=sound.getAudio(0);
-					TSoundStretcher<const CRezPoolAccesser> src(t_src,srcStart,srcLength,fDestLength,1,0,paddedForInterpolation);
-
-					for(sample_pos_t t=0;t<destLength;t++)
-					{
-						int16_t s=convert_sample<sample_t,int16_t>(src.getSample());
-						fwrite(&s,2,1,f);
-						fwrite(&s,2,1,f);
-						if(ferror(f))
-						{
-							const int errNO=errno;
-							throw runtime_error(string(__func__)+" -- error writing to file: "+filename+" -- "+strerror(errNO));
-						}
-
-						if(statusBar.update(statusTotal++))
-							throw EUserMessage(""); /* won't cause a popup */
-					}
-				}
-				else if(channelCount==2)
-				{
-					const CRezPoolAccesser t_srcL=sound.getAudio(0);
-					const CRezPoolAccesser t_srcR=sound.getAudio(1);
-					TSoundStretcher<const CRezPoolAccesser> srcL(t_srcL,srcStart,srcLength,fDestLength,1,0,paddedForInterpolation);
-					TSoundStretcher<const CRezPoolAccesser> srcR(t_srcR,srcStart,srcLength,fDestLength,1,0,paddedForInterpolation);
-
-					for(sample_pos_t t=0;t<destLength;t++)
-					{
-						int16_t left=convert_sample<sample_t,int16_t>(srcL.getSample());
-						int16_t right=convert_sample<sample_t,int16_t>(srcR.getSample());
-
-						fwrite(&left,2,1,f);
-						fwrite(&right,2,1,f);
-						if(ferror(f))
-						{
-							const int errNO=errno;
-							throw runtime_error(string(__func__)+" -- error writing to file: "+filename+" -- "+strerror(errNO));
-						}
-
-						if(statusBar.update(statusTotal++))
-							throw EUserMessage(""); /* won't cause a popup */
-					}
-				}
-				else
-				{	/* write N number of channels as stereo where N>2 */
-					const CRezPoolAccesser *t_src[MAX_CHANNELS]={0};
-					for(unsigned t=0;t<channelCount;t++)
-						t_src[t]=new CRezPoolAccesser(sound.getAudio(t));
-
-					TSoundStretcher<const CRezPoolAccesser> *src[MAX_CHANNELS]={0};
-					for(unsigned t=0;t<channelCount;t++)
-						src[t]=new TSoundStretcher<const CRezPoolAccesser>(*(t_src[t]),srcStart,srcLength,fDestLength,1,0,paddedForInterpolation);
-
-					try /* ??? really need two separate try/catches .. or a master one around the whole thing and deallocate these objects there (declaring src[] and t_src[] outside that try (or figure out how to do it with a smart pointer */
-					{
-						for(sample_pos_t t=0;t<destLength;t++)
-						{
-							mix_sample_t tleft=0;
-							mix_sample_t tright=0;
-							for(unsigned i=0;i<channelCount;i++)
-							{
-								if(i%2)
-									tright+=src[i]->getSample();
-								else
-									tleft+=src[i]->getSample();
-							}
-		
-							int16_t left=convert_sample<sample_t,int16_t>(tleft);
-							int16_t right=convert_sample<sample_t,int16_t>(tright);
-		
-							fwrite(&left,2,1,f);
-							fwrite(&right,2,1,f);
-							if(ferror(f))
-							{
-								const int errNO=errno;
-								throw runtime_error(string(__func__)+" -- error writing to file: "+filename+" -- "+strerror(errNO));
-							}
-
-							if(statusBar.update(statusTotal++))
-								throw EUserMessage(""); /* won't cause a popup */
-						}
-		
-						for(unsigned t=0;t<channelCount;t++)
-						{
-							delete src[t];
-							delete t_src[t];
-						}
-					}
-					catch(...)
-					{
-						fclose(f);
-						for(unsigned t=0;t<channelCount;t++)
-						{
-							delete src[t];
-							delete t_src[t];
-						}
-						throw;
-					}
-				}
-				fclose(f);
-			}
-			catch(...)
-			{
-				// remove files that were created
-				for(segments_t::iterator i2=segments.begin();i2!=(i+1);i2++)
-					unlink(i2->first.c_str());
-				throw;
-			}
-
-		}
-	}
-
 	// build TOC file for cdrdao
 	const string TOCFilename=prefix+".toc";
 	FILE *f=fopen(TOCFilename.c_str(),"w");
@@ -318,7 +261,9 @@ bool CBurnToCDAction::doActionSizeSafe(CActionSound *actionSound,bool prepareFor
 				fprintf(f,"SILENCE 00:%02d:00\n",gapBetweenTracks);
 				fprintf(f,"START\n");
 			}
-			fprintf(f,"FILE \"%s\" 0\n",i->first.c_str());
+			// the data is streamed to cdrdao's stdin, so the length has to be given (in samples)
+			const sample_pos_t srcLength=i->second.second-i->second.first;
+			fprintf(f,"FILE \"-\" 0 %lld\n",(long long)(sample_pos_t)((sample_fpos_t)srcLength/sampleRate*44100));
 			fprintf(f,"\n");
 		}
 
@@ -334,10 +279,6 @@ bool CBurnToCDAction::doActionSizeSafe(CActionSound *actionSound,bool prepareFor
 	catch(...)
 	{
 		unlink(TOCFilename.c_str());
-
-		// cleanup files
-		for(segments_t::iterator i=segments.begin();i!=segments.end();i++)
-			unlink(i->first.c_str());
 		throw;
 	}
 
@@ -361,16 +302,46 @@ bool CBurnToCDAction::doActionSizeSafe(CActionSound *actionSound,bool prepareFor
 			CDCount++;
 		*/
 
-		FILE *p=popen(command.c_str(),"r");
-		showStatus(p);
+		int stdinFd=-1;
+		FILE *p=mypopen_rw(command.c_str(),&stdinFd);
+		if(p==NULL)
+		{
+			const int errNO=errno;
+			unlink(TOCFilename.c_str());
+			throw runtime_error(string(__func__)+" -- error running cdrdao -- "+strerror(errNO));
+		}
+
+		// feed the tracks to cdrdao straight from the pool file while we watch its output
+		string streamError;
+		{
+			stdx::thread feedThread([&]() {
+				try
+				{
+					// (if this throws, the streamer's destructor closes cdrdao's stdin so it won't wait forever)
+					CPipeStreamer stream(stdinFd,true);
+					streamTracks(sound,segments,fullLength,stream);
+					stream.finish();
+				}
+				catch(exception &e)
+				{
+					streamError=e.what();
+				}
+			});
+
+			showStatus(p);
 
-		// finish eating the output of the command (otherwise it causes errors)
-		for(char c; (fread(&c,1,1,p)==1); )
-			{ fwrite(&c,1,1,stdout); fflush(stdout); }
+			// finish eating the output of the command (otherwise it causes errors)
+			for(char c; (fread(&c,1,1,p)==1); )
+				{ fwrite(&c,1,1,stdout); fflush(stdout); }
+
+			feedThread.join();
+		}
 
-		int ret=pclose(p);
-		if(WEXITSTATUS(ret)!=0)
+		int ret=mypclose(p);
+		if(!WIFEXITED(ret) || WEXITSTATUS(ret)!=0)
 			Warning(_("cdrdao returned non-zero exit status.  Consult standard output/error for problems."));
+		else if(streamError!="")
+			Warning(streamError);
 		else
 			CDCount++;
 
@@ -378,8 +349,6 @@ bool CBurnToCDAction::doActionSizeSafe(CActionSound *actionSound,bool prepareFor
 
 	// cleanup
 	unlink(TOCFilename.c_str());
-	for(segments_t::iterator i=segments.begin();i!=segments.end();i++)
-		unlink(i->first.c_str());
 
 	return true;
 }
@@ -20,9 +20,15 @@
 
 #include "CSaveAsMultipleFilesAction.h"
 
+#include <algorithm>
+#include <atomic>
 #include <map>
+#include <memory>
+#include <thread>
 #include <CPath.h>
 
+#include "stdx/thread"
+
 #include "../CActionParameters.h"
 #include "../AStatusComm.h"
 #include "../ASoundFileManager.h"
@@ -30,6 +36,168 @@
 
 #include "parse_segment_cues.h"
 
+/*
+ * When the same save parameters are used for every segment, nothing about saving a segment
+ * needs the user after the first one.  So the first segment is saved normally (which is when the
+ * translator asks for its parameters) and then the rest are encoded by a pool of worker threads
+ * while this thread shows one progress bar for all of them.  The workers only read the sound,
+ * and the size lock that doActionSizeSafe() is called with (and that each saveSound() takes again)
+ * is a shared lock.
+ */
+static bool saveSegmentsInParallel(ASoundFileManager *soundFileManager,const CSound &sound,segments_t &segments,const bool openSavedSegments)
+{
+	segments_t::iterator i=segments.begin();
+	for(;;)
+	{ // save the first segment here to get the user's save parameters
+		if(soundFileManager->savePartial(&sound,i->first,i->second.first,i->second.second-i->second.first,false))
+		{
+			if(openSavedSegments)
+				soundFileManager->open(i->first);
+			i++;
+			break;
+		}
+		else if(Question(i->first+"\n"+_("The file was not saved successfully.  Do you wish to abort saving any other files?"),yesnoQues)==yesAns)
+			return false;
+		else if((++i)==segments.end())
+			return true;
+	}
+
+	struct RJob
+	{
+		string filename;
+		const ASoundTranslator *translator;
+		sample_pos_t start,length;
+		bool saved;
+		string error;
+	};
+
+	// ask the rest of the questions (overwriting, etc) up front
+	vector<RJob> jobs;
+	sample_pos_t totalLength=0;
+	for(;i!=segments.end();i++)
+	{
+		RJob job;
+		job.filename=i->first;
+		job.translator=soundFileManager->prepareToSave(job.filename);
+		job.start=i->second.first;
+		job.length=i->second.second-i->second.first;
+		job.saved=false;
+
+		if(job.translator==NULL)
+		{ // the same as the save failing in the sequential case
+			if(Question(i->first+"\n"+_("The file was not saved successfully.  Do you wish to abort saving any other files?"),yesnoQues)==yesAns)
+				return false;
+			continue;
+		}
+
+		if(!job.translator->canSaveInBackground())
+		{ // save it now
+			if(job.translator->saveSound(job.filename,&sound,job.start,job.length,true))
+			{
+				soundFileManager->updateReopenHistory(job.filename);
+				if(openSavedSegments)
+					soundFileManager->open(job.filename);
+			}
+			else if(Question(job.filename+"\n"+_("The file was not saved successfully.  Do you wish to abort saving any other files?"),yesnoQues)==yesAns)
+				return false;
+			continue;
+		}
+
+		jobs.push_back(job);
+		totalLength+=job.length;
+	}
+
+	if(jobs.empty())
+		return true;
+
+	struct RWorker
+	{
+		std::atomic<int> progress; // of the segment being saved
+		std::atomic<sample_pos_t> length; // of the segment being saved
+	};
+
+	const size_t workerCount=max((size_t)1,min(jobs.size(),(size_t)std::thread::hardware_concurrency()));
+	std::unique_ptr<RWorker[]> workers(new RWorker[workerCount]);
+
+	CStatusCommRelay relay;
+	std::atomic<size_t> nextJob(0);
+	std::atomic<size_t> finishedJobs(0);
+	std::atomic<sample_pos_t> finishedLength(0);
+
+	vector<std::unique_ptr<stdx::thread>> threads;
+	for(size_t w=0;w<workerCount;w++)
+	{
+		RWorker &worker=workers[w];
+		worker.progress=0;
+		worker.length=0;
+		threads.push_back(std::make_unique<stdx::thread>([&relay,&jobs,&sound,&worker,&nextJob,&finishedJobs,&finishedLength]() {
+			size_t j;
+			while((j=nextJob++)<jobs.size())
+			{
+				RJob &job=jobs[j];
+				if(!relay.isCancelled())
+				{
+					worker.progress=0;
+					worker.length=job.length;
+					try
+					{
+						CStatusCommRelay::CWorkerScope scope(relay,&worker.progress);
+						job.saved=job.translator->saveSound(job.filename,&sound,job.start,job.length,true);
+					}
+					catch(exception &e)
+					{
+						job.error=e.what();
+					}
+					worker.length=0;
+				}
+				finishedLength+=job.length;
+				finishedJobs++;
+				relay.wake();
+			}
+		}));
+	}
+
+	{
+		CStatusBar statusBar(_("Saving Segments"),0,totalLength,true);
+		while(finishedJobs<jobs.size())
+		{
+			relay.service(100);
+
+			sample_pos_t progress=finishedLength;
+			for(size_t w=0;w<workerCount;w++)
+				progress+=(sample_pos_t)((double)workers[w].length*workers[w].progress/100.0);
+
+			if(statusBar.update(min(progress,totalLength)))
+				relay.cancel();
+		}
+	}
+
+	for(size_t t=0;t<threads.size();t++)
+		threads[t]->join();
+	relay.service(0); // anything said by the last worker to finish
+
+
+	// report the segments that weren't saved all at once
+	string failures;
+	for(size_t t=0;t<jobs.size();t++)
+	{
+		const RJob &job=jobs[t];
+		if(job.saved)
+		{
+			soundFileManager->updateReopenHistory(job.filename);
+			if(openSavedSegments)
+				soundFileManager->open(job.filename);
+		}
+		else if(!relay.isCancelled() || job.error!="")
+			failures+=job.filename+(job.error!="" ? " -- "+job.error : "")+"\n";
+	}
+
+	if(failures!="")
+		Error(_("These files were not saved successfully")+string(":\n\n")+failures,none,false);
+
+	return !relay.isCancelled();
+}
+
 CSaveAsMultipleFilesAction::CSaveAsMultipleFilesAction(const AActionFactory *factory,const CActionSound *actionSound,ASoundFileManager *_soundFileManager,const string _directory,const string _filenamePrefix,const string _filenameSuffix,const string _extension,bool _openSavedSegments,unsigned _segmentNumberOffset,bool _selectionOnly,bool _promptOnlyOnce) :
 	AAction(factory,actionSound),
 	soundFileManager(_soundFileManager),
@@ -107,23 +275,27 @@ bool CSaveAsMultipleFilesAction::doActionSizeSafe(CActionSound *actionSound,bool
 
 
 	// proceed to save files
-	bool useLastUserPrefs=false;
-	for(segments_t::iterator i=segments.begin();i!=segments.end();i++)
+	if(!promptOnlyOnce || segments.size()<2)
 	{
-		if(!soundFileManager->savePartial(&sound,i->first,i->second.first,i->second.second-i->second.first,useLastUserPrefs))
-		{ // error saving file
-			if(Question(i->first+"\n"+_("The file was not saved successfully.  Do you wish to abort saving any other files?"),yesnoQues)==yesAns)
-				return false;
-		}
-		else
-		{ // success saving file
-			if(openSavedSegments)
-				soundFileManager->open(i->first);
+		bool useLastUserPrefs=false;
+		for(segments_t::iterator i=segments.begin();i!=segments.end();i++)
+		{
+			if(!soundFileManager->savePartial(&sound,i->first,i->second.first,i->second.second-i->second.first,useLastUserPrefs))
+			{ // error saving file
+				if(Question(i->first+"\n"+_("The file was not saved successfully.  Do you wish to abort saving any other files?"),yesnoQues)==yesAns)
+					return false;
+			}
+			else
+			{ // success saving file
+				if(openSavedSegments)
+					soundFileManager->open(i->first);
+			}
+			useLastUserPrefs=promptOnlyOnce;
 		}
-		useLastUserPrefs=promptOnlyOnce;
+		return true;
 	}
-	
-	return true;
+	else
+		return saveSegmentsInParallel(soundFileManager,sound,segments,openSavedSegments);
 }
 
 AAction::CanUndoResults CSaveAsMultipleFilesAction::canUndo(const CActionSound *actionSound) const
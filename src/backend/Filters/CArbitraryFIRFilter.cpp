@@ -21,6 +21,7 @@
 #include "CArbitraryFIRFilter.h"
 
 #include <algorithm>
+#include <memory>
 #include <vector>
 
 #include "../CActionParameters.h"
@@ -66,8 +67,7 @@ bool CArbitraryFIRFilter::doActionSizeSafe(CActionSound *actionSound,bool prepar
 	const sample_pos_t filterKernelLength=kernelLength+1;
 	std::vector<float> filterKernel(filterKernelLength);
 	CGraphParamValueIterator fr_i(freqResponse,filterKernelLength);
-	for(size_t t=0;t<filterKernelLength;t++)
-		filterKernel[t]=fr_i.next();
+	fr_i.next(filterKernel.data(),filterKernelLength);
 	//filterKernel[0]=0.0; // I guess I should do this
 
 
@@ -79,111 +79,131 @@ bool CArbitraryFIRFilter::doActionSizeSafe(CActionSound *actionSound,bool prepar
 	const float dryGain=(100.0-fabs(wetdryMix))/100.0 * (wetdryMix<0.0 ? -1.0 : 1.0);
 	const float wetGain=wetdryMix/100.0;
 
-	unsigned channelsDoneCount=0;
+	// transform the kernel once and share it among each channel's convolver (fftw's planner isn't thread-safe so they're all made and destroyed on this thread)
+	std::vector<std::unique_ptr<TFFTConvolverTimeDomainKernel<float,float>>> convolvers(actionSound->sound->getChannelCount());
+	std::shared_ptr<const RFFTConvolverKernel> kernel;
 	for(unsigned i=0;i<actionSound->sound->getChannelCount();i++)
 	{
-		if(actionSound->doChannel[i])
+		if(!actionSound->doChannel[i])
+			continue;
+		if(!kernel)
 		{
-			TFFTConvolverFrequencyDomainKernel<float,float> convolver(filterKernel.data(),filterKernelLength);
+			convolvers[i]=std::make_unique<TFFTConvolverFrequencyDomainKernel<float,float>>(filterKernel.data(),filterKernelLength);
+			kernel=convolvers[i]->getKernel();
+		}
+		else
+			convolvers[i]=std::make_unique<TFFTConvolverTimeDomainKernel<float,float>>(kernel);
+	}
 
-			CRezPoolAccesser dest=actionSound->sound->getAudio(i);
-			const CRezPoolAccesser src=prepareForUndo ? actionSound->sound->getTempAudio(tempAudioPoolKey,i) : actionSound->sound->getAudio(i);
-			sample_pos_t srcOffset=prepareForUndo ? 0 : start;
+	const bool completed=processChannelsInParallel(actionSound,_("Filtering"),[&](const unsigned i) {
+		TFFTConvolverTimeDomainKernel<float,float> &convolver=*convolvers[i];
+		const size_t chunkSize=convolver.getChunkSize();
 
-			CStatusBar statusBar(_("Filtering -- Channel ")+istring(++channelsDoneCount)+"/"+istring(actionSound->countChannels()),start,stop,true); 
+		CRezPoolAccesser dest=actionSound->sound->getAudio(i);
+		CRezPoolAccesser src=prepareForUndo ? actionSound->sound->getTempAudio(tempAudioPoolKey,i) : actionSound->sound->getAudio(i);
+		sample_pos_t srcOffset=prepareForUndo ? 0 : start;
 
-			if(removeDelay)
-			{
-				// the filter kernel (necessarily) causes a delay of filterKernelLength/2 samples in the filtered output.
-				// so, here, I counter-act that effect by skipping the first filterKernelLength/2 samples
+		std::vector<sample_t> buffer(chunkSize);
+		std::vector<fftw_real> wet(chunkSize);
 
-				sample_pos_t srcFeedPos=srcOffset; // where in src to feed to the convolver
-				sample_pos_t srcReadPos=srcOffset; // where in src to read and mix with the convolver's output
-				const sample_pos_t srcStop=srcOffset+src.getSize();
-				sample_pos_t destPos=start;
-				sample_pos_t skipOutput=filterKernelLength/2;
+		CStatusBar statusBar(_("Filtering"),start,stop,true);
 
-				while(destPos<=stop)
-				{
-					const sample_pos_t count=min((sample_pos_t)convolver.getChunkSize(),stop-destPos+1); // amount to read/write to the convolver
-
-					// write to the convolver
-					{
-						convolver.beginWrite();
-						if(count>(srcStop-srcFeedPos)) // <-- optimization
-						{ // check for srcFeedPos overflow each time
-							for(sample_pos_t t=0;t<count && srcFeedPos<srcStop;t++)
-								convolver.writeSample(src[srcFeedPos++]);
-						}
-						else
-						{ // avoid that check above
-							for(sample_pos_t t=0;t<count;t++)
-								convolver.writeSample(src[srcFeedPos++]);
-						}
-					}
-
-					// read from the convolver
-					{
-						convolver.beginRead();
-
-						// skip as much of the convolved output as we can and are supposed to
-						const sample_pos_t maxToSkip=min(skipOutput,(sample_pos_t)convolver.getChunkSize());
-						sample_pos_t skippedAmount=0;
-						for(;skippedAmount<maxToSkip; skippedAmount++,skipOutput--)
-							convolver.readSample();
-
-						// now read from the convolver and write back to the dest as much as we can and as much as we're supposed to
-						const sample_pos_t maxToRead=min(count,(sample_pos_t)convolver.getChunkSize()-skippedAmount);
-						for(sample_pos_t t=0;t<maxToRead;t++)
-							dest[destPos++]=ClipSample((src[srcReadPos++])*dryGain+convolver.readSample()*wetGain);
-					}
-
-					if(statusBar.update(destPos))
-					{
-						if(prepareForUndo)
-							undoActionSizeSafe(actionSound);
-						else
-							actionSound->sound->invalidatePeakData(i,actionSound->start,destPos);
-						return false;
-					}
-				}
-			}
-			else
+		if(removeDelay)
+		{
+			// the filter kernel (necessarily) causes a delay of filterKernelLength/2 samples in the filtered output.
+			// so, here, I counter-act that effect by skipping the first filterKernelLength/2 samples
+
+			sample_pos_t srcFeedPos=srcOffset; // where in src to feed to the convolver
+			sample_pos_t srcReadPos=srcOffset; // where in src to read and mix with the convolver's output
+			const sample_pos_t srcStop=srcOffset+src.getSize();
+			sample_pos_t destPos=start;
+			sample_pos_t skipOutput=filterKernelLength/2;
+
+			while(destPos<=stop)
 			{
-				sample_pos_t srcPos=srcOffset;
-				sample_pos_t destPos=start;
-				while(destPos<=stop)
-				{
-					const sample_pos_t count=min((sample_pos_t)convolver.getChunkSize(),stop-destPos+1);
+				const sample_pos_t count=min((sample_pos_t)chunkSize,stop-destPos+1); // amount to read/write to the convolver
 
-					// write to the convolver
+				// write to the convolver (as much as there is left in src)
+				{
 					convolver.beginWrite();
-					for(sample_pos_t t=0;t<count;t++)
-						convolver.writeSample(src[srcPos++]);
-					srcPos-=count;
+					const sample_pos_t feedCount=min(count,srcStop-srcFeedPos);
+					src.seek(srcFeedPos);
+					src.read(buffer.data(),feedCount);
+					convolver.writeSamples(buffer.data(),feedCount);
+					srcFeedPos+=feedCount;
+				}
 
-					// read from the convolver
+				// read from the convolver
+				{
 					convolver.beginRead();
-					for(sample_pos_t t=0;t<count;t++)
-						dest[destPos++]=ClipSample((src[srcPos++])*dryGain+convolver.readSample()*wetGain);
-
-					if(statusBar.update(destPos))
-					{
-						if(prepareForUndo)
-							undoActionSizeSafe(actionSound);
-						else
-							actionSound->sound->invalidatePeakData(i,actionSound->start,destPos);
-						return false;
-					}
+
+					// skip as much of the convolved output as we can and are supposed to
+					const sample_pos_t skippedAmount=min(skipOutput,(sample_pos_t)chunkSize);
+					convolver.skipSamples(skippedAmount);
+					skipOutput-=skippedAmount;
+
+					// now read from the convolver and write back to the dest as much as we can and as much as we're supposed to
+					const sample_pos_t readCount=min(count,(sample_pos_t)chunkSize-skippedAmount);
+					convolver.readSamples(wet.data(),readCount);
+					src.seek(srcReadPos);
+					src.read(buffer.data(),readCount);
+					for(sample_pos_t t=0;t<readCount;t++)
+						buffer[t]=ClipSample(buffer[t]*dryGain+wet[t]*wetGain);
+					dest.seek(destPos);
+					dest.write(buffer.data(),readCount);
+					srcReadPos+=readCount;
+					destPos+=readCount;
 				}
+
+				if(statusBar.update(destPos))
+					return false;
+			}
+		}
+		else
+		{
+			sample_pos_t srcPos=srcOffset;
+			sample_pos_t destPos=start;
+			while(destPos<=stop)
+			{
+				const sample_pos_t count=min((sample_pos_t)chunkSize,stop-destPos+1);
+
+				src.seek(srcPos);
+				src.read(buffer.data(),count);
+				srcPos+=count;
+
+				// write to the convolver
+				convolver.beginWrite();
+				convolver.writeSamples(buffer.data(),count);
+
+				// read from the convolver
+				convolver.beginRead();
+				convolver.readSamples(wet.data(),count);
+				for(sample_pos_t t=0;t<count;t++)
+					buffer[t]=ClipSample(buffer[t]*dryGain+wet[t]*wetGain);
+				dest.seek(destPos);
+				dest.write(buffer.data(),count);
+				destPos+=count;
+
+				if(statusBar.update(destPos))
+					return false;
 			}
+		}
 
-			if(!prepareForUndo)
+		return true;
+	});
+
+	if(!completed && prepareForUndo)
+		undoActionSizeSafe(actionSound);
+	else if(!prepareForUndo)
+	{
+		for(unsigned i=0;i<actionSound->sound->getChannelCount();i++)
+		{
+			if(actionSound->doChannel[i])
 				actionSound->sound->invalidatePeakData(i,actionSound->start,actionSound->stop);
 		}
 	}
 
-	return(true);
+	return(completed);
 #endif
 	throw(EUserMessage(string(__func__)+_(" -- feature disabled because the fftw/rfftw library was not installed or detected when configure was run")));
 }
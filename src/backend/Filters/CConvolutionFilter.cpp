@@ -20,6 +20,7 @@
 
 #include "CConvolutionFilter.h"
 
+#include <memory>
 #include <vector>
 
 #include <CPath.h>
@@ -36,6 +37,8 @@
 
 #include "../settings.h"
 
+#include "filters_util.h"
+
 CConvolutionFilter::CConvolutionFilter(
 	const AActionFactory *factory,
 	const CActionSound *actionSound,
@@ -107,131 +110,169 @@ bool CConvolutionFilter::doActionSizeSafe(CActionSound *actionSound,bool prepare
 			const float dryGain=(100.0-fabs(wetdryMix))/100.0 * (wetdryMix<0.0 ? -1.0 : 1.0);
 			const float wetGain=wetdryMix/100.0;
 
-			unsigned channelsDoneCount=0;
+			// make each channel's convolver, but transform each channel of the kernel file only once and share that among the channels it's used for (fftw's planner isn't thread-safe so they're all made and destroyed on this thread)
+			std::vector<std::unique_ptr<TFFTConvolverTimeDomainKernel<float,float>>> convolvers(actionSound->sound->getChannelCount());
+			std::vector<std::shared_ptr<const RFFTConvolverKernel>> kernels(filterKernelFile.getChannelCount());
 			for(unsigned i=0;i<actionSound->sound->getChannelCount();i++)
 			{
-				if(actionSound->doChannel[i])
+				if(!actionSound->doChannel[i])
+					continue;
+
+				const unsigned k=i%filterKernelFile.getChannelCount();
+				if(kernels[k])
 				{
-					/*
-					 * read the data from filterKernelFile but also adjust the sample rate 
-					 * of the filterKernel file to match the action sound's sample rate 
-					 */
-					const sample_fpos_t rateAdjustment=(sample_fpos_t)actionSound->sound->getSampleRate()/(sample_fpos_t)filterKernelFile.getSampleRate();
+					convolvers[i]=std::make_unique<TFFTConvolverTimeDomainKernel<float,float>>(kernels[k]);
+					continue;
+				}
 
-					const CRezPoolAccesser filterKernelAccesser=filterKernelFile.getAudio(i%filterKernelFile.getChannelCount());
+				/*
+				 * read the data from filterKernelFile but also adjust the sample rate 
+				 * of the filterKernel file to match the action sound's sample rate 
+				 */
+				const sample_fpos_t rateAdjustment=(sample_fpos_t)actionSound->sound->getSampleRate()/(sample_fpos_t)filterKernelFile.getSampleRate();
 
-					const sample_pos_t filterKernelLength=(sample_pos_t)(filterKernelAccesser.getSize()*rateAdjustment/filterKernelRate);
-					std::vector<float> filterKernel(filterKernelLength);
+				const CRezPoolAccesser filterKernelAccesser=filterKernelFile.getAudio(k);
 
-					TSoundStretcher<const CRezPoolAccesser> filterKernelStretcher(filterKernelAccesser,0,filterKernelAccesser.getSize(),filterKernelLength);
+				const sample_pos_t filterKernelLength=(sample_pos_t)(filterKernelAccesser.getSize()*rateAdjustment/filterKernelRate);
+				std::vector<float> filterKernel(filterKernelLength);
 
-					TDSPSinglePoleLowpassFilter<float,float> filterKernelLowpassFilter(freq_to_fraction(filterKernelLowpassFreq,filterKernelFile.getSampleRate()));
-					for(sample_pos_t t=0;t<filterKernelLength;t++)
-						filterKernel[t]=filterKernelLowpassFilter.processSample(convert_sample<sample_t,float>(filterKernelStretcher.getSample())*filterKernelGain);
+				TSoundStretcher<const CRezPoolAccesser> filterKernelStretcher(filterKernelAccesser,0,filterKernelAccesser.getSize(),filterKernelLength);
 
-					if(reverseFilterKernel)
-					{
-						const sample_pos_t d=filterKernelLength/2;
-						sample_pos_t p1=0;
-						sample_pos_t p2=filterKernelLength-1;
-						for(sample_pos_t t=0;t<d;t++)
-						{
-							float temp=filterKernel[p1];
-							filterKernel[p1++]=filterKernel[p2];
-							filterKernel[p2--]=temp;
-						}
-					}
+				TDSPSinglePoleLowpassFilter<float,float> filterKernelLowpassFilter(freq_to_fraction(filterKernelLowpassFreq,filterKernelFile.getSampleRate()));
+				for(sample_pos_t t=0;t<filterKernelLength;t++)
+					filterKernel[t]=filterKernelLowpassFilter.processSample(convert_sample<sample_t,float>(filterKernelStretcher.getSample())*filterKernelGain);
 
-						// ??? this might be a bad thing.. cause a value in the filter kernel of 0.0000001 might be on purpose
-					// trim silent samples from the end of the filter kernel after rate changing, gain, and filtering
-					sample_pos_t filterKernelLengthSub=0;
-					for(sample_pos_t t=filterKernelLength-1;t>0;t--)
+				if(reverseFilterKernel)
+				{
+					const sample_pos_t d=filterKernelLength/2;
+					sample_pos_t p1=0;
+					sample_pos_t p2=filterKernelLength-1;
+					for(sample_pos_t t=0;t<d;t++)
 					{
-						if(fabs(filterKernel[t])>0.0000001)
-							break;
-						filterKernelLengthSub++;
+						float temp=filterKernel[p1];
+						filterKernel[p1++]=filterKernel[p2];
+						filterKernel[p2--]=temp;
 					}
+				}
 
-					//TSimpleConvolver<mix_sample_t,float> convolver(filterKernel.data(),filterKernelLength-filterKernelLengthSub);
-					TFFTConvolverTimeDomainKernel<float,float> convolver(filterKernel.data(),filterKernelLength-filterKernelLengthSub);
+					// ??? this might be a bad thing.. cause a value in the filter kernel of 0.0000001 might be on purpose
+				// trim silent samples from the end of the filter kernel after rate changing, gain, and filtering
+				sample_pos_t filterKernelLengthSub=0;
+				for(sample_pos_t t=filterKernelLength-1;t>0;t--)
+				{
+					if(fabs(filterKernel[t])>0.0000001)
+						break;
+					filterKernelLengthSub++;
+				}
 
-					TDSPSinglePoleLowpassFilter<float,float> inputLowpassFilter(freq_to_fraction(inputLowpassFreq,actionSound->sound->getSampleRate()));
+				//TSimpleConvolver<mix_sample_t,float> convolver(filterKernel.data(),filterKernelLength-filterKernelLengthSub);
+				convolvers[i]=std::make_unique<TFFTConvolverTimeDomainKernel<float,float>>(filterKernel.data(),filterKernelLength-filterKernelLengthSub);
+				kernels[k]=convolvers[i]->getKernel();
+			}
 
-					TDSPDelay<float> predelayer(ms_to_samples(predelay,actionSound->sound->getSampleRate()));
+			const bool completed=processChannelsInParallel(actionSound,_("Convolving"),[&](const unsigned i) {
+				TFFTConvolverTimeDomainKernel<float,float> &convolver=*convolvers[i];
+				const size_t chunkSize=convolver.getChunkSize();
 
-					CRezPoolAccesser dest=actionSound->sound->getAudio(i);
-					const CRezPoolAccesser src=prepareForUndo ? actionSound->sound->getTempAudio(tempAudioPoolKey,i) : actionSound->sound->getAudio(i);
-					sample_pos_t srcOffset=prepareForUndo ? 0 : start;
+				TDSPSinglePoleLowpassFilter<float,float> inputLowpassFilter(freq_to_fraction(inputLowpassFreq,actionSound->sound->getSampleRate()));
 
-					CStatusBar statusBar(_("Convolving -- Channel ")+istring(++channelsDoneCount)+"/"+istring(actionSound->countChannels()),start,stop,true); 
+				TDSPDelay<float> predelayer(ms_to_samples(predelay,actionSound->sound->getSampleRate()));
 
-					sample_pos_t srcPos=srcOffset;
-					sample_pos_t destPos=start;
-					sample_pos_t prevCount=0; // only needed in the wrapDecay section to know what size the last chunk was
-					while(destPos<=stop)
-					{
-						const sample_pos_t count=min((sample_pos_t)convolver.getChunkSize(),stop-destPos+1);
-						prevCount=count;
+				CRezPoolAccesser dest=actionSound->sound->getAudio(i);
+				CRezPoolAccesser src=prepareForUndo ? actionSound->sound->getTempAudio(tempAudioPoolKey,i) : actionSound->sound->getAudio(i);
+				sample_pos_t srcOffset=prepareForUndo ? 0 : start;
 
-						// write to the convolver
-						convolver.beginWrite();
-						if(predelay>0)
-						{
-								for(sample_pos_t t=0;t<count;t++)
-									convolver.writeSample(predelayer.processSample(inputLowpassFilter.processSample(inputGain*src[srcPos++])));
-						}
-						else // avoid running thru the predelay delay object if there is no predelay
-						{
-								for(sample_pos_t t=0;t<count;t++)
-									convolver.writeSample(inputLowpassFilter.processSample(inputGain*src[srcPos++]));
-						}
-						srcPos-=count;
+				std::vector<sample_t> buffer(chunkSize);
+				std::vector<float> feed(chunkSize);
+				std::vector<fftw_real> wet(chunkSize);
 
-						// read from the convolver
-						convolver.beginRead();
+				CStatusBar statusBar(_("Convolving"),start,stop,true);
+
+				sample_pos_t srcPos=srcOffset;
+				sample_pos_t destPos=start;
+				sample_pos_t prevCount=0; // only needed in the wrapDecay section to know what size the last chunk was
+				while(destPos<=stop)
+				{
+					const sample_pos_t count=min((sample_pos_t)chunkSize,stop-destPos+1);
+					prevCount=count;
+
+					src.seek(srcPos);
+					src.read(buffer.data(),count);
+					srcPos+=count;
+
+					// write to the convolver
+					if(predelay>0)
+					{
 						for(sample_pos_t t=0;t<count;t++)
-							dest[destPos++]=ClipSample(outputGain*(src[srcPos++]*dryGain+convolver.readSample()*wetGain));
+							feed[t]=predelayer.processSample(inputLowpassFilter.processSample(inputGain*buffer[t]));
+					}
+					else // avoid running thru the predelay delay object if there is no predelay
+					{
+						for(sample_pos_t t=0;t<count;t++)
+							feed[t]=inputLowpassFilter.processSample(inputGain*buffer[t]);
+					}
+					convolver.beginWrite();
+					convolver.writeSamples(feed.data(),count);
+
+					// read from the convolver
+					convolver.beginRead();
+					convolver.readSamples(wet.data(),count);
+					for(sample_pos_t t=0;t<count;t++)
+						buffer[t]=ClipSample(outputGain*(buffer[t]*dryGain+wet[t]*wetGain));
+					dest.seek(destPos);
+					dest.write(buffer.data(),count);
+					destPos+=count;
+
+					if(statusBar.update(destPos))
+						return false;
+				}
 
-						// (if TSimpleConvolver were used)
-						//dest[destPos++]=ClipSample(convolver.processSample(src[srcPos++]));
+				if(wrapDecay)
+				{
+					destPos=start;
 
-						if(statusBar.update(destPos))
+					// mixes the first count samples in wet onto dest, going back to the start of the selection whenever the stop is passed
+					const auto mixWrapped=[&](const sample_pos_t count) {
+						for(sample_pos_t done=0;done<count;)
 						{
-							if(prepareForUndo)
-								undoActionSizeSafe(actionSound);
-							else
-								actionSound->sound->invalidatePeakData(i,actionSound->start,destPos);
-							filterKernelFile.closeSound();
-							unlink(tempFilename.c_str());
-							return false;
+							const sample_pos_t n=min(count-done,stop-destPos+1);
+							dest.seek(destPos);
+							dest.read(buffer.data(),n);
+							for(sample_pos_t t=0;t<n;t++)
+								buffer[t]=ClipSample(buffer[t]+(outputGain*wet[done+t]*wetGain));
+							dest.seek(destPos);
+							dest.write(buffer.data(),n);
+							done+=n;
+							destPos+=n;
+							if(destPos>stop)
+								destPos=start;
 						}
-					}
+					};
+
+					// finish reading from a possibly incomplete write of a whole chunk (yet it did pad with zeros up there)
+					convolver.readSamples(wet.data(),chunkSize-prevCount);
+					mixWrapped(chunkSize-prevCount);
 
-					if(wrapDecay)
+					// finish reading the extra samples from the convolution
+					for(sample_pos_t remaining=convolver.getFilterKernelSize()-1;remaining>0;)
 					{
-							destPos=start;
-
-							// finish reading from a possibly incomplete write of a whole chunk (yet it did pad with zeros up there)
-							for(sample_pos_t t=prevCount;t<convolver.getChunkSize();t++)
-							{
-								dest[destPos]=ClipSample(dest[destPos]+(outputGain*convolver.readSample()*wetGain));
-								destPos++;
-								if(destPos>stop)
-										destPos=start;
-							}
-
-							// finish reading the extra samples from the convolution
-							const sample_pos_t M=(filterKernelLength-filterKernelLengthSub); // I really think I could also subtract the iteration count of the preceeding loop (essentially because trailing zeros were processed in the final chunk)
-							for(sample_pos_t t=0;t<M-1;t++)
-							{
-								dest[destPos]=ClipSample(dest[destPos]+(outputGain*convolver.readEndingSample()*wetGain));
-								destPos++;
-								if(destPos>stop)
-										destPos=start;
-							}
+						const sample_pos_t n=min(remaining,(sample_pos_t)chunkSize);
+						convolver.readEndingSamples(wet.data(),n);
+						mixWrapped(n);
+						remaining-=n;
 					}
+				}
+
+				return true;
+			});
 
-					if(!prepareForUndo)
+			if(!completed && prepareForUndo)
+				undoActionSizeSafe(actionSound);
+			else if(!prepareForUndo)
+			{
+				for(unsigned i=0;i<actionSound->sound->getChannelCount();i++)
+				{
+					if(actionSound->doChannel[i])
 						actionSound->sound->invalidatePeakData(i,actionSound->start,actionSound->stop);
 				}
 			}
@@ -239,7 +280,7 @@ bool CConvolutionFilter::doActionSizeSafe(CActionSound *actionSound,bool prepare
 			filterKernelFile.closeSound();
 			unlink(tempFilename.c_str());
 
-			return(true);
+			return(completed);
 		}
 		catch(...)
 		{
@@ -110,8 +110,7 @@ bool CMorphingArbitraryFIRFilter::doActionSizeSafe(CActionSound *actionSound,boo
 				const CGraphParamValueNodeList normFreqResponse=normalizeFrequencyResponse(freqResponse,actionSound->sound->getSampleRate()); \
  																\
 				CGraphParamValueIterator fr_i(normFreqResponse,filterKernelLength); 				\
-				for(size_t t=0;t<filterKernelLength;t++) 							\
-					filterKernel[t]=fr_i.next(); 								\
+				fr_i.next(filterKernel.data(),filterKernelLength); 						\
 				convolver.setNewMagnitudeArray(filterKernel.data(),filterKernelLength); 				\
 			}
 
@@ -22,6 +22,7 @@
 
 #include "../CActionSound.h"
 #include "../CActionParameters.h"
+#include "../APreviewProcessor.h"
 
 #include "../DSP/SinglePoleFilters.h"
 #include "../unit_conv.h"
@@ -144,12 +145,42 @@ void CSinglePoleFilter::undoActionSizeSafe(const CActionSound *actionSound)
 	restoreSelectionFromTempPools(actionSound,actionSound->start,actionSound->selectionLength());
 }
 
+template<class filter_t> static APreviewProcessor *createFilterPreviewProcessor(const CActionSound *actionSound,const std::function<filter_t *()> &createFilter,const float gain)
+{
+	return new TPerChannelPreviewProcessor<filter_t>(
+		actionSound,
+		createFilter,
+		[gain](filter_t &filter,const sample_t s) { return ClipSample(filter.processSample((mix_sample_t)(gain*s))); }
+	);
+}
+
+APreviewProcessor *CSinglePoleFilter::createPreviewProcessor(const CActionSound *actionSound) const
+{
+	const float frequency=freq_to_fraction(this->frequency,actionSound->sound->getSampleRate());
+	const float bandwidth=freq_to_fraction(this->bandwidth,actionSound->sound->getSampleRate());
+
+	switch(filterType)
+	{
+	case ftLowpass:
+		return createFilterPreviewProcessor<TDSPSinglePoleLowpassFilter<mix_sample_t>>(actionSound,[frequency]() { return new TDSPSinglePoleLowpassFilter<mix_sample_t>(frequency); },gain);
+	case ftHighpass:
+		return createFilterPreviewProcessor<TDSPSinglePoleHighpassFilter<mix_sample_t>>(actionSound,[frequency]() { return new TDSPSinglePoleHighpassFilter<mix_sample_t>(frequency); },gain);
+	case ftBandpass:
+		return createFilterPreviewProcessor<TDSPBandpassFilter<mix_sample_t>>(actionSound,[frequency,bandwidth]() { return new TDSPBandpassFilter<mix_sample_t>(frequency,bandwidth); },gain);
+	case ftNotch:
+		return createFilterPreviewProcessor<TDSPNotchFilter<mix_sample_t>>(actionSound,[frequency,bandwidth]() { return new TDSPNotchFilter<mix_sample_t>(frequency,bandwidth); },gain);
+	default:
+		throw(runtime_error(string(__func__)+" -- invalid filterType: "+istring(filterType)));
+	}
+}
+
 
 // --------------------------------------------------
 
 CSinglePoleLowpassFilterFactory::CSinglePoleLowpassFilterFactory(AActionDialog *channelSelectDialog,AActionDialog *dialog) :
 	AActionFactory(N_("Single Pole Lowpass Filter"),"",channelSelectDialog,dialog)
 {
+	previewIsApplicable=true;
 }
 
 CSinglePoleLowpassFilterFactory::~CSinglePoleLowpassFilterFactory()
@@ -172,6 +203,7 @@ CSinglePoleFilter *CSinglePoleLowpassFilterFactory::manufactureAction(const CAct
 CSinglePoleHighpassFilterFactory::CSinglePoleHighpassFilterFactory(AActionDialog *channelSelectDialog,AActionDialog *dialog) :
 	AActionFactory(N_("Single Pole Highpass Filter"),"",channelSelectDialog,dialog)
 {
+	previewIsApplicable=true;
 }
 
 CSinglePoleHighpassFilterFactory::~CSinglePoleHighpassFilterFactory()
@@ -194,6 +226,7 @@ CSinglePoleFilter *CSinglePoleHighpassFilterFactory::manufactureAction(const CAc
 CBandpassFilterFactory::CBandpassFilterFactory(AActionDialog *channelSelectDialog,AActionDialog *dialog) :
 	AActionFactory(N_("Bandpass Filter"),"",channelSelectDialog,dialog)
 {
+	previewIsApplicable=true;
 }
 
 CBandpassFilterFactory::~CBandpassFilterFactory()
@@ -217,6 +250,7 @@ CSinglePoleFilter *CBandpassFilterFactory::manufactureAction(const CActionSound
 CNotchFilterFactory::CNotchFilterFactory(AActionDialog *channelSelectDialog,AActionDialog *dialog) :
 	AActionFactory(N_("Notch Filter"),"",channelSelectDialog,dialog)
 {
+	previewIsApplicable=true;
 }
 
 CNotchFilterFactory::~CNotchFilterFactory()
@@ -51,6 +51,8 @@ protected:
 	void undoActionSizeSafe(const CActionSound *actionSound);
 	CanUndoResults canUndo(const CActionSound *actionSound) const;
 
+	APreviewProcessor *createPreviewProcessor(const CActionSound *actionSound) const;
+
 private:
 	const FilterTypes filterType;
 	const float gain;
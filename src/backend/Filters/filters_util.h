@@ -1,7 +1,20 @@
 #ifndef __filters_util_H__
 #define __filters_util_H__
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "stdx/thread"
+
 #include "../CGraphParamValueNode.h"
+#include "../CActionSound.h"
+#include "../AStatusComm.h"
 
 static const CGraphParamValueNodeList normalizeFrequencyResponse(const CGraphParamValueNodeList &_freqResponse,unsigned sampleRate)
 {
@@ -49,4 +62,91 @@ static const CGraphParamValueNodeList normalizeFrequencyResponse(const CGraphPar
 	return freqResponse;
 }
 
+
+/*
+ * Calls processChannel() for each channel of the action, several channels at a time on a pool of
+ * worker threads while this thread shows one progress bar for all of them.  A CStatusBar that
+ * processChannel() constructs reports into that progress bar, and its update() returns true once
+ * the user has cancelled.  processChannel() should return false when it stops because of that.
+ *
+ * Returns false if cancelled.  If processChannel() throws, the other workers are cancelled and the
+ * first exception is rethrown here after all of them have stopped.
+ */
+static bool processChannelsInParallel(const CActionSound *actionSound,const string title,const std::function<bool(unsigned channel)> &processChannel)
+{
+	std::vector<unsigned> channels;
+	for(unsigned i=0;i<actionSound->sound->getChannelCount();i++)
+	{
+		if(actionSound->doChannel[i])
+			channels.push_back(i);
+	}
+	if(channels.empty())
+		return true;
+
+	const size_t workerCount=std::max((size_t)1,std::min(channels.size(),(size_t)std::thread::hardware_concurrency()));
+	std::unique_ptr<std::atomic<int>[]> progress(new std::atomic<int>[channels.size()]); // of each channel from 0 to 100
+	for(size_t t=0;t<channels.size();t++)
+		progress[t]=0;
+
+	CStatusCommRelay relay;
+	std::atomic<size_t> nextChannel(0);
+	std::atomic<size_t> finishedChannels(0);
+	std::mutex errorMutex;
+	std::exception_ptr error;
+
+	std::vector<std::unique_ptr<stdx::thread>> threads;
+	for(size_t w=0;w<workerCount;w++)
+	{
+		threads.push_back(std::make_unique<stdx::thread>([&relay,&channels,&progress,&processChannel,&nextChannel,&finishedChannels,&errorMutex,&error]() {
+			size_t c;
+			while((c=nextChannel++)<channels.size())
+			{
+				if(!relay.isCancelled())
+				{
+					try
+					{
+						CStatusCommRelay::CWorkerScope scope(relay,&progress[c]);
+						if(!processChannel(channels[c]))
+							relay.cancel();
+					}
+					catch(...)
+					{
+						std::lock_guard<std::mutex> lock(errorMutex);
+						if(!error)
+							error=std::current_exception();
+						relay.cancel();
+					}
+				}
+				progress[c]=100;
+				finishedChannels++;
+				relay.wake();
+			}
+		}));
+	}
+
+	{
+		CStatusBar statusBar(title,0,channels.size()*100,true);
+		while(finishedChannels<channels.size())
+		{
+			relay.service(100);
+
+			sample_pos_t totalProgress=0;
+			for(size_t t=0;t<channels.size();t++)
+				totalProgress+=progress[t];
+
+			if(statusBar.update(totalProgress))
+				relay.cancel();
+		}
+	}
+
+	for(size_t t=0;t<threads.size();t++)
+		threads[t]->join();
+	relay.service(0); // anything said by the last worker to finish
+
+	if(error)
+		std::rethrow_exception(error);
+
+	return !relay.isCancelled();
+}
+
 #endif
@@ -26,6 +26,7 @@
 #include "../CActionParameters.h"
 #include "../unit_conv.h"
 
+#include "../DSP/Delay.h"
 #include "../DSP/LevelDetector.h"
 
 //??? could use a state machine or some sort of fuzzy state machine that doesnt raise the gain unless there is going to be a rise again in some minimum amount of time (actually could probably just use a delay line to do this)
@@ -84,7 +85,6 @@ bool CAdaptiveNormalizeAction::doActionSizeSafe(CActionSound *actionSound,bool p
 				// now 'src' is an accessor either directly into the sound or into the temp pool created for undo
 				// so its range of indexes is either [start,stop] or [0,selectionLength) respectively
 
-				const CRezPoolAccesser src_alt=src; // could be improved by possibly using a delay line instead of having another src to read from
 				sample_pos_t destPos=start;
 				CRezPoolAccesser dest=actionSound->sound->getAudio(i);
 
@@ -92,12 +92,19 @@ bool CAdaptiveNormalizeAction::doActionSizeSafe(CActionSound *actionSound,bool p
 				// prime the level detector
 				for(sample_pos_t t=0;t<windowSize && (srcPos+hWindowSize+t)<src.getSize();t++)
 					detector.updateLevel(src[srcPos+hWindowSize+t]);
+
+				// src is only read hWindowSize samples ahead for the level and the samples to 
+				// be normalized come back out of this delay line when it's their turn
+				TDSPDelay<mix_sample_t> lookAhead(hWindowSize);
+				for(sample_pos_t t=0;t<hWindowSize;t++)
+					lookAhead.putSample(src[srcPos+t]);
 				
 				const sample_pos_t _stop=stop-hWindowSize;
 				while(destPos<=_stop)
 				{
-					const mix_sample_t s_level=(mix_sample_t)(src_alt[srcPos+hWindowSize]);
-					const mix_sample_t s_input=(mix_sample_t)(src[srcPos++]);
+					const mix_sample_t s_level=(mix_sample_t)(src[srcPos+hWindowSize]);
+					const mix_sample_t s_input= hWindowSize>0 ? lookAhead.processSample(s_level) : s_level;
+					srcPos++;
 					const mix_sample_t currentLevel=detector.readLevel(s_level);
 
 					if(normalizationLevel>(maxGain*currentLevel))
@@ -135,11 +142,11 @@ bool CAdaptiveNormalizeAction::doActionSizeSafe(CActionSound *actionSound,bool p
 	}
 	else 
 	{ // same algorithm as above, but uses the max level of all channels for calculating the gain of a channel
-		// set up 3 arrays of accessers (two srcs and one dest) for each channel to be processed
+		// set up 2 arrays of accessers (src and dest) for each channel to be processed
 		unsigned nChannels=0;
 		CRezPoolAccesser *dests[MAX_CHANNELS];
 		const CRezPoolAccesser *srcs[MAX_CHANNELS];
-		const CRezPoolAccesser *srcs_alt[MAX_CHANNELS];
+		TDSPDelay<mix_sample_t> lookAheads[MAX_CHANNELS]; // like lookAhead above
 
 		sample_pos_t destPos=start;
 		sample_pos_t srcPos=prepareForUndo ? 0 : start;
@@ -151,18 +158,20 @@ bool CAdaptiveNormalizeAction::doActionSizeSafe(CActionSound *actionSound,bool p
 				{
 					dests[nChannels]=new CRezPoolAccesser(actionSound->sound->getAudio(i));
 					srcs[nChannels]=new CRezPoolAccesser(prepareForUndo ? actionSound->sound->getTempAudio(tempAudioPoolKey,i) : actionSound->sound->getAudio(i));
-					srcs_alt[nChannels]=new CRezPoolAccesser(*(srcs[nChannels]));
+					lookAheads[nChannels].setDelayTime(hWindowSize);
+					for(sample_pos_t t=0;t<hWindowSize;t++)
+						lookAheads[nChannels].putSample((*(srcs[nChannels]))[srcPos+t]);
 					nChannels++;
 				}
 			}
 
 			CDSPRMSLevelDetector detector(windowSize);
 			// prime the level detector
-			for(sample_pos_t t=0;t<windowSize && (srcPos+hWindowSize+t)<srcs_alt[0]->getSize();t++)
+			for(sample_pos_t t=0;t<windowSize && (srcPos+hWindowSize+t)<srcs[0]->getSize();t++)
 			{
-				mix_sample_t s_level=(mix_sample_t)((*(srcs_alt[0]))[srcPos+hWindowSize+t]);
+				mix_sample_t s_level=(mix_sample_t)((*(srcs[0]))[srcPos+hWindowSize+t]);
 				for(unsigned i=1;i<nChannels;i++)
-					s_level=max((mix_sample_t)((*(srcs_alt[i]))[srcPos+hWindowSize+t]),s_level);
+					s_level=max((mix_sample_t)((*(srcs[i]))[srcPos+hWindowSize+t]),s_level);
 				detector.updateLevel(s_level);
 			}
 
@@ -170,14 +179,14 @@ bool CAdaptiveNormalizeAction::doActionSizeSafe(CActionSound *actionSound,bool p
 			const sample_pos_t _stop=stop-hWindowSize;
 			while(destPos<=_stop)
 			{
-				mix_sample_t s_level=(mix_sample_t)((*(srcs_alt[0]))[srcPos+hWindowSize]);
+				mix_sample_t s_level=(mix_sample_t)((*(srcs[0]))[srcPos+hWindowSize]);
 				for(unsigned i=1;i<nChannels;i++)
-					s_level=max((mix_sample_t)((*(srcs_alt[i]))[srcPos+hWindowSize]),s_level);
+					s_level=max((mix_sample_t)((*(srcs[i]))[srcPos+hWindowSize]),s_level);
 
 				const mix_sample_t currentLevel=detector.readLevel(s_level);
 				for(unsigned i=0;i<nChannels;i++)
 				{
-					const mix_sample_t s_input=(mix_sample_t)((*(srcs[i]))[srcPos]);
+					const mix_sample_t s_input= hWindowSize>0 ? lookAheads[i].processSample((*(srcs[i]))[srcPos+hWindowSize]) : (mix_sample_t)((*(srcs[i]))[srcPos]);
 					if(normalizationLevel>(maxGain*currentLevel))
 						(*(dests[i]))[destPos]=ClipSample(s_input*maxGain);
 					else
@@ -202,7 +211,6 @@ bool CAdaptiveNormalizeAction::doActionSizeSafe(CActionSound *actionSound,bool p
 					{
 						delete dests[i];
 						delete srcs[i];
-						delete srcs_alt[i];
 					}
 					return false;
 				}
@@ -233,7 +241,6 @@ bool CAdaptiveNormalizeAction::doActionSizeSafe(CActionSound *actionSound,bool p
 			{
 				delete dests[i];
 				delete srcs[i];
-				delete srcs_alt[i];
 			}
 		}
 		catch(...)
@@ -242,7 +249,6 @@ bool CAdaptiveNormalizeAction::doActionSizeSafe(CActionSound *actionSound,bool p
 			{
 				delete dests[i];
 				delete srcs[i];
-				delete srcs_alt[i];
 			}
 			throw;
 		}
@@ -1,6 +1,8 @@
 #include "CCompressorAction.h"
 
 #include <algorithm>
+#include <memory>
+#include <vector>
 
 #include "../DSP/Compressor.h"
 #include "../unit_conv.h"
@@ -28,237 +30,129 @@ CCompressorAction::~CCompressorAction()
 
 bool CCompressorAction::doActionSizeSafe(CActionSound *actionSound,bool prepareForUndo)
 {
-	const sample_pos_t start=actionSound->start;
-	const sample_pos_t stop=actionSound->stop;
-	const sample_pos_t selectionLength=actionSound->selectionLength();
-
 	// ??? boy... if AAction had it abstracted out better so that I could make as many backups of sections as I wanted, I could essientially backup only the sections that need to be ... except then I would need feedback from the compressor DSP block to know when compression started and stopped... and it wouldn't be for all channels... and... I'd have to 
 	// well.. then I would have to look ahead at the threshold crossings... it would be harder than I think to do undo efficently ... but it would be interesting.. maybe I could make two passes thru the data
 
 	if(prepareForUndo)
 		moveSelectionToTempPools(actionSound,mmSelection,actionSound->selectionLength());
 
-	const sample_pos_t windowSize=ms_to_samples(windowTime,actionSound->sound->getSampleRate());
-	const sample_pos_t hWindowSize=windowSize/2;
+	unsigned channels[MAX_CHANNELS];
+	unsigned channelCount=0;
+	for(unsigned i=0;i<actionSound->sound->getChannelCount();i++)
+	{
+		if(actionSound->doChannel[i])
+			channels[channelCount++]=i;
+	}
 
 	if(!syncChannels || actionSound->sound->getChannelCount()==1)
 	{
-		unsigned channelsDoneCount=0;
-		for(unsigned i=0;i<actionSound->sound->getChannelCount();i++)
+		for(unsigned t=0;t<channelCount;t++)
 		{
-			if(actionSound->doChannel[i])
-			{
-				CStatusBar statusBar(_("Compressor -- Channel ")+istring(++channelsDoneCount)+"/"+istring(actionSound->countChannels()),start,stop,true);
-
-				sample_pos_t srcPos=prepareForUndo ? 0 : start;
-				const CRezPoolAccesser src=prepareForUndo ? actionSound->sound->getTempAudio(tempAudioPoolKey,i) : actionSound->sound->getAudio(i);
-
-				sample_pos_t destPos=start;
-				CRezPoolAccesser dest=actionSound->sound->getAudio(i);
-
-				CDSPCompressor compressor(
-					windowSize,
-					dBFS_to_amp(threshold),
-					ratio,
-					ms_to_samples(attackTime,actionSound->sound->getSampleRate()),
-					ms_to_samples(releaseTime,actionSound->sound->getSampleRate())
-				);
-
-				// initialize the compressor's level detector
-				//while((destPos++)<min(stop,4000))
-					//compressor.initSample(src[srcPos++]);
-
-				if(lookAheadForLevel && stop>hWindowSize)
-				{
-					const CRezPoolAccesser src_alt=src; // could be improved by possibly using a delay line instead of having another src to read from
-					const sample_pos_t _stop=stop-hWindowSize;
-					while(destPos<=_stop)
-					{
-						const mix_sample_t s_level=(mix_sample_t)(src_alt[srcPos+hWindowSize]*inputGain);
-						const mix_sample_t s_input=(mix_sample_t)(src[srcPos++]*inputGain);
-						dest[destPos]=ClipSample(compressor.processSample(s_input,s_level)*outputGain);
-
-						if(statusBar.update(destPos))
-						{ // cancelled
-							if(prepareForUndo)
-								undoActionSizeSafe(actionSound);
-							else
-								actionSound->sound->invalidatePeakData(i,actionSound->start,destPos);
-							return false;
-						}
-
-						destPos++;
-					}
-					// copy remainder that we couldn't look ahead for
-					while(destPos<=stop)
-						dest[destPos++]=src[srcPos++];
-				}
-				else
-				{
-					while(destPos<=stop)
-					{
-						
-						const mix_sample_t s=(mix_sample_t)(src[srcPos++]*inputGain);
-						dest[destPos]=ClipSample(compressor.processSample(s,s)*outputGain);
-
-						if(statusBar.update(destPos))
-						{ // cancelled
-							if(prepareForUndo)
-								undoActionSizeSafe(actionSound);
-							else
-								actionSound->sound->invalidatePeakData(i,actionSound->start,destPos);
-							return false;
-						}
-
-						destPos++;
-					}
-				}
-
-				if(!prepareForUndo)
-					actionSound->sound->invalidatePeakData(i,actionSound->start,actionSound->stop);
-			}
+			if(!compressChannels(actionSound,prepareForUndo,channels+t,1,false,_("Compressor -- Channel ")+istring(t+1)+"/"+istring(channelCount)))
+				return false;
 		}
 	}
 	else // the level should be determined from all the samples in a frame but all frames in a sample should be affected by that singular level
 	{
-		CDSPCompressor	compressor(
-			ms_to_samples(windowTime,actionSound->sound->getSampleRate()),
-			dBFS_to_amp(threshold),
-			ratio,
-			ms_to_samples(attackTime,actionSound->sound->getSampleRate()),
-			ms_to_samples(releaseTime,actionSound->sound->getSampleRate())
-		);
-
-		sample_pos_t srcPos=prepareForUndo ? 0 : start;
-		const CRezPoolAccesser *srces[MAX_CHANNELS]; // ??? I could be more efficient by being able to call operator= for elements of an existing array of accessors so I didn't have to do the extra dereference
-		const CRezPoolAccesser *alt_srces[MAX_CHANNELS]; // ??? I could be more efficient by being able to call operator= for elements of an existing array of accessors so I didn't have to do the extra dereference
-
-		sample_pos_t destPos=start;
-		CRezPoolAccesser *dests[MAX_CHANNELS]; // ??? I could be more efficient by being able to call operator= for elements of an existing array of accessors so I didn't have to do the extra dereference
-
-		size_t channelCount=0;
-		for(unsigned i=0;i<actionSound->sound->getChannelCount();i++)
-		{
-			if(actionSound->doChannel[i])
-			{
-				srces[channelCount]=new CRezPoolAccesser(prepareForUndo ? actionSound->sound->getTempAudio(tempAudioPoolKey,i) : actionSound->sound->getAudio(i));
-				alt_srces[channelCount]=new CRezPoolAccesser(prepareForUndo ? actionSound->sound->getTempAudio(tempAudioPoolKey,i) : actionSound->sound->getAudio(i));
-				dests[channelCount]=new CRezPoolAccesser(actionSound->sound->getAudio(i));
-				channelCount++;
-			}
-		}
+		if(!compressChannels(actionSound,prepareForUndo,channels,channelCount,true,_("Compressor ")))
+			return false;
+	}
 
-		try
-		{
-			CStatusBar statusBar(_("Compressor "),start,stop,true);
+	// set the new selection points (only necessary if the length of the sound has changed)
+	//actionSound->stop=actionSound->start+selectionLength-1;
 
-			// initialize the compressor's level detector
-			//while((destPos++)<min(stop,4000))
-				//compressor.initSample(src[srcPos++]);
+	return(true);
+}
 
-			mix_sample_t levelInputFrame[MAX_CHANNELS];
-			mix_sample_t inputFrame[MAX_CHANNELS];
-			if(lookAheadForLevel && stop>hWindowSize)
-			{
-				const sample_pos_t _stop=stop-hWindowSize;
-				while(destPos<=_stop)
-				{
-					for(unsigned t=0;t<channelCount;t++)
-					{
-						levelInputFrame[t]=(mix_sample_t)((*(alt_srces[t]))[srcPos+hWindowSize]*inputGain);
-						inputFrame[t]=(mix_sample_t)((*(srces[t]))[srcPos]*inputGain);
-					}
-					srcPos++;
-
-					compressor.processSampleFrame(inputFrame,levelInputFrame,channelCount);
-
-					for(unsigned t=0;t<channelCount;t++)
-						(*(dests[t]))[destPos]=ClipSample(inputFrame[t]*outputGain);
-			
-					if(statusBar.update(destPos))
-					{ // cancelled
-						if(prepareForUndo)
-							undoActionSizeSafe(actionSound);
-						// cleanup
-						for(size_t t=0;t<channelCount;t++)
-						{
-							if(!prepareForUndo)
-								actionSound->sound->invalidatePeakData(t,actionSound->start,destPos);
-
-							delete srces[t];
-							delete dests[t];
-						}
-						return false;
-					}
-
-					destPos++;
-				}
-				// copy remainder that we couldn't look ahead for
-				while(destPos<=stop)
-				{
-					for(unsigned t=0;t<channelCount;t++)
-						(*(dests[t]))[destPos]=(*(srces[t]))[srcPos];
-					srcPos++;
-					destPos++;
-				}
-			}
-			else
-			{
-				while(destPos<=stop)
-				{
-					for(unsigned t=0;t<channelCount;t++)
-						inputFrame[t]=(mix_sample_t)((*(srces[t]))[srcPos]*inputGain);
-					srcPos++;
-
-					compressor.processSampleFrame(inputFrame,inputFrame,channelCount);
-
-					for(unsigned t=0;t<channelCount;t++)
-						(*(dests[t]))[destPos]=ClipSample(inputFrame[t]*outputGain);
-			
-					if(statusBar.update(destPos))
-					{ // cancelled
-						if(prepareForUndo)
-							undoActionSizeSafe(actionSound);
-						// cleanup
-						for(size_t t=0;t<channelCount;t++)
-						{
-							if(!prepareForUndo)
-								actionSound->sound->invalidatePeakData(t,actionSound->start,destPos);
-
-							delete srces[t];
-							delete dests[t];
-						}
-						return false;
-					}
-
-					destPos++;
-				}
-			}
+bool CCompressorAction::compressChannels(CActionSound *actionSound,bool prepareForUndo,const unsigned *channels,const unsigned channelCount,const bool linked,const string statusTitle)
+{
+	const sample_pos_t start=actionSound->start;
+	const sample_pos_t stop=actionSound->stop;
+	const sample_pos_t selectionLength=actionSound->selectionLength();
+	const unsigned sampleRate=actionSound->sound->getSampleRate();
+
+	const sample_pos_t windowSize=ms_to_samples(windowTime,sampleRate);
+
+	// the compressor reads the level this far ahead of the samples it's adjusting by delaying its output
+	const sample_pos_t lookAheadTime=lookAheadForLevel ? min(windowSize/2,selectionLength) : 0;
+
+	CDSPCompressor compressor(
+		windowSize,
+		dBFS_to_amp(threshold),
+		ratio,
+		ms_to_samples(attackTime,sampleRate),
+		ms_to_samples(releaseTime,sampleRate),
+		lookAheadTime
+	);
+
+	// now each src is an accessor either directly into the sound or into the temp pool created for undo
+	// so its range of indexes is either [start,stop] or [0,selectionLength) respectively
+	const sample_pos_t srcStart=prepareForUndo ? 0 : start;
+	std::unique_ptr<const CRezPoolAccesser> srces[MAX_CHANNELS];
+	std::unique_ptr<CRezPoolAccesser> dests[MAX_CHANNELS];
+	for(unsigned c=0;c<channelCount;c++)
+	{
+		srces[c] = std::make_unique<CRezPoolAccesser>(prepareForUndo ? actionSound->sound->getTempAudio(tempAudioPoolKey,channels[c]) : actionSound->sound->getAudio(channels[c]));
+		dests[c] = std::make_unique<CRezPoolAccesser>(actionSound->sound->getAudio(channels[c]));
+	}
 
-			for(size_t t=0;t<channelCount;t++)
-			{
-				if(!prepareForUndo)
-					actionSound->sound->invalidatePeakData(t,actionSound->start,actionSound->stop);
+	// the data is run through the compressor in blocks of interleaved frames and the input 
+	// is padded with lookAheadTime frames of silence to get the last of the output out
+	const size_t bufferFrames=4096;
+	std::vector<mix_sample_t> buffer(bufferFrames*channelCount);
+	const sample_pos_t totalLength=selectionLength+lookAheadTime;
 
-				delete srces[t];
-				delete dests[t];
-			}
+	CStatusBar statusBar(statusTitle,0,totalLength,true);
+	for(sample_pos_t pos=0;pos<totalLength;)
+	{
+		const size_t n=(size_t)min((sample_pos_t)bufferFrames,totalLength-pos);
+
+		for(unsigned c=0;c<channelCount;c++)
+		{
+			const CRezPoolAccesser &src=*(srces[c]);
+			mix_sample_t *b=buffer.data()+c;
+			for(sample_pos_t t=0;t<(sample_pos_t)n;t++,b+=channelCount)
+				*b= (pos+t)<selectionLength ? (mix_sample_t)(src[srcStart+pos+t]*inputGain) : 0;
 		}
-		catch(...)
+
+		if(linked)
+			compressor.processSampleFrames(buffer.data(),buffer.data(),buffer.data(),channelCount,n);
+		else
+			compressor.processSamples(buffer.data(),buffer.data(),buffer.data(),n);
+
+		// the first lookAheadTime frames out of the compressor are just its delay line filling up
+		const size_t skip= pos<lookAheadTime ? (size_t)min((sample_pos_t)n,lookAheadTime-pos) : 0;
+		for(unsigned c=0;c<channelCount;c++)
 		{
-			for(size_t t=0;t<channelCount;t++)
+			CRezPoolAccesser &dest=*(dests[c]);
+			const mix_sample_t *b=buffer.data()+skip*channelCount+c;
+			sample_pos_t destPos=start+pos+skip-lookAheadTime;
+			for(size_t t=skip;t<n;t++,b+=channelCount)
+				dest[destPos++]=ClipSample(*b*outputGain);
+		}
+
+		pos+=n;
+
+		if(statusBar.update(pos))
+		{ // cancelled
+			if(prepareForUndo)
+				undoActionSizeSafe(actionSound);
+			else if(pos>lookAheadTime)
 			{
-				delete srces[t];
-				delete dests[t];
+				for(unsigned c=0;c<channelCount;c++)
+					actionSound->sound->invalidatePeakData(channels[c],start,start+(pos-lookAheadTime)-1);
 			}
-			throw;
+			return false;
 		}
 	}
 
-	// set the new selection points (only necessary if the length of the sound has changed)
-	//actionSound->stop=actionSound->start+selectionLength-1;
+	if(!prepareForUndo)
+	{
+		for(unsigned c=0;c<channelCount;c++)
+			actionSound->sound->invalidatePeakData(channels[c],start,stop);
+	}
 
-	return(true);
+	return true;
 }
 
 AAction::CanUndoResults CCompressorAction::canUndo(const CActionSound *actionSound) const
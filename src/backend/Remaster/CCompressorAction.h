@@ -21,6 +21,8 @@ protected:
 	CanUndoResults canUndo(const CActionSound *actionSound) const;
 
 private:
+	bool compressChannels(CActionSound *actionSound,bool prepareForUndo,const unsigned *channels,const unsigned channelCount,const bool linked,const string statusTitle);
+
 	const float windowTime;
 	const float threshold;
 	const float ratio;
@@ -46,6 +46,7 @@ bool CMarkQuietAreasAction::doActionSizeSafe(CActionSound *actionSound,bool prep
 	const sample_pos_t start=actionSound->start;
 	const sample_pos_t stop=actionSound->stop;
 	const sample_t quietThreshold=dBFS_to_amp(this->quietThreshold);
+	const double quietPower=(double)quietThreshold*quietThreshold; // compared to the detector's power to avoid a sqrt per sample
 	const sample_pos_t quietTime=max((sample_pos_t)1,ms_to_samples(this->quietTime,actionSound->sound->getSampleRate()));
 	const sample_pos_t unquietTime=ms_to_samples(this->unquietTime,actionSound->sound->getSampleRate());
 
@@ -80,12 +81,12 @@ bool CMarkQuietAreasAction::doActionSizeSafe(CActionSound *actionSound,bool prep
 	const CRezPoolAccesser src=actionSound->sound->getAudio(0); // ??? which channel to use or both? (prompt the user!)
 	for(sample_pos_t pos=start;pos<=stop;pos++)
 	{
-		const mix_sample_t l=levelDetector.readLevel(src[pos]);
+		const double power=levelDetector.readPower(src[pos]);
 
 		switch(state)
 		{
 		case 0: // waiting for level to fall below threshold
-			if(l<=quietThreshold)
+			if(power<=quietPower)
 			{
 				state=1;
 				quietCounter=0;
@@ -95,7 +96,7 @@ bool CMarkQuietAreasAction::doActionSizeSafe(CActionSound *actionSound,bool prep
 			break;
 
 		case 1: // waiting for level that is below threshold to remain that way for quiet time
-			if(l>quietThreshold)
+			if(power>quietPower)
 			{	// level wasn't below threshold for long enough
 				state=0;
 			}
@@ -110,7 +111,7 @@ bool CMarkQuietAreasAction::doActionSizeSafe(CActionSound *actionSound,bool prep
 			break;
 
 		case 2: // level has been below the threshold for quiet time samples, now waiting for it to go back above the threshold
-			if(l>quietThreshold)
+			if(power>quietPower)
 			{
 				state=3;
 				unquietCounter=0;
@@ -120,7 +121,7 @@ bool CMarkQuietAreasAction::doActionSizeSafe(CActionSound *actionSound,bool prep
 			break;
 
 		case 3: // waiting for level to remain above the quiet threshold for unquiet time samples
-			if(l<=quietThreshold)
+			if(power<=quietPower)
 			{ // level has fallen back below the treshold, start over waiting for unquiet time
 				state=2;
 			}
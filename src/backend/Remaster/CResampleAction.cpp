@@ -23,7 +23,8 @@
 #include "../CActionSound.h"
 #include "../CActionParameters.h"
 
-#include "../DSP/TSoundStretcher.h"
+#include "../DSP/SincResampler.h"
+#include "../settings.h"
 
 CResampleAction::CResampleAction(const AActionFactory *factory,const CActionSound *actionSound,const unsigned _newSampleRate) :
 	AAction(factory,actionSound),
@@ -66,10 +67,15 @@ bool CResampleAction::doActionSizeSafe(CActionSound *actionSound,bool prepareFor
 			const CRezPoolAccesser src=actionSound->sound->getTempAudio(tempAudioPoolKey,i);
 			CRezPoolAccesser dest=actionSound->sound->getAudio(i);
 
-			TSoundStretcher<const CRezPoolAccesser> stretcher(src,0,oldLength,newLength,1,0,true);
-			for(sample_pos_t t=0;t<newLength;t++)
+			TSincSoundStretcher<const CRezPoolAccesser> stretcher(src,0,oldLength,newLength,(CDSPSincResampler::Qualities)gSampleRateConversionQuality);
+			sample_t buffer[4096];
+			dest.seek(0);
+			for(sample_pos_t t=0;t<newLength;)
 			{
-				dest[t]=stretcher.getSample();
+				const size_t n=(size_t)min((sample_pos_t)4096,newLength-t);
+				stretcher.getSamples(buffer,n);
+				dest.write(buffer,n);
+				t+=n;
 
 				if(statusBar.update(t))
 				{ // cancelled
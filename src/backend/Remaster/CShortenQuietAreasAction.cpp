@@ -54,14 +54,14 @@ bool CShortenQuietAreasAction::doActionSizeSafe(CActionSound *actionSound,bool p
 		return true;
 
 	const sample_pos_t start=actionSound->start;
-	const sample_pos_t stop=actionSound->stop;
 	const sample_pos_t selectionLength=actionSound->selectionLength();
 
-	undoRemoveLength=selectionLength; // we shrink this each time space is removed
+	undoRemoveLength=selectionLength; // we shrink this by the space removed
 
 	moveSelectionToTempPools(actionSound,mmSelection,actionSound->selectionLength(),(sample_pos_t)quietTime); // fudge by quietTime.. we might read past the end for crossfading
 
 	const sample_t quietThreshold=dBFS_to_amp(this->quietThreshold);
+	const double quietPower=(double)quietThreshold*quietThreshold; // compared to the detector's power to avoid a sqrt per sample
 	const sample_pos_t quietTime=max((sample_pos_t)1,ms_to_samples(this->quietTime,actionSound->sound->getSampleRate()));
 	const sample_pos_t unquietTime=ms_to_samples(this->unquietTime,actionSound->sound->getSampleRate());
 
@@ -86,8 +86,6 @@ bool CShortenQuietAreasAction::doActionSizeSafe(CActionSound *actionSound,bool p
 	 */
 
 	int state=0;
-	sample_pos_t dQuietBeginPos=start;
-	sample_pos_t dQuietEndPos;
 	sample_pos_t sQuietBeginPos=0;
 	sample_pos_t sQuietEndPos;
 	sample_pos_t quietCounter;
@@ -97,8 +95,10 @@ bool CShortenQuietAreasAction::doActionSizeSafe(CActionSound *actionSound,bool p
 	std::unique_ptr<const CRezPoolAccesser> srces[MAX_CHANNELS];
 	std::unique_ptr<const CRezPoolAccesser> alt_srces[MAX_CHANNELS]; // used in order to be more efficient.. the crossfade code reads from two positions in the src data
 	
+	// the data is copied back unaltered while finding the quiet areas, then they are all shortened at once afterwards
 	sample_pos_t destPos=start;
 	std::unique_ptr<CRezPoolAccesser> dests[MAX_CHANNELS];
+	vector<RQuietArea> quietAreas;
 
 	// create accessors to write to
 	const unsigned channelCount=actionSound->sound->getChannelCount();
@@ -127,30 +127,29 @@ bool CShortenQuietAreasAction::doActionSizeSafe(CActionSound *actionSound,bool p
 		}
 
 		const sample_t s=(*(srces[0]))[srcPos]; // ??? which channel to use or both? (prompt the user!)
-		const mix_sample_t l=levelDetector.readLevel(s);
+		const double power=levelDetector.readPower(s);
 
 		switch(state)
 		{
 		case 0: // waiting for level to fall below threshold
-			if(l<=quietThreshold)
+			if(power<=quietPower)
 			{
 				state=1;
 				quietCounter=0;
-				dQuietBeginPos=destPos;
 				sQuietBeginPos=srcPos;
 			}
 
 			break;
 
 		case 1: // waiting for level that is below threshold to remain that way for quiet time
-			if(l>quietThreshold)
+			if(power>quietPower)
 			{	// level wasn't below threshold for long enough
 				state=0;
 			}
 			else if(quietCounter>=quietTime)
 			{ 	// level has now been below the threshold for long enough
 				state=2;
-				// position of quiet areas start is noted because dQuietBeginPos has been updated in state 0
+				// position of quiet areas start is noted because sQuietBeginPos has been updated in state 0
 			}
 			else
 				quietCounter++;
@@ -158,18 +157,17 @@ bool CShortenQuietAreasAction::doActionSizeSafe(CActionSound *actionSound,bool p
 			break;
 
 		case 2: // level has been below the threshold for quiet time samples, now waiting for it to go back above the threshold
-			if(l>quietThreshold)
+			if(power>quietPower)
 			{
 				state=3;
 				unquietCounter=0;
-				dQuietEndPos=destPos;
 				sQuietEndPos=srcPos;
 			}
 
 			break;
 
 		case 3: // waiting for level to remain above the quiet threshold for unquiet time samples
-			if(l<=quietThreshold)
+			if(power<=quietPower)
 			{ // level has fallen back below the treshold, start over waiting for unquiet time
 				state=2;
 			}
@@ -177,7 +175,7 @@ bool CShortenQuietAreasAction::doActionSizeSafe(CActionSound *actionSound,bool p
 			{ // level has now been above the threshold for unquiet time samples
 				state=0;
 
-				alterQuietAreaLength(actionSound,destPos,unquietCounter,dQuietBeginPos,dQuietEndPos,sQuietBeginPos,sQuietEndPos,srces,alt_srces,dests);
+				noteQuietArea(actionSound->sound->getSampleRate(),unquietCounter,sQuietBeginPos,sQuietEndPos,quietAreas);
 			}
 			else
 				unquietCounter++;
@@ -196,12 +194,13 @@ bool CShortenQuietAreasAction::doActionSizeSafe(CActionSound *actionSound,bool p
 
 		// this is what happens wend going from state 2 -> 3 .. except we subtract 1 because we don't want to overstep the boundary
 		unquietCounter=0;
-		dQuietEndPos=destPos-1;
 		sQuietEndPos=srcPos-1;
 
-		alterQuietAreaLength(actionSound,destPos,unquietCounter,dQuietBeginPos,dQuietEndPos,sQuietBeginPos,sQuietEndPos,srces,alt_srces,dests);
+		noteQuietArea(actionSound->sound->getSampleRate(),unquietCounter,sQuietBeginPos,sQuietEndPos,quietAreas);
 	}
 
+	destPos-=shortenQuietAreas(actionSound,quietAreas,srces,alt_srces,dests);
+
 	if(!prepareForUndo)
 		freeAllTempPools(); // free the temp pools if we don't need to keep the backup copy around
 
@@ -211,19 +210,46 @@ bool CShortenQuietAreasAction::doActionSizeSafe(CActionSound *actionSound,bool p
 	return true;
 }
 
-void CShortenQuietAreasAction::alterQuietAreaLength(CActionSound *actionSound,sample_pos_t &destPos,const sample_pos_t unquietCounter,const sample_pos_t dQuietBeginPos,const sample_pos_t dQuietEndPos,const sample_pos_t sQuietBeginPos,const sample_pos_t sQuietEndPos,std::unique_ptr<const CRezPoolAccesser> srces[],std::unique_ptr<const CRezPoolAccesser> alt_srces[],std::unique_ptr<CRezPoolAccesser> dests[])
+void CShortenQuietAreasAction::noteQuietArea(const unsigned sampleRate,const sample_pos_t unquietCounter,const sample_pos_t sQuietBeginPos,const sample_pos_t sQuietEndPos,vector<RQuietArea> &quietAreas) const
 {
-	// it's time to alter length of quiet area 
-	// 	- remove an appropriately sized section between the dQuietBeginPos and dQuietEndPos
-	// 	- create a crossfade using data from srces
+	// it's time to alter length of quiet area
+	// 	- note an appropriately sized section between the sQuietBeginPos and sQuietEndPos to be removed
+	// 	- and how long of a crossfade to make there once it is removed
+
+	const sample_pos_t quietAreaLength=(sQuietEndPos-sQuietBeginPos)+1;
+
+	if(quietAreaLength>1)
+	{ // don't do anything that at least doesn't affect two samples
+		RQuietArea area;
+		area.deleteLength=(sample_pos_t)sample_fpos_round((sample_fpos_t)quietAreaLength*(1.0-shortenFactor));
+		area.deletePos=sQuietBeginPos+((quietAreaLength-area.deleteLength)/2); // split the different
+
+		// the crossfade time is based on the "Must Remain Quiet For" parameter (but not more than we have remained unquiet, otherwise we'll write into a previous crossfade) and a minimum of 1ms (but an even smaller minimum if we don't have enough data in srces to do 1ms of crossfade)
+		area.crossfadeTime=min(area.deletePos, max((sample_pos_t)(sampleRate/1000), min(unquietCounter,(sample_pos_t)quietTime) ));
+
+		quietAreas.push_back(area);
+	}
+}
+
+sample_pos_t CShortenQuietAreasAction::shortenQuietAreas(CActionSound *actionSound,const vector<RQuietArea> &quietAreas,std::unique_ptr<const CRezPoolAccesser> srces[],std::unique_ptr<const CRezPoolAccesser> alt_srces[],std::unique_ptr<CRezPoolAccesser> dests[])
+{
+	// remove all the space at once (one pass over the audio, peak data and cues no matter how many areas were found)
+	vector<CSound::RSpaceEdit> edits(quietAreas.size());
+	for(size_t t=0;t<quietAreas.size();t++)
+	{
+		edits[t].where=actionSound->start+quietAreas[t].deletePos;
+		edits[t].removeLength=quietAreas[t].deleteLength;
+		edits[t].insertLength=0;
+	}
+	actionSound->sound->editSpace(edits);
 
-	// the crossfade looks something like:
+	// the crossfade at each point of deletion looks something like:
 	//
 	//   before delete region          |    within delete region     |    after delete region
-	//                          \      |                            /|                         
-	//                            \    |                          /  |                         
-	//                              \  |                        /    |                         
-	//                                \|                      /      |                         
+	//                          \      |                            /|
+	//                            \    |                          /  |
+	//                              \  |                        /    |
+	//                                \|                      /      |
 	//
 	//                         |_______|                     |_______|
 	//                       fade 1 region                 fade 2 region
@@ -233,45 +259,37 @@ void CShortenQuietAreasAction::alterQuietAreaLength(CActionSound *actionSound,sa
 	// and the crossfade is the result of adding the signals from fade 1 and fade 2 together
 	// fade 1's and fade 2's covered region may overlap if the region to be deleted is smaller than half the fade
 	//
-	// the implementation does the delete first, then goes back to the src to calculate the data surounding the point of deletion
+	// the implementation does the deletes first, then goes back to the src to calculate the data surounding each point of deletion
 
 	const unsigned channelCount=actionSound->sound->getChannelCount();
 
-	const sample_pos_t dQuietAreaLength=(dQuietEndPos-dQuietBeginPos)+1;
-
-	if(dQuietAreaLength>1)
-	{ // don't do anything that at least doesn't affect two samples
-
-		const sample_pos_t dDeleteLength=(sample_pos_t)sample_fpos_round((sample_fpos_t)dQuietAreaLength*(1.0-shortenFactor));
-		const sample_pos_t dDeletePos=dQuietBeginPos+((dQuietAreaLength-dDeleteLength)/2); // split the different
-		sample_pos_t sDeletePos=sQuietBeginPos+((dQuietAreaLength-dDeleteLength)/2); // same as dDeletePos except mapped into src space instead of dest space
+	sample_pos_t removedLength=0; // the space removed before the current area
+	for(size_t t=0;t<quietAreas.size();t++)
+	{
+		const RQuietArea &area=quietAreas[t];
+		const sample_pos_t dDeletePos=actionSound->start+area.deletePos-removedLength; // where the deletion was made in dest space
 
-		actionSound->sound->removeSpace(dDeletePos,dDeleteLength);
-		undoRemoveLength-=dDeleteLength;
-		destPos-=dDeleteLength;
+		sample_pos_t fade1Pos=area.deletePos-area.crossfadeTime;
+		sample_pos_t fade2Pos=(area.deletePos+area.deleteLength)-area.crossfadeTime;
+		sample_pos_t writePos=dDeletePos-area.crossfadeTime;
 
-		// the crossfade time is based on the "Must Remain Quiet For" parameter (but not more than we have remained unquiet, otherwise we'll write into a previous crossfade) and a minimum of 1ms (but an even smaller minimum if we don't have enough data in srces to do 1ms of crossfade)
-		const sample_pos_t crossfadeTime=min(sDeletePos, max((sample_pos_t)(actionSound->sound->getSampleRate()/1000), min(unquietCounter,(sample_pos_t)quietTime) ));
-		if(crossfadeTime>0)
+		for(sample_pos_t i=0;i<area.crossfadeTime;i++)
 		{
+			const float g=(float)i/(float)area.crossfadeTime;
 
-			sample_pos_t fade1Pos=sDeletePos-crossfadeTime;
-			sample_pos_t fade2Pos=(sDeletePos+dDeleteLength)-crossfadeTime;
-			sample_pos_t writePos=dDeletePos-crossfadeTime;
-
-			for(sample_pos_t t=0;t<crossfadeTime;t++)
-			{
-				const float g=(float)t/(float)crossfadeTime;
-
-				for(unsigned i=0;i<channelCount;i++)
-					(*(dests[i]))[writePos]=ClipSample( (1.0-g)*( (*(srces[i]))[fade1Pos]) + g*( (*(alt_srces[i]))[fade2Pos]) );
+			for(unsigned k=0;k<channelCount;k++)
+				(*(dests[k]))[writePos]=ClipSample( (1.0-g)*( (*(srces[k]))[fade1Pos]) + g*( (*(alt_srces[k]))[fade2Pos]) );
 
-				fade1Pos++;
-				fade2Pos++;
-				writePos++;
-			}
+			fade1Pos++;
+			fade2Pos++;
+			writePos++;
 		}
+
+		removedLength+=area.deleteLength;
 	}
+
+	undoRemoveLength-=removedLength;
+	return removedLength;
 }
 
 AAction::CanUndoResults CShortenQuietAreasAction::canUndo(const CActionSound *actionSound) const
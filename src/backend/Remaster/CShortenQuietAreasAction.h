@@ -22,6 +22,7 @@
 #define __CShortenQuietAreasAction_H__
 
 #include <memory>
+#include <vector>
 
 #include "../../../config/common.h"
 
@@ -50,7 +51,16 @@ private:
 
 	sample_pos_t undoRemoveLength;
 
-	void alterQuietAreaLength(CActionSound *actionSound,sample_pos_t &destPos,const sample_pos_t unquietCounter,const sample_pos_t dQuietBeginPos,const sample_pos_t dQuietEndPos,const sample_pos_t sQuietBeginPos,const sample_pos_t sQuietEndPos,std::unique_ptr<const CRezPoolAccesser> srces[],std::unique_ptr<const CRezPoolAccesser> alt_srces[],std::unique_ptr<CRezPoolAccesser> dests[]);
+	struct RQuietArea
+	{
+		sample_pos_t deletePos;		// relative to the start of the selection before anything is removed
+		sample_pos_t deleteLength;
+		sample_pos_t crossfadeTime;
+	};
+
+	void noteQuietArea(const unsigned sampleRate,const sample_pos_t unquietCounter,const sample_pos_t sQuietBeginPos,const sample_pos_t sQuietEndPos,vector<RQuietArea> &quietAreas) const;
+	// removes the space of all the quiet areas, crossfades across each point of deletion and returns the total length removed
+	sample_pos_t shortenQuietAreas(CActionSound *actionSound,const vector<RQuietArea> &quietAreas,std::unique_ptr<const CRezPoolAccesser> srces[],std::unique_ptr<const CRezPoolAccesser> alt_srces[],std::unique_ptr<CRezPoolAccesser> dests[]);
 };
 
 class CShortenQuietAreasActionFactory : public AActionFactory
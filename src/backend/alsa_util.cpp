@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2026 - agent
+ *
+ * This file is part of ReZound, an audio editing application.
+ *
+ * ReZound is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * ReZound is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+#include "alsa_util.h"
+
+#ifdef ENABLE_ALSA
+
+#include <errno.h>
+#include <stdio.h>
+
+#include <stdexcept>
+#include <string>
+
+bool areasAreInterleaved(const snd_pcm_channel_area_t *areas,const unsigned channelCount,const unsigned width)
+{
+	for(unsigned c=0;c<channelCount;c++)
+	{
+		if(areas[c].addr!=areas[0].addr || areas[c].first!=areas[0].first+c*width || areas[c].step!=channelCount*width)
+			return false;
+	}
+	return true;
+}
+
+void recoverFromError(snd_pcm_t *handle,const int err)
+{
+	if(err==-EPIPE)
+		fprintf(stderr,"an xrun occurred\n");
+
+	int e;
+	if((e = snd_pcm_recover(handle, err, 1)) < 0)
+		throw runtime_error(string(__func__)+" -- cannot recover from error: "+snd_strerror(err)+" -- "+snd_strerror(e));
+}
+
+#endif // ENABLE_ALSA
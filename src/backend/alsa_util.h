@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2026 - agent
+ *
+ * This file is part of ReZound, an audio editing application.
+ *
+ * ReZound is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * ReZound is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+#ifndef __alsa_util_h__
+#define __alsa_util_h__
+
+
+#include "../../config/common.h"
+
+#ifdef ENABLE_ALSA
+
+#include <stdint.h>
+
+#include <alsa/asoundlib.h>
+
+/*
+ * What CALSASoundPlayer and CALSASoundRecorder have in common for dealing with the device
+ */
+
+// returns where frame 'offset' of the channel is in the device's mmapped buffer
+static inline uint8_t *areaAddress(const snd_pcm_channel_area_t &area,const snd_pcm_uframes_t offset)
+{
+	return (uint8_t *)area.addr+((area.first+offset*area.step)/8);
+}
+
+// returns true if the channels' areas are laid out as one block of interleaved samples that are width bits wide
+bool areasAreInterleaved(const snd_pcm_channel_area_t *areas,const unsigned channelCount,const unsigned width);
+
+// recovers from an xrun or a suspend so that the device can be started again, or throws for any other error
+void recoverFromError(snd_pcm_t *handle,const int err);
+
+#endif // ENABLE_ALSA
+
+#endif
@@ -348,6 +348,7 @@ static void printUsage(const string app)
 #ifdef ENABLE_PULSE
 	printf("\t\tpulse\n");
 #endif
+	printf("\t\toffline  (plays at real time without any audio hardware)\n");
 	printf("\t\tnull\n");
 
 	printf("\n");
@@ -0,0 +1,341 @@
+/*
+ * Copyright (C) 2026 - agent
+ *
+ * This file is part of ReZound, an audio editing application.
+ *
+ * ReZound is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * ReZound is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+#include "lossless_sample_codec.h"
+
+#include <math.h>
+#include <string.h>
+
+#include <stdexcept>
+#include <string>
+
+#include <istring>
+
+/*
+ * The coded block is:
+ *	byte	mode (one of the BlockModes)
+ * and unless the mode is bmVerbatim:
+ *	byte	predictor order (0 to 3)
+ *	byte	Rice parameter
+ *	...	the Rice coded, zig-zagged residuals, MSB first, padded to a byte
+ * The predictors assume the samples before the block are 0 so each block stands alone.
+ */
+
+enum BlockModes
+{
+	bmVerbatim=0,	// the sample_t values as they are in memory
+	bmInteger=1,	// 16 bit samples, or floats that are all multiples of 2^-23 in [-2,2]
+	bmFloatBits=2,	// the floats' bit patterns mapped to integers which sort like the floats
+	bmInteger16=3,	// floats that are all what convert_sample<int16_t,float>() gives for some 16 bit value
+	bmInteger24=4	// floats that are all what convert_sample<int24_t,float>() gives for some 24 bit value
+};
+
+enum { MAX_ORDER=3, MAX_RICE_PARAMETER=60 };
+
+#ifdef SAMPLE_TYPE_FLOAT
+static const float INTEGER_SCALE=8388608.0f; // 2^23
+
+// what the integers of each integer mode are divided by to get the samples
+static float integerScale(const uint8_t mode)
+{
+	switch(mode)
+	{
+	case bmInteger16: return 32767.0f;
+	case bmInteger24: return 8388607.0f;
+	default: return INTEGER_SCALE;
+	}
+}
+
+// finds the integers which decode to exactly the given samples with the given mode's scale if there are such integers
+static bool samplesToIntegers(const float *samples,const size_t count,const uint8_t mode,int64_t *x)
+{
+	const float scale=integerScale(mode);
+	for(size_t t=0;t<count;t++)
+	{
+		const float s=samples[t];
+		const float v=rintf(s*scale);
+		// (-0 would come back as 0)
+		if(!(fabsf(v)<=2.0f*scale) || (float)(int64_t)v/scale!=s || (s==0.0f && signbit(s)))
+			return false;
+		x[t]=(int64_t)v;
+	}
+	return true;
+}
+
+// an order preserving, one to one, map of the bit pattern of a float to a signed integer
+static inline int64_t floatBitsToInt(const float f)
+{
+	uint32_t u;
+	memcpy(&u,&f,sizeof(u));
+	return (u&0x80000000) ? -(int64_t)(u&0x7fffffff)-1 : (int64_t)u;
+}
+
+static inline float intToFloatBits(const int64_t v)
+{
+	const uint32_t u= v<0 ? ((uint32_t)(-(v+1)) | 0x80000000) : (uint32_t)v;
+	float f;
+	memcpy(&f,&u,sizeof(f));
+	return f;
+}
+#endif
+
+static inline uint64_t zigzag(const int64_t v) { return ((uint64_t)v<<1) ^ (uint64_t)(v>>63); }
+static inline int64_t unzigzag(const uint64_t u) { return (int64_t)(u>>1) ^ -(int64_t)(u&1); }
+
+// the zig-zagged residuals of x[] after the fixed predictor of the given order
+static void residuals(const int64_t *x,const size_t count,const unsigned order,uint64_t *u)
+{
+	int64_t x1=0,x2=0,x3=0;
+	switch(order)
+	{
+	case 0:
+		for(size_t t=0;t<count;t++)
+			u[t]=zigzag(x[t]);
+		break;
+	case 1:
+		for(size_t t=0;t<count;t++)
+		{
+			u[t]=zigzag(x[t]-x1);
+			x1=x[t];
+		}
+		break;
+	case 2:
+		for(size_t t=0;t<count;t++)
+		{
+			u[t]=zigzag(x[t]-2*x1+x2);
+			x2=x1; x1=x[t];
+		}
+		break;
+	default:
+		for(size_t t=0;t<count;t++)
+		{
+			u[t]=zigzag(x[t]-3*x1+3*x2-x3);
+			x3=x2; x2=x1; x1=x[t];
+		}
+		break;
+	}
+}
+
+// undoes residuals()
+static void unresiduals(const uint64_t *u,const size_t count,const unsigned order,int64_t *x)
+{
+	int64_t x1=0,x2=0,x3=0;
+	for(size_t t=0;t<count;t++)
+	{
+		const int64_t r=unzigzag(u[t]);
+		switch(order)
+		{
+		case 0: x[t]=r; break;
+		case 1: x[t]=r+x1; break;
+		case 2: x[t]=r+2*x1-x2; break;
+		default: x[t]=r+3*x1-3*x2+x3; break;
+		}
+		x3=x2; x2=x1; x1=x[t];
+	}
+}
+void losslessEncodeBlock(const sample_t *samples,size_t count,std::vector<uint8_t> &out)
+{
+	if(count>LOSSLESS_CODEC_BLOCK_SIZE)
+		throw runtime_error(string(__func__)+" -- count is too large: "+istring(count));
+
+	int64_t x[LOSSLESS_CODEC_BLOCK_SIZE];
+	uint8_t mode;
+
+#ifdef SAMPLE_TYPE_FLOAT
+	// samples loaded from a 16 or 24 bit file are usually scaled by 32767 or 8388607 rather than a power of 2
+	if(samplesToIntegers(samples,count,bmInteger,x))
+		mode=bmInteger;
+	else if(samplesToIntegers(samples,count,bmInteger16,x))
+		mode=bmInteger16;
+	else if(samplesToIntegers(samples,count,bmInteger24,x))
+		mode=bmInteger24;
+	else
+	{
+		mode=bmFloatBits;
+		for(size_t t=0;t<count;t++)
+			x[t]=floatBitsToInt(samples[t]);
+	}
+#else
+	mode=bmInteger;
+	for(size_t t=0;t<count;t++)
+		x[t]=samples[t];
+#endif
+
+	// find the predictor and Rice parameter which code the block in the fewest bits
+	const uint64_t verbatimBits=(uint64_t)count*sizeof(sample_t)*8;
+	uint64_t bestBits=verbatimBits;
+	unsigned bestOrder=0,bestK=0;
+	uint64_t u[LOSSLESS_CODEC_BLOCK_SIZE];
+	for(unsigned order=0;order<=MAX_ORDER;order++)
+	{
+		residuals(x,count,order,u);
+
+		uint64_t sum=0;
+		for(size_t t=0;t<count;t++)
+			sum+=u[t];
+
+		// the optimal parameter is near log2 of the mean, so only try either side of that
+		unsigned k=0;
+		while(k<MAX_RICE_PARAMETER && ((uint64_t)count<<(k+1))<=sum)
+			k++;
+		for(unsigned tryK=(k>0 ? k-1 : 0);tryK<=k+1 && tryK<=MAX_RICE_PARAMETER;tryK++)
+		{
+			uint64_t bits=(uint64_t)count*(tryK+1);
+			for(size_t t=0;t<count;t++)
+				bits+=u[t]>>tryK;
+			if(bits<bestBits)
+			{
+				bestBits=bits;
+				bestOrder=order;
+				bestK=tryK;
+			}
+		}
+	}
+
+	if(bestBits+3*8>=verbatimBits)
+	{
+		out.push_back(bmVerbatim);
+		const uint8_t *p=(const uint8_t *)samples;
+		out.insert(out.end(),p,p+count*sizeof(sample_t));
+		return;
+	}
+
+	out.push_back(mode);
+	out.push_back((uint8_t)bestOrder);
+	out.push_back((uint8_t)bestK);
+
+	residuals(x,count,bestOrder,u);
+
+	// write the quotient in unary (that many 0s then a 1) then the low bestK bits
+	const size_t start=out.size();
+	out.resize(start+(size_t)((bestBits+7)/8),0);
+	uint8_t *d=&out[start];
+	uint64_t bitPos=0;
+	const uint64_t lowMask=(((uint64_t)1)<<bestK)-1;
+	for(size_t t=0;t<count;t++)
+	{
+		bitPos+=u[t]>>bestK; // the 0s are already there
+		d[bitPos>>3]|=0x80>>(bitPos&7);
+		bitPos++;
+
+		// the low bits, a byte at a time once aligned
+		uint64_t low=u[t]&lowMask;
+		unsigned n=bestK;
+		while(n>0)
+		{
+			const unsigned room=8-(bitPos&7);
+			const unsigned take= n<room ? n : room;
+			d[bitPos>>3]|=(uint8_t)(((low>>(n-take))&((1u<<take)-1))<<(room-take));
+			bitPos+=take;
+			n-=take;
+		}
+	}
+}
+
+void losslessDecodeBlock(const uint8_t *data,size_t size,sample_t *samples,size_t count)
+{
+	if(count>LOSSLESS_CODEC_BLOCK_SIZE)
+		throw runtime_error(string(__func__)+" -- count is too large: "+istring(count));
+	if(size<1)
+		throw runtime_error(string(__func__)+" -- empty block");
+
+	const uint8_t mode=data[0];
+	if(mode==bmVerbatim)
+	{
+		if(size!=1+count*sizeof(sample_t))
+			throw runtime_error(string(__func__)+" -- verbatim block has the wrong size: "+istring(size));
+		memcpy(samples,data+1,count*sizeof(sample_t));
+		return;
+	}
+
+	if(size<3 || (mode!=bmInteger && mode!=bmFloatBits && mode!=bmInteger16 && mode!=bmInteger24))
+		throw runtime_error(string(__func__)+" -- invalid block header");
+	const unsigned order=data[1];
+	const unsigned k=data[2];
+	if(order>MAX_ORDER || k>MAX_RICE_PARAMETER)
+		throw runtime_error(string(__func__)+" -- invalid block header");
+
+	const uint8_t *d=data+3;
+	const uint64_t totalBits=(uint64_t)(size-3)*8;
+	uint64_t bitPos=0;
+
+	uint64_t u[LOSSLESS_CODEC_BLOCK_SIZE];
+	for(size_t t=0;t<count;t++)
+	{
+		// count the 0s up to the next 1, skipping whole 0 bytes at once
+		uint64_t q=0;
+		for(;;)
+		{
+			if(bitPos>=totalBits)
+				throw runtime_error(string(__func__)+" -- block data is truncated");
+			const uint8_t rest=(uint8_t)(d[bitPos>>3]<<(bitPos&7));
+			if(rest==0)
+			{
+				const unsigned skip=8-(bitPos&7);
+				q+=skip;
+				bitPos+=skip;
+				continue;
+			}
+			unsigned z=0;
+			while(!(rest&(0x80>>z)))
+				z++;
+			q+=z;
+			bitPos+=z+1;
+			break;
+		}
+
+		if(bitPos+k>totalBits)
+			throw runtime_error(string(__func__)+" -- block data is truncated");
+		uint64_t r=0;
+		unsigned n=k;
+		while(n>0)
+		{
+			const unsigned avail=8-(bitPos&7);
+			const unsigned take= n<avail ? n : avail;
+			r=(r<<take) | ((d[bitPos>>3]>>(avail-take))&((1u<<take)-1));
+			bitPos+=take;
+			n-=take;
+		}
+
+		u[t]=(q<<k)|r;
+	}
+
+	int64_t x[LOSSLESS_CODEC_BLOCK_SIZE];
+	unresiduals(u,count,order,x);
+
+#ifdef SAMPLE_TYPE_FLOAT
+	if(mode!=bmFloatBits)
+	{
+		const float scale=integerScale(mode);
+		for(size_t t=0;t<count;t++)
+			samples[t]=(float)x[t]/scale;
+	}
+	else
+	{
+		for(size_t t=0;t<count;t++)
+			samples[t]=intToFloatBits(x[t]);
+	}
+#else
+	if(mode!=bmInteger)
+		throw runtime_error(string(__func__)+" -- block was not coded from 16 bit samples");
+	for(size_t t=0;t<count;t++)
+		samples[t]=(sample_t)x[t];
+#endif
+}
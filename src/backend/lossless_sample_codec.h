@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2026 - agent
+ *
+ * This file is part of ReZound, an audio editing application.
+ *
+ * ReZound is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * ReZound is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+#ifndef __lossless_sample_codec_h__
+#define __lossless_sample_codec_h__
+
+
+#include "../../config/common.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "CSound_defs.h"
+
+/*
+ * A fast lossless coder for blocks of sample_t used to keep undo data compact.
+ *
+ * Like FLAC, each block of samples is run through whichever of the fixed polynomial
+ * predictors of order 0 to 3 leaves the smallest residual, and the residuals are Rice
+ * coded.  A block that would not get any smaller is stored verbatim.  With floating
+ * point samples, a block whose samples are all exactly representable in 24 bits, or
+ * that are all what convert_sample<>() gives for 16 or 24 bit values (i.e. anything that
+ * came from a 16 or 24 bit file unmodified), is coded as those integers; otherwise the 
+ * bit patterns of the floats are coded, which is still exact.
+ *
+ * Decoding gives back the identical samples (bit for bit).
+ */
+
+enum { LOSSLESS_CODEC_BLOCK_SIZE=4096 };
+
+// appends the coded form of count (at most LOSSLESS_CODEC_BLOCK_SIZE) samples to out
+void losslessEncodeBlock(const sample_t *samples,size_t count,std::vector<uint8_t> &out);
+
+// decodes the count samples that losslessEncodeBlock() coded into the size bytes at data 
+// (count must be the same as was given to losslessEncodeBlock()).  Throws if the data is invalid.
+void losslessDecodeBlock(const uint8_t *data,size_t size,sample_t *samples,size_t count);
+
+#endif
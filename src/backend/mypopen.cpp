@@ -66,7 +66,11 @@
 #include <sys/wait.h>
 #include <sys/types.h>
 
+#include <mutex>
+
 #define MAX_OPENS 100
+/* guarded by piped_processes_mutex since pipes are opened and closed from more than one thread at a time */
+static std::mutex piped_processes_mutex;
 static int child_pids[MAX_OPENS]; /* init to zero */
 static FILE *pipe_streams[MAX_OPENS];
 static FILE *pipe_err_streams[MAX_OPENS];
@@ -79,6 +83,7 @@ static FILE *pipe_err_streams[MAX_OPENS];
 */
 static int add_piped_process(int pid,FILE *s,FILE *e)
 {
+	std::lock_guard<std::mutex> l(piped_processes_mutex);
 	int t;
 	for(t=0;t<MAX_OPENS;t++)
 	{
@@ -100,6 +105,7 @@ static int add_piped_process(int pid,FILE *s,FILE *e)
 */
 static int remove_piped_process(FILE *s,FILE **e)
 {
+	std::lock_guard<std::mutex> l(piped_processes_mutex);
 	int t;
 	for(t=0;t<MAX_OPENS;t++)
 	{
@@ -116,13 +122,32 @@ static int remove_piped_process(FILE *s,FILE **e)
 
 
 
+/*
+	creates a pipe whose ends are not inherited by other children (this
+	matters when more than one child is being fed at a time from different
+	threads, since a child holding a copy of another's stdin pipe would keep 
+	that other from ever seeing EOF)
+*/
+static int cloexec_pipe(int pipe_ends[2])
+{
+#if defined(__linux__) && defined(O_CLOEXEC)
+	return(pipe2(pipe_ends,O_CLOEXEC));
+#else
+	if(pipe(pipe_ends)!=0)
+		return(-1);
+	fcntl(pipe_ends[0],F_SETFD,FD_CLOEXEC);
+	fcntl(pipe_ends[1],F_SETFD,FD_CLOEXEC);
+	return(0);
+#endif
+}
+
 FILE *mypopen(const char cmd[],const char type[],FILE **errStream)
 {
 	int pid;
 	int pipe_ends[2];
 	int err_pipe_ends[2];
 
-	if(pipe(pipe_ends)!=0)
+	if(cloexec_pipe(pipe_ends)!=0)
 		return(NULL);
 
 	if(strcmp(type,"w")==0)
@@ -150,7 +175,7 @@ FILE *mypopen(const char cmd[],const char type[],FILE **errStream)
 	}
 	else if(strcmp(type,"r")==0)
 	{
-		if(errStream!=NULL && pipe(err_pipe_ends)!=0)
+		if(errStream!=NULL && cloexec_pipe(err_pipe_ends)!=0)
 			return(NULL);
 
 		/*
@@ -211,6 +236,49 @@ FILE *mypopen(const char cmd[],const char type[],FILE **errStream)
 }
 
 
+FILE *mypopen_rw(const char cmd[],int *stdinFd)
+{
+	int pid;
+	int in_pipe_ends[2];
+	int out_pipe_ends[2];
+
+	if(cloexec_pipe(in_pipe_ends)!=0)
+		return(NULL);
+	if(cloexec_pipe(out_pipe_ends)!=0)
+	{
+		close(in_pipe_ends[0]);
+		close(in_pipe_ends[1]);
+		return(NULL);
+	}
+
+	if((pid=fork())==0)
+	{ /* child */
+		/* dup2 clears close-on-exec on the new descriptors */
+		dup2(in_pipe_ends[0],0);
+		dup2(out_pipe_ends[1],1);
+		execlp("/bin/sh","/bin/sh","-c",cmd,NULL);
+		_exit(127);
+	}
+	else
+	{ /* parent */
+		close(in_pipe_ends[0]);
+		close(out_pipe_ends[1]);
+
+		if(pid<0)
+		{
+			close(in_pipe_ends[1]);
+			close(out_pipe_ends[0]);
+			return(NULL);
+		}
+
+		FILE *pipe_end=fdopen(out_pipe_ends[0],"r");
+		add_piped_process(pid,pipe_end,NULL);
+		(*stdinFd)=in_pipe_ends[1];
+		return(pipe_end);
+	}
+}
+
+
 int mypclose(FILE *p)
 {
 	FILE *e;
@@ -227,6 +295,6 @@ int mypclose(FILE *p)
 		fclose(e);
 
 	waitpid(pid,&statval,0);
-	return(0);
+	return(statval);
 }
 
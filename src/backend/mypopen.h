@@ -26,6 +26,9 @@
 #include <stdio.h>
 
 FILE *mypopen(const char cmd[],const char type[],FILE **errStream=NULL);
+// like mypopen(cmd,"r") but the child's stdin is a pipe too whose write end is returned in stdinFd (the caller must close it)
+FILE *mypopen_rw(const char cmd[],int *stdinFd);
+// returns the child's exit status as given by waitpid() or -1 if p wasn't opened by mypopen
 int mypclose(FILE *p);
 
 #endif
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2026 - agent
+ *
+ * This file is part of ReZound, an audio editing application.
+ *
+ * ReZound is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * ReZound is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+#include "rt_allocation_check.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+
+#include <new>
+#include <stdexcept>
+#include <string>
+
+#include <istring>
+
+void *allocLockedMemory(size_t size)
+{
+	const long pageSize=sysconf(_SC_PAGESIZE);
+
+	void *p=NULL;
+	if(posix_memalign(&p,pageSize>0 ? pageSize : 4096,size)!=0)
+		throw runtime_error(string(__func__)+" -- error allocating "+istring(size)+" bytes");
+
+	// touching every page now also makes sure they are faulted in before the audio thread ever sees them
+	memset(p,0,size);
+
+	if(mlock(p,size)!=0)
+		fprintf(stderr,"%s -- warning: unable to lock %u bytes into RAM for mixing audio -- %s\n",__func__,(unsigned)size,strerror(errno));
+
+	return p;
+}
+
+void freeLockedMemory(void *p,size_t size)
+{
+	if(p)
+	{
+		munlock(p,size);
+		free(p);
+	}
+}
+
+bool makeThreadRealtime(const int priority,const bool lockAllMemory)
+{
+	bool ret=true;
+
+	if(lockAllMemory && mlockall(MCL_CURRENT|MCL_FUTURE)!=0)
+	{
+		fprintf(stderr,"%s -- warning: unable to lock all memory into RAM -- %s\n",__func__,strerror(errno));
+		ret=false;
+	}
+
+	if(priority>0)
+	{
+		sched_param param;
+		memset(&param,0,sizeof(param));
+		param.sched_priority=std::min(std::max(priority,sched_get_priority_min(SCHED_FIFO)),sched_get_priority_max(SCHED_FIFO));
+
+		const int err=pthread_setschedparam(pthread_self(),SCHED_FIFO,&param);
+		if(err!=0)
+		{
+			fprintf(stderr,"%s -- warning: unable to set SCHED_FIFO priority %d for the audio thread -- %s\n",__func__,param.sched_priority,strerror(err));
+			ret=false;
+		}
+	}
+
+	return ret;
+}
+
+
+#ifdef ENABLE_RT_ALLOCATION_CHECK
+
+thread_local unsigned CRealtimeSection::depth=0;
+
+static void checkRealtimeAllocation(const char *what,size_t size)
+{
+	if(CRealtimeSection::depth>0)
+	{
+		CRealtimeSection::depth=0; // in case fprintf itself allocates
+		fprintf(stderr,"%s -- %s of %u bytes while mixing audio in real-time\n",__func__,what,(unsigned)size);
+		abort();
+	}
+}
+
+static void *checkedAlloc(const char *what,size_t size)
+{
+	checkRealtimeAllocation(what,size);
+	void *p=malloc(size ? size : 1);
+	if(!p)
+		throw std::bad_alloc();
+	return p;
+}
+
+void *operator new(size_t size) { return checkedAlloc("operator new",size); }
+void *operator new[](size_t size) { return checkedAlloc("operator new[]",size); }
+void *operator new(size_t size,const std::nothrow_t &) noexcept { checkRealtimeAllocation("operator new",size); return malloc(size ? size : 1); }
+void *operator new[](size_t size,const std::nothrow_t &) noexcept { checkRealtimeAllocation("operator new[]",size); return malloc(size ? size : 1); }
+
+void operator delete(void *p) noexcept { if(p) checkRealtimeAllocation("operator delete",0); free(p); }
+void operator delete[](void *p) noexcept { if(p) checkRealtimeAllocation("operator delete[]",0); free(p); }
+void operator delete(void *p,size_t) noexcept { if(p) checkRealtimeAllocation("operator delete",0); free(p); }
+void operator delete[](void *p,size_t) noexcept { if(p) checkRealtimeAllocation("operator delete[]",0); free(p); }
+void operator delete(void *p,const std::nothrow_t &) noexcept { if(p) checkRealtimeAllocation("operator delete",0); free(p); }
+void operator delete[](void *p,const std::nothrow_t &) noexcept { if(p) checkRealtimeAllocation("operator delete[]",0); free(p); }
+
+#endif
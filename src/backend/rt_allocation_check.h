@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2026 - agent
+ *
+ * This file is part of ReZound, an audio editing application.
+ *
+ * ReZound is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * ReZound is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+#ifndef __rt_allocation_check_h__
+#define __rt_allocation_check_h__
+
+
+#include "../../config/common.h"
+
+#include <stddef.h>
+
+/*
+ * Support for the code that runs in the audio I/O callback (ASoundPlayer::mixSoundPlayerChannels()
+ * and everything it calls).  With JACK that is a real-time thread which must not page-fault or wait
+ * on the heap allocator's locks.
+ */
+
+// allocates size bytes of zeroed, page-aligned memory and locks it into RAM (failing to lock is not
+// fatal since RLIMIT_MEMLOCK is often small for normal users).  Throws if the allocation fails.
+void *allocLockedMemory(size_t size);
+void freeLockedMemory(void *p,size_t size);
+
+// gives the calling thread SCHED_FIFO scheduling at priority (if > 0) and, if lockAllMemory, locks all the
+// process's current and future pages into RAM with mlockall().  It's meant for audio I/O threads that don't
+// belong to JACK.  Neither is permitted for normal users without rtprio or memlock limits, so failing only 
+// prints a warning and returns false since the audio still works, just less reliably at small buffer sizes.
+bool makeThreadRealtime(const int priority,const bool lockAllMemory);
+
+/*
+ * Constructing one of these marks the calling thread as mixing audio in real-time until it is
+ * destructed.  When configured with ENABLE_RT_ALLOCATION_CHECK, operator new and delete are
+ * replaced so that using them on a thread inside such a section prints the size of the
+ * allocation and aborts (run under a debugger to get the backtrace).  Otherwise this costs nothing.
+ */
+class CRealtimeSection
+{
+public:
+#ifdef ENABLE_RT_ALLOCATION_CHECK
+	CRealtimeSection() { depth++; }
+	~CRealtimeSection() { depth--; }
+
+	static thread_local unsigned depth;
+#else
+	CRealtimeSection() { }
+#endif
+};
+
+#endif
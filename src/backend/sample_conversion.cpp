@@ -0,0 +1,525 @@
+/*
+ * Copyright (C) 2026 - agent
+ *
+ * This file is part of ReZound, an audio editing application.
+ *
+ * ReZound is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * ReZound is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+#include "sample_conversion.h"
+
+#include <math.h>
+
+#include <string>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	#define X86_KERNELS
+	#include <immintrin.h>
+	#define TARGET(t) __attribute__((target(t)))
+#endif
+
+RSampleDither::RSampleDither(const DitherTypes _type,const unsigned _channelCount) :
+	type(_type),
+	channelCount(_channelCount<1 ? 1 : (_channelCount>MAX_CHANNELS ? MAX_CHANNELS : _channelCount))
+{
+	reset();
+}
+
+void RSampleDither::reset()
+{
+	// xorshift must not be seeded with 0
+	seeds[0]=0x9e3779b9;
+	seeds[1]=0x7f4a7c15;
+	seeds[2]=0x85ebca6b;
+	seeds[3]=0xc2b2ae35;
+	for(unsigned t=0;t<MAX_CHANNELS;t++)
+		errors[t]=0.0f;
+	channel=0;
+}
+
+static inline uint32_t nextRandom(uint32_t &seed)
+{
+	seed^=seed<<13;
+	seed^=seed>>17;
+	seed^=seed<<5;
+	return seed;
+}
+
+// triangular noise in (-1,1) from two uniform draws in [0,1)
+static inline float triangularNoise(uint32_t &seed)
+{
+	const float a=(nextRandom(seed)>>8)*(1.0f/16777216.0f);
+	const float b=(nextRandom(seed)>>8)*(1.0f/16777216.0f);
+	return a-b;
+}
+
+static inline float clampSample(const float s)
+{
+	return s>1.0f ? 1.0f : (s<-1.0f ? -1.0f : s);
+}
+
+// returns the quantized value of the sample scaled by fullScale, with dither applied
+static inline int_fast32_t ditherSample(const float sample,const float fullScale,RSampleDither *dither)
+{
+	const float s=clampSample(sample)*fullScale;
+	float q;
+	if(dither->type==RSampleDither::dtShaped)
+	{
+		// feed the last error of this channel back so that the noise spectrum is tilted by (1 - z^-1)
+		const float v=s-dither->errors[dither->channel];
+		q=floorf(v+triangularNoise(dither->seeds[dither->channel&3]));
+		q=q>fullScale ? fullScale : (q<-fullScale-1.0f ? -fullScale-1.0f : q);
+		dither->errors[dither->channel]=q-v;
+	}
+	else
+	{
+		q=floorf(s+triangularNoise(dither->seeds[dither->channel&3]));
+		q=q>fullScale ? fullScale : (q<-fullScale-1.0f ? -fullScale-1.0f : q);
+	}
+
+	if(++dither->channel>=dither->channelCount)
+		dither->channel=0;
+	return (int_fast32_t)q;
+}
+
+
+// --- generic ------------------------------------------------------------------
+
+static void floatToInt16_generic(const float *src,int16_t *dest,const size_t count)
+{
+	for(size_t t=0;t<count;t++)
+		dest[t]=convert_sample<float,int16_t>(src[t]);
+}
+
+static void int16ToFloat_generic(const int16_t *src,float *dest,const size_t count)
+{
+	for(size_t t=0;t<count;t++)
+		dest[t]=convert_sample<int16_t,float>(src[t]);
+}
+
+static void floatToInt32_generic(const float *src,int32_t *dest,const size_t count)
+{
+	for(size_t t=0;t<count;t++)
+		dest[t]=convert_sample<float,int32_t>(src[t]);
+}
+
+static void int32ToFloat_generic(const int32_t *src,float *dest,const size_t count)
+{
+	for(size_t t=0;t<count;t++)
+		dest[t]=convert_sample<int32_t,float>(src[t]);
+}
+
+// one lane per position mod 4 so that the vectorized version draws the same noise
+static void floatToInt16Triangular_generic(const float *src,int16_t *dest,const size_t count,uint32_t *seeds)
+{
+	for(size_t t=0;t<count;t++)
+	{
+		float q=floorf(clampSample(src[t])*32767.0f+triangularNoise(seeds[t&3]));
+		dest[t]=(int16_t)(q>32767.0f ? 32767.0f : (q<-32768.0f ? -32768.0f : q));
+	}
+}
+
+static void interleave2_generic(const float *src1,const float *src2,float *dest,const size_t frames)
+{
+	for(size_t t=0;t<frames;t++)
+	{
+		dest[t*2]=src1[t];
+		dest[t*2+1]=src2[t];
+	}
+}
+
+static void deinterleave2_generic(const float *src,float *dest1,float *dest2,const size_t frames)
+{
+	for(size_t t=0;t<frames;t++)
+	{
+		dest1[t]=src[t*2];
+		dest2[t]=src[t*2+1];
+	}
+}
+
+
+#ifdef X86_KERNELS
+// --- SSE2 ---------------------------------------------------------------------
+
+// floor() of 4 floats as integers: truncate and subtract 1 wherever that rounded up
+TARGET("sse2") static inline __m128i floor_sse2(const __m128 v)
+{
+	const __m128i t=_mm_cvttps_epi32(v);
+	return _mm_add_epi32(t,_mm_castps_si128(_mm_cmplt_ps(v,_mm_cvtepi32_ps(t))));
+}
+
+TARGET("sse2") static inline __m128 clampScale_sse2(const __m128 v,const __m128 scale)
+{
+	return _mm_mul_ps(_mm_min_ps(_mm_max_ps(v,_mm_set1_ps(-1.0f)),_mm_set1_ps(1.0f)),scale);
+}
+
+TARGET("sse2") static void floatToInt16_sse2(const float *src,int16_t *dest,const size_t count)
+{
+	const __m128 scale=_mm_set1_ps(32767.0f);
+	size_t t=0;
+	for(;t+8<=count;t+=8)
+	{
+		const __m128i a=floor_sse2(clampScale_sse2(_mm_loadu_ps(src+t),scale));
+		const __m128i b=floor_sse2(clampScale_sse2(_mm_loadu_ps(src+t+4),scale));
+		_mm_storeu_si128((__m128i *)(dest+t),_mm_packs_epi32(a,b));
+	}
+	floatToInt16_generic(src+t,dest+t,count-t);
+}
+
+TARGET("sse2") static void int16ToFloat_sse2(const int16_t *src,float *dest,const size_t count)
+{
+	const __m128 scale=_mm_set1_ps(32767.0f);
+	size_t t=0;
+	for(;t+8<=count;t+=8)
+	{
+		const __m128i s=_mm_loadu_si128((const __m128i *)(src+t));
+		// sign extend to 32 bits by putting each sample in the high half and shifting it back down
+		const __m128i lo=_mm_srai_epi32(_mm_unpacklo_epi16(s,s),16);
+		const __m128i hi=_mm_srai_epi32(_mm_unpackhi_epi16(s,s),16);
+		_mm_storeu_ps(dest+t,_mm_div_ps(_mm_cvtepi32_ps(lo),scale));
+		_mm_storeu_ps(dest+t+4,_mm_div_ps(_mm_cvtepi32_ps(hi),scale));
+	}
+	int16ToFloat_generic(src+t,dest+t,count-t);
+}
+
+// floor() of 2 doubles as integers in the low 2 lanes
+TARGET("sse2") static inline __m128i floorpd_sse2(const __m128d v)
+{
+	const __m128i t=_mm_cvttpd_epi32(v);
+	const __m128i roundedUp=_mm_shuffle_epi32(_mm_castpd_si128(_mm_cmplt_pd(v,_mm_cvtepi32_pd(t))),_MM_SHUFFLE(3,3,2,0));
+	return _mm_add_epi32(t,roundedUp);
+}
+
+TARGET("sse2") static void floatToInt32_sse2(const float *src,int32_t *dest,const size_t count)
+{
+	const __m128 one=_mm_set1_ps(1.0f);
+	const __m128d scale=_mm_set1_pd(2147483647.0);
+	size_t t=0;
+	for(;t+4<=count;t+=4)
+	{
+		const __m128 s=_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src+t),_mm_set1_ps(-1.0f)),one);
+		const __m128i lo=floorpd_sse2(_mm_mul_pd(_mm_cvtps_pd(s),scale));
+		const __m128i hi=floorpd_sse2(_mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(s,s)),scale));
+		_mm_storeu_si128((__m128i *)(dest+t),_mm_unpacklo_epi64(lo,hi));
+	}
+	floatToInt32_generic(src+t,dest+t,count-t);
+}
+
+TARGET("sse2") static void int32ToFloat_sse2(const int32_t *src,float *dest,const size_t count)
+{
+	const __m128d scale=_mm_set1_pd(2147483647.0);
+	size_t t=0;
+	for(;t+4<=count;t+=4)
+	{
+		const __m128i s=_mm_loadu_si128((const __m128i *)(src+t));
+		const __m128 lo=_mm_cvtpd_ps(_mm_div_pd(_mm_cvtepi32_pd(s),scale));
+		const __m128 hi=_mm_cvtpd_ps(_mm_div_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(s,_MM_SHUFFLE(1,0,3,2))),scale));
+		_mm_storeu_ps(dest+t,_mm_movelh_ps(lo,hi));
+	}
+	int32ToFloat_generic(src+t,dest+t,count-t);
+}
+
+TARGET("sse2") static inline __m128i nextRandom_sse2(__m128i &seeds)
+{
+	seeds=_mm_xor_si128(seeds,_mm_slli_epi32(seeds,13));
+	seeds=_mm_xor_si128(seeds,_mm_srli_epi32(seeds,17));
+	seeds=_mm_xor_si128(seeds,_mm_slli_epi32(seeds,5));
+	return seeds;
+}
+
+TARGET("sse2") static void floatToInt16Triangular_sse2(const float *src,int16_t *dest,const size_t count,uint32_t *_seeds)
+{
+	const __m128 scale=_mm_set1_ps(32767.0f);
+	const __m128 unit=_mm_set1_ps(1.0f/16777216.0f);
+	__m128i seeds=_mm_loadu_si128((const __m128i *)_seeds);
+	size_t t=0;
+	for(;t+4<=count;t+=4)
+	{
+		const __m128 a=_mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(nextRandom_sse2(seeds),8)),unit);
+		const __m128 b=_mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(nextRandom_sse2(seeds),8)),unit);
+		const __m128i q=floor_sse2(_mm_add_ps(clampScale_sse2(_mm_loadu_ps(src+t),scale),_mm_sub_ps(a,b)));
+		_mm_storel_epi64((__m128i *)(dest+t),_mm_packs_epi32(q,q));
+	}
+	_mm_storeu_si128((__m128i *)_seeds,seeds);
+	floatToInt16Triangular_generic(src+t,dest+t,count-t,_seeds);
+}
+
+TARGET("sse2") static void interleave2_sse2(const float *src1,const float *src2,float *dest,const size_t frames)
+{
+	size_t t=0;
+	for(;t+4<=frames;t+=4)
+	{
+		const __m128 a=_mm_loadu_ps(src1+t);
+		const __m128 b=_mm_loadu_ps(src2+t);
+		_mm_storeu_ps(dest+t*2,_mm_unpacklo_ps(a,b));
+		_mm_storeu_ps(dest+t*2+4,_mm_unpackhi_ps(a,b));
+	}
+	interleave2_generic(src1+t,src2+t,dest+t*2,frames-t);
+}
+
+TARGET("sse2") static void deinterleave2_sse2(const float *src,float *dest1,float *dest2,const size_t frames)
+{
+	size_t t=0;
+	for(;t+4<=frames;t+=4)
+	{
+		const __m128 a=_mm_loadu_ps(src+t*2);
+		const __m128 b=_mm_loadu_ps(src+t*2+4);
+		_mm_storeu_ps(dest1+t,_mm_shuffle_ps(a,b,_MM_SHUFFLE(2,0,2,0)));
+		_mm_storeu_ps(dest2+t,_mm_shuffle_ps(a,b,_MM_SHUFFLE(3,1,3,1)));
+	}
+	deinterleave2_generic(src+t*2,dest1+t,dest2+t,frames-t);
+}
+
+
+// --- AVX2 ---------------------------------------------------------------------
+
+TARGET("avx2") static inline __m256 clampScale_avx2(const __m256 v,const __m256 scale)
+{
+	return _mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(v,_mm256_set1_ps(-1.0f)),_mm256_set1_ps(1.0f)),scale);
+}
+
+TARGET("avx2") static void floatToInt16_avx2(const float *src,int16_t *dest,const size_t count)
+{
+	const __m256 scale=_mm256_set1_ps(32767.0f);
+	size_t t=0;
+	for(;t+16<=count;t+=16)
+	{
+		const __m256i a=_mm256_cvttps_epi32(_mm256_floor_ps(clampScale_avx2(_mm256_loadu_ps(src+t),scale)));
+		const __m256i b=_mm256_cvttps_epi32(_mm256_floor_ps(clampScale_avx2(_mm256_loadu_ps(src+t+8),scale)));
+		// packing works within each 128 bit half, so put the 64 bit quarters back in order
+		_mm256_storeu_si256((__m256i *)(dest+t),_mm256_permute4x64_epi64(_mm256_packs_epi32(a,b),_MM_SHUFFLE(3,1,2,0)));
+	}
+	floatToInt16_sse2(src+t,dest+t,count-t);
+}
+
+TARGET("avx2") static void int16ToFloat_avx2(const int16_t *src,float *dest,const size_t count)
+{
+	const __m256 scale=_mm256_set1_ps(32767.0f);
+	size_t t=0;
+	for(;t+8<=count;t+=8)
+	{
+		const __m256i s=_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(src+t)));
+		_mm256_storeu_ps(dest+t,_mm256_div_ps(_mm256_cvtepi32_ps(s),scale));
+	}
+	int16ToFloat_generic(src+t,dest+t,count-t);
+}
+
+TARGET("avx2") static void floatToInt32_avx2(const float *src,int32_t *dest,const size_t count)
+{
+	const __m128 one=_mm_set1_ps(1.0f);
+	const __m256d scale=_mm256_set1_pd(2147483647.0);
+	size_t t=0;
+	for(;t+4<=count;t+=4)
+	{
+		const __m128 s=_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src+t),_mm_set1_ps(-1.0f)),one);
+		_mm_storeu_si128((__m128i *)(dest+t),_mm256_cvttpd_epi32(_mm256_floor_pd(_mm256_mul_pd(_mm256_cvtps_pd(s),scale))));
+	}
+	floatToInt32_generic(src+t,dest+t,count-t);
+}
+
+TARGET("avx2") static void int32ToFloat_avx2(const int32_t *src,float *dest,const size_t count)
+{
+	const __m256d scale=_mm256_set1_pd(2147483647.0);
+	size_t t=0;
+	for(;t+4<=count;t+=4)
+	{
+		const __m256d s=_mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i *)(src+t)));
+		_mm_storeu_ps(dest+t,_mm256_cvtpd_ps(_mm256_div_pd(s,scale)));
+	}
+	int32ToFloat_generic(src+t,dest+t,count-t);
+}
+#endif
+
+
+// --- dispatch -----------------------------------------------------------------
+
+struct RKernels
+{
+	const char *name;
+	void (*floatToInt16)(const float *src,int16_t *dest,const size_t count);
+	void (*int16ToFloat)(const int16_t *src,float *dest,const size_t count);
+	void (*floatToInt32)(const float *src,int32_t *dest,const size_t count);
+	void (*int32ToFloat)(const int32_t *src,float *dest,const size_t count);
+	void (*floatToInt16Triangular)(const float *src,int16_t *dest,const size_t count,uint32_t *seeds);
+	void (*interleave2)(const float *src1,const float *src2,float *dest,const size_t frames);
+	void (*deinterleave2)(const float *src,float *dest1,float *dest2,const size_t frames);
+};
+
+// fills in k with the named kernel set if this CPU can run it
+static bool makeKernels(const string name,RKernels &k)
+{
+	const RKernels generic={"generic",floatToInt16_generic,int16ToFloat_generic,floatToInt32_generic,int32ToFloat_generic,floatToInt16Triangular_generic,interleave2_generic,deinterleave2_generic};
+	if(name=="generic")
+	{
+		k=generic;
+		return true;
+	}
+#ifdef X86_KERNELS
+	__builtin_cpu_init();
+	if(!__builtin_cpu_supports("sse2"))
+		return false;
+	const RKernels sse2={"sse2",floatToInt16_sse2,int16ToFloat_sse2,floatToInt32_sse2,int32ToFloat_sse2,floatToInt16Triangular_sse2,interleave2_sse2,deinterleave2_sse2};
+	if(name=="sse2")
+	{
+		k=sse2;
+		return true;
+	}
+	if(name=="avx2" && __builtin_cpu_supports("avx2"))
+	{
+		// (only the plain conversions have avx2 versions)
+		k=sse2;
+		k.name="avx2";
+		k.floatToInt16=floatToInt16_avx2;
+		k.int16ToFloat=int16ToFloat_avx2;
+		k.floatToInt32=floatToInt32_avx2;
+		k.int32ToFloat=int32ToFloat_avx2;
+		return true;
+	}
+#endif
+	return false;
+}
+
+static RKernels chooseKernels()
+{
+	RKernels k;
+	for(const char *name:{"avx2","sse2","generic"})
+	{
+		if(makeKernels(name,k))
+			break;
+	}
+	return k;
+}
+
+static RKernels &getKernels()
+{
+	static RKernels kernels=chooseKernels();
+	return kernels;
+}
+
+bool setSampleConversionKernels(const char *name)
+{
+	return makeKernels(name,getKernels());
+}
+
+const char *getSampleConversionKernelName()
+{
+	return getKernels().name;
+}
+
+void convertSamples(const float *src,int16_t *dest,const size_t count,RSampleDither *dither)
+{
+	if(dither==NULL || dither->type==RSampleDither::dtNone)
+		getKernels().floatToInt16(src,dest,count);
+	else if(dither->type==RSampleDither::dtTriangular)
+		getKernels().floatToInt16Triangular(src,dest,count,dither->seeds);
+	else
+	{
+		for(size_t t=0;t<count;t++)
+			dest[t]=(int16_t)ditherSample(src[t],32767.0f,dither);
+	}
+}
+
+void convertSamples(const int16_t *src,float *dest,const size_t count)
+{
+	getKernels().int16ToFloat(src,dest,count);
+}
+
+void convertSamples(const float *src,int24_t *dest,const size_t count,RSampleDither *dither)
+{
+	if(dither==NULL || dither->type==RSampleDither::dtNone)
+	{
+		for(size_t t=0;t<count;t++)
+			dest[t]=convert_sample<float,int24_t>(src[t]);
+	}
+	else
+	{
+		for(size_t t=0;t<count;t++)
+			dest[t].set(ditherSample(src[t],8388607.0f,dither));
+	}
+}
+
+void convertSamples(const int24_t *src,float *dest,const size_t count)
+{
+	for(size_t t=0;t<count;t++)
+		dest[t]=convert_sample<int24_t,float>(src[t]);
+}
+
+void convertSamples(const float *src,int32_t *dest,const size_t count)
+{
+	getKernels().floatToInt32(src,dest,count);
+}
+
+void convertSamples(const int32_t *src,float *dest,const size_t count)
+{
+	getKernels().int32ToFloat(src,dest,count);
+}
+
+template<typename sample_t> static void interleaveSamples_generic(const sample_t * const *src,const unsigned channelCount,sample_t *dest,const size_t frames)
+{
+	for(unsigned c=0;c<channelCount;c++)
+	{
+		const sample_t *s=src[c];
+		sample_t *d=dest+c;
+		for(size_t t=0;t<frames;t++,d+=channelCount)
+			*d=s[t];
+	}
+}
+
+template<typename sample_t> static void deinterleaveSamples_generic(const sample_t *src,const unsigned channelCount,sample_t * const *dest,const size_t frames)
+{
+	for(unsigned c=0;c<channelCount;c++)
+	{
+		const sample_t *s=src+c;
+		sample_t *d=dest[c];
+		for(size_t t=0;t<frames;t++,s+=channelCount)
+			d[t]=*s;
+	}
+}
+
+void interleaveSamples(const float * const *src,const unsigned channelCount,float *dest,const size_t frames)
+{
+	if(channelCount==1)
+		memcpy(dest,src[0],frames*sizeof(*dest));
+	else if(channelCount==2)
+		getKernels().interleave2(src[0],src[1],dest,frames);
+	else
+		interleaveSamples_generic(src,channelCount,dest,frames);
+}
+
+void interleaveSamples(const int16_t * const *src,const unsigned channelCount,int16_t *dest,const size_t frames)
+{
+	if(channelCount==1)
+		memcpy(dest,src[0],frames*sizeof(*dest));
+	else
+		interleaveSamples_generic(src,channelCount,dest,frames);
+}
+
+void deinterleaveSamples(const float *src,const unsigned channelCount,float * const *dest,const size_t frames)
+{
+	if(channelCount==1)
+		memcpy(dest[0],src,frames*sizeof(*src));
+	else if(channelCount==2)
+		getKernels().deinterleave2(src,dest[0],dest[1],frames);
+	else
+		deinterleaveSamples_generic(src,channelCount,dest,frames);
+}
+
+void deinterleaveSamples(const int16_t *src,const unsigned channelCount,int16_t * const *dest,const size_t frames)
+{
+	if(channelCount==1)
+		memcpy(dest[0],src,frames*sizeof(*src));
+	else
+		deinterleaveSamples_generic(src,channelCount,dest,frames);
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2026 - agent
+ *
+ * This file is part of ReZound, an audio editing application.
+ *
+ * ReZound is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * ReZound is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+#ifndef __sample_conversion_h__
+#define __sample_conversion_h__
+
+
+#include "../../config/common.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "CSound_defs.h"
+
+/*
+ * Block conversions between the sample formats that the audio I/O and the sound translators
+ * deal in, and (de)interleaving of frames.
+ *
+ * Without dither, the results are bit for bit what convert_sample<>() gives for each element;
+ * the float <-> int16/int32 conversions and the stereo (de)interleaving are vectorized, and
+ * which implementation is used is decided once at runtime from the CPU's features (SSE2 or
+ * AVX2 on x86, otherwise a plain C++ loop).
+ *
+ * Converting float to a narrower integer type may be dithered by passing an RSampleDither.
+ * Its state carries over from one call to the next so a stream can be converted a block at
+ * a time, but each block must then start on a frame boundary.
+ */
+
+struct RSampleDither
+{
+	enum DitherTypes
+	{
+		dtNone,
+		dtTriangular,	// +/- 1 LSB of triangular noise, which makes the quantization error independent of the signal
+		dtShaped	// triangular, plus first order error feedback which moves the noise up toward nyquist
+	};
+
+	RSampleDither(const DitherTypes type=dtTriangular,const unsigned channelCount=1);
+	void reset();
+
+	DitherTypes type;
+	unsigned channelCount;
+
+	// state used by the kernels
+	uint32_t seeds[4];
+	float errors[MAX_CHANNELS];
+	unsigned channel; // that the next sample belongs to
+};
+
+// returns the name of the kernels that were chosen for this CPU ("avx2", "sse2" or "generic")
+const char *getSampleConversionKernelName();
+// switches to the named kernels, returning false if this CPU can't run them (meant for tests and benchmarks, not while conversions are going on)
+bool setSampleConversionKernels(const char *name);
+
+void convertSamples(const float *src,int16_t *dest,const size_t count,RSampleDither *dither=NULL);
+void convertSamples(const int16_t *src,float *dest,const size_t count);
+void convertSamples(const float *src,int24_t *dest,const size_t count,RSampleDither *dither=NULL);
+void convertSamples(const int24_t *src,float *dest,const size_t count);
+void convertSamples(const float *src,int32_t *dest,const size_t count);
+void convertSamples(const int32_t *src,float *dest,const size_t count);
+
+static inline void convertSamples(const float *src,float *dest,const size_t count) { memcpy(dest,src,count*sizeof(*dest)); }
+static inline void convertSamples(const int16_t *src,int16_t *dest,const size_t count,RSampleDither *dither=NULL) { memcpy(dest,src,count*sizeof(*dest)); } // (nothing to dither)
+static inline void convertSamples(const int32_t *src,int32_t *dest,const size_t count) { memcpy(dest,src,count*sizeof(*dest)); }
+
+// any other combination (the integer formats to each other) is done an element at a time
+template<typename from_t,typename to_t> static inline void convertSamples(const from_t *src,to_t *dest,const size_t count)
+{
+	for(size_t t=0;t<count;t++)
+		dest[t]=convert_sample<from_t,to_t>(src[t]);
+}
+
+
+// interleaves frames from channelCount separate buffers into dest, or the reverse
+void interleaveSamples(const float * const *src,const unsigned channelCount,float *dest,const size_t frames);
+void interleaveSamples(const int16_t * const *src,const unsigned channelCount,int16_t *dest,const size_t frames);
+void deinterleaveSamples(const float *src,const unsigned channelCount,float * const *dest,const size_t frames);
+void deinterleaveSamples(const int16_t *src,const unsigned channelCount,int16_t * const *dest,const size_t frames);
+
+// these also convert the samples, a block at a time through a buffer on the stack (the separate buffers must be float or int16_t)
+template<typename from_t,typename to_t> static void interleaveSamples(const from_t * const *src,const unsigned channelCount,to_t *dest,const size_t frames)
+{
+	from_t buffer[1024];
+	const from_t *s[MAX_CHANNELS];
+	const size_t blockFrames=1024/channelCount;
+	for(size_t pos=0;pos<frames;pos+=blockFrames)
+	{
+		const size_t n=min(blockFrames,frames-pos);
+		for(unsigned c=0;c<channelCount;c++)
+			s[c]=src[c]+pos;
+		interleaveSamples(s,channelCount,buffer,n);
+		convertSamples(buffer,dest+pos*channelCount,n*channelCount);
+	}
+}
+
+template<typename from_t,typename to_t> static void deinterleaveSamples(const from_t *src,const unsigned channelCount,to_t * const *dest,const size_t frames)
+{
+	to_t buffer[1024];
+	to_t *d[MAX_CHANNELS];
+	const size_t blockFrames=1024/channelCount;
+	for(size_t pos=0;pos<frames;pos+=blockFrames)
+	{
+		const size_t n=min(blockFrames,frames-pos);
+		convertSamples(src+pos*channelCount,buffer,n*channelCount);
+		for(unsigned c=0;c<channelCount;c++)
+			d[c]=dest[c]+pos;
+		deinterleaveSamples(buffer,channelCount,d,n);
+	}
+}
+
+#endif
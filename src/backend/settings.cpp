@@ -70,6 +70,12 @@ unsigned gDesiredOutputChannelCount=2;
 int gDesiredOutputBufferCount=2;
 unsigned gDesiredOutputBufferSize=2048; // in frames (must be a power of 2)
 
+int gDesiredInputBufferCount=2;
+unsigned gDesiredInputBufferSize=8192; // in frames
+
+int gRealtimeAudioThreadPriority=0;
+bool gLockMemoryForRealtimeAudio=false;
+
 
 #ifdef ENABLE_OSS
 string gOSSOutputDevice="/dev/dsp";
@@ -78,6 +84,8 @@ string gOSSInputDevice="/dev/dsp";
 #ifdef ENABLE_ALSA
 string gALSAOutputDevice="hw:0";
 string gALSAInputDevice="hw:0";
+bool gALSAUseMmap=true;
+unsigned gALSAOutputPeriodSize=0; // in frames (0 means the player's default of 1024)
 #endif
 #ifdef ENABLE_PORTAUDIO
 int gPortAudioOutputDevice=0;
@@ -104,11 +112,19 @@ size_t gWhichClipboard=0;
 size_t gMaxReopenHistory=16;
 
 
+bool gCompressUndoData=false;
+unsigned gUndoHistoryBudgetMB=0;
+
+
 float gSkipMiddleMarginSeconds=2.0;
 float gLoopGapLengthSeconds=0.75;
 
 float gPlayPositionShift=-0.08; // a guess at latency between hearing and where it would place the cue
 
+unsigned gSampleRateConversionQuality=2;
+
+unsigned gExportDither=0;
+
 string gAddCueWhilePlaying_CueName="";
 bool gAddCueWhilePlaying_Anchored=false;
 
@@ -150,6 +166,7 @@ map<string,AActionFactory *> gRegisteredActionFactories;
 #include <stdio.h>
 
 #include <stdexcept>
+#include <algorithm>
 
 #include <CPath.h>
 #include <CNestedDataFile/CNestedDataFile.h>
@@ -267,6 +284,15 @@ void readBackendSettings()
 		if(gDesiredOutputBufferSize<256 || (gDesiredOutputBufferSize & (gDesiredOutputBufferSize-1)))
 			throw runtime_error(string(__func__)+" -- DesiredOutputBufferSize in "+gSettingsRegistry->getFilename()+" must be a power of 2 and >= than 256");
 
+	GET_SETTING("DesiredInputBufferCount",gDesiredInputBufferCount,int)
+		gDesiredInputBufferCount=max(2,gDesiredInputBufferCount);
+	GET_SETTING("DesiredInputBufferSize",gDesiredInputBufferSize,unsigned)
+		if(gDesiredInputBufferSize<32)
+			throw runtime_error(string(__func__)+" -- DesiredInputBufferSize in "+gSettingsRegistry->getFilename()+" must be >= than 32");
+
+	GET_SETTING("RealtimeAudioThreadPriority",gRealtimeAudioThreadPriority,int)
+	GET_SETTING("LockMemoryForRealtimeAudio",gLockMemoryForRealtimeAudio,bool)
+
 
 #ifdef ENABLE_OSS
 	GET_SETTING("OSSOutputDevice",gOSSOutputDevice,string)
@@ -276,6 +302,10 @@ void readBackendSettings()
 #ifdef ENABLE_ALSA
 	GET_SETTING("ALSAOutputDevice",gALSAOutputDevice,string)
 	GET_SETTING("ALSAInputDevice",gALSAInputDevice,string)
+	GET_SETTING("ALSAUseMmap",gALSAUseMmap,bool)
+	GET_SETTING("ALSAOutputPeriodSize",gALSAOutputPeriodSize,unsigned)
+		if(gALSAOutputPeriodSize!=0 && (gALSAOutputPeriodSize<32 || (gALSAOutputPeriodSize & (gALSAOutputPeriodSize-1))))
+			throw runtime_error(string(__func__)+" -- ALSAOutputPeriodSize in "+gSettingsRegistry->getFilename()+" must be 0 or a power of 2 and >= than 32");
 #endif
 
 #ifdef ENABLE_PORTAUDIO
@@ -325,12 +355,21 @@ void readBackendSettings()
 
 	GET_SETTING("ReopenHistory" DOT "maxReopenHistory",gMaxReopenHistory,size_t)
 
+	GET_SETTING("Undo" DOT "compressUndoData",gCompressUndoData,bool)
+	GET_SETTING("Undo" DOT "historyBudgetMB",gUndoHistoryBudgetMB,unsigned)
+
 	GET_SETTING("skipMiddleMarginSeconds",gSkipMiddleMarginSeconds,float)
 
 	GET_SETTING("loopGapLengthSeconds",gLoopGapLengthSeconds,float)
 
 	GET_SETTING("playPositionShift",gPlayPositionShift,float)
 
+	GET_SETTING("sampleRateConversionQuality",gSampleRateConversionQuality,unsigned)
+	gSampleRateConversionQuality=min(gSampleRateConversionQuality,3u);
+
+	GET_SETTING("exportDither",gExportDither,unsigned)
+	gExportDither=min(gExportDither,2u);
+
 	GET_SETTING("addCueWhilePlaying_CueName",gAddCueWhilePlaying_CueName,string)
 	GET_SETTING("addCueWhilePlaying_Anchored",gAddCueWhilePlaying_Anchored,bool)
 
@@ -372,6 +411,11 @@ void writeBackendSettings()
 	gSettingsRegistry->setValue<unsigned>("DesiredOutputChannelCount",gDesiredOutputChannelCount);
 	gSettingsRegistry->setValue<int>("DesiredOutputBufferCount",gDesiredOutputBufferCount);
 	gSettingsRegistry->setValue<unsigned>("DesiredOutputBufferSize",gDesiredOutputBufferSize);
+	gSettingsRegistry->setValue<int>("DesiredInputBufferCount",gDesiredInputBufferCount);
+	gSettingsRegistry->setValue<unsigned>("DesiredInputBufferSize",gDesiredInputBufferSize);
+
+	gSettingsRegistry->setValue<int>("RealtimeAudioThreadPriority",gRealtimeAudioThreadPriority);
+	gSettingsRegistry->setValue<bool>("LockMemoryForRealtimeAudio",gLockMemoryForRealtimeAudio);
 
 
 #ifdef ENABLE_OSS
@@ -379,6 +423,11 @@ void writeBackendSettings()
 	gSettingsRegistry->setValue<string>("OSSInputDevice",gOSSInputDevice);
 #endif
 
+#ifdef ENABLE_ALSA
+	gSettingsRegistry->setValue<bool>("ALSAUseMmap",gALSAUseMmap);
+	gSettingsRegistry->setValue<unsigned>("ALSAOutputPeriodSize",gALSAOutputPeriodSize);
+#endif
+
 #ifdef ENABLE_PORTAUDIO
 	gSettingsRegistry->setValue<int>("PortAudioOutputDevice",gPortAudioOutputDevice);
 	gSettingsRegistry->setValue<int>("PortAudioInputDevice",gPortAudioInputDevice);
@@ -419,11 +468,17 @@ void writeBackendSettings()
 
 	gSettingsRegistry->setValue<size_t>("ReopenHistory" DOT "maxReopenHistory",gMaxReopenHistory);
 
+	gSettingsRegistry->setValue<bool>("Undo" DOT "compressUndoData",gCompressUndoData);
+	gSettingsRegistry->setValue<unsigned>("Undo" DOT "historyBudgetMB",gUndoHistoryBudgetMB);
+
 	gSettingsRegistry->setValue<float>("skipMiddleMarginSeconds",gSkipMiddleMarginSeconds);
 	gSettingsRegistry->setValue<float>("loopGapLengthSeconds",gLoopGapLengthSeconds);
 
 	gSettingsRegistry->setValue<float>("playPositionShift",gPlayPositionShift);
 
+	gSettingsRegistry->setValue<unsigned>("sampleRateConversionQuality",gSampleRateConversionQuality);
+	gSettingsRegistry->setValue<unsigned>("exportDither",gExportDither);
+
 	gSettingsRegistry->setValue<string>("addCueWhilePlaying_CueName",gAddCueWhilePlaying_CueName);
 	gSettingsRegistry->setValue<bool>("addCueWhilePlaying_Anchored",gAddCueWhilePlaying_Anchored);
 
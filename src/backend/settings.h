@@ -80,6 +80,15 @@ extern unsigned gDesiredOutputChannelCount;	// defaulted to 2
 extern int gDesiredOutputBufferCount;		// defaulted to 2
 extern unsigned gDesiredOutputBufferSize;	// defaulted to 2048 (in frames)
 
+// the desired input device buffering (only used by ALSA so far)
+extern int gDesiredInputBufferCount;		// defaulted to 2
+extern unsigned gDesiredInputBufferSize;	// defaulted to 8192 (in frames)
+
+// if > 0, the audio I/O threads that don't belong to JACK ask for SCHED_FIFO at this priority (which needs rtprio permission)
+extern int gRealtimeAudioThreadPriority;	// defaulted to 0
+// if true, the audio I/O threads lock all the process's memory into RAM with mlockall() (which needs memlock permission)
+extern bool gLockMemoryForRealtimeAudio;	// defaulted to false
+
 #ifdef ENABLE_OSS
 // the OSS devices to use 
 extern string gOSSOutputDevice;			// defaulted to "/dev/dsp"
@@ -89,6 +98,8 @@ extern string gOSSInputDevice;			// defaulted to "/dev/dsp"
 // the ALSA devices to use 
 extern string gALSAOutputDevice;		// defaulted to "hw:0"
 extern string gALSAInputDevice;			// defaulted to "hw:0"
+extern bool gALSAUseMmap;			// defaulted to true (mix into and record from the device's buffer directly if it supports it)
+extern unsigned gALSAOutputPeriodSize;		// defaulted to 0 (if not 0, the player's period size in frames instead of 1024, and it may be as small as 32 for low-latency monitoring)
 #endif
 #ifdef ENABLE_PORTAUDIO
 // the PortAudio devices to use
@@ -128,6 +139,19 @@ extern size_t gWhichClipboard;
 extern size_t gMaxReopenHistory; 		// defaulted to 16
 
 
+/*
+ * Whether the audio that is saved for undoing actions is losslessly compressed once the action is done
+ * (costs some time after each action and before undoing it, but keeps the working files much smaller)
+ */
+extern bool gCompressUndoData;			// defaulted to false
+
+/*
+ * The most megabytes of undo data to keep for each sound, the oldest actions are forgotten to stay 
+ * under it (the last action can always be undone).  0 is no limit
+ */
+extern unsigned gUndoHistoryBudgetMB;		// defaulted to 0
+
+
 /*
  * dealing when loopType is ltLoopSkipMost
  * Specifies how much time should be played before skipping past the middle to (this much also before) the loop point
@@ -146,6 +170,19 @@ extern float gLoopGapLengthSeconds;
 extern float gPlayPositionShift;
 
 
+/*
+ * The quality of sample rate conversion when changing a sound's sample rate or when mixing
+ * audio of a different sample rate into a sound: 0 (fastest) to 3 (best) (see CDSPSincResampler::Qualities)
+ */
+extern unsigned gSampleRateConversionQuality;	// defaulted to 2
+
+/*
+ * The dither to use when saving to a 16 bit format: 0 (none), 1 (triangular) or 2 (noise shaped) 
+ * (see RSampleDither::DitherTypes)
+ */
+extern unsigned gExportDither;			// defaulted to 0
+
+
 /*
  * How to create a cue that is added with the "Add Cue While Playing" action
  */
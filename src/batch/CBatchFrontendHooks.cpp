@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2026 - agent
+ *
+ * This file is part of ReZound, an audio editing application.
+ *
+ * ReZound is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * ReZound is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+#include "CBatchFrontendHooks.h"
+
+#include <stdio.h>
+
+#include <stdexcept>
+
+#include <istring>
+
+#include "../backend/settings.h"
+
+CBatchFrontendHooks::CBatchFrontendHooks()
+{
+}
+
+CBatchFrontendHooks::~CBatchFrontendHooks()
+{
+}
+
+void CBatchFrontendHooks::setWhichClipboard(size_t whichClipboard)
+{
+	gWhichClipboard=whichClipboard;
+}
+
+static bool cannotPrompt(const string what)
+{
+	fprintf(stderr,"rezound_batch: cannot prompt for %s; cancelling\n",what.c_str());
+	return false;
+}
+
+bool CBatchFrontendHooks::promptForOpenSoundFilename(string &filename,bool &readOnly,bool &openAsRaw)
+{
+	return cannotPrompt("a file to open");
+}
+
+bool CBatchFrontendHooks::promptForOpenSoundFilenames(vector<string> &filenames,bool &readOnly,bool &openAsRaw)
+{
+	return cannotPrompt("files to open");
+}
+
+bool CBatchFrontendHooks::promptForSaveSoundFilename(string &filename,bool &saveAsRaw)
+{
+	return cannotPrompt("a filename to save as");
+}
+
+bool CBatchFrontendHooks::promptForNewSoundParameters(string &filename,bool &rawFormat,bool hideFilename,unsigned &channelCount,bool hideChannelCount,unsigned &sampleRate,bool hideSampleRate,sample_pos_t &length,bool hideLength)
+{
+	return cannotPrompt("new sound parameters");
+}
+
+bool CBatchFrontendHooks::promptForDirectory(string &dirname,const string title)
+{
+	return cannotPrompt("a directory");
+}
+
+bool CBatchFrontendHooks::promptForRecord(ASoundRecorder *recorder)
+{
+	return cannotPrompt("recording");
+}
+
+bool CBatchFrontendHooks::showRecordMacroDialog(string &macroName)
+{
+	return cannotPrompt("recording a macro");
+}
+
+bool CBatchFrontendHooks::showMacroActionParamsDialog(const AActionFactory *actionFactory,MacroActionParameters &macroActionParameters,CLoadedSound *loadedSound)
+{
+	return cannotPrompt("macro action parameters");
+}
+
+#ifdef ENABLE_JACK
+const string CBatchFrontendHooks::promptForJACKPort(const string message,const vector<string> portNames)
+{
+	return portNames.empty() ? "" : portNames[0];
+}
+#endif
+
+bool CBatchFrontendHooks::promptForRezSaveParameters(RezSaveParameters &parameters)
+{
+	// the translator has filled in the sound's previous encoding or the default
+	return true;
+}
+
+bool CBatchFrontendHooks::promptForRawParameters(RawParameters &parameters,bool showOffsetAndLengthParameters)
+{
+	return cannotPrompt("raw format parameters");
+}
+
+bool CBatchFrontendHooks::promptForOggCompressionParameters(OggCompressionParameters &parameters)
+{
+	// same as COggDialog's defaults
+	parameters.method=OggCompressionParameters::brQuality;
+	parameters.quality=0.7f;
+	parameters.minBitRate=parameters.normBitRate=parameters.maxBitRate=128000;
+	return true;
+}
+
+bool CBatchFrontendHooks::promptForMp3CompressionParameters(Mp3CompressionParameters &parameters)
+{
+	// same as CMp3Dialog's defaults
+	parameters.method=Mp3CompressionParameters::brQuality;
+	parameters.quality=4;
+	parameters.constantBitRate=128000;
+	parameters.minBitRate=parameters.normBitRate=parameters.maxBitRate=128000;
+	parameters.useFlagsOnly=false;
+	parameters.additionalFlags="";
+	return true;
+}
+
+bool CBatchFrontendHooks::promptForVoxParameters(VoxParameters &parameters)
+{
+	return cannotPrompt("vox format parameters");
+}
+
+#ifdef ENABLE_LADSPA
+AActionDialog *CBatchFrontendHooks::getChannelSelectDialog()
+{
+	return NULL;
+}
+
+AActionDialog *CBatchFrontendHooks::getLADSPAActionDialog(const LADSPA_Descriptor *desc)
+{
+	return NULL;
+}
+#endif
+
+bool CBatchFrontendHooks::promptForOpenMIDISampleDump(int &sysExChannel,int &waveformId)
+{
+	return cannotPrompt("a MIDI sample dump");
+}
+
+bool CBatchFrontendHooks::promptForSaveMIDISampleDump(int &sysExChannel,int &waveformId,int &loopType)
+{
+	return cannotPrompt("a MIDI sample dump");
+}
+
+#ifdef HAVE_LIBAUDIOFILE
+#include <audiofile.h>
+#endif
+
+bool CBatchFrontendHooks::promptForlibaudiofileSaveParameters(libaudiofileSaveParameters &parameters,const string formatName)
+{
+#ifdef HAVE_LIBAUDIOFILE
+	// use the defaults the translator chose (the same as ClibaudiofileSaveParametersDialog shows)
+	static const int sampleFormats[]={ AF_SAMPFMT_TWOSCOMP,AF_SAMPFMT_UNSIGNED,AF_SAMPFMT_FLOAT,AF_SAMPFMT_DOUBLE };
+	static const int sampleWidths[]={ 8,16,24,32 };
+
+	if(parameters.defaultSampleFormatIndex<0 || parameters.defaultSampleFormatIndex>=4)
+		throw runtime_error(string(__func__)+" -- internal error -- unhandled sample format index: "+istring(parameters.defaultSampleFormatIndex));
+	if(parameters.defaultSampleWidthIndex<0 || parameters.defaultSampleWidthIndex>=4)
+		throw runtime_error(string(__func__)+" -- internal error -- unhandled sample width index: "+istring(parameters.defaultSampleWidthIndex));
+
+	parameters.sampleFormat=sampleFormats[parameters.defaultSampleFormatIndex];
+	parameters.sampleWidth=sampleWidths[parameters.defaultSampleWidthIndex];
+	parameters.compressionType=
+		(size_t)parameters.defaultCompressionTypeIndex<parameters.supportedCompressionTypes.size()
+		?
+			parameters.supportedCompressionTypes[parameters.defaultCompressionTypeIndex].second
+		:
+			AF_COMPRESSION_NONE
+		;
+	parameters.saveCues=true;
+	parameters.saveUserNotes=true;
+	return true;
+#else
+	return cannotPrompt(formatName+" save parameters");
+#endif
+}
+
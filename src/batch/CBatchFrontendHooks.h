@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2026 - agent
+ *
+ * This file is part of ReZound, an audio editing application.
+ *
+ * ReZound is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * ReZound is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+#ifndef __CBatchFrontendHooks_H__
+#define __CBatchFrontendHooks_H__
+
+#include "../../config/common.h"
+
+#include "../backend/AFrontendHooks.h"
+
+/*
+ * There is nobody to prompt in rezound_batch.  Anything that would ask for a
+ * filename, a directory, recording or the format of a raw file is cancelled.
+ * The save parameter prompts are answered with what the frontend's dialogs
+ * would show by default so that saving to any format works unattended.
+ */
+class CBatchFrontendHooks : public AFrontendHooks
+{
+public:
+	CBatchFrontendHooks();
+	virtual ~CBatchFrontendHooks();
+
+	void setWhichClipboard(size_t whichClipboard);
+
+	bool promptForOpenSoundFilename(string &filename,bool &readOnly,bool &openAsRaw);
+	bool promptForOpenSoundFilenames(vector<string> &filenames,bool &readOnly,bool &openAsRaw);
+	bool promptForSaveSoundFilename(string &filename,bool &saveAsRaw);
+
+	bool promptForNewSoundParameters(string &filename,bool &rawFormat,bool hideFilename,unsigned &channelCount,bool hideChannelCount,unsigned &sampleRate,bool hideSampleRate,sample_pos_t &length,bool hideLength);
+
+	bool promptForDirectory(string &dirname,const string title);
+
+	bool promptForRecord(ASoundRecorder *recorder);
+
+	bool showRecordMacroDialog(string &macroName);
+
+	bool showMacroActionParamsDialog(const AActionFactory *actionFactory,MacroActionParameters &macroActionParameters,CLoadedSound *loadedSound);
+
+#ifdef ENABLE_JACK
+	const string promptForJACKPort(const string message,const vector<string> portNames);
+#endif
+
+	bool promptForRezSaveParameters(RezSaveParameters &parameters);
+	bool promptForRawParameters(RawParameters &parameters,bool showOffsetAndLengthParameters);
+	bool promptForOggCompressionParameters(OggCompressionParameters &parameters);
+	bool promptForMp3CompressionParameters(Mp3CompressionParameters &parameters);
+	bool promptForVoxParameters(VoxParameters &parameters);
+
+#ifdef ENABLE_LADSPA
+	AActionDialog *getChannelSelectDialog();
+	AActionDialog *getLADSPAActionDialog(const LADSPA_Descriptor *desc);
+#endif
+
+	bool promptForOpenMIDISampleDump(int &sysExChannel,int &waveformId);
+	bool promptForSaveMIDISampleDump(int &sysExChannel,int &waveformId,int &loopType);
+
+	bool promptForlibaudiofileSaveParameters(libaudiofileSaveParameters &parameters,const string formatName);
+};
+
+#endif
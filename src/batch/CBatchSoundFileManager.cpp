@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2026 - agent
+ *
+ * This file is part of ReZound, an audio editing application.
+ *
+ * ReZound is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * ReZound is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+#include "CBatchSoundFileManager.h"
+
+#include "../backend/CLoadedSound.h"
+
+CBatchSoundFileManager::CBatchSoundFileManager(ASoundPlayer *soundPlayer,CNestedDataFile *loadedRegistryFile) :
+	ASoundFileManager(soundPlayer,loadedRegistryFile),
+	activeIndex(0)
+{
+}
+
+CBatchSoundFileManager::~CBatchSoundFileManager()
+{
+}
+
+CLoadedSound *CBatchSoundFileManager::getActive()
+{
+	if(activeIndex<loadedSounds.size())
+		return loadedSounds[activeIndex];
+	return NULL;
+}
+
+const size_t CBatchSoundFileManager::getOpenedCount() const
+{
+	return loadedSounds.size();
+}
+
+CLoadedSound *CBatchSoundFileManager::getSound(size_t index)
+{
+	return loadedSounds[index];
+}
+
+void CBatchSoundFileManager::setActiveSound(size_t index)
+{
+	if(index<loadedSounds.size())
+		activeIndex=index;
+}
+
+void CBatchSoundFileManager::updateAfterEdit(CLoadedSound *sound,bool undoing)
+{
+	if(sound==NULL)
+		sound=getActive();
+	if(sound!=NULL && !undoing)
+		sound->clearUndoHistory();
+}
+
+const map<string,string> CBatchSoundFileManager::getPositionalInfo(CLoadedSound *sound)
+{
+	return map<string,string>();
+}
+
+void CBatchSoundFileManager::setPositionalInfo(const map<string,string> positionalInfo,CLoadedSound *sound)
+{
+}
+
+void CBatchSoundFileManager::closeAll()
+{
+	while(!loadedSounds.empty())
+		close(ctSaveNone,loadedSounds.back());
+}
+
+void CBatchSoundFileManager::createWindow(CLoadedSound *loaded)
+{
+	loadedSounds.push_back(loaded);
+	activeIndex=loadedSounds.size()-1;
+}
+
+void CBatchSoundFileManager::destroyWindow(CLoadedSound *loaded)
+{
+	for(size_t t=0;t<loadedSounds.size();t++)
+	{
+		if(loadedSounds[t]==loaded)
+		{
+			loadedSounds.erase(loadedSounds.begin()+t);
+
+			// like the frontend, the sound in the same position (or the last one) becomes active
+			if(t<activeIndex)
+				activeIndex--;
+			else if(activeIndex>=loadedSounds.size())
+				activeIndex= loadedSounds.empty() ? 0 : loadedSounds.size()-1;
+			break;
+		}
+	}
+}
+
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2026 - agent
+ *
+ * This file is part of ReZound, an audio editing application.
+ *
+ * ReZound is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * ReZound is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+#ifndef __CBatchSoundFileManager_H__
+#define __CBatchSoundFileManager_H__
+
+#include "../../config/common.h"
+
+#include <vector>
+
+#include "../backend/ASoundFileManager.h"
+
+/*
+ * A sound file manager without any windows.  It keeps the loaded sounds in the 
+ * order they were opened, and the most recently opened (or created) one is the
+ * active one, just like a new sound window gets the focus in the frontend.
+ *
+ * Nothing can be undone in a batch, so the undo history is cleared after every
+ * action to give the disk space of the undo data back as a macro runs.
+ */
+class CBatchSoundFileManager : public ASoundFileManager
+{
+public:
+	CBatchSoundFileManager(ASoundPlayer *soundPlayer,CNestedDataFile *loadedRegistryFile);
+	virtual ~CBatchSoundFileManager();
+
+	CLoadedSound *getActive();
+	const size_t getOpenedCount() const;
+	CLoadedSound *getSound(size_t index);
+	void setActiveSound(size_t index);
+
+	void updateAfterEdit(CLoadedSound *sound=NULL,bool undoing=false);
+
+	const map<string,string> getPositionalInfo(CLoadedSound *sound=NULL);
+	void setPositionalInfo(const map<string,string> positionalInfo,CLoadedSound *sound=NULL);
+
+	// closes every loaded sound without saving
+	void closeAll();
+
+protected:
+	void createWindow(CLoadedSound *loaded);
+	void destroyWindow(CLoadedSound *loaded);
+
+private:
+	vector<CLoadedSound *> loadedSounds;
+	size_t activeIndex;
+};
+
+#endif
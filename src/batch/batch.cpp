@@ -0,0 +1,566 @@
+/*
+ * Copyright (C) 2026 - agent
+ *
+ * This file is part of ReZound, an audio editing application.
+ *
+ * ReZound is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * ReZound is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/*
+ * rezound_batch -- opens each of the given audio files, runs a macro from the macro
+ * store (as recorded in the frontend) on it and saves the result into an output
+ * directory; all without a frontend.  Run with --help for the options.
+ *
+ * The backend keeps its state in globals (the clipboards, the settings and the 
+ * registered actions) so each file is processed by a child process of its own.
+ * Up to --jobs of them run at once.  Each child gets a private directory for its 
+ * working and clipboard pool files so that children do not collide with each other
+ * (or with a running ReZound).  Nothing that the child does to the settings is saved.
+ */
+
+#include "../../config/common.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <istring>
+
+#include <CPath.h>
+DECLARE_STATIC_CPATH // to declare CPath::dirDelim
+
+#include <CNestedDataFile/CNestedDataFile.h>
+
+#include "../backend/AStatusComm.h"
+#include "../backend/AAction.h"
+#include "../backend/CLoadedSound.h"
+#include "../backend/CMacroPlayer.h"
+#include "../backend/CNativeSoundClipboard.h"
+#include "../backend/CNULLSoundPlayer.h"
+#include "../backend/settings.h"
+
+#include "CBatchFrontendHooks.h"
+#include "CBatchSoundFileManager.h"
+
+#include "../backend/CRunMacroAction.h"
+#include "../backend/File/FileActions.h"
+#include "../backend/Edits/EditActions.h"
+#include "../backend/Effects/EffectActions.h"
+#include "../backend/Filters/FilterActions.h"
+#include "../backend/Looping/LoopingActions.h"
+#include "../backend/Remaster/RemasterActions.h"
+#include "../backend/Generate/GenerateActions.h"
+#include "../backend/LADSPA/LADSPAActions.h"
+
+
+// --- headless status communication --------
+// messages go to stderr prefixed with the file being processed, and questions are answered with no
+
+class CBatchStatusComm : public AStatusComm
+{
+public:
+	string prefix;
+
+	void error(const string &message,VSeverity severity,bool reformatIfNeeded) { fprintf(stderr,"%serror: %s\n",prefix.c_str(),message.c_str()); }
+	void warning(const string &message,bool reformatIfNeeded) { fprintf(stderr,"%swarning: %s\n",prefix.c_str(),message.c_str()); }
+	void message(const string &message,bool reformatIfNeeded) { fprintf(stderr,"%s%s\n",prefix.c_str(),message.c_str()); }
+	VAnswer question(const string &message,int options,bool reformatIfNeeded)
+	{
+		const VAnswer answer= (options&cancelQues) ? cancelAns : noAns;
+		fprintf(stderr,"%squestion: %s\n%s-- answering %s\n",prefix.c_str(),message.c_str(),prefix.c_str(),answer==cancelAns ? "cancel" : "no");
+		return answer;
+	}
+
+	void beep() { }
+
+	int beginProgressBar(const string &title,bool showCancelButton) { return 0; }
+	bool updateProgressBar(int handle,int progress,const string timeElapsed,const string timeRemaining) { return false; }
+	void endProgressBar(int handle) { }
+	void endAllProgressBars() { }
+};
+
+static CBatchStatusComm *batchStatusComm=NULL;
+
+
+// --- actions -------------------------------
+
+static const string stripAmpersand(const string str)
+{
+	string stripped;
+	for(size_t t=0;t<str.length();t++)
+		if(str[t]!='&') stripped+=str[t];
+	return stripped;
+}
+
+static void registerActionFactory(AActionFactory *actionFactory)
+{
+	gRegisteredActionFactories[stripAmpersand(actionFactory->getName())]=actionFactory;
+}
+
+/*
+ * Registers the same actions under the same names as CMainWindow::buildActionMap() does so
+ * that any macro recorded in the frontend can be played.  There are no dialogs; the macro
+ * player always passes the parameters that were recorded with the macro.
+ */
+static void registerActionFactories()
+{
+	gRegisteredActionFactories.clear();
+
+	// File
+	registerActionFactory(new CNewAudioFileActionFactory(NULL));
+	registerActionFactory(new COpenAudioFileActionFactory(NULL));
+	registerActionFactory(new CSaveAudioFileActionFactory);
+	registerActionFactory(new CSaveAsAudioFileActionFactory(NULL));
+	registerActionFactory(new CSaveSelectionAsActionFactory());
+	registerActionFactory(new CSaveAsMultipleFilesActionFactory(NULL));
+	registerActionFactory(new CBurnToCDActionFactory(NULL));
+	registerActionFactory(new CRunMacroActionFactory(NULL));
+
+	// Edit
+	registerActionFactory(new CCopyEditFactory(NULL));
+	registerActionFactory(new CCopyToNewEditFactory(NULL));
+	registerActionFactory(new CCutEditFactory(NULL));
+	registerActionFactory(new CCutToNewEditFactory(NULL));
+	registerActionFactory(new CDeleteEditFactory(NULL));
+	registerActionFactory(new CCropEditFactory(NULL));
+	registerActionFactory(new CInsertPasteEditFactory(NULL));
+	registerActionFactory(new CReplacePasteEditFactory(NULL));
+	registerActionFactory(new COverwritePasteEditFactory(NULL));
+	registerActionFactory(new CLimitedOverwritePasteEditFactory(NULL));
+	registerActionFactory(new CMixPasteEditFactory(NULL));
+	registerActionFactory(new CLimitedMixPasteEditFactory(NULL));
+	registerActionFactory(new CFitMixPasteEditFactory(NULL));
+	registerActionFactory(new CPasteAsNewEditFactory);
+	registerActionFactory(new CInsertSilenceEditFactory(NULL,NULL));
+	registerActionFactory(new CMuteEditFactory(NULL));
+	registerActionFactory(new CAddChannelsEditFactory(NULL));
+	registerActionFactory(new CDuplicateChannelEditFactory(NULL));
+	registerActionFactory(new CRemoveChannelsEditFactory(NULL));
+	registerActionFactory(new CSwapChannelsEditFactory(NULL));
+	registerActionFactory(new CRotateLeftEditFactory(NULL,NULL));
+	registerActionFactory(new CRotateRightEditFactory(NULL,NULL));
+	registerActionFactory(new CSelectionEditFactory(sSelectAll));
+	registerActionFactory(new CGrowOrSlideSelectionEditFactory(NULL));
+	registerActionFactory(new CSelectionEditFactory(sSelectToBeginning));
+	registerActionFactory(new CSelectionEditFactory(sSelectToEnd));
+	registerActionFactory(new CSelectionEditFactory(sFlopToBeginning));
+	registerActionFactory(new CSelectionEditFactory(sFlopToEnd));
+	registerActionFactory(new CSelectionEditFactory(sSelectToSelectStart));
+	registerActionFactory(new CSelectionEditFactory(sSelectToSelectStop));
+
+	// Effects
+	registerActionFactory(new CReverseEffectFactory(NULL));
+	registerActionFactory(new CChangeVolumeEffectFactory(NULL,NULL));
+	registerActionFactory(new CSimpleGainEffectFactory(NULL,NULL));
+	registerActionFactory(new CCurvedGainEffectFactory(NULL,NULL));
+	registerActionFactory(new CSimpleChangeRateEffectFactory(NULL,NULL));
+	registerActionFactory(new CCurvedChangeRateEffectFactory(NULL,NULL));
+	registerActionFactory(new CFlangeEffectFactory(NULL,NULL));
+	registerActionFactory(new CSimpleDelayEffectFactory(NULL,NULL));
+	registerActionFactory(new CQuantizeEffectFactory(NULL,NULL));
+	registerActionFactory(new CDistortionEffectFactory(NULL,NULL));
+	registerActionFactory(new CVariedRepeatEffectFactory(NULL,NULL));
+	registerActionFactory(new CTestEffectFactory(NULL));
+
+	// Filter
+	registerActionFactory(new CConvolutionFilterFactory(NULL,NULL));
+	registerActionFactory(new CArbitraryFIRFilterFactory(NULL,NULL));
+	registerActionFactory(new CMorphingArbitraryFIRFilterFactory(NULL,NULL));
+	registerActionFactory(new CSinglePoleLowpassFilterFactory(NULL,NULL));
+	registerActionFactory(new CSinglePoleHighpassFilterFactory(NULL,NULL));
+	registerActionFactory(new CBandpassFilterFactory(NULL,NULL));
+	registerActionFactory(new CNotchFilterFactory(NULL,NULL));
+	registerActionFactory(new CBiquadResLowpassFilterFactory(NULL,NULL));
+	registerActionFactory(new CBiquadResHighpassFilterFactory(NULL,NULL));
+	registerActionFactory(new CBiquadResBandpassFilterFactory(NULL,NULL));
+
+	// Looping
+	registerActionFactory(new CMakeSymetricActionFactory(NULL));
+	registerActionFactory(new CAddNCuesActionFactory(NULL));
+	registerActionFactory(new CAddTimedCuesActionFactory(NULL));
+
+	// Remaster
+	registerActionFactory(new CSimpleBalanceActionFactory(NULL,NULL));
+	registerActionFactory(new CCurvedBalanceActionFactory(NULL,NULL));
+	registerActionFactory(new CMonoizeActionFactory(NULL,NULL));
+	registerActionFactory(new CNoiseGateActionFactory(NULL,NULL));
+	registerActionFactory(new CCompressorActionFactory(NULL,NULL));
+	registerActionFactory(new CNormalizeActionFactory(NULL,NULL));
+	registerActionFactory(new CAdaptiveNormalizeActionFactory(NULL,NULL));
+	registerActionFactory(new CMarkQuietAreasActionFactory(NULL));
+	registerActionFactory(new CShortenQuietAreasActionFactory(NULL));
+	registerActionFactory(new CResampleActionFactory(NULL,NULL));
+	registerActionFactory(new CChangePitchActionFactory(NULL,NULL));
+	registerActionFactory(new CChangeTempoActionFactory(NULL,NULL));
+	registerActionFactory(new CRemoveDCActionFactory(NULL));
+	registerActionFactory(new CInvertPhaseActionFactory(NULL));
+	registerActionFactory(new CUnclipActionFactory(NULL));
+
+	// Generate
+	registerActionFactory(new CGenerateNoiseActionFactory(NULL,NULL));
+	registerActionFactory(new CGenerateToneActionFactory(NULL,NULL));
+
+#ifdef ENABLE_LADSPA
+	// registered by the unstripped name, as CMainWindow::buildLADSPAMenus() does
+	const vector<CLADSPAActionFactory *> LADSPAActionFactories=getLADSPAActionFactories();
+	for(size_t t=0;t<LADSPAActionFactories.size();t++)
+		gRegisteredActionFactories[LADSPAActionFactories[t]->getName()]=LADSPAActionFactories[t];
+#endif
+}
+
+
+// --- processing one file -------------------
+
+static void createClipboards(const string dir)
+{
+	// only the native clipboards; the record clipboards would need an audio I/O method to record with
+	for(unsigned t=1;t<=3;t++)
+	{
+		const string filename=dir+CPath::dirDelim+gClipboardFilenamePrefix+".clipboard"+istring(t);
+		AAction::clipboards.push_back(new CNativeSoundClipboard(_("Native Clipboard ")+istring(t),filename));
+	}
+
+	if(gWhichClipboard>=AAction::clipboards.size())
+		gWhichClipboard=0; 
+}
+
+static void destroyClipboards()
+{
+	while(!AAction::clipboards.empty())
+	{
+		delete AAction::clipboards.back();
+		AAction::clipboards.pop_back();
+	}
+}
+
+/*
+ * This runs in the child process.  Returns true if inputFilename was opened, the
+ * macro succeeded and the result was saved as outputFilename.
+ */
+static bool processFile(const string inputFilename,const string outputFilename,const CNestedDataFile *macroStore,const string macroName,ASoundPlayer *soundPlayer,const string workDir)
+{
+	const string privateDir=workDir+CPath::dirDelim+"rezound_batch."+istring(getpid());
+	if(mkdir(privateDir.c_str(),0700)!=0)
+	{
+		Error(string(__func__)+" -- error creating "+privateDir+" -- "+strerror(errno));
+		return false;
+	}
+	gPrimaryWorkDir=privateDir;
+	gClipboardDir=privateDir;
+
+	bool ret=false;
+	CNestedDataFile loadedRegistry("",false); // not the one in the registry so a running frontend's list of loaded files is left alone
+	CBatchSoundFileManager fileManager(soundPlayer,&loadedRegistry);
+	try
+	{
+		createClipboards(privateDir);
+
+		if(!fileManager.open(inputFilename))
+			throw runtime_error(string(__func__)+" -- opening was cancelled");
+		CLoadedSound *loaded=fileManager.getActive();
+
+		CMacroPlayer macroPlayer(macroStore,macroName);
+		if(macroPlayer.doMacro(&fileManager))
+		{
+			// the macro may have created other sounds (i.e. with 'Copy to New'), but it's the opened one that is saved
+			for(size_t t=0;t<fileManager.getOpenedCount();t++)
+			{
+				if(fileManager.getSound(t)==loaded)
+					fileManager.setActiveSound(t);
+			}
+			if(fileManager.getActive()!=loaded)
+				throw runtime_error(string(__func__)+" -- the sound was closed by the macro");
+
+			// save beside the output with a hidden name (the extension must stay the same to choose the format) so that a failure leaves no partial output
+			const string partialFilename=CPath(outputFilename).dirName()+CPath::dirDelim+".rezound_batch."+istring(getpid())+"."+CPath(outputFilename).baseName();
+			try
+			{
+				if(fileManager.saveAs(partialFilename))
+				{
+					if(rename(partialFilename.c_str(),outputFilename.c_str())!=0)
+						throw runtime_error(string(__func__)+" -- error renaming "+partialFilename+" to "+outputFilename+" -- "+strerror(errno));
+					ret=true;
+				}
+			}
+			catch(...)
+			{
+				remove(partialFilename.c_str());
+				throw;
+			}
+			if(!ret)
+				remove(partialFilename.c_str());
+		}
+	}
+	catch(exception &e)
+	{
+		Error(e.what());
+		ret=false;
+	}
+
+	try
+	{
+		fileManager.closeAll();
+		destroyClipboards();
+	}
+	catch(exception &e)
+	{
+		Error(e.what());
+	}
+
+	if(rmdir(privateDir.c_str())!=0)
+		Warning(string(__func__)+" -- error removing "+privateDir+" -- "+strerror(errno));
+
+	return ret;
+}
+
+
+// --- main ----------------------------------
+
+static void printUsage(const string app)
+{
+	printf("Usage: %s --macro=<name> --output-dir=<dir> [option]... filename... [-- [filename]...]\n",app.c_str());
+	printf("Runs a recorded macro on each of the files and saves the results into the output directory.\n");
+	printf("Options:\n");
+	printf("\t--macro=<name>         the macro to run on each file\n");
+	printf("\t--macro-store=<file>   where the macro was recorded (default: ~/.rezound/macros.dat)\n");
+	printf("\t--list-macros          list the macros in the macro store and exit\n");
+	printf("\t--output-dir=<dir>     where to save the results (under the same base names)\n");
+	printf("\t--format=<extension>   save the results in this format instead of the format of each input file\n");
+	printf("\t--overwrite            replace existing files in the output directory\n");
+	printf("\t--jobs=<n>             the number of files to process at once (default: the number of processors)\n");
+	printf("\t--work-dir=<dir>       where to create the temporary files (default: the working directory setting or /tmp)\n");
+	printf("\t--help                 show this help message and exit\n");
+	printf("\n");
+	printf("Notes:\n");
+	printf("\t- Anything after a '--' flag will be assumed as a filename to process\n");
+	printf("\t- Questions that the macro would ask are answered with 'no'\n");
+	printf("\t- Sounds that the macro creates (i.e. with 'Copy to New') are discarded\n");
+	printf("\t- The exit status is 1 if any file failed\n");
+}
+
+int main(int argc,char *argv[])
+{
+	string macroName="";
+	string macroStoreFilename="";
+	bool listMacros=false;
+	string outputDir="";
+	string format="";
+	bool overwrite=false;
+	long jobCount=sysconf(_SC_NPROCESSORS_ONLN);
+	string workDir="";
+	vector<string> inputFilenames;
+
+	bool forceFilenames=false;
+	for(int t=1;t<argc;t++)
+	{
+		if(forceFilenames || argv[t][0]!='-')
+			inputFilenames.push_back(argv[t]);
+		else if(strcmp(argv[t],"--")==0)
+			forceFilenames=true;
+		else if(strncmp(argv[t],"--macro=",8)==0)
+			macroName=argv[t]+8;
+		else if(strncmp(argv[t],"--macro-store=",14)==0)
+			macroStoreFilename=argv[t]+14;
+		else if(strcmp(argv[t],"--list-macros")==0)
+			listMacros=true;
+		else if(strncmp(argv[t],"--output-dir=",13)==0)
+			outputDir=argv[t]+13;
+		else if(strncmp(argv[t],"--format=",9)==0)
+			format=argv[t]+9;
+		else if(strcmp(argv[t],"--overwrite")==0)
+			overwrite=true;
+		else if(strncmp(argv[t],"--jobs=",7)==0)
+			jobCount=atol(argv[t]+7);
+		else if(strncmp(argv[t],"--work-dir=",11)==0)
+			workDir=argv[t]+11;
+		else if(strcmp(argv[t],"--help")==0)
+		{
+			printUsage(argv[0]);
+			return 0;
+		}
+		else
+		{
+			fprintf(stderr,"unknown argument: %s\n",argv[t]);
+			printUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	if(!listMacros && (macroName=="" || outputDir=="" || inputFilenames.empty()))
+	{
+		printUsage(argv[0]);
+		return 1;
+	}
+	if(jobCount<1)
+		jobCount=1;
+
+	try
+	{
+		gStatusComm=batchStatusComm=new CBatchStatusComm;
+		gFrontendHooks=new CBatchFrontendHooks;
+
+		readBackendSettings();
+
+		if(macroStoreFilename=="")
+			macroStoreFilename=gUserDataDirectory+istring(CPath::dirDelim)+"macros.dat";
+		if(!CPath(macroStoreFilename).exists())
+			throw runtime_error(string(__func__)+" -- macro store not found: "+macroStoreFilename);
+		CNestedDataFile *macroStore=new CNestedDataFile(macroStoreFilename,false);
+		gUserMacroStore=macroStore; // for 'Run Macro' actions within the macro
+
+		const vector<string> macroNames=CMacroPlayer::getMacroNames(macroStore);
+		if(listMacros)
+		{
+			for(size_t t=0;t<macroNames.size();t++)
+				printf("%s\n",macroNames[t].c_str());
+			return 0;
+		}
+		bool found=false;
+		for(size_t t=0;t<macroNames.size();t++)
+			found|= macroNames[t]==macroName;
+		if(!found)
+			throw runtime_error(string(__func__)+" -- macro not found in "+macroStoreFilename+": "+macroName);
+
+		if(!CPath(outputDir).isDirectory())
+			throw runtime_error(string(__func__)+" -- output directory not found: "+outputDir);
+		outputDir=CPath(outputDir).realPath();
+
+		if(workDir=="")
+			workDir= (gPrimaryWorkDir!="" && CPath(gPrimaryWorkDir).isDirectory()) ? gPrimaryWorkDir : gFallbackWorkDir;
+		if(!CPath(workDir).isDirectory())
+			throw runtime_error(string(__func__)+" -- working directory not found: "+workDir);
+		workDir=CPath(workDir).realPath();
+
+		registerActionFactories();
+
+		// the audio is never played, but every loaded sound needs a sound player channel
+		ASoundPlayer *soundPlayer=new CNULLSoundPlayer;
+
+		// decide each output filename now so that the problems can be reported before anything starts
+		vector<string> outputFilenames;
+		vector<bool> failed;
+		map<string,size_t> outputsSeen;
+		for(size_t t=0;t<inputFilenames.size();t++)
+		{
+			string baseName=CPath(inputFilenames[t]).baseName();
+			if(format!="")
+			{
+				const string extension=CPath(inputFilenames[t]).extension();
+				if(extension!="")
+					baseName=baseName.substr(0,baseName.length()-extension.length()-1);
+				baseName+="."+format;
+			}
+			const string outputFilename=outputDir+CPath::dirDelim+baseName;
+			outputFilenames.push_back(outputFilename);
+			failed.push_back(true);
+
+			if(!CPath(inputFilenames[t]).exists())
+				fprintf(stderr,"%s: error: file does not exist\n",inputFilenames[t].c_str());
+			else if(CPath(inputFilenames[t]).realPath()==outputFilename)
+				fprintf(stderr,"%s: error: the output would overwrite the input\n",inputFilenames[t].c_str());
+			else if(outputsSeen.find(outputFilename)!=outputsSeen.end())
+				fprintf(stderr,"%s: error: has the same output filename as %s: %s\n",inputFilenames[t].c_str(),inputFilenames[outputsSeen[outputFilename]].c_str(),outputFilename.c_str());
+			else if(!overwrite && CPath(outputFilename).exists())
+				fprintf(stderr,"%s: error: output file exists (use --overwrite to replace it): %s\n",inputFilenames[t].c_str(),outputFilename.c_str());
+			else
+				failed[t]=false; // can go
+			outputsSeen[outputFilename]=t;
+		}
+
+		// run a child process per file with at most jobCount at a time
+		map<pid_t,size_t> running;
+		size_t next=0;
+		while(next<inputFilenames.size() || !running.empty())
+		{
+			while(next<inputFilenames.size() && running.size()<(size_t)jobCount)
+			{
+				const size_t index=next++;
+				if(failed[index])
+					continue;
+
+				fflush(stdout);
+				fflush(stderr);
+				const pid_t pid=fork();
+				if(pid==0)
+				{ // child
+					batchStatusComm->prefix=inputFilenames[index]+": ";
+					const bool ok=processFile(inputFilenames[index],outputFilenames[index],macroStore,macroName,soundPlayer,workDir);
+					fflush(stdout);
+					fflush(stderr);
+					_exit(ok ? 0 : 1);
+				}
+				else if(pid<0)
+				{
+					fprintf(stderr,"%s: error: cannot start a process -- %s\n",inputFilenames[index].c_str(),strerror(errno));
+					failed[index]=true;
+					break; // wait for one to finish
+				}
+
+				running[pid]=index;
+			}
+
+			if(running.empty())
+				continue;
+
+			int status;
+			const pid_t pid=waitpid(-1,&status,0);
+			if(pid<0)
+			{
+				if(errno==EINTR)
+					continue;
+				throw runtime_error(string(__func__)+" -- error waiting on the child processes -- "+strerror(errno));
+			}
+
+			map<pid_t,size_t>::iterator i=running.find(pid);
+			if(i==running.end())
+				continue;
+			const size_t index=i->second;
+			running.erase(i);
+
+			if(WIFEXITED(status) && WEXITSTATUS(status)==0)
+				printf("%s -> %s\n",inputFilenames[index].c_str(),outputFilenames[index].c_str());
+			else
+			{
+				failed[index]=true;
+				if(WIFSIGNALED(status))
+					fprintf(stderr,"%s: error: killed by signal %d\n",inputFilenames[index].c_str(),WTERMSIG(status));
+				fprintf(stderr,"%s: FAILED\n",inputFilenames[index].c_str());
+			}
+		}
+
+		unsigned failedCount=0;
+		for(size_t t=0;t<failed.size();t++)
+			failedCount+= failed[t] ? 1 : 0;
+		printf("%u of %u file(s) processed\n",(unsigned)(failed.size()-failedCount),(unsigned)failed.size());
+
+		return failedCount>0 ? 1 : 0;
+	}
+	catch(exception &e)
+	{
+		fprintf(stderr,"exception -- %s\n",e.what());
+		return 1;
+	}
+}
+
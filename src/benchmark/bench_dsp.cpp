@@ -0,0 +1,316 @@
+/*
+ * Copyright (C) 2026 - agent
+ *
+ * This file is part of ReZound, an audio editing application.
+ *
+ * ReZound is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * ReZound is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+#include "benchmark.h"
+
+#include <math.h>
+
+#include <memory>
+#include <vector>
+
+#include <istring>
+
+#include "CSound_defs.h"
+#include "ALFO.h"
+#include "sample_conversion.h"
+
+#include "DSP/BiquadResFilters.h"
+#include "DSP/Compressor.h"
+#include "DSP/Convolver.h"
+#include "DSP/Delay.h"
+#include "DSP/DelayEffect.h"
+#include "DSP/FlangeEffect.h"
+#include "DSP/LevelDetector.h"
+#include "DSP/NoiseGate.h"
+#include "DSP/Quantizer.h"
+#include "DSP/SincResampler.h"
+#include "DSP/SinglePoleFilters.h"
+
+/*
+ * DSP measurements: samples per second through each of the classes in backend/DSP the way the 
+ * actions use them (one sample at a time unless the class has a block interface).
+ */
+
+static const string SUITE="dsp";
+
+static const unsigned SAMPLE_RATE=44100;
+
+// runs every sample of input through processSample and records the throughput
+template<class dsp_t,class process_t> static void runPerSample(CBenchmark &b,const string name,const string params,const std::vector<mix_sample_t> &input,const std::function<dsp_t *()> &create,const process_t &process)
+{
+	if(!b.wants(SUITE,name))
+		return;
+
+	std::unique_ptr<dsp_t> dsp;
+	std::vector<mix_sample_t> output(input.size());
+	b.run(SUITE,name,params,input.size(),"samples",[&]() {
+		dsp.reset(create()); // a fresh one each time so the state is the same
+		const size_t count=input.size();
+		for(size_t t=0;t<count;t++)
+			output[t]=process(*dsp,input[t]);
+		benchmarkUse(output[count-1]);
+	});
+}
+
+void runDSPBenchmarks(CBenchmark &b)
+{
+	if(!b.wants(SUITE,""))
+		return;
+
+	// a sweep with some noise on it so nothing can be trivially predicted
+	const size_t count=(size_t)(4*1024*1024*b.getScale());
+	std::vector<mix_sample_t> input(count);
+	uint32_t r=1;
+	for(size_t t=0;t<count;t++)
+	{
+		r=r*1664525+1013904223;
+		input[t]=(mix_sample_t)((sin(t*(0.001+t*1e-9))*0.7+((double)(r>>8)/(1<<24)-0.5)*0.1)*MAX_SAMPLE);
+	}
+
+	const float cutoff=1000.0f/SAMPLE_RATE;
+	const float bandwidth=200.0f/SAMPLE_RATE;
+
+	runPerSample<TDSPSinglePoleLowpassFilter<mix_sample_t>>(b,"single pole lowpass","",input,
+		[&]() { return new TDSPSinglePoleLowpassFilter<mix_sample_t>(cutoff); },
+		[](TDSPSinglePoleLowpassFilter<mix_sample_t> &f,const mix_sample_t s) { return f.processSample(s); });
+
+	runPerSample<TDSPSinglePoleHighpassFilter<mix_sample_t>>(b,"single pole highpass","",input,
+		[&]() { return new TDSPSinglePoleHighpassFilter<mix_sample_t>(cutoff); },
+		[](TDSPSinglePoleHighpassFilter<mix_sample_t> &f,const mix_sample_t s) { return f.processSample(s); });
+
+	runPerSample<TDSPBandpassFilter<mix_sample_t>>(b,"bandpass","",input,
+		[&]() { return new TDSPBandpassFilter<mix_sample_t>(cutoff,bandwidth); },
+		[](TDSPBandpassFilter<mix_sample_t> &f,const mix_sample_t s) { return f.processSample(s); });
+
+	runPerSample<TDSPNotchFilter<mix_sample_t>>(b,"notch","",input,
+		[&]() { return new TDSPNotchFilter<mix_sample_t>(cutoff,bandwidth); },
+		[](TDSPNotchFilter<mix_sample_t> &f,const mix_sample_t s) { return f.processSample(s); });
+
+	runPerSample<TDSPBiquadResLowpassFilter<mix_sample_t>>(b,"biquad resonant lowpass","",input,
+		[&]() { return new TDSPBiquadResLowpassFilter<mix_sample_t>(cutoff,0.7f); },
+		[](TDSPBiquadResLowpassFilter<mix_sample_t> &f,const mix_sample_t s) { return f.processSample(s); });
+
+	for(unsigned delayTime : {100u,SAMPLE_RATE})
+	{
+		runPerSample<TDSPDelay<mix_sample_t>>(b,"delay line","delay="+istring(delayTime),input,
+			[&]() { return new TDSPDelay<mix_sample_t>(delayTime); },
+			[](TDSPDelay<mix_sample_t> &d,const mix_sample_t s) { return d.processSample(s); });
+
+		const string name="delay line (block)";
+		if(b.wants(SUITE,name))
+		{
+			std::vector<mix_sample_t> output(input.size());
+			b.run(SUITE,name,"delay="+istring(delayTime),input.size(),"samples",[&]() {
+				TDSPDelay<mix_sample_t> d(delayTime);
+				d.processSamples(input.data(),output.data(),input.size());
+				benchmarkUse(output.back());
+			});
+		}
+
+		// a modulated read like the flange does
+		runPerSample<TDSPDelay<mix_sample_t>>(b,"delay line (fractional read)","delay="+istring(delayTime),input,
+			[&]() { return new TDSPDelay<mix_sample_t>(delayTime); },
+			[&](TDSPDelay<mix_sample_t> &d,const mix_sample_t s) { const mix_sample_t o=d.getSample(delayTime*0.37f); d.putSample(s); return o; });
+
+		runPerSample<TDSPDelay<mix_sample_t>>(b,"delay line (hermite read)","delay="+istring(delayTime),input,
+			[&]() { return new TDSPDelay<mix_sample_t>(delayTime); },
+			[&](TDSPDelay<mix_sample_t> &d,const mix_sample_t s) { const mix_sample_t o=d.getSampleHermite(delayTime*0.37f); d.putSample(s); return o; });
+	}
+
+	{
+		float tapTimes[]={SAMPLE_RATE*0.25f,SAMPLE_RATE*0.5f,SAMPLE_RATE*0.75f};
+		float tapGains[]={0.6f,0.4f,0.2f};
+		float tapFeedbacks[]={0.2f,0.1f,0.0f};
+		runPerSample<CDSPDelayEffect>(b,"delay effect","taps=3",input,
+			[&]() { return new CDSPDelayEffect(3,tapTimes,tapGains,tapFeedbacks); },
+			[](CDSPDelayEffect &d,const mix_sample_t s) { return d.processSample(s); });
+	}
+
+	{
+		std::unique_ptr<ALFO> LFO;
+		runPerSample<CDSPFlangeEffect>(b,"flange","",input,
+			[&]() { LFO.reset(gLFORegistry.createLFO(CLFODescription(1.0f,0.5f,0.0f,0),SAMPLE_RATE)); return new CDSPFlangeEffect(SAMPLE_RATE/500,0.7f,0.7f,LFO.get(),SAMPLE_RATE/500,0.3f); },
+			[](CDSPFlangeEffect &f,const mix_sample_t s) { return f.processSample(s); });
+	}
+
+	for(unsigned windowTime : {64u,SAMPLE_RATE/10})
+	{
+		runPerSample<CDSPRMSLevelDetector>(b,"RMS level detector","window="+istring(windowTime),input,
+			[&]() { return new CDSPRMSLevelDetector(windowTime); },
+			[](CDSPRMSLevelDetector &d,const mix_sample_t s) { return d.readLevel(s); });
+
+		{ // the way the meters use it
+			const string name="RMS level detector (max power)";
+			if(b.wants(SUITE,name))
+			{
+				b.run(SUITE,name,"window="+istring(windowTime),input.size(),"samples",[&]() {
+					CDSPRMSLevelDetector d(windowTime);
+					benchmarkUse(sqrt(d.readMaxPower(input.data(),input.size())));
+				});
+			}
+		}
+
+		runPerSample<CDSPPeakLevelDetector>(b,"peak level detector","window="+istring(windowTime),input,
+			[&]() { return new CDSPPeakLevelDetector(windowTime); },
+			[](CDSPPeakLevelDetector &d,const mix_sample_t s) { return (mix_sample_t)d.readLevel((sample_t)s); });
+
+		const string name="peak level detector (block)";
+		if(b.wants(SUITE,name))
+		{
+			std::vector<sample_t> samples(input.begin(),input.end()),levels(input.size());
+			b.run(SUITE,name,"window="+istring(windowTime),input.size(),"samples",[&]() {
+				CDSPPeakLevelDetector d(windowTime);
+				d.readLevels(samples.data(),levels.data(),samples.size());
+				benchmarkUse(levels.back());
+			});
+		}
+	}
+
+	runPerSample<CDSPCompressor>(b,"compressor","",input,
+		[&]() { return new CDSPCompressor(SAMPLE_RATE/100,(sample_t)(MAX_SAMPLE/4),4.0f,SAMPLE_RATE/100,SAMPLE_RATE/10); },
+		[](CDSPCompressor &c,const mix_sample_t s) { return c.processSample(s,s); });
+
+	{
+		const string name="compressor (block)";
+		if(b.wants(SUITE,name))
+		{
+			std::vector<mix_sample_t> output(input.size());
+			b.run(SUITE,name,"control interval=32",input.size(),"samples",[&]() {
+				CDSPCompressor c(SAMPLE_RATE/100,(sample_t)(MAX_SAMPLE/4),4.0f,SAMPLE_RATE/100,SAMPLE_RATE/10,0,32);
+				c.processSamples(input.data(),input.data(),output.data(),input.size());
+				benchmarkUse(output.back());
+			});
+		}
+	}
+
+	runPerSample<CDSPNoiseGate>(b,"noise gate","",input,
+		[&]() { return new CDSPNoiseGate(SAMPLE_RATE/100,(sample_t)(MAX_SAMPLE/20),SAMPLE_RATE/100,SAMPLE_RATE/10); },
+		[](CDSPNoiseGate &g,const mix_sample_t s) { return g.processSample(s); });
+
+	runPerSample<TDSPQuantizer<mix_sample_t,(int)MAX_SAMPLE>>(b,"quantizer","quanta=16",input,
+		[&]() { return new TDSPQuantizer<mix_sample_t,(int)MAX_SAMPLE>(16); },
+		[](TDSPQuantizer<mix_sample_t,(int)MAX_SAMPLE> &q,const mix_sample_t s) { return q.processSample(s); });
+
+	// the resampler and the convolver work on blocks
+	for(int quality=CDSPSincResampler::qLow;quality<=CDSPSincResampler::qBest;quality++)
+	{
+		const string name="sinc resampler";
+		if(!b.wants(SUITE,name))
+			break;
+
+		std::vector<float> in(input.begin(),input.end());
+		std::vector<float> out(4096);
+		b.run(SUITE,name,"44100->48000 quality="+istring(quality),count,"samples",[&]() {
+			CDSPSincResampler resampler(44100.0/48000.0,(CDSPSincResampler::Qualities)quality);
+			for(size_t t=0;t<count;t+=4096)
+			{
+				resampler.putSamples(&in[t],std::min<size_t>(4096,count-t));
+				while(resampler.getSamples(out.data(),out.size())>0);
+			}
+			benchmarkUse(out[0]);
+		});
+	}
+
+#ifdef HAVE_FFTW
+	for(size_t kernelSize : {64,1024,16384})
+	{
+		const string name="FFT convolver";
+		if(!b.wants(SUITE,name))
+			break;
+
+		std::vector<float> kernel(kernelSize);
+		for(size_t t=0;t<kernelSize;t++)
+			kernel[t]=expf(-(float)t/(kernelSize/4))/kernelSize;
+
+		std::vector<fftw_real> out(count);
+		b.run(SUITE,name,"kernel="+istring(kernelSize),count,"samples",[&]() {
+			TFFTConvolverTimeDomainKernel<mix_sample_t,float> convolver(kernel.data(),kernelSize);
+			const size_t chunkSize=convolver.getChunkSize();
+			for(size_t t=0;t<count;t+=chunkSize)
+			{
+				const size_t n=std::min(chunkSize,count-t);
+				convolver.beginWrite();
+				convolver.writeSamples(input.data()+t,n);
+				convolver.beginRead();
+				convolver.readSamples(out.data()+t,n);
+			}
+			benchmarkUse(out[count-1]);
+		});
+	}
+#endif
+
+	// the format conversions done at the audio I/O and by the sound translators
+	{
+		const string kernels=string("kernels=")+getSampleConversionKernelName();
+		std::vector<float> f(count);
+		for(size_t t=0;t<count;t++)
+			f[t]=(float)input[t]/MAX_SAMPLE;
+		std::vector<int16_t> i16(count);
+		std::vector<int32_t> i32(count);
+		std::vector<float> out(count);
+
+		if(b.wants(SUITE,"convert_sample float->int16"))
+			b.run(SUITE,"convert_sample float->int16","",count,"samples",[&]() {
+				for(size_t t=0;t<count;t++)
+					i16[t]=convert_sample<float,int16_t>(f[t]);
+				benchmarkUse(i16[count-1]);
+			});
+		if(b.wants(SUITE,"convert float->int16"))
+			b.run(SUITE,"convert float->int16",kernels,count,"samples",[&]() {
+				convertSamples(f.data(),i16.data(),count);
+				benchmarkUse(i16[count-1]);
+			});
+		for(int type=RSampleDither::dtTriangular;type<=RSampleDither::dtShaped && b.wants(SUITE,"convert float->int16 dithered");type++)
+			b.run(SUITE,"convert float->int16 dithered",kernels+(type==RSampleDither::dtShaped ? " shaped" : " triangular"),count,"samples",[&]() {
+				RSampleDither dither((RSampleDither::DitherTypes)type,2);
+				convertSamples(f.data(),i16.data(),count,&dither);
+				benchmarkUse(i16[count-1]);
+			});
+		if(b.wants(SUITE,"convert int16->float"))
+			b.run(SUITE,"convert int16->float",kernels,count,"samples",[&]() {
+				convertSamples(i16.data(),out.data(),count);
+				benchmarkUse(out[count-1]);
+			});
+		if(b.wants(SUITE,"convert float->int32"))
+			b.run(SUITE,"convert float->int32",kernels,count,"samples",[&]() {
+				convertSamples(f.data(),i32.data(),count);
+				benchmarkUse(i32[count-1]);
+			});
+		if(b.wants(SUITE,"convert int32->float"))
+			b.run(SUITE,"convert int32->float",kernels,count,"samples",[&]() {
+				convertSamples(i32.data(),out.data(),count);
+				benchmarkUse(out[count-1]);
+			});
+
+		// what the JACK player does with each period
+		float *channels[2]={out.data(),out.data()+count/2};
+		if(b.wants(SUITE,"deinterleave"))
+			b.run(SUITE,"deinterleave",kernels+" channels=2",count,"samples",[&]() {
+				deinterleaveSamples(f.data(),2,channels,count/2);
+				benchmarkUse(out[count-1]);
+			});
+		// what the sound translators do when saving 16 bit files
+		if(b.wants(SUITE,"interleave float->int16"))
+			b.run(SUITE,"interleave float->int16",kernels+" channels=2",count,"samples",[&]() {
+				interleaveSamples(channels,2,i16.data(),count/2);
+				benchmarkUse(i16[count-1]);
+			});
+	}
+}
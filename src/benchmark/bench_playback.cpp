@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2026 - agent
+ *
+ * This file is part of ReZound, an audio editing application.
+ *
+ * ReZound is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * ReZound is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+#include "benchmark.h"
+
+#include <math.h>
+
+#include <memory>
+#include <vector>
+
+#include <istring>
+
+#include "CSound.h"
+#include "CSoundPlayerChannel.h"
+#include "CNULLSoundPlayer.h"
+
+/*
+ * Playback measurements: a sound is played from start to end through CNULLSoundPlayer's offline
+ * driver, so this covers the prebuffering thread as well as the mixing.  The paced measurements
+ * run at a multiple of real time and should come out at about that rate; the deadline misses and 
+ * underruns which explain it when they don't are printed along with the histogram of mix times.
+ * At --scale=1 the sound is 2 channels of 10 seconds.
+ */
+
+static const string SUITE="playback";
+
+static void fillSound(CSound &sound)
+{
+	CSoundLocker sl(&sound,false);
+	std::vector<sample_t> buffer(65536);
+	for(unsigned i=0;i<sound.getChannelCount();i++)
+	{
+		CRezPoolAccesser a=sound.getAudio(i);
+		a.seek(0);
+		sample_pos_t pos=0;
+		while(pos<sound.getLength())
+		{
+			const sample_pos_t n=std::min<sample_pos_t>(buffer.size(),sound.getLength()-pos);
+			for(sample_pos_t t=0;t<n;t++)
+				buffer[t]=convert_sample<float,sample_t>(sinf((pos+t)*(i+1)*0.001f)*0.5f);
+			a.write(buffer.data(),n);
+			pos+=n;
+		}
+	}
+}
+
+static void runPlayback(CBenchmark &b,CSound &sound,const size_t periodSize,const double speed,const float seekSpeed)
+{
+	const string name= speed>0.0 ? "paced x"+istring(speed) : "unpaced";
+	if(!b.wants(SUITE,name))
+		return;
+
+	CNULLSoundPlayer::ROfflineParams params;
+	params.sampleRate=sound.getSampleRate();
+	params.channelCount=sound.getChannelCount();
+	params.periodSize=periodSize;
+	params.speed=speed;
+	params.threaded=false;
+
+	CNULLSoundPlayer player(params);
+	player.initialize();
+
+	std::unique_ptr<CSoundPlayerChannel> channel(player.newSoundPlayerChannel(&sound));
+	channel->setSeekSpeed(seekSpeed);
+
+	const string p="period="+istring(periodSize)+" rate="+istring(params.sampleRate)+" seek="+istring(seekSpeed);
+	b.run(SUITE,name,p,sound.getLength(),"frames",[&]() {
+		player.resetStats();
+		channel->play(0);
+		player.renderPeriods(~(size_t)0,[&]() { return channel->isPlaying(); });
+	});
+
+	player.printStats(stderr);
+
+	channel.reset();
+	player.deinitialize();
+}
+
+void runPlaybackBenchmarks(CBenchmark &b)
+{
+	if(!b.wants(SUITE,""))
+		return;
+
+	const unsigned channelCount=2;
+	const unsigned sampleRate=44100;
+	const sample_pos_t length=(sample_pos_t)(10*sampleRate*b.getScale());
+
+	CSound sound(b.getWorkDir()+"/rezound_benchmark_playback.wav",sampleRate,channelCount,length);
+	try
+	{
+		fillSound(sound);
+
+		// small periods are what JACK users would run with
+		runPlayback(b,sound,64,16.0,1.0f);
+		runPlayback(b,sound,256,16.0,1.0f);
+		runPlayback(b,sound,2048,16.0,1.0f);
+
+		// the stretching path in mixOntoBuffer()
+		runPlayback(b,sound,256,16.0,1.5f);
+
+		// as fast as prebuffering can go
+		runPlayback(b,sound,2048,0.0,1.0f);
+
+		sound.closeSound();
+	}
+	catch(...)
+	{
+		sound.closeSound();
+		throw;
+	}
+}
@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2026 - agent
+ *
+ * This file is part of ReZound, an audio editing application.
+ *
+ * ReZound is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * ReZound is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+#include "benchmark.h"
+
+#include <stdlib.h>
+
+#include <random>
+#include <vector>
+
+#include <istring>
+
+#include "CSound.h" // for the pool file type and block size that sounds use
+
+/*
+ * TPoolFile measurements: the bandwidth of the accessers when reading and writing
+ * sequentially and at random, and the throughput of inserting, removing and moving 
+ * data as the SAT grows (every insert in the middle of a block splits it).
+ */
+
+typedef CSound::PoolFile_t CBenchPoolFile;
+typedef TPoolAccesser<sample_t,CBenchPoolFile> CBenchPoolAccesser;
+
+static const string SUITE="poolfile";
+
+static void runAccesserBenchmarks(CBenchmark &b,CBenchPoolFile &f,const sample_pos_t length)
+{
+	static const char * const names[]={"sequential write (operator[])","sequential read (operator[])","sequential write (block)","sequential read (block)","random read","random write"};
+	bool wanted=false;
+	for(size_t t=0;t<sizeof(names)/sizeof(*names);t++)
+		wanted=wanted || b.wants(SUITE,names[t]);
+	if(!wanted)
+		return;
+
+	CBenchPoolAccesser a=f.createPool<sample_t>("bandwidth");
+	a.append(length);
+
+	const double bytes=(double)length*sizeof(sample_t);
+	const string params="length="+istring(length);
+
+	b.run(SUITE,"sequential write (operator[])",params,bytes,"bytes",[&]() {
+		for(sample_pos_t t=0;t<length;t++)
+			a[t]=(sample_t)(t&0x3fff);
+	});
+
+	b.run(SUITE,"sequential read (operator[])",params,bytes,"bytes",[&]() {
+		sample_t sum=0;
+		for(sample_pos_t t=0;t<length;t++)
+			sum+=a[t];
+		benchmarkUse(sum);
+	});
+
+	std::vector<sample_t> buffer(65536);
+
+	b.run(SUITE,"sequential write (block)",params,bytes,"bytes",[&]() {
+		a.seek(0);
+		for(sample_pos_t t=0;t<length;t+=buffer.size())
+			a.write(buffer.data(),std::min<sample_pos_t>(buffer.size(),length-t));
+	});
+
+	b.run(SUITE,"sequential read (block)",params,bytes,"bytes",[&]() {
+		a.seek(0);
+		for(sample_pos_t t=0;t<length;t+=buffer.size())
+			a.read(buffer.data(),std::min<sample_pos_t>(buffer.size(),length-t));
+		benchmarkUse(buffer[0]);
+	});
+
+	// random access touches a new block most of the time
+	const size_t randomCount=(size_t)(1000000*b.getScale());
+	std::vector<sample_pos_t> positions(randomCount);
+	std::mt19937_64 rng(1);
+	for(size_t t=0;t<randomCount;t++)
+		positions[t]=rng()%length;
+
+	b.run(SUITE,"random read",params,randomCount,"samples",[&]() {
+		sample_t sum=0;
+		for(size_t t=0;t<randomCount;t++)
+			sum+=a[positions[t]];
+		benchmarkUse(sum);
+	});
+
+	b.run(SUITE,"random write",params,randomCount,"samples",[&]() {
+		for(size_t t=0;t<randomCount;t++)
+			a[positions[t]]=(sample_t)t;
+	});
+
+	f.removePool("bandwidth");
+}
+
+static void runStructuralBenchmarks(CBenchmark &b,CBenchPoolFile &f,const sample_pos_t length)
+{
+	// the SAT sizes (roughly) that insert/remove/move are measured at
+	const size_t fragmentations[]={0,1000,10000,30000};
+	const sample_pos_t opLength=4096;
+	const size_t opCount=(size_t)std::min<sample_pos_t>(1000,length/opLength/2);
+
+	if(!b.wants(SUITE,"insert+remove") && !b.wants(SUITE,"move out+back"))
+		return;
+
+	for(size_t i=0;i<sizeof(fragmentations)/sizeof(*fragmentations);i++)
+	{
+		CBenchPoolAccesser a=f.createPool<sample_t>("structure");
+		CBenchPoolAccesser a2=f.createPool<sample_t>("structure2");
+		a.append(length);
+
+		// fragment the pool with single sample inserts at random places
+		std::mt19937_64 rng(i+1);
+		for(size_t t=0;t<fragmentations[i];t++)
+			a.insert(rng()%a.getSize(),1);
+
+		const string params="blocks="+istring(f.getPoolBlockCount(f.getPoolIdByName("structure")));
+
+		// (each move out leaves the pool shorter)
+		std::vector<sample_pos_t> positions(opCount);
+		for(size_t t=0;t<opCount;t++)
+			positions[t]=rng()%(length-(t+1)*opLength);
+
+		// each of these leaves the pool as it found it so that they can be repeated
+		b.run(SUITE,"insert+remove",params,opCount*2,"operations",[&]() {
+			for(size_t t=0;t<opCount;t++)
+				a.insert(positions[t],opLength);
+			for(size_t t=opCount;t>0;t--)
+				a.remove(positions[t-1],opLength);
+		});
+
+		b.run(SUITE,"move out+back",params,opCount*2,"operations",[&]() {
+			for(size_t t=0;t<opCount;t++)
+				a2.moveData(0,a,positions[t],opLength);
+			for(size_t t=opCount;t>0;t--)
+				a.moveData(positions[t-1],a2,0,opLength);
+		});
+
+		f.removePool("structure");
+		f.removePool("structure2");
+	}
+}
+
+void runPoolFileBenchmarks(CBenchmark &b)
+{
+	const string filename=b.getWorkDir()+"/rezound_benchmark.pf";
+
+	CBenchPoolFile f(REZOUND_POOLFILE_BLOCKSIZE,REZOUND_WORKING_POOLFILE_SIGNATURE);
+	CBenchPoolFile::removeFile(filename);
+	f.openFile(filename,true);
+
+	try
+	{
+		const sample_pos_t length=(sample_pos_t)(64*1024*1024*b.getScale()); // 256MB of floats at scale 1
+
+		runAccesserBenchmarks(b,f,length);
+		runStructuralBenchmarks(b,f,length);
+
+		f.closeFile(false,true);
+	}
+	catch(...)
+	{
+		f.closeFile(false,true);
+		throw;
+	}
+}
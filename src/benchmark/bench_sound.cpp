@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2026 - agent
+ *
+ * This file is part of ReZound, an audio editing application.
+ *
+ * ReZound is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * ReZound is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+#include "benchmark.h"
+
+#include <math.h>
+
+#include <vector>
+
+#include <istring>
+
+#include "CSound.h"
+
+/*
+ * CSound measurements: the edits that actions do to the whole working file (adding and removing
+ * space, copying to temp pools for undo) and recalculating the peak data that the waveform is 
+ * drawn from.  At --scale=1 the sound is 2 channels of 64M samples (512MB of floats), so use a 
+ * larger scale to measure multi-gigabyte sounds.
+ */
+
+static const string SUITE="sound";
+
+static void fillSound(CSound &sound)
+{
+	std::vector<sample_t> buffer(65536);
+	for(unsigned i=0;i<sound.getChannelCount();i++)
+	{
+		CRezPoolAccesser a=sound.getAudio(i);
+		a.seek(0);
+		sample_pos_t pos=0;
+		while(pos<sound.getLength())
+		{
+			const sample_pos_t n=std::min<sample_pos_t>(buffer.size(),sound.getLength()-pos);
+			for(sample_pos_t t=0;t<n;t++)
+				buffer[t]=convert_sample<float,sample_t>(sinf((pos+t)*(i+1)*0.001f)*0.5f);
+			a.write(buffer.data(),n);
+			pos+=n;
+		}
+	}
+}
+
+void runSoundBenchmarks(CBenchmark &b)
+{
+	if(!b.wants(SUITE,""))
+		return;
+
+	const unsigned channelCount=2;
+	const sample_pos_t length=(sample_pos_t)(64*1024*1024*b.getScale());
+
+	CSound sound(b.getWorkDir()+"/rezound_benchmark.wav",44100,channelCount,length);
+	try
+	{
+		fillSound(sound);
+
+		const string params="length="+istring(length)+" channels="+istring(channelCount);
+
+		bool allChannels[MAX_CHANNELS];
+		for(unsigned i=0;i<MAX_CHANNELS;i++)
+			allChannels[i]= i<channelCount;
+
+		{
+			CSoundLocker sl(&sound,true);
+
+			// a minute of space in the middle of the sound
+			const sample_pos_t where=length/2;
+			const sample_pos_t spaceLength=44100*60;
+
+			b.run(SUITE,"addSpace",params,spaceLength*channelCount,"samples",[&]() {
+				sound.addSpace(allChannels,where,spaceLength,false);
+			});
+
+			b.run(SUITE,"addSpace (zeroed)",params,spaceLength*channelCount,"samples",[&]() {
+				sound.addSpace(allChannels,where,spaceLength,true);
+			});
+
+			b.run(SUITE,"removeSpace",params,spaceLength*channelCount,"samples",[&]() {
+				sound.removeSpace(allChannels,where,spaceLength);
+			});
+
+			// remove whatever space the measurements above added that's left
+			if(sound.getLength()>length)
+				sound.removeSpace(allChannels,where,sound.getLength()-length);
+		}
+
+		{
+			CSoundLocker sl(&sound,false);
+
+			// what an action does to prepare for undo on a quarter of the sound
+			const sample_pos_t copyLength=length/4;
+			std::vector<unsigned> tempAudioPoolKeys;
+
+			b.run(SUITE,"copyDataToTemp",params+" copied="+istring(copyLength),copyLength*channelCount,"samples",[&]() {
+				tempAudioPoolKeys.push_back(sound.copyDataToTemp(allChannels,length/8,copyLength));
+			});
+
+			for(size_t t=0;t<tempAudioPoolKeys.size();t++)
+				sound.removeTempAudioPools(tempAudioPoolKeys[t]);
+
+			// drawing the whole sound 2000 pixels wide after it has all changed
+			b.run(SUITE,"peak data recalculation",params,length*channelCount,"samples",[&]() {
+				const sample_pos_t len=sound.getLength(); // (removeSpace alone may have made it shorter)
+				sound.invalidatePeakData(allChannels,0,len-1);
+
+				const sample_pos_t samplesPerPixel=len/2000;
+				for(unsigned i=0;i<channelCount;i++)
+				{
+					const CRezPoolAccesser a=sound.getAudio(i);
+					for(sample_pos_t t=0;t+samplesPerPixel<=len;t+=samplesPerPixel)
+						benchmarkUse(sound.getPeakData(i,t,t+samplesPerPixel,a));
+				}
+			});
+		}
+
+		sound.closeSound();
+	}
+	catch(...)
+	{
+		sound.closeSound();
+		throw;
+	}
+}
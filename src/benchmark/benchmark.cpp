@@ -0,0 +1,258 @@
+/*
+ * Copyright (C) 2026 - agent
+ *
+ * This file is part of ReZound, an audio editing application.
+ *
+ * ReZound is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * ReZound is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+/*
+ * rezound_benchmark -- measures the throughput of the pool file, CSound's edits, the DSP classes
+ * and playback without a frontend and writes the results as JSON.  Run with --help for the options.
+ */
+
+#include "benchmark.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <stdexcept>
+
+#include <istring>
+
+#include <CPath.h>
+DECLARE_STATIC_CPATH // to declare CPath::dirDelim
+
+#include "AStatusComm.h"
+
+// --- CBenchmark ---------------------------
+
+CBenchmark::CBenchmark(const string _workDir,const string _filter,const double _scale,const unsigned _repeat) :
+	workDir(_workDir),
+	filter(_filter),
+	scale(_scale),
+	repeat(_repeat)
+{
+	if(scale<=0.0)
+		throw runtime_error(string(__func__)+" -- invalid scale: "+istring(scale));
+	if(repeat<1)
+		throw runtime_error(string(__func__)+" -- invalid repeat: "+istring(repeat));
+}
+
+CBenchmark::~CBenchmark()
+{
+}
+
+bool CBenchmark::wants(const string suite,const string name) const
+{
+	if(filter=="")
+		return true;
+
+	if(name=="")
+	{ // the filter could be in any of the suite's names unless it names another suite
+		const size_t slash=filter.find('/');
+		return slash==string::npos || (suite.size()>=slash && suite.compare(suite.size()-slash,slash,filter,0,slash)==0);
+	}
+
+	return (suite+"/"+name).find(filter)!=string::npos;
+}
+
+void CBenchmark::run(const string suite,const string name,const string params,const double items,const string units,const std::function<void()> &func)
+{
+	if(filter!="" && (suite+"/"+name).find(filter)==string::npos)
+		return;
+
+	RResult r;
+	r.suite=suite;
+	r.name=name;
+	r.params=params;
+	r.items=items;
+	r.units=units;
+	r.iterations=repeat;
+	r.bestSeconds=0;
+	r.meanSeconds=0;
+
+	for(unsigned t=0;t<repeat;t++)
+	{
+		const auto start=std::chrono::steady_clock::now();
+		func();
+		const double seconds=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+
+		if(t==0 || seconds<r.bestSeconds)
+			r.bestSeconds=seconds;
+		r.meanSeconds+=seconds/repeat;
+	}
+
+	fprintf(stderr,"%-8s %-40s %-28s %14.1f %s/s\n",suite.c_str(),name.c_str(),params.c_str(),r.bestSeconds>0 ? items/r.bestSeconds : 0.0,units.c_str());
+
+	results.push_back(r);
+}
+
+static const string JSONString(const string s)
+{
+	string r="\"";
+	for(size_t t=0;t<s.size();t++)
+	{
+		const char c=s[t];
+		if(c=='"' || c=='\\')
+			r+=string("\\")+c;
+		else if((unsigned char)c<0x20)
+		{
+			char buf[8];
+			snprintf(buf,sizeof(buf),"\\u%04x",(unsigned)c);
+			r+=buf;
+		}
+		else
+			r+=c;
+	}
+	return r+"\"";
+}
+
+void CBenchmark::writeJSON(FILE *f) const
+{
+	char date[64];
+	const time_t now=time(NULL);
+	strftime(date,sizeof(date),"%Y-%m-%dT%H:%M:%SZ",gmtime(&now));
+
+	fprintf(f,"{\n");
+	fprintf(f,"\t\"version\": %s,\n",JSONString(REZOUND_VERSION).c_str());
+#ifdef SAMPLE_TYPE_FLOAT
+	fprintf(f,"\t\"sample_type\": \"float\",\n");
+#else
+	fprintf(f,"\t\"sample_type\": \"int16\",\n");
+#endif
+	fprintf(f,"\t\"date\": %s,\n",JSONString(date).c_str());
+	fprintf(f,"\t\"scale\": %g,\n",scale);
+	fprintf(f,"\t\"results\": [\n");
+	for(size_t t=0;t<results.size();t++)
+	{
+		const RResult &r=results[t];
+		fprintf(f,"\t\t{ \"suite\": %s, \"name\": %s, \"params\": %s, \"items\": %.0f, \"units\": %s, \"iterations\": %u, \"best_seconds\": %.9f, \"mean_seconds\": %.9f, \"rate\": %.3f }%s\n",
+			JSONString(r.suite).c_str(),
+			JSONString(r.name).c_str(),
+			JSONString(r.params).c_str(),
+			r.items,
+			JSONString(r.units).c_str(),
+			r.iterations,
+			r.bestSeconds,
+			r.meanSeconds,
+			r.bestSeconds>0 ? r.items/r.bestSeconds : 0.0,
+			t+1<results.size() ? "," : ""
+		);
+	}
+	fprintf(f,"\t]\n");
+	fprintf(f,"}\n");
+}
+
+
+// --- headless status communication --------
+// CSound puts up progress bars for some operations and there's nobody to show them to
+
+class CBenchmarkStatusComm : public AStatusComm
+{
+public:
+	void error(const string &message,VSeverity severity,bool reformatIfNeeded) { fprintf(stderr,"error: %s\n",message.c_str()); }
+	void warning(const string &message,bool reformatIfNeeded) { fprintf(stderr,"warning: %s\n",message.c_str()); }
+	void message(const string &message,bool reformatIfNeeded) { fprintf(stderr,"%s\n",message.c_str()); }
+	VAnswer question(const string &message,int options,bool reformatIfNeeded) { return cancelAns; }
+
+	void beep() { }
+
+	int beginProgressBar(const string &title,bool showCancelButton) { return 0; }
+	bool updateProgressBar(int handle,int progress,const string timeElapsed,const string timeRemaining) { return false; }
+	void endProgressBar(int handle) { }
+	void endAllProgressBars() { }
+};
+
+
+static void printUsage(const string app)
+{
+	printf("Usage: %s [option]...\n",app.c_str());
+	printf("\t--json=<filename>  write the results as JSON to filename (default: stdout)\n");
+	printf("\t--work-dir=<dir>   where to create the pool files (default: the current directory)\n");
+	printf("\t--filter=<text>    only run the measurements whose suite/name contains text\n");
+	printf("\t--scale=<n>        multiply the sizes of the data by n (e.g. 8 for multi-gigabyte sounds)\n");
+	printf("\t--repeat=<n>       times to repeat each measurement (default: 3)\n");
+	printf("\t--help             show this help message and exit\n");
+}
+
+int main(int argc,char *argv[])
+{
+	string jsonFilename="";
+	string workDir=".";
+	string filter="";
+	double scale=1.0;
+	unsigned repeat=3;
+
+	for(int t=1;t<argc;t++)
+	{
+		if(strncmp(argv[t],"--json=",7)==0)
+			jsonFilename=argv[t]+7;
+		else if(strncmp(argv[t],"--work-dir=",11)==0)
+			workDir=argv[t]+11;
+		else if(strncmp(argv[t],"--filter=",9)==0)
+			filter=argv[t]+9;
+		else if(strncmp(argv[t],"--scale=",8)==0)
+			scale=atof(argv[t]+8);
+		else if(strncmp(argv[t],"--repeat=",9)==0)
+			repeat=atoi(argv[t]+9);
+		else if(strcmp(argv[t],"--help")==0)
+		{
+			printUsage(argv[0]);
+			return 0;
+		}
+		else
+		{
+			fprintf(stderr,"unknown argument: %s\n",argv[t]);
+			printUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	try
+	{
+		gStatusComm=new CBenchmarkStatusComm;
+
+		CBenchmark b(workDir,filter,scale,repeat);
+
+		runPoolFileBenchmarks(b);
+		runSoundBenchmarks(b);
+		runDSPBenchmarks(b);
+		runPlaybackBenchmarks(b);
+
+		if(jsonFilename=="")
+			b.writeJSON(stdout);
+		else
+		{
+			FILE *f=fopen(jsonFilename.c_str(),"w");
+			if(f==NULL)
+				throw runtime_error(string(__func__)+" -- error opening "+jsonFilename+" -- "+strerror(errno));
+			b.writeJSON(f);
+			fclose(f);
+		}
+	}
+	catch(exception &e)
+	{
+		fprintf(stderr,"exception -- %s\n",e.what());
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2026 - agent
+ *
+ * This file is part of ReZound, an audio editing application.
+ *
+ * ReZound is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * ReZound is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+#ifndef __benchmark_H__
+#define __benchmark_H__
+
+#include "../../config/common.h"
+
+#include <stdio.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+/*
+ * A small harness for rezound_benchmark.  Each measurement is a function that does 'items' units
+ * of work (samples, bytes, operations) which run() times 'repeat' times, keeping the best and 
+ * the mean times.  The setup for a measurement should be done before calling run() so that it 
+ * isn't part of the timing.  The results are written as JSON so that they can be compared from 
+ * release to release.
+ */
+class CBenchmark
+{
+public:
+	CBenchmark(const string workDir,const string filter,const double scale,const unsigned repeat);
+	virtual ~CBenchmark();
+
+	// returns false if the measurement is filtered out by --filter (to avoid doing its setup)
+	// if name is "", returns false only if every measurement in the suite would be
+	bool wants(const string suite,const string name) const;
+
+	void run(const string suite,const string name,const string params,const double items,const string units,const std::function<void()> &func);
+
+	// where to create pool files
+	const string getWorkDir() const { return workDir; }
+
+	// sizes of the data used by the measurements are multiplied by this (--scale)
+	const double getScale() const { return scale; }
+
+	void writeJSON(FILE *f) const;
+
+private:
+	const string workDir;
+	const string filter;
+	const double scale;
+	const unsigned repeat;
+
+	struct RResult
+	{
+		string suite;
+		string name;
+		string params;
+		double items;
+		string units;
+		unsigned iterations;
+		double bestSeconds;
+		double meanSeconds;
+	};
+	vector<RResult> results;
+};
+
+void runPoolFileBenchmarks(CBenchmark &b);
+void runSoundBenchmarks(CBenchmark &b);
+void runDSPBenchmarks(CBenchmark &b);
+void runPlaybackBenchmarks(CBenchmark &b);
+
+// keeps the compiler from optimizing away a computed value
+template<class type> inline void benchmarkUse(const type &v)
+{
+	asm volatile("" : : "g"(&v) : "memory");
+}
+
+#endif
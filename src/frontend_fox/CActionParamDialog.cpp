@@ -48,11 +48,16 @@ FXDEFMAP(CActionParamDialog) CActionParamDialogMap[]=
 	FXMAPFUNC(SEL_DOUBLECLICKED,	CActionParamDialog::ID_USER_PRESET_LIST,	CActionParamDialog::onPresetUseButton),
 
 	FXMAPFUNC(SEL_COMMAND,		CActionParamDialog::ID_EXPLAIN_BUTTON,		CActionParamDialog::onExplainButton),
+
+	FXMAPFUNC(SEL_COMMAND,		CActionParamDialog::ID_PREVIEW_BUTTON,		CActionParamDialog::onPreviewButton),
+	FXMAPFUNC(SEL_TIMEOUT,		CActionParamDialog::ID_PREVIEW_TIMER,		CActionParamDialog::onPreviewTimer),
 };
 		
 
 FXIMPLEMENT(CActionParamDialog,FXModalDialogBox,CActionParamDialogMap,ARRAYNUMBER(CActionParamDialogMap))
 
+#define PREVIEW_TIMER_INTERVAL 250
+
 
 // ----------------------------------------
 
@@ -64,6 +69,9 @@ FXIMPLEMENT(CActionParamDialog,FXModalDialogBox,CActionParamDialogMap,ARRAYNUMBE
 CActionParamDialog::CActionParamDialog(FXWindow *mainWindow,bool _showPresetPanel,const string _presetPrefix,FXModalDialogBox::ShowTypes showType) :
 	FXModalDialogBox(mainWindow,"",0,0,FXModalDialogBox::ftVertical,showType),
 
+	actionSound(NULL),
+	actionParameters(NULL),
+
 	showPresetPanel(_showPresetPanel),
 
 	explanationButtonCreated(false),
@@ -78,7 +86,9 @@ CActionParamDialog::CActionParamDialog(FXWindow *mainWindow,bool _showPresetPane
 			userPresetList(NULL),
 
 	presetPrefix(_presetPrefix=="" ? "" : _presetPrefix DOT ""),
-	firstShowing(true)
+	firstShowing(true),
+
+	previewButton(new FXCheckButton(getButtonFrame(),_("Preview\tPlay the Selection Looped With the Current Parameter Values Applied"),this,ID_PREVIEW_BUTTON,CHECKBUTTON_NORMAL | LAYOUT_CENTER_Y))
 {
 	disableFrameDecor();
 
@@ -108,6 +118,62 @@ long CActionParamDialog::onExplainButton(FXObject *sender,FXSelector sel,void *p
 	return 1;
 }
 
+long CActionParamDialog::onPreviewButton(FXObject *sender,FXSelector sel,void *ptr)
+{
+	if(previewButton->getCheck())
+	{
+		previewedParameters="";
+		updatePreview();
+	}
+	else
+	{
+		getApp()->removeTimeout(this,ID_PREVIEW_TIMER);
+		stopPreview();
+	}
+	return 1;
+}
+
+long CActionParamDialog::onPreviewTimer(FXObject *sender,FXSelector sel,void *ptr)
+{
+	if(previewButton->getCheck())
+		updatePreview();
+	return 1;
+}
+
+/*
+ * The controls don't tell the dialog when they change, so while previewing this polls them
+ * and restarts the preview with the new values whenever they differ from what's being heard.
+ */
+void CActionParamDialog::updatePreview()
+{
+	try
+	{
+		CActionParameters parameters(*actionParameters);
+		vector<string> addedParameters;
+		getParameters(&parameters,addedParameters);
+
+		const string s=parameters.asString();
+		if(s!=previewedParameters)
+		{
+			startPreview(actionSound,&parameters);
+			previewedParameters=s;
+		}
+	}
+	catch(EUserMessage &e)
+	{
+		// an invalid value is probably still being typed; keep hearing the last valid ones
+	}
+	catch(exception &e)
+	{
+		previewButton->setCheck(FALSE);
+		stopPreview();
+		Error(e.what());
+		return;
+	}
+
+	getApp()->addTimeout(this,ID_PREVIEW_TIMER,PREVIEW_TIMER_INTERVAL);
+}
+
 FXPacker *CActionParamDialog::newHorzPanel(void *parent,bool createMargin,bool createFrame)
 {
 	if(parent==NULL)
@@ -537,6 +603,15 @@ bool CActionParamDialog::show(CActionSound *actionSound,CActionParameters *actio
 
 	firstShowing=false;
 
+	this->actionSound=actionSound;
+	this->actionParameters=actionParameters;
+	previewButton->setCheck(FALSE);
+	if(canPreview())
+		previewButton->show();
+	else
+		previewButton->hide();
+	getButtonFrame()->recalc();
+
 reshow:
 
 	if(execute(PLACEMENT_CURSOR))
@@ -544,121 +619,7 @@ reshow:
 		vector<string> addedParameters;
 		try
 		{
-			for(unsigned t=0;t<parameters.size();t++)
-			{
-				switch(parameters[t].first)
-				{
-				case ptConstant:
-					{
-						FXConstantParamValue *slider=(FXConstantParamValue *)parameters[t].second;
-						double ret=slider->getValue();
-
-						if(retValueConvs[t]!=NULL)
-							ret=retValueConvs[t](ret);
-
-						actionParameters->setValue<double>(slider->getName(),ret);
-						addedParameters.push_back(slider->getName());
-					}
-					break;
-
-				case ptNumericText:
-					{
-						FXTextParamValue *textEntry=(FXTextParamValue *)parameters[t].second;
-						double ret=textEntry->getValue();
-
-						if(retValueConvs[t]!=NULL)
-							ret=retValueConvs[t](ret);
-
-						actionParameters->setValue<double>(textEntry->getName(),ret);	
-						addedParameters.push_back(textEntry->getName());
-					}
-					break;
-
-				case ptStringText:
-					{
-						FXTextParamValue *textEntry=(FXTextParamValue *)parameters[t].second;
-						const string ret=textEntry->getText();
-						actionParameters->setValue<string>(textEntry->getName(),ret);	
-						addedParameters.push_back(textEntry->getName());
-					}
-					break;
-
-				case ptDiskEntity:
-					{
-						FXDiskEntityParamValue *diskEntityEntry=(FXDiskEntityParamValue *)parameters[t].second;
-						const string ret=diskEntityEntry->getEntityName();
-
-						actionParameters->setValue<string>(diskEntityEntry->getName(),ret);	
-
-						if(diskEntityEntry->getEntityType()==FXDiskEntityParamValue::detAudioFilename)
-							actionParameters->setValue<bool>(diskEntityEntry->getName()+" OpenAsRaw",diskEntityEntry->getOpenAsRaw());	
-						addedParameters.push_back(diskEntityEntry->getName());
-					}
-					break;
-
-				case ptComboText:
-					{
-						FXComboTextParamValue *comboTextEntry=(FXComboTextParamValue *)parameters[t].second;
-						if(comboTextEntry->asString)
-						{ // return the text of the item selected
-							actionParameters->setValue<string>(comboTextEntry->getName(),comboTextEntry->getStringValue());
-						}
-						else
-						{ // return values as integer of the index that was selected
-							FXint ret=comboTextEntry->getIntegerValue();
-							actionParameters->setValue<unsigned>(comboTextEntry->getName(),(unsigned)ret);	
-						}
-						addedParameters.push_back(comboTextEntry->getName());
-					}
-					break;
-
-				case ptCheckBox:
-					{
-						FXCheckBoxParamValue *checkBoxEntry=(FXCheckBoxParamValue *)parameters[t].second;
-						bool ret=checkBoxEntry->getValue();
-
-						actionParameters->setValue<bool>(checkBoxEntry->getName(),ret);	
-						addedParameters.push_back(checkBoxEntry->getName());
-					}
-					break;
-
-				case ptGraph:
-				case ptGraphWithWaveform:
-					{
-						FXGraphParamValue *graph=(FXGraphParamValue *)parameters[t].second;
-						CGraphParamValueNodeList nodes=graph->getNodes();
-
-						if(retValueConvs[t]!=NULL)
-						{
-							for(size_t i=0;i<nodes.size();i++)
-								nodes[i].y=retValueConvs[t](nodes[i].y);
-						}
-
-						actionParameters->setValue<CGraphParamValueNodeList>(graph->getName(),nodes);
-						addedParameters.push_back(graph->getName());
-					}
-					break;
-
-				case ptLFO:
-					{
-						FXLFOParamValue *LFOEntry=(FXLFOParamValue *)parameters[t].second;
-						actionParameters->setValue<CLFODescription>(LFOEntry->getName(),LFOEntry->getValue());
-						addedParameters.push_back(LFOEntry->getName());
-					}
-					break;
-
-				case ptPluginRouting:
-					{
-						FXPluginRoutingParamValue *pluginRoutingEntry=(FXPluginRoutingParamValue *)parameters[t].second;
-						actionParameters->setValue<CPluginMapping>(pluginRoutingEntry->getName(),pluginRoutingEntry->getValue());
-						addedParameters.push_back(pluginRoutingEntry->getName());
-					}
-					break;
-
-				default:
-					throw runtime_error(string(__func__)+" -- unhandled parameter type: "+istring(parameters[t].first));
-				}
-			}
+			getParameters(actionParameters,addedParameters);
 			retval=true;
 		}
 		catch(EUserMessage &e)
@@ -675,6 +636,10 @@ reshow:
 		}
 	}
 
+	// AAction::performAction() stops the preview itself once the dialog is done
+	getApp()->removeTimeout(this,ID_PREVIEW_TIMER);
+	previewButton->setCheck(FALSE);
+
 	// save the splitter's position
 	if(presetsFrame!=NULL)
 	{
@@ -690,6 +655,125 @@ reshow:
 	return retval;
 }
 
+void CActionParamDialog::getParameters(CActionParameters *actionParameters,vector<string> &addedParameters)
+{
+	for(unsigned t=0;t<parameters.size();t++)
+	{
+		switch(parameters[t].first)
+		{
+		case ptConstant:
+			{
+				FXConstantParamValue *slider=(FXConstantParamValue *)parameters[t].second;
+				double ret=slider->getValue();
+
+				if(retValueConvs[t]!=NULL)
+					ret=retValueConvs[t](ret);
+
+				actionParameters->setValue<double>(slider->getName(),ret);
+				addedParameters.push_back(slider->getName());
+			}
+			break;
+
+		case ptNumericText:
+			{
+				FXTextParamValue *textEntry=(FXTextParamValue *)parameters[t].second;
+				double ret=textEntry->getValue();
+
+				if(retValueConvs[t]!=NULL)
+					ret=retValueConvs[t](ret);
+
+				actionParameters->setValue<double>(textEntry->getName(),ret);	
+				addedParameters.push_back(textEntry->getName());
+			}
+			break;
+
+		case ptStringText:
+			{
+				FXTextParamValue *textEntry=(FXTextParamValue *)parameters[t].second;
+				const string ret=textEntry->getText();
+				actionParameters->setValue<string>(textEntry->getName(),ret);	
+				addedParameters.push_back(textEntry->getName());
+			}
+			break;
+
+		case ptDiskEntity:
+			{
+				FXDiskEntityParamValue *diskEntityEntry=(FXDiskEntityParamValue *)parameters[t].second;
+				const string ret=diskEntityEntry->getEntityName();
+
+				actionParameters->setValue<string>(diskEntityEntry->getName(),ret);	
+
+				if(diskEntityEntry->getEntityType()==FXDiskEntityParamValue::detAudioFilename)
+					actionParameters->setValue<bool>(diskEntityEntry->getName()+" OpenAsRaw",diskEntityEntry->getOpenAsRaw());	
+				addedParameters.push_back(diskEntityEntry->getName());
+			}
+			break;
+
+		case ptComboText:
+			{
+				FXComboTextParamValue *comboTextEntry=(FXComboTextParamValue *)parameters[t].second;
+				if(comboTextEntry->asString)
+				{ // return the text of the item selected
+					actionParameters->setValue<string>(comboTextEntry->getName(),comboTextEntry->getStringValue());
+				}
+				else
+				{ // return values as integer of the index that was selected
+					FXint ret=comboTextEntry->getIntegerValue();
+					actionParameters->setValue<unsigned>(comboTextEntry->getName(),(unsigned)ret);	
+				}
+				addedParameters.push_back(comboTextEntry->getName());
+			}
+			break;
+
+		case ptCheckBox:
+			{
+				FXCheckBoxParamValue *checkBoxEntry=(FXCheckBoxParamValue *)parameters[t].second;
+				bool ret=checkBoxEntry->getValue();
+
+				actionParameters->setValue<bool>(checkBoxEntry->getName(),ret);	
+				addedParameters.push_back(checkBoxEntry->getName());
+			}
+			break;
+
+		case ptGraph:
+		case ptGraphWithWaveform:
+			{
+				FXGraphParamValue *graph=(FXGraphParamValue *)parameters[t].second;
+				CGraphParamValueNodeList nodes=graph->getNodes();
+
+				if(retValueConvs[t]!=NULL)
+				{
+					for(size_t i=0;i<nodes.size();i++)
+						nodes[i].y=retValueConvs[t](nodes[i].y);
+				}
+
+				actionParameters->setValue<CGraphParamValueNodeList>(graph->getName(),nodes);
+				addedParameters.push_back(graph->getName());
+			}
+			break;
+
+		case ptLFO:
+			{
+				FXLFOParamValue *LFOEntry=(FXLFOParamValue *)parameters[t].second;
+				actionParameters->setValue<CLFODescription>(LFOEntry->getName(),LFOEntry->getValue());
+				addedParameters.push_back(LFOEntry->getName());
+			}
+			break;
+
+		case ptPluginRouting:
+			{
+				FXPluginRoutingParamValue *pluginRoutingEntry=(FXPluginRoutingParamValue *)parameters[t].second;
+				actionParameters->setValue<CPluginMapping>(pluginRoutingEntry->getName(),pluginRoutingEntry->getValue());
+				addedParameters.push_back(pluginRoutingEntry->getName());
+			}
+			break;
+
+		default:
+			throw runtime_error(string(__func__)+" -- unhandled parameter type: "+istring(parameters[t].first));
+		}
+	}
+}
+
 void CActionParamDialog::hide()
 {
 	FXModalDialogBox::hide();
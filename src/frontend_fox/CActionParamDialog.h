@@ -118,6 +118,9 @@ public:
 
 		ID_EXPLAIN_BUTTON,
 
+		ID_PREVIEW_BUTTON,
+		ID_PREVIEW_TIMER,
+
 		ID_LAST
 	};
 
@@ -128,6 +131,9 @@ public:
 
 	long onExplainButton(FXObject *sender,FXSelector sel,void *ptr);
 
+	long onPreviewButton(FXObject *sender,FXSelector sel,void *ptr);
+	long onPreviewTimer(FXObject *sender,FXSelector sel,void *ptr);
+
 	void create();
 
 	void setTitle(const string title) { FXModalDialogBox::setTitle(title); }
@@ -140,6 +146,7 @@ protected:
 
 private:
 	const CActionSound *actionSound;
+	CActionParameters *actionParameters;
 
 	bool showPresetPanel;
 
@@ -179,8 +186,15 @@ private:
 
 	unsigned findParamByName(const string name) const;
 
+	// sets the values of the controls into actionParameters and adds the names set to addedParameters (throws EUserMessage if a value is invalid)
+	void getParameters(CActionParameters *actionParameters,vector<string> &addedParameters);
+
 	bool firstShowing;
 
+	FXCheckButton *previewButton;
+	string previewedParameters; // asString() of the parameters last given to startPreview()
+	void updatePreview();
+
 };
 
 #endif
@@ -0,0 +1,164 @@
+/* 
+ * Copyright (C) 2026 - agent
+ * 
+ * This file is part of ReZound, an audio editing application.
+ * 
+ * ReZound is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ * 
+ * ReZound is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+#include "CWaveRenderThread.h"
+
+#define COARSE_STRIDE 16
+
+CWaveRenderThread::CJob::CJob(double _horzZoomFactor,sample_pos_t _firstX,int _width) :
+	horzZoomFactor(_horzZoomFactor),
+	firstX(_firstX),
+	width(_width),
+
+	passesDone(0),
+	cancelled(false),
+
+	channelCount(0),
+	inSound(0),
+	stride(1)
+{
+}
+
+int CWaveRenderThread::CJob::getPeaks(vector<RPeakChunk> &_peaks,unsigned &_channelCount,int &_inSound) const
+{
+	std::lock_guard<std::mutex> l(mutex);
+
+	_peaks=peaks;
+	_channelCount=channelCount;
+	_inSound=inSound;
+
+	if(stride>1)
+	{ // fill the gaps between the columns gotten by the coarse pass
+		for(unsigned i=0;i<channelCount;i++)
+		{
+			RPeakChunk *p=&_peaks[i*width];
+			for(int x=0;x<inSound;x++)
+			{
+				if(x%stride)
+					p[x]=p[x-(x%stride)];
+			}
+		}
+	}
+
+	return passesDone;
+}
+
+
+CWaveRenderThread::CWaveRenderThread(CSound *_sound) :
+	sound(_sound)
+{
+	thread = std::make_unique<stdx::thread>([this]() { threadWork(); });
+}
+
+CWaveRenderThread::~CWaveRenderThread()
+{
+	{
+		std::unique_lock<std::mutex> l(queueMutex);
+		for(size_t t=0;t<queue.size();t++)
+			queue[t]->cancel();
+		queue.clear();
+		thread->set_cancelled(true);
+		queueChanged.notify_one(); // so the thread will for sure catch set_cancelled(true)
+	}
+
+	thread->join();
+}
+
+void CWaveRenderThread::request(const std::shared_ptr<CJob> &job)
+{
+	std::unique_lock<std::mutex> l(queueMutex);
+	queue.push_back(job);
+	queueChanged.notify_one();
+}
+
+void CWaveRenderThread::threadWork()
+{
+	stdx::this_thread::set_thread_name("wave render");
+
+	while(!stdx::this_thread::is_cancelled())
+	{
+		std::shared_ptr<CJob> job;
+		{
+			std::unique_lock<std::mutex> l(queueMutex);
+			while(queue.empty())
+			{
+				if(stdx::this_thread::is_cancelled())
+					return;
+				queueChanged.wait(l);
+			}
+			job=queue.front();
+			queue.pop_front();
+		}
+
+		try
+		{
+			if(doPass(*job,COARSE_STRIDE))
+				doPass(*job,1);
+		}
+		catch(exception &e)
+		{
+			printf("error rendering waveform -- %s\n",e.what());
+			job->cancel();
+		}
+	}
+}
+
+// gets every stride'th column of the job and returns false if the job was cancelled
+bool CWaveRenderThread::doPass(CJob &job,int stride)
+{
+	if(job.cancelled)
+		return false;
+
+	CSoundLocker sl(sound,false);
+
+	const sample_pos_t length=sound->getLength();
+	const unsigned channelCount= length>0 ? sound->getChannelCount() : 0; // (0 makes ::drawPortion() draw it as empty)
+
+	// count how many of the columns are within the sound (the rest is the right margin or past the end of a very short sound)
+	int inSound=0;
+	while(inSound<job.width && (sample_pos_t)((job.firstX+inSound)*job.horzZoomFactor)<length)
+		inSound++;
+
+	vector<RPeakChunk> peaks(channelCount*job.width);
+	for(unsigned i=0;i<channelCount;i++)
+	{
+		const CRezPoolAccesser a=sound->getAudio(i);
+		for(int x=0;x<inSound;x+=stride)
+		{
+			if(job.cancelled)
+				return false;
+
+			// the same positions that ::drawPortion() would use, except that a coarse column covers stride columns
+			const sample_pos_t dataPosition=(sample_pos_t)((job.firstX+x)*job.horzZoomFactor);
+			const sample_pos_t nextDataPosition=(sample_pos_t)((job.firstX+x+stride)*job.horzZoomFactor);
+			peaks[i*job.width+x]=sound->getPeakData(i,dataPosition,nextDataPosition,a);
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> l(job.mutex);
+		job.peaks.swap(peaks);
+		job.channelCount=channelCount;
+		job.inSound=inSound;
+		job.stride=stride;
+		job.passesDone++;
+	}
+	return true;
+}
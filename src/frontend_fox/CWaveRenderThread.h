@@ -0,0 +1,110 @@
+/* 
+ * Copyright (C) 2026 - agent
+ * 
+ * This file is part of ReZound, an audio editing application.
+ * 
+ * ReZound is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ * 
+ * ReZound is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+#ifndef __CWaveRenderThread_H__
+#define __CWaveRenderThread_H__
+
+#include "../../config/common.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "stdx/thread"
+
+#include "../backend/CSound.h"
+
+/*
+ * This thread gets the peak data for the columns of the waveform from a CSound so that 
+ * the FOX event thread doesn't have to wait on reading the pool file (which can take
+ * seconds when zoomed out on a large sound whose peak data has been invalidated, or 
+ * zoomed in on audio that isn't cached).  FXWaveCanvas requests a job for each tile it
+ * needs and draws the columns of it as they become available.
+ *
+ * Each job is done in two passes so that something can be drawn sooner.  The first only
+ * gets every COARSE_STRIDE'th column, but over the range of COARSE_STRIDE columns, so 
+ * when the gaps are filled from it the waveform has the right shape, just blocky.  The 
+ * second pass gets every column.  The sound's size is locked only for the duration of a 
+ * pass so that an action wanting to lock it for resize doesn't have to wait long.
+ */
+class CWaveRenderThread
+{
+public:
+	class CJob
+	{
+	public:
+		// firstX is the X of the first column from the left edge of the whole wave at horzZoomFactor
+		CJob(double horzZoomFactor,sample_pos_t firstX,int width);
+
+		const double horzZoomFactor;
+		const sample_pos_t firstX;
+		const int width;
+
+		// returns the number of passes that have been completed (nothing can be drawn while it's 0)
+		int getPassesDone() const { return passesDone; }
+		bool isFinished() const { return passesDone>=2 || cancelled; }
+
+		// makes the thread stop working on (or skip) this job
+		void cancel() { cancelled=true; }
+
+		/*
+		 * - Copies the peak data gotten so far into peaks laid out as ::drawPortion() expects 
+		 *   it with the columns not gotten yet filled from the column to the left of them
+		 * - channelCount and inSound are set for passing to ::drawPortion() as well
+		 * - Returns the number of passes that it reflects
+		 */
+		int getPeaks(vector<RPeakChunk> &peaks,unsigned &channelCount,int &inSound) const;
+
+	private:
+		friend class CWaveRenderThread;
+
+		std::atomic<int> passesDone;
+		std::atomic<bool> cancelled;
+
+		mutable std::mutex mutex; // protects the following
+		unsigned channelCount;
+		int inSound;
+		int stride;
+		vector<RPeakChunk> peaks;
+	};
+
+	CWaveRenderThread(CSound *sound);
+	virtual ~CWaveRenderThread();
+
+	// queues the job to be worked on after any already queued
+	void request(const std::shared_ptr<CJob> &job);
+
+private:
+	CSound * const sound;
+
+	std::mutex queueMutex;
+	std::condition_variable queueChanged;
+	std::deque<std::shared_ptr<CJob> > queue;
+
+	std::unique_ptr<stdx::thread> thread;
+
+	void threadWork();
+	bool doPass(CJob &job,int stride);
+};
+
+#endif
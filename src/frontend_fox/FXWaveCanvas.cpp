@@ -60,10 +60,15 @@ static FXColor playStatusColor=FXRGB(255,0,0);
 
 #define RIGHT_MARGIN 10
 
+#define TILE_WIDTH 256
+#define MAX_CACHED_TILES 32
+#define RENDER_POLL_TIME 50 // ms
+
 FXDEFMAP(FXWaveCanvas) FXWaveCanvasMap[]=
 {
 	//Message_Type		ID	Message_Handler
 	FXMAPFUNC(SEL_PAINT,	0,	FXWaveCanvas::onPaint),
+	FXMAPFUNC(SEL_TIMEOUT,	FXWaveCanvas::ID_RENDER_TIMEOUT,	FXWaveCanvas::onRenderTimeout),
 };
 
 FXIMPLEMENT(FXWaveCanvas,FXCanvas,FXWaveCanvasMap,ARRAYNUMBER(FXWaveCanvasMap))
@@ -71,12 +76,22 @@ FXIMPLEMENT(FXWaveCanvas,FXCanvas,FXWaveCanvasMap,ARRAYNUMBER(FXWaveCanvasMap))
 FXWaveCanvas::FXWaveCanvas(CLoadedSound *_loadedSound,FXComposite *p,FXObject *tgt,FXSelector sel,FXuint opts,FXint x,FXint y,FXint w,FXint h) :
 	FXCanvas(p,tgt,sel,opts,x,y,w,h),
 	first(true),
+
+	tileVertZoomFactor(-1.0f),
+	tileVOffset(0),
+	tileHeight(-1),
+	tileChannelCount(0),
+	tileRenderClippingWarning(false),
+
+	renderThread(new CWaveRenderThread(_loadedSound->sound)),
+	renderTimerHandle(NULL),
+
 	loadedSound(_loadedSound),
 
 	horzZoomFactor(1.0),
 	vertZoomFactor(1.0),
 
-	horzOffset(0),prevHorzZoomFactor_horzOffset(-1.0),
+	horzOffset(0),
 	vertOffset(0),
 
 	prevDrawPlayStatusX(0xffffffff),
@@ -91,6 +106,15 @@ FXWaveCanvas::FXWaveCanvas(CLoadedSound *_loadedSound,FXComposite *p,FXObject *t
 
 FXWaveCanvas::~FXWaveCanvas()
 {
+#if REZ_FOX_VERSION<10322
+	if(renderTimerHandle!=NULL)
+		getApp()->removeTimeout(renderTimerHandle);
+#else
+	getApp()->removeTimeout(this,ID_RENDER_TIMEOUT);
+#endif
+
+	clearTiles();
+	delete renderThread;
 }
 
 void FXWaveCanvas::updateFromEdit(bool undoing)
@@ -224,85 +248,20 @@ const int FXWaveCanvas::getVertSize() const
 }
 
 
-/*
-There is actaully a bug with using drawArea, when using Xinerama for dual monitors 
-If you scroll while the window is stretched across two screens FXCanvas::drawArea
-fails to copy from the other screen.  I suppose it would be possibly to fix in X or
-it could be fixed in fox's drawArea() method.  But as of now, I have no way of 
-knowing of this condition of the window.  
-*/
 void FXWaveCanvas::setHorzOffset(sample_pos_t v)
 {
 	if(v!=horzOffset)
 	{
-		const sample_pos_t oldHorzOffset=horzOffset;
 		horzOffset=v;
 
-		if(horzZoomFactor==prevHorzZoomFactor_horzOffset)
-		{
-			FXDCWindow dc(this);
-
-			// copy part of the screen if possible
-			if(horzOffset>oldHorzOffset)
-			{ // scrolling leftwards
-				// means we need to copy some of the canvas to the left then draw new stuff on the right side
-				FXint sx=horzOffset-oldHorzOffset;
-				prevDrawPlayStatusX-=sx; // make sure the draw play status erases the from the scrolled position
-				if(getWidth()>sx)
-				{
-					// copy the waveform over that already exists on the canvas
-					dc.drawArea(this,sx,0,getWidth()-sx,getHeight(),0,0);
-
-					// handle if some of the canvas that we attempted to copy was off the right of the screen (which doesn't exist to copy from)
-					FXint sub=0;
-					FXint screenXOfCanvasRight,dummy;
-					translateCoordinatesTo(screenXOfCanvasRight,dummy,getApp()->getRootWindow(),getX()+getWidth(),0);
-					const FXint screenWidth=getApp()->getRootWindow()->getDefaultWidth();
-					if(screenXOfCanvasRight>screenWidth)
-					{
-						sx+=(screenXOfCanvasRight-screenWidth); // make the following update, update a more leftward and wider region
-						sub=(screenXOfCanvasRight-screenWidth); // this makes the update avoid telling it to update the off-screen area
-					}
-	
-					// update the new part to draw
-					update(getWidth()-sx,0,sx-sub,getHeight());
-				}
-				else
-					update(); // just update everything since they scrolled more than the canvas's width
-			}
-			else
-			{ // scrolling rightwards
-				// means we need to copy some of the canvas to the right then draw new stuff on the left side
-				FXint sx=oldHorzOffset-horzOffset;
-				prevDrawPlayStatusX+=sx; // make sure the draw play status erases the from the scrolled position
-				if(getWidth()>sx)
-				{
-					// copy the waveform over that already exists on the canvas
-					dc.drawArea(this,0,0,getWidth()-sx,getHeight(),sx,0);
-
-					// handle if some of the canvas that we attempted to copy was off the right of the screen (which doesn't exist to copy from)
-					FXint add=0;
-					FXint screenXOfCanvasLeft,dummy;
-					translateCoordinatesTo(screenXOfCanvasLeft,dummy,getApp()->getRootWindow(),getX(),0);
-					if(screenXOfCanvasLeft<0)
-						add=-screenXOfCanvasLeft; // this makes the update shift the update that would be off-screen to on-screen
-	
-					// update the new part to draw
-					update(0+add,0,sx,getHeight());
-				}
-				else
-					update(); // just update everything since they scrolled more than the canvas's width
-			}
-
-			// I have to force the updates to go ahead and finish now otherwise it has drawing 
-			// problems, I'm guessing that the drawArea()'s and update()'s are getting out of 
-			// sync when using the scroll wheel causing so many scroll events so fast
-			repaint();
-		}
-		else 
-			update(); // update everything since the horz zoom position is new
-		
-		prevHorzZoomFactor_horzOffset=horzZoomFactor;
+		// The canvas is composited from the tile cache, so redrawing all of it at the new 
+		// offset only has to render the tiles that are scrolled into view for the first 
+		// time no matter how far it scrolled.  (This also no longer copies from the screen 
+		// to itself which failed with Xinerama when the window was stretched across two 
+		// screens, or when part of the canvas was off the edge of the screen)
+		FXDCWindow dc(this);
+		drawPortion(0,getWidth(),&dc);
+		prevDrawPlayStatusX=0xffffffff; // it was just drawn over
 	}
 }
 
@@ -354,22 +313,27 @@ void FXWaveCanvas::drawPortion(int left,int width,FXDCWindow *dc)
 		return;
 
 
+	const int vOffset=((getVertSize()-getHeight())/2)-vertOffset;
+
 	// Here is where while an action may be processing that it has the sound locked 
 	// for resize so if a redraw occurs that this would deadlock if used a waiting 
 	// lock instead of a try-lock.
-	// so, I just draw an empty background on the whole thing until a real redraw 
-	// can succeed.  
-	//
-	// ??? One better solution would be to arrange for a back buffer to be saved 
-	// before the action started, and I could blit from that for updates
+	// so, I just copy what was already rendered into the tile cache (which is what 
+	// the sound looked like before the action started) and draw an empty background 
+	// wherever nothing was, until a real redraw can succeed.  
 	CSoundLocker sl(loadedSound->sound, false, true);
 	if(!sl.isLocked())
-	{ // can't lock.. just paint with background.. whole thing first time the lock fails.. just do updated part on not-the-first time
-		dc->setForeground(backGroundColor);
-		if(lastDrawWasUnsuccessful)
-			dc->fillRectangle(left,0,width,getHeight());
+	{ 
+		if(tilesMatchView(vOffset))
+			compositeTiles(left,width,dc,vOffset,false);
 		else
-			update();
+		{ // can't lock.. just paint with background.. whole thing first time the lock fails.. just do updated part on not-the-first time
+			dc->setForeground(backGroundColor);
+			if(lastDrawWasUnsuccessful)
+				dc->fillRectangle(left,0,width,getHeight());
+			else
+				update();
+		}
 		lastDrawWasUnsuccessful=true;
 		return;
 	}
@@ -379,8 +343,8 @@ void FXWaveCanvas::drawPortion(int left,int width,FXDCWindow *dc)
 	renderedStartPosition=loadedSound->channel->getStartPosition();
 	renderedStopPosition=loadedSound->channel->getStopPosition();
 
-	const int vOffset=((getVertSize()-getHeight())/2)-vertOffset;
-	::drawPortion(left,width,dc,loadedSound->sound,getWidth(),getHeight(),(int)getDrawSelectStart(),(int)getDrawSelectStop(),horzZoomFactor,horzOffset,vertZoomFactor,vOffset);
+	validateTiles(vOffset);
+	compositeTiles(left,width,dc,vOffset,true);
 
 	if(gDrawVerticalCuePositions)
 	{	// draw cue positions as inverted colors
@@ -396,11 +360,269 @@ void FXWaveCanvas::drawPortion(int left,int width,FXDCWindow *dc)
 			const sample_pos_t cueTime=loadedSound->sound->getCueTime(t);
 			if(cueTime>=minTime && cueTime<=maxTime)
 			{
+				// copy the column from the tile with its colors inverted
 				const FXint x=getCueScreenX(t);
-				::drawPortion(x,1,dc,loadedSound->sound,getWidth(),getHeight(),(int)getDrawSelectStart(),(int)getDrawSelectStop(),horzZoomFactor,horzOffset,vertZoomFactor,vOffset,false,true);
+				if(x>=0 && x<getWidth())
+				{
+					const sample_pos_t waveX=x+horzOffset;
+					FXImage *image=getTile(waveX/TILE_WIDTH,x>=(int)getDrawSelectStart() && x<=(int)getDrawSelectStop(),vOffset,false);
+					if(image!=NULL)
+					{
+						dc->setFunction(BLT_NOT_SRC);
+						dc->drawArea(image,(int)(waveX%TILE_WIDTH),0,1,getHeight(),x,0);
+						dc->setFunction();
+					}
+				}
+			}
+		}
+	}
+}
+
+
+
+// --- tile cache methods ------------------------------------------------
+
+const bool FXWaveCanvas::tilesMatchView(int vOffset) const
+{
+	return 
+		tileVertZoomFactor==vertZoomFactor &&
+		tileVOffset==vOffset &&
+		tileHeight==getHeight() &&
+		tileChannelCount==loadedSound->sound->getChannelCount() &&
+		tileRenderClippingWarning==gRenderClippingWarning;
+}
+
+// NOTE: the sound needs to be locked when calling this
+void FXWaveCanvas::validateTiles(int vOffset)
+{
+	if(!tilesMatchView(vOffset))
+	{
+		clearTiles();
+		tileVertZoomFactor=vertZoomFactor;
+		tileVOffset=vOffset;
+		tileHeight=getHeight();
+		tileChannelCount=loadedSound->sound->getChannelCount();
+		tileRenderClippingWarning=gRenderClippingWarning;
+	}
+
+	// throw away the tiles (at any zoom level) that were rendered from audio which has since changed
+	sample_pos_t start,stop;
+	if(loadedSound->sound->getInvalidatedPeakRange(start,stop))
+	{
+		for(map<TileKey,RTile>::iterator i=tiles.begin();i!=tiles.end();)
+		{
+			// the sample positions the tile was rendered from (see ::drawPortion for how an X maps to a sample position)
+			const sample_fpos_t zoomFactor=i->first.first;
+			const sample_fpos_t tileStart=(sample_fpos_t)(i->first.second*TILE_WIDTH)*zoomFactor;
+			const sample_fpos_t tileStop=(sample_fpos_t)((i->first.second+1)*TILE_WIDTH+1)*zoomFactor;
+			if(tileStop>=start && tileStart<=stop)
+			{
+				destroyTile(i->second);
+				tiles.erase(i++);
+			}
+			else
+				i++;
+		}
+	}
+}
+
+void FXWaveCanvas::destroyTile(RTile &tile)
+{
+	tile.job->cancel();
+	delete tile.image;
+	delete tile.selectedImage;
+}
+
+void FXWaveCanvas::clearTiles()
+{
+	for(map<TileKey,RTile>::iterator i=tiles.begin();i!=tiles.end();i++)
+		destroyTile(i->second);
+	tiles.clear();
+}
+
+// makes room for one more tile by throwing away the tiles of other zoom levels first and then the ones farthest from what's on screen
+void FXWaveCanvas::evictTiles()
+{
+	const sample_pos_t firstVisibleTile=horzOffset/TILE_WIDTH;
+	const sample_pos_t lastVisibleTile=(horzOffset+getWidth())/TILE_WIDTH;
+
+	while(tiles.size()>=MAX_CACHED_TILES)
+	{
+		map<TileKey,RTile>::iterator victim=tiles.end();
+		sample_pos_t victimDistance=0;
+		for(map<TileKey,RTile>::iterator i=tiles.begin();i!=tiles.end();i++)
+		{
+			const sample_pos_t tileIndex=i->first.second;
+			sample_pos_t distance;
+			if(i->first.first!=horzZoomFactor)
+				distance=MAX_LENGTH;
+			else if(tileIndex<firstVisibleTile)
+				distance=firstVisibleTile-tileIndex;
+			else if(tileIndex>lastVisibleTile)
+				distance=tileIndex-lastVisibleTile;
+			else
+				continue; // never throw away what's on screen
+
+			if(distance>victimDistance)
+			{
+				victim=i;
+				victimDistance=distance;
+			}
+		}
+
+		if(victim==tiles.end())
+			break;
+
+		destroyTile(victim->second);
+		tiles.erase(victim);
+	}
+}
+
+/*
+ * Returns the selected or unselected version of the tile at the current zoom level, (re)drawing it if more 
+ * of its peak data has been gotten since it was last drawn.  NULL is returned if none of it has been gotten 
+ * yet, and if the tile doesn't exist and requestMissing is true then the render thread is asked to get it.
+ */
+FXImage *FXWaveCanvas::getTile(sample_pos_t tileIndex,bool selected,int vOffset,bool requestMissing)
+{
+	const TileKey key(horzZoomFactor,tileIndex);
+	map<TileKey,RTile>::iterator i=tiles.find(key);
+	if(i==tiles.end())
+	{
+		if(requestMissing)
+		{
+			evictTiles();
+
+			RTile &tile=tiles[key]; // (value-initialized to NULLs and 0s)
+			tile.job=std::make_shared<CWaveRenderThread::CJob>(horzZoomFactor,tileIndex*TILE_WIDTH,TILE_WIDTH);
+			renderThread->request(tile.job);
+			startRenderTimer();
+		}
+		return NULL;
+	}
+
+	RTile &tile=i->second;
+	if(!tile.job->isFinished())
+		startRenderTimer();
+
+	FXImage *&image= selected ? tile.selectedImage : tile.image;
+	int &imagePasses= selected ? tile.selectedImagePasses : tile.imagePasses;
+	if(tile.job->getPassesDone()>imagePasses)
+	{
+		vector<RPeakChunk> peaks;
+		unsigned channelCount;
+		int inSound;
+		imagePasses=tile.job->getPeaks(peaks,channelCount,inSound);
+
+		if(image==NULL)
+		{
+			image=new FXImage(getApp(),NULL,0,TILE_WIDTH,getHeight());
+			image->create();
+		}
+
+		FXDCWindow dc(image);
+		// the selected version is all selected and the unselected version has nothing selected
+		::drawPortion(0,TILE_WIDTH,&dc,peaks.empty() ? NULL : &peaks[0],channelCount,inSound,TILE_WIDTH,getHeight(),selected ? 0 : -1,selected ? TILE_WIDTH-1 : -1,vertZoomFactor,vOffset);
+	}
+
+	tile.paintedPasses=max(tile.paintedPasses,imagePasses);
+	return image;
+}
+
+// copies [left,left+width) of the canvas from the selected or unselected version of the tiles
+void FXWaveCanvas::copyTiles(int left,int width,FXDCWindow *dc,bool selected,int vOffset,bool requestMissing)
+{
+	if(left<0)
+	{
+		width+=left;
+		left=0;
+	}
+	width=min(width,(int)getWidth()-left);
+
+	for(int x=left;x<left+width;)
+	{
+		const sample_pos_t waveX=x+horzOffset;
+		const sample_pos_t tileIndex=waveX/TILE_WIDTH;
+		const int tileX=(int)(waveX%TILE_WIDTH);
+		const int w=min(TILE_WIDTH-tileX,left+width-x);
+
+		FXImage *image=getTile(tileIndex,selected,vOffset,requestMissing);
+		if(image!=NULL)
+			dc->drawArea(image,tileX,0,w,getHeight(),x,0);
+		else
+		{
+			dc->setForeground(backGroundColor);
+			dc->fillRectangle(x,0,w,getHeight());
+		}
+
+		x+=w;
+	}
+}
+
+// draws [left,left+width) of the canvas by copying from the tiles, choosing the selected version of them within the selection
+void FXWaveCanvas::compositeTiles(int left,int width,FXDCWindow *dc,int vOffset,bool requestMissing)
+{
+	const int right=left+width;
+	const int selectStart=max(left,(int)getDrawSelectStart());
+	const int selectStop=min(right-1,(int)getDrawSelectStop());
+
+	if(selectStart<=selectStop)
+	{
+		copyTiles(left,selectStart-left,dc,false,vOffset,requestMissing);
+		copyTiles(selectStart,selectStop-selectStart+1,dc,true,vOffset,requestMissing);
+		copyTiles(selectStop+1,right-(selectStop+1),dc,false,vOffset,requestMissing);
+	}
+	else
+		copyTiles(left,width,dc,false,vOffset,requestMissing);
+}
+
+void FXWaveCanvas::startRenderTimer()
+{
+#if REZ_FOX_VERSION<10322
+	if(renderTimerHandle==NULL)
+		renderTimerHandle=getApp()->addTimeout(this,ID_RENDER_TIMEOUT,RENDER_POLL_TIME);
+#else
+	if(!getApp()->hasTimeout(this,ID_RENDER_TIMEOUT))
+		getApp()->addTimeout(this,ID_RENDER_TIMEOUT,RENDER_POLL_TIME);
+#endif
+}
+
+long FXWaveCanvas::onRenderTimeout(FXObject *object,FXSelector sel,void *ptr)
+{
+	renderTimerHandle=NULL;
+
+	const sample_pos_t firstVisibleTile=horzOffset/TILE_WIDTH;
+	const sample_pos_t lastVisibleTile=(horzOffset+getWidth())/TILE_WIDTH;
+
+	bool waiting=false;
+	for(map<TileKey,RTile>::iterator i=tiles.begin();i!=tiles.end();)
+	{
+		RTile &tile=i->second;
+		const sample_pos_t tileIndex=i->first.second;
+		const int passesDone=tile.job->getPassesDone();
+		if(i->first.first!=horzZoomFactor || tileIndex<firstVisibleTile || tileIndex>lastVisibleTile)
+		{ 
+			if(passesDone==0)
+			{ // scrolled or zoomed away before the render thread got to it, so don't make what's on screen now wait on it
+				destroyTile(tile);
+				tiles.erase(i++);
+				continue;
 			}
 		}
+		else
+		{ // repaint what's on screen as more of it is ready
+			if(passesDone>tile.paintedPasses)
+				update((FXint)(tileIndex*TILE_WIDTH-horzOffset),0,TILE_WIDTH,getHeight());
+			if(!tile.job->isFinished())
+				waiting=true;
+		}
+		i++;
 	}
+
+	if(waiting)
+		startRenderTimer();
+
+	return 1;
 }
 
 
@@ -427,7 +649,6 @@ void FXWaveCanvas::showAmount(double seconds,sample_pos_t pos,int marginPixels)
 	{
 		horzZoomFactor=max((sample_fpos_t)1.0,((sample_fpos_t)seconds*loadedSound->sound->getSampleRate())/(getWidth()-(2*marginPixels)));
 		horzOffset=(sample_pos_t)(max((sample_fpos_t)0,min((sample_fpos_t)loadedSound->sound->getLength()-getWidth()+RIGHT_MARGIN,(sample_fpos_t)pos-(marginPixels*horzZoomFactor)))/horzZoomFactor);
-		prevHorzZoomFactor_horzOffset=horzZoomFactor;
 
 		// recalc the percent value so that getHorzZoom() will return the correct value
 		const sample_fpos_t maxZoomFactor=(sample_fpos_t)loadedSound->sound->getLength()/(sample_fpos_t)max(1,(int)(getWidth()-RIGHT_MARGIN));
@@ -37,9 +37,15 @@
 #include "../../config/common.h"
 #include "fox_compat.h"
 
+#include <map>
+#include <memory>
+#include <utility>
+
 #include "../backend/CSound_defs.h"
 class CLoadedSound;
 
+#include "CWaveRenderThread.h"
+
 class FXWaveCanvas : public FXCanvas
 {
 	FXDECLARE(FXWaveCanvas)
@@ -100,7 +106,14 @@ public:
 	void drawPlayPosition(sample_pos_t dataPosition,bool justErasing,bool scrollToMakeVisible,FXScrollArea *optScrollArea);
 
 
+	enum
+	{
+		ID_RENDER_TIMEOUT=FXCanvas::ID_LAST,
+		ID_LAST
+	};
+
 	long onPaint(FXObject *object,FXSelector sel,void *ptr);
+	long onRenderTimeout(FXObject *object,FXSelector sel,void *ptr);
 	bool first;
 
 protected:
@@ -109,13 +122,56 @@ protected:
 private:
 	void drawPortion(int left,int width,FXDCWindow *dc);
 
+	/*
+	 * The waveform is rendered in fixed-width vertical strips (tiles) into off-screen
+	 * images that are kept between paints and just copied onto the canvas.  So scrolling,
+	 * moving the play position or changing the selection only has to render a tile that
+	 * has never been seen at the current zoom.  Each tile has an unselected and (only made
+	 * when needed) a selected version, and the selection is drawn by choosing which one to
+	 * copy from.  Tiles are keyed by the horizontal zoom factor and the tile's index from
+	 * the left edge of the whole wave so that going back to a recent zoom level is cheap too.
+	 *
+	 * The peak data for a tile is gotten from the sound by renderThread.  Until it has some,
+	 * the tile is painted as background, and then a timer repaints the tile each time more
+	 * of it is ready.
+	 */
+	struct RTile
+	{
+		std::shared_ptr<CWaveRenderThread::CJob> job;
+		FXImage *image;
+		FXImage *selectedImage;
+		int imagePasses,selectedImagePasses; // how many of the job's passes each image was drawn from
+		int paintedPasses; // how many of the job's passes were reflected the last time the tile was painted
+	};
+	typedef pair<sample_fpos_t,sample_pos_t> TileKey;
+	map<TileKey,RTile> tiles;
+
+	// what the tiles were rendered with besides the horizontal zoom; all of them are thrown away if any of this changes
+	float tileVertZoomFactor;
+	int tileVOffset;
+	FXint tileHeight;
+	unsigned tileChannelCount;
+	bool tileRenderClippingWarning;
+
+	CWaveRenderThread *renderThread;
+	FXTimer *renderTimerHandle;
+
+	const bool tilesMatchView(int vOffset) const;
+	void validateTiles(int vOffset);
+	void destroyTile(RTile &tile);
+	void clearTiles();
+	void evictTiles();
+	FXImage *getTile(sample_pos_t tileIndex,bool selected,int vOffset,bool requestMissing);
+	void copyTiles(int left,int width,FXDCWindow *dc,bool selected,int vOffset,bool requestMissing);
+	void compositeTiles(int left,int width,FXDCWindow *dc,int vOffset,bool requestMissing);
+	void startRenderTimer();
+
 	CLoadedSound *loadedSound;
 
 	sample_fpos_t horzZoomFactor;
 	float vertZoomFactor;
 
 	sample_pos_t horzOffset;
-	sample_fpos_t prevHorzZoomFactor_horzOffset;
 
 	int vertOffset;
 
@@ -24,6 +24,7 @@
 
 #include <exception>
 #include <algorithm>
+#include <memory>
 
 #include "settings.h"
 
@@ -59,34 +60,12 @@ static inline float sample_to_y(sample_t sampleValue,float vertZoomFactor,int ve
 
 
 // ??? some of these int types would need to be changed to be sample_pos_t or int64_t if >31bits zoomed-in lengths were supported
-/*
- * NOTE: need to lock sound's size before calling this to be safe
- *
- * left: 		X position in the dc of where to start drawing
- * width:		how far past left to draw
- * dc:			the drawing context to draw on
- * sound:		the sound to render from
- * canvasWidth:		the total width of the canvas that is being drawn on
- * drawSelectStart:	the X position in the dc where the selection begins
- * drawSelectStop:	the X position in the dc where the selection ends
- * horzZoomFactor:	how many sample positions are represented by one pixels.  hence, 1.0 is zoomed all the way in
- * hOffset:		how many sample positions the left edge of the canvas is offset
- * vertZoomFactor:	how many sample values are represented by one pixel. hence 1.0 is zoomed all the way in
- * vOffset:		how many sample values the middle of a channel is offset by
- * darkened:		true if the whole drawing is to be somewhat darkened
- * invert colors:	true if to bitwise not any color when drawing
- *
- * NOTE: on vertZoomFactor and vOffset, it should be thought of as rendering a single channel.  IOW, and caculations done
- * outside this function should not be concerned with how many channels are being rendered on screen.
- * NOTE: on vertZoomFactor and vOffset, values should be calculated as if there were only MAX_WAVE_HEIGHT possible sample
- * values i.e. whether sample_t is float, int16_t or int32_t, etc these values should be calculated that there are 
- * MAX_WAVE_HEIGHT number of sample values.
- *
- */
-void drawPortion(int left,int width,FXDCWindow *dc,CSound *sound,int canvasWidth,int canvasHeight,int drawSelectStart,int drawSelectStop,double horzZoomFactor,sample_pos_t hOffset,float vertZoomFactor,int vOffset,bool darkened,bool invertColors)
+// draws the columns [left,left+width) getting each one's peak data from the given peak source (see the drawPortion()s below)
+template<class peak_source_t> static void drawColumns(int left,int width,FXDCWindow *dc,peak_source_t &peaks,int canvasWidth,int canvasHeight,int drawSelectStart,int drawSelectStop,float vertZoomFactor,int vOffset,bool darkened,bool invertColors)
 {
-	vertZoomFactor*=(float)sound->getChannelCount();
-	vOffset/=(int)sound->getChannelCount();
+	const unsigned channelCount=max(1u,peaks.getChannelCount()); // (1 if empty just to avoid dividing by zero)
+	vertZoomFactor*=(float)channelCount;
+	vOffset/=(int)channelCount;
 
 	try
 	{
@@ -125,10 +104,10 @@ void drawPortion(int left,int width,FXDCWindow *dc,CSound *sound,int canvasWidth
 		//printf("draw: c: %d   left: %d right: %d width: %d\n",g++,left,right,width);
 
 		// Draw the waveform and axies
-		if(sound!=NULL && !sound->isEmpty())
+		if(!peaks.isEmpty())
 		{
 			float _channelTop=0;
-			const float channelHeight=(float)canvasHeight/(float)sound->getChannelCount();
+			const float channelHeight=(float)canvasHeight/(float)channelCount;
 
 			float channelOffset=channelHeight/2;
 			if(left<0)
@@ -137,24 +116,20 @@ void drawPortion(int left,int width,FXDCWindow *dc,CSound *sound,int canvasWidth
 				left=0;
 			}
 
-			for(unsigned i=0;i<sound->getChannelCount();i++)
+			for(unsigned i=0;i<channelCount;i++)
 			{
 				const int channelTop=(int)round(_channelTop);
 
-				const CRezPoolAccesser a=sound->getAudio(i);
-				const sample_pos_t soundLength=sound->getLength();
+				peaks.beginChannel(i);
 
 				// draw waveform
 				for(int x=left;x<=right;x++)
 				{
-					const sample_pos_t dataPosition=(sample_pos_t)((x+hOffset)*horzZoomFactor);
+					RPeakChunk r;
 
 					// this is false when drawing the right margin of unused space or when zoomed out on a sound of very few samples
-					if(dataPosition<soundLength)
+					if(peaks.getPeak(i,x,r))
 					{
-						const sample_pos_t next_dataPosition=(sample_pos_t)((x+hOffset+1)*horzZoomFactor);
-
-						RPeakChunk r=sound->getPeakData(i,dataPosition,next_dataPosition,a);
 
 						float min_y=sample_to_y(r.max,vertZoomFactor,vOffset,channelOffset);
 						if(min_y<channelOffset-channelHeight/2)
@@ -278,6 +253,128 @@ void drawPortion(int left,int width,FXDCWindow *dc,CSound *sound,int canvasWidth
 	}
 }
 
+
+namespace
+{
+	// gets the peak data for each column from the sound
+	class CSoundPeakSource
+	{
+	public:
+		CSoundPeakSource(CSound *_sound,double _horzZoomFactor,sample_pos_t _hOffset) :
+			sound(_sound),
+			horzZoomFactor(_horzZoomFactor),
+			hOffset(_hOffset),
+			soundLength(_sound==NULL ? 0 : _sound->getLength())
+		{
+		}
+
+		unsigned getChannelCount() const { return sound==NULL ? 0 : sound->getChannelCount(); }
+		bool isEmpty() const { return sound==NULL || sound->isEmpty(); }
+
+		void beginChannel(unsigned channel)
+		{
+			a.reset(new CRezPoolAccesser(sound->getAudio(channel)));
+		}
+
+		bool getPeak(unsigned channel,int x,RPeakChunk &r)
+		{
+			const sample_pos_t dataPosition=(sample_pos_t)((x+hOffset)*horzZoomFactor);
+			if(dataPosition>=soundLength)
+				return false;
+
+			const sample_pos_t next_dataPosition=(sample_pos_t)((x+hOffset+1)*horzZoomFactor);
+			r=sound->getPeakData(channel,dataPosition,next_dataPosition,*a);
+			return true;
+		}
+
+	private:
+		CSound * const sound;
+		const double horzZoomFactor;
+		const sample_pos_t hOffset;
+		const sample_pos_t soundLength;
+		unique_ptr<const CRezPoolAccesser> a;
+	};
+
+	// gets the peak data for each column from peak data that was already gotten
+	class CPrecalculatedPeakSource
+	{
+	public:
+		CPrecalculatedPeakSource(const RPeakChunk *_peaks,unsigned _channelCount,int _left,int _width,int _inSound) :
+			peaks(_peaks),
+			channelCount(_channelCount),
+			left(_left),
+			width(_width),
+			inSound(_inSound)
+		{
+		}
+
+		unsigned getChannelCount() const { return channelCount; }
+		bool isEmpty() const { return channelCount==0; }
+
+		void beginChannel(unsigned channel)
+		{
+		}
+
+		bool getPeak(unsigned channel,int x,RPeakChunk &r)
+		{
+			x-=left;
+			if(x<0 || x>=inSound)
+				return false;
+			r=peaks[channel*width+x];
+			return true;
+		}
+
+	private:
+		const RPeakChunk * const peaks;
+		const unsigned channelCount;
+		const int left;
+		const int width;
+		const int inSound;
+	};
+}
+
+/*
+ * NOTE: need to lock sound's size before calling this to be safe
+ *
+ * left: 		X position in the dc of where to start drawing
+ * width:		how far past left to draw
+ * dc:			the drawing context to draw on
+ * sound:		the sound to render from
+ * canvasWidth:		the total width of the canvas that is being drawn on
+ * drawSelectStart:	the X position in the dc where the selection begins
+ * drawSelectStop:	the X position in the dc where the selection ends
+ * horzZoomFactor:	how many sample positions are represented by one pixels.  hence, 1.0 is zoomed all the way in
+ * hOffset:		how many sample positions the left edge of the canvas is offset
+ * vertZoomFactor:	how many sample values are represented by one pixel. hence 1.0 is zoomed all the way in
+ * vOffset:		how many sample values the middle of a channel is offset by
+ * darkened:		true if the whole drawing is to be somewhat darkened
+ * invert colors:	true if to bitwise not any color when drawing
+ *
+ * The second version draws from peak data that was already gotten from the sound (possibly on
+ * another thread) and doesn't touch the sound, so it doesn't need the sound to be locked
+ * peaks:		channelCount*width values, the ones for channel i begin at peaks[i*width] and peaks[i*width+x] is drawn at left+x
+ * channelCount:	the sound's channel count or 0 if the sound is empty
+ * inSound:		how many columns from left are within the sound's length (the rest are drawn as background)
+ *
+ * NOTE: on vertZoomFactor and vOffset, it should be thought of as rendering a single channel.  IOW, and caculations done
+ * outside this function should not be concerned with how many channels are being rendered on screen.
+ * NOTE: on vertZoomFactor and vOffset, values should be calculated as if there were only MAX_WAVE_HEIGHT possible sample
+ * values i.e. whether sample_t is float, int16_t or int32_t, etc these values should be calculated that there are 
+ * MAX_WAVE_HEIGHT number of sample values.
+ *
+ */
+void drawPortion(int left,int width,FXDCWindow *dc,CSound *sound,int canvasWidth,int canvasHeight,int drawSelectStart,int drawSelectStop,double horzZoomFactor,sample_pos_t hOffset,float vertZoomFactor,int vOffset,bool darkened,bool invertColors)
+{
+	CSoundPeakSource peaks(sound,horzZoomFactor,hOffset);
+	drawColumns(left,width,dc,peaks,canvasWidth,canvasHeight,drawSelectStart,drawSelectStop,vertZoomFactor,vOffset,darkened,invertColors);
+}
+
+void drawPortion(int left,int width,FXDCWindow *dc,const RPeakChunk *peaks,unsigned channelCount,int inSound,int canvasWidth,int canvasHeight,int drawSelectStart,int drawSelectStop,float vertZoomFactor,int vOffset,bool darkened,bool invertColors)
+{
+	CPrecalculatedPeakSource peakSource(peaks,channelCount,left,width,inSound);
+	drawColumns(left,width,dc,peakSource,canvasWidth,canvasHeight,drawSelectStart,drawSelectStop,vertZoomFactor,vOffset,darkened,invertColors);
+}
+
 float sample_to_y(sample_t sampleValue,float vertZoomFactor,int vertOffset,float channelOffset)
 {
 	//           the sample value, normalized to [-1,1], scaled to MAX_WAVE_HEIGHT (max height/2 because range is -1 to +1) 
@@ -25,6 +25,7 @@
 #include "fox_compat.h"
 
 #include "../backend/CSound_defs.h"
+struct RPeakChunk;
 
 #ifdef FOX_NO_NAMESPACE
 	class FXDCWindow;
@@ -40,6 +41,7 @@
 #endif
 
 extern void drawPortion(int left,int width,FXDCWindow *dc,CSound *sound,int canvasWidth,int canvasHeight,int drawSelectStart,int drawSelectStop,double horzZoomFactor,sample_pos_t hOffset,float vertZoomFactor,int vOffset,bool darkened=false,bool invertColors=false);
+extern void drawPortion(int left,int width,FXDCWindow *dc,const RPeakChunk *peaks,unsigned channelCount,int inSound,int canvasWidth,int canvasHeight,int drawSelectStart,int drawSelectStop,float vertZoomFactor,int vOffset,bool darkened=false,bool invertColors=false);
 
 
 
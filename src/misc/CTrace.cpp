@@ -0,0 +1,300 @@
+/*
+ * Copyright (C) 2026 - agent
+ *
+ * This file is part of ReZound, an audio editing application.
+ *
+ * ReZound is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * ReZound is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+#include "CTrace.h"
+
+#ifdef ENABLE_TRACING
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef rez_OS_LINUX
+#include <sys/syscall.h>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+
+#include <istring>
+
+/*
+ * Each thread records into its own list of fixed size chunks so recording never waits on
+ * another thread.  Only the owning thread appends to a chunk; it publishes each event by
+ * storing the chunk's new count with release semantics so writeJSON() can read the events
+ * from another thread at any time.
+ *
+ * The chunks and thread buffers come from malloc() rather than operator new so that
+ * recording in the audio I/O thread does not trip ENABLE_RT_ALLOCATION_CHECK.  (A new chunk
+ * is only needed every CHUNK_SIZE events, but it is still an allocation in that thread, so
+ * the timings of the scope it happens in will be a little pessimistic.)
+ */
+
+namespace
+{
+	enum
+	{
+		CHUNK_SIZE=8192,
+		MAX_THREADS=256
+	};
+
+	struct RTraceEvent
+	{
+		const char *name;
+		int64_t ts;
+		int64_t durOrValue;
+		char type; // 'X' for a scope, 'C' for a counter
+	};
+
+	struct RTraceChunk
+	{
+		std::atomic<size_t> count;
+		std::atomic<RTraceChunk *> next;
+		RTraceEvent events[CHUNK_SIZE];
+	};
+
+	struct RThreadBuffer
+	{
+		long tid;
+		RTraceChunk *head;
+		RTraceChunk *tail;
+	};
+
+	std::mutex threadBuffersMutex;
+	std::atomic<RThreadBuffer *> threadBuffers[MAX_THREADS];
+	std::atomic<size_t> threadBufferCount(0);
+	bool threadBuffersFull=false;
+
+	thread_local RThreadBuffer *threadBuffer=NULL;
+
+	char *traceFilename=NULL;
+	const std::chrono::steady_clock::time_point startTime=std::chrono::steady_clock::now();
+
+	RTraceChunk *newChunk()
+	{
+		void *p=malloc(sizeof(RTraceChunk));
+		if(!p)
+			return NULL;
+		RTraceChunk *chunk=new(p) RTraceChunk;
+		chunk->count=0;
+		chunk->next=NULL;
+		return chunk;
+	}
+
+	long currentThreadId()
+	{
+#ifdef rez_OS_LINUX
+		return (long)syscall(SYS_gettid);
+#else
+		static std::atomic<long> nextId(1);
+		return nextId++;
+#endif
+	}
+
+	// returns NULL if too many threads have recorded events or malloc fails
+	RThreadBuffer *getThreadBuffer()
+	{
+		if(threadBuffer)
+			return threadBuffer;
+
+		std::lock_guard<std::mutex> l(threadBuffersMutex);
+
+		const size_t index=threadBufferCount;
+		if(index>=MAX_THREADS)
+		{
+			if(!threadBuffersFull)
+				fprintf(stderr,"%s -- more than %d threads have been traced; events from the rest are dropped\n",__func__,(int)MAX_THREADS);
+			threadBuffersFull=true;
+			return NULL;
+		}
+
+		void *p=malloc(sizeof(RThreadBuffer));
+		RTraceChunk *chunk=newChunk();
+		if(!p || !chunk)
+		{
+			free(p);
+			free(chunk);
+			return NULL;
+		}
+
+		RThreadBuffer *buffer=new(p) RThreadBuffer;
+		buffer->tid=currentThreadId();
+		buffer->head=buffer->tail=chunk;
+
+		threadBuffers[index]=buffer;
+		threadBufferCount=index+1;
+
+		return threadBuffer=buffer;
+	}
+
+	void addEvent(const char type,const char *name,const int64_t ts,const int64_t durOrValue)
+	{
+		RThreadBuffer *buffer=getThreadBuffer();
+		if(!buffer)
+			return;
+
+		RTraceChunk *chunk=buffer->tail;
+		size_t count=chunk->count.load(std::memory_order_relaxed);
+		if(count>=CHUNK_SIZE)
+		{
+			RTraceChunk *next=newChunk();
+			if(!next)
+				return;
+			chunk->next.store(next,std::memory_order_release);
+			buffer->tail=chunk=next;
+			count=0;
+		}
+
+		RTraceEvent &e=chunk->events[count];
+		e.name=name;
+		e.ts=ts;
+		e.durOrValue=durOrValue;
+		e.type=type;
+		chunk->count.store(count+1,std::memory_order_release);
+	}
+
+	// names are string literals in the source but escape anything JSON would choke on anyway
+	void writeJSONString(FILE *f,const char *s)
+	{
+		fputc('"',f);
+		for(;*s;s++)
+		{
+			if(*s=='"' || *s=='\\')
+				fputc('\\',f);
+			if((unsigned char)*s<0x20)
+				fputc(' ',f);
+			else
+				fputc(*s,f);
+		}
+		fputc('"',f);
+	}
+
+	// nanoseconds to the microseconds that the trace format uses
+	void writeMicroseconds(FILE *f,int64_t ns)
+	{
+		if(ns<0)
+		{
+			fputc('-',f);
+			ns=-ns;
+		}
+		fprintf(f,"%lld.%03d",(long long)(ns/1000),(int)(ns%1000));
+	}
+
+	void writeAtExit()
+	{
+		try
+		{
+			CTrace::writeJSON(traceFilename);
+			fprintf(stderr,"trace written to: %s\n",traceFilename);
+		}
+		catch(std::exception &e)
+		{
+			fprintf(stderr,"%s\n",e.what());
+		}
+	}
+}
+
+bool CTrace::enabled=false;
+
+struct CTraceInit
+{
+	CTraceInit()
+	{
+		const char *filename=getenv("REZOUND_TRACE");
+		if(filename && filename[0])
+		{
+			traceFilename=strdup(filename);
+			if(traceFilename)
+			{
+				CTrace::enabled=true;
+				atexit(writeAtExit);
+			}
+		}
+	}
+};
+
+static CTraceInit traceInit;
+
+int64_t CTrace::now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-startTime).count();
+}
+
+void CTrace::addScope(const char *name,int64_t begin,int64_t end)
+{
+	addEvent('X',name,begin,end-begin);
+}
+
+void CTrace::addCounter(const char *name,int64_t value)
+{
+	addEvent('C',name,now(),value);
+}
+
+void CTrace::writeJSON(const std::string filename)
+{
+	FILE *f=fopen(filename.c_str(),"w");
+	if(!f)
+		throw runtime_error(string(__func__)+" -- error opening trace file: "+filename);
+
+	const long pid=(long)getpid();
+
+	fprintf(f,"{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	bool first=true;
+
+	const size_t bufferCount=threadBufferCount;
+	for(size_t t=0;t<bufferCount;t++)
+	{
+		const RThreadBuffer *buffer=threadBuffers[t];
+		for(const RTraceChunk *chunk=buffer->head;chunk;chunk=chunk->next.load(std::memory_order_acquire))
+		{
+			const size_t count=chunk->count.load(std::memory_order_acquire);
+			for(size_t i=0;i<count;i++)
+			{
+				const RTraceEvent &e=chunk->events[i];
+
+				fprintf(f,"%s{\"name\":",first ? "" : ",\n");
+				first=false;
+				writeJSONString(f,e.name);
+				fprintf(f,",\"ph\":\"%c\",\"pid\":%ld,\"tid\":%ld,\"ts\":",e.type,pid,buffer->tid);
+				writeMicroseconds(f,e.ts);
+				if(e.type=='X')
+				{
+					fprintf(f,",\"dur\":");
+					writeMicroseconds(f,e.durOrValue);
+					fprintf(f,"}");
+				}
+				else
+					fprintf(f,",\"args\":{\"value\":%lld}}",(long long)e.durOrValue);
+			}
+		}
+	}
+
+	fprintf(f,"\n]}\n");
+
+	const bool failed=ferror(f)!=0;
+	if(fclose(f)!=0 || failed)
+		throw runtime_error(string(__func__)+" -- error writing trace file: "+filename);
+}
+
+#endif
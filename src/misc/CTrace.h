@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2026 - agent
+ *
+ * This file is part of ReZound, an audio editing application.
+ *
+ * ReZound is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * ReZound is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA
+ */
+
+#ifndef __CTrace_H__
+#define __CTrace_H__
+
+#include "../../config/common.h"
+
+/*
+ * Trace points for seeing where the time goes inside an action, playback or loading and
+ * saving without attaching a profiler.
+ *
+ *	TRACE_SCOPE(name)         records the time from here to the end of the enclosing block
+ *	TRACE_COUNTER(name,value) records the current value of something (i.e. a queue's size)
+ *	TRACE_COUNT(name,delta)   adds delta to a running total and records the total
+ *
+ * name must be a string literal (only the pointer is kept).
+ *
+ * The trace points are only compiled in when configured with ENABLE_TRACING; otherwise
+ * they expand to nothing.  When compiled in they still record nothing (and cost a test of
+ * a bool) unless $REZOUND_TRACE is set to a filename when the program starts.  Then, at
+ * exit, everything recorded is written to that file in Chrome's trace event JSON format
+ * which chrome://tracing or https://ui.perfetto.dev can show as a timeline per thread.
+ */
+
+#ifdef ENABLE_TRACING
+
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+
+class CTrace
+{
+public:
+	static bool isEnabled() { return enabled; }
+
+	// nanoseconds on a monotonic clock
+	static int64_t now();
+
+	static void addScope(const char *name,int64_t begin,int64_t end);
+	static void addCounter(const char *name,int64_t value);
+
+	// writes the events recorded so far (this is done automatically at exit)
+	static void writeJSON(const std::string filename);
+
+private:
+	static bool enabled;
+	friend struct CTraceInit;
+};
+
+class CTraceScope
+{
+public:
+	CTraceScope(const char *_name) :
+		name(CTrace::isEnabled() ? _name : NULL),
+		begin(name ? CTrace::now() : 0)
+	{
+	}
+
+	~CTraceScope()
+	{
+		if(name)
+			CTrace::addScope(name,begin,CTrace::now());
+	}
+
+private:
+	const char * const name;
+	const int64_t begin;
+};
+
+class CTraceCounter
+{
+public:
+	CTraceCounter(const char *_name) :
+		name(_name),
+		total(0)
+	{
+	}
+
+	void add(int64_t delta)
+	{
+		const int64_t t=(total+=delta);
+		if(CTrace::isEnabled())
+			CTrace::addCounter(name,t);
+	}
+
+private:
+	const char * const name;
+	std::atomic<int64_t> total;
+};
+
+#define TRACE_CONCAT_(a,b) a##b
+#define TRACE_CONCAT(a,b) TRACE_CONCAT_(a,b)
+
+#define TRACE_SCOPE(name) CTraceScope TRACE_CONCAT(traceScope,__LINE__)(name)
+#define TRACE_COUNTER(name,value) do { if(CTrace::isEnabled()) CTrace::addCounter((name),(int64_t)(value)); } while(0)
+#define TRACE_COUNT(name,delta) do { static CTraceCounter traceCounter(name); traceCounter.add((int64_t)(delta)); } while(0)
+
+#else
+
+#define TRACE_SCOPE(name) do { } while(0)
+#define TRACE_COUNTER(name,value) do { } while(0)
+#define TRACE_COUNT(name,delta) do { } while(0)
+
+#endif
+
+#endif
@@ -47,7 +47,7 @@ template <class type> TMemoryPipe<type>::~TMemoryPipe()
 	closeWrite();
 
 	if(buffer) {
-		munlock(buffer, bufferSize);
+		munlock(buffer, bufferSize*sizeof(type));
 		delete [] buffer;
 	}
 }
@@ -61,7 +61,7 @@ template <class type> void TMemoryPipe<type>::setSize(int pipeSize)
 
 	if(buffer) {
 		// release lock on not-swapping memory
-		munlock(buffer, bufferSize);
+		munlock(buffer, bufferSize*sizeof(type));
 	}
 
 	type *temp=new type[pipeSize+1];
@@ -71,7 +71,7 @@ template <class type> void TMemoryPipe<type>::setSize(int pipeSize)
 	bufferSize=pipeSize+1;
 
 	// lock memory for being swapped (for JACK's sake)
-	mlock(buffer, bufferSize);
+	mlock(buffer, bufferSize*sizeof(type));
 }
 
 template <class type> void TMemoryPipe<type>::open()